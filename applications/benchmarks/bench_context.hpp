@@ -0,0 +1,24 @@
+#pragma once
+#include "benchmark.hpp"
+#include <core/engine/engine.hpp>
+
+/**
+ * @file bench_context.hpp
+ * @brief Access to the managers of an engine that is set up but never runs its main loop.
+ */
+
+namespace legion::benchmarks
+{
+    /**@class engine_context
+     * @brief The engine wires up all the static manager pointers on construction, this exposes them to the benchmarks.
+     */
+    class engine_context : public Module
+    {
+    public:
+        void setup() override {}
+
+        static ecs::EcsRegistry& ecs() { return *m_ecs; }
+        static scheduling::Scheduler& scheduler() { return *m_scheduler; }
+        static events::EventBus& eventBus() { return *m_eventBus; }
+    };
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "benchmark.hpp"
+#include <core/containers/delegate.hpp>
+
+#include <functional>
+
+/**
+ * @file bench_delegate.hpp
+ * @brief Creation, copy and invocation cost of delegates against the previous heap allocating delegate and std::function.
+ */
+
+namespace legion::benchmarks
+{
+    namespace detail
+    {
+        /**@brief Reduced copy of the delegate before small buffer storage, lambdas live on the heap and copies clone them.
+         */
+        template<typename T>
+        class heap_delegate;
+
+        template<typename return_type, typename... parameter_types>
+        class heap_delegate<return_type(parameter_types...)>
+        {
+            using stub_type = return_type(*)(void*, parameter_types...);
+            using allocator = void* (*)(void*);
+            using deleter = void(*)(void*);
+
+            void* m_object = nullptr;
+            stub_type m_stub = nullptr;
+            allocator m_copy = nullptr;
+            deleter m_delete = nullptr;
+
+            template<typename lambda_type>
+            static return_type lambda_stub(void* ptr, parameter_types... arguments)
+            {
+                return (*static_cast<lambda_type*>(ptr))(arguments...);
+            }
+
+        public:
+            heap_delegate() = default;
+
+            template<typename lambda_type>
+            heap_delegate(const lambda_type& lambda)
+                : m_object(new lambda_type(lambda)), m_stub(&lambda_stub<lambda_type>),
+                m_copy([](void* ptr) { return static_cast<void*>(new lambda_type(*static_cast<lambda_type*>(ptr))); }),
+                m_delete([](void* ptr) { delete static_cast<lambda_type*>(ptr); }) {}
+
+            heap_delegate(const heap_delegate& other)
+                : m_object(other.m_copy ? other.m_copy(other.m_object) : other.m_object), m_stub(other.m_stub), m_copy(other.m_copy), m_delete(other.m_delete) {}
+
+            heap_delegate& operator=(const heap_delegate&) = delete;
+
+            ~heap_delegate()
+            {
+                if (m_delete)
+                    m_delete(m_object);
+            }
+
+            return_type operator()(parameter_types... arguments) const
+            {
+                return m_stub(m_object, arguments...);
+            }
+        };
+
+        struct delegate_target
+        {
+            size_type value = 0;
+            size_type add(size_type x) { return value += x; }
+        };
+
+        template<typename delegate_type>
+        void run_delegate_workload(BenchmarkRunner& runner, std::string_view name, const delegate_type& func, size_type operations)
+        {
+            runner.measure("delegate", std::string(name) + "_invoke", 0, operations, [&]()
+                {
+                    size_type sum = 0;
+                    for (size_type i = 0; i < operations; i++)
+                        sum += func(i);
+                    do_not_optimize(sum);
+                });
+
+            runner.measure("delegate", std::string(name) + "_copy", 0, operations, [&]()
+                {
+                    for (size_type i = 0; i < operations; i++)
+                    {
+                        delegate_type copy(func);
+                        do_not_optimize(copy);
+                    }
+                });
+        }
+    }
+
+    /**@brief Benchmarks for the delegate suite.
+     */
+    inline void run_delegate_benchmarks(BenchmarkRunner& runner)
+    {
+        if (!runner.enabled("delegate"))
+            return;
+
+        constexpr size_type operations = 1000000;
+
+        using signature = size_type(size_type);
+        detail::delegate_target target;
+        size_type a = 1, b = 2, c = 3;
+        const char padding[64] = {}; // Pushes the capture over the inline storage size of delegates.
+
+        auto smallLambda = [a, b, c](size_type x) { return x * a + b - c; };
+        auto bigLambda = [a, padding](size_type x) { return x * a + static_cast<size_type>(padding[x & 63]); };
+
+        detail::run_delegate_workload(runner, "member_delegate", delegate<signature>::create<detail::delegate_target, &detail::delegate_target::add>(&target), operations);
+        detail::run_delegate_workload(runner, "small_lambda_heap_delegate", detail::heap_delegate<signature>(smallLambda), operations);
+        detail::run_delegate_workload(runner, "small_lambda_delegate", delegate<signature>(smallLambda), operations);
+        detail::run_delegate_workload(runner, "small_lambda_std_function", std::function<signature>(smallLambda), operations);
+        detail::run_delegate_workload(runner, "big_lambda_heap_delegate", detail::heap_delegate<signature>(bigLambda), operations);
+        detail::run_delegate_workload(runner, "big_lambda_delegate", delegate<signature>(bigLambda), operations);
+        detail::run_delegate_workload(runner, "big_lambda_std_function", std::function<signature>(bigLambda), operations);
+
+        runner.measure("delegate", "small_lambda_heap_delegate_create", 0, operations, [&]()
+            {
+                for (size_type i = 0; i < operations; i++)
+                {
+                    detail::heap_delegate<signature> func(smallLambda);
+                    do_not_optimize(func);
+                }
+            });
+
+        runner.measure("delegate", "small_lambda_delegate_create", 0, operations, [&]()
+            {
+                for (size_type i = 0; i < operations; i++)
+                {
+                    delegate<signature> func(smallLambda);
+                    do_not_optimize(func);
+                }
+            });
+
+        runner.measure("delegate", "small_lambda_move_only_delegate_move", 0, operations, [&]()
+            {
+                move_only_delegate<signature> func(smallLambda);
+                for (size_type i = 0; i < operations; i++)
+                {
+                    move_only_delegate<signature> moved(std::move(func));
+                    func = std::move(moved);
+                }
+                do_not_optimize(func);
+            });
+
+        multicast_delegate<size_type(size_type)> multicast;
+        for (size_type i = 0; i < 8; i++)
+            multicast += smallLambda;
+
+        runner.measure("delegate", "multicast_8_invoke", 8, operations, [&]()
+            {
+                for (size_type i = 0; i < operations / 8; i++)
+                    multicast(i);
+                do_not_optimize(multicast);
+            });
+    }
+}
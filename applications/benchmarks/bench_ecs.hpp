@@ -0,0 +1,263 @@
+#pragma once
+#include "bench_context.hpp"
+
+#include <algorithm>
+
+/**
+ * @file bench_ecs.hpp
+ * @brief Entity and component life-time, query iteration and component handle contention benchmarks.
+ */
+
+namespace legion::benchmarks
+{
+    struct bench_position
+    {
+        float x = 0.f, y = 0.f, z = 0.f;
+    };
+
+    struct bench_velocity
+    {
+        float x = 1.f, y = 2.f, z = 3.f;
+    };
+
+    // Same layout as bench_position and bench_velocity, but reported with storage_mode::chunked.
+    struct bench_chunked_position
+    {
+        float x = 0.f, y = 0.f, z = 0.f;
+    };
+
+    struct bench_chunked_velocity
+    {
+        float x = 1.f, y = 2.f, z = 3.f;
+    };
+
+    struct bench_counter
+    {
+        int64 value = 0;
+
+        bench_counter operator+(const bench_counter& other) const { return bench_counter{ value + other.value }; }
+        bench_counter operator*(const bench_counter& other) const { return bench_counter{ value * other.value }; }
+    };
+
+    namespace detail
+    {
+        inline ecs::entity_container create_bench_entities(size_type count, bool withComponents)
+        {
+            auto& registry = engine_context::ecs();
+            if (withComponents)
+                return registry.createEntities(count, bench_position{}, bench_velocity{});
+            return registry.createEntities(count);
+        }
+
+        inline void run_entity_benchmarks(BenchmarkRunner& runner, size_type count)
+        {
+            auto& registry = engine_context::ecs();
+            ecs::entity_container entities;
+            entities.reserve(count);
+
+            // Every run starts from a fresh set of entities, so repetitions don't work on what the previous run left behind.
+            auto clear = [&]()
+            {
+                registry.destroyEntities(entities);
+                entities.clear();
+            };
+
+            auto recreate = [&](bool withComponents)
+            {
+                clear();
+                entities = create_bench_entities(count, withComponents);
+            };
+
+            runner.measure("ecs", "create_entity", count, count, clear, [&]()
+                {
+                    for (size_type i = 0; i < count; i++)
+                        entities.push_back(registry.createEntity());
+                });
+
+            runner.measure("ecs", "add_component", count, count, [&]() { recreate(false); }, [&]()
+                {
+                    for (auto& entity : entities)
+                        entity.add_component<bench_position>();
+                });
+
+            runner.measure("ecs", "remove_component", count, count, [&]() { recreate(true); }, [&]()
+                {
+                    for (auto& entity : entities)
+                        entity.remove_component<bench_position>();
+                });
+
+            runner.measure("ecs", "destroy_entity", count, count, [&]() { recreate(false); }, [&]()
+                {
+                    for (auto& entity : entities)
+                        registry.destroyEntity(entity);
+                    entities.clear();
+                });
+
+            runner.measure("ecs", "create_entities_batch", count, count, clear, [&]()
+                {
+                    entities = create_bench_entities(count, true);
+                });
+
+            runner.measure("ecs", "destroy_entities_batch", count, count, [&]() { recreate(true); }, [&]()
+                {
+                    registry.destroyEntities(entities);
+                    entities.clear();
+                });
+        }
+
+        inline void run_query_benchmarks(BenchmarkRunner& runner, size_type count)
+        {
+            constexpr size_type frames = 10;
+
+            auto& registry = engine_context::ecs();
+            auto entities = create_bench_entities(count, true);
+            auto query = registry.createQuery<bench_position, bench_velocity>();
+
+            runner.measure("ecs", "query_get_submit", count, count * frames, [&]()
+                {
+                    for (size_type frame = 0; frame < frames; frame++)
+                    {
+                        query.queryEntities();
+                        auto& positions = query.get<bench_position>();
+                        auto& velocities = query.get<bench_velocity>();
+
+                        for (size_type i = 0; i < query.size(); i++)
+                        {
+                            positions[i].x += velocities[i].x;
+                            positions[i].y += velocities[i].y;
+                            positions[i].z += velocities[i].z;
+                        }
+
+                        query.submit<bench_position>();
+                    }
+                });
+
+            runner.measure("ecs", "query_view", count, count * frames, [&]()
+                {
+                    for (size_type frame = 0; frame < frames; frame++)
+                    {
+                        query.queryEntities();
+                        auto positions = query.view<bench_position, ecs::access_mode::read_write>();
+                        auto velocities = query.view<bench_velocity>();
+
+                        for (size_type i = 0; i < positions.size(); i++)
+                        {
+                            bench_position& position = positions[i];
+                            const bench_velocity& velocity = velocities[i];
+                            position.x += velocity.x;
+                            position.y += velocity.y;
+                            position.z += velocity.z;
+                        }
+                    }
+                });
+
+            registry.destroyEntities(entities);
+
+            auto chunkedEntities = registry.createEntities(count, bench_chunked_position{}, bench_chunked_velocity{});
+            auto chunkedQuery = registry.createQuery<bench_chunked_position, bench_chunked_velocity>();
+
+            runner.measure("ecs", "query_view_chunked", count, count * frames, [&]()
+                {
+                    for (size_type frame = 0; frame < frames; frame++)
+                    {
+                        chunkedQuery.queryEntities();
+                        auto positions = chunkedQuery.view<bench_chunked_position, ecs::access_mode::read_write>();
+                        auto velocities = chunkedQuery.view<bench_chunked_velocity>();
+
+                        for (size_type i = 0; i < positions.size(); i++)
+                        {
+                            bench_chunked_position& position = positions[i];
+                            const bench_chunked_velocity& velocity = velocities[i];
+                            position.x += velocity.x;
+                            position.y += velocity.y;
+                            position.z += velocity.z;
+                        }
+                    }
+                });
+
+            runner.measure("ecs", "query_for_each_chunk", count, count * frames, [&]()
+                {
+                    for (size_type frame = 0; frame < frames; frame++)
+                    {
+                        chunkedQuery.for_each_chunk<bench_chunked_position, const bench_chunked_velocity>(
+                            [](size_type chunkSize, const id_type*, bench_chunked_position* positions, const bench_chunked_velocity* velocities)
+                            {
+                                for (size_type i = 0; i < chunkSize; i++)
+                                {
+                                    positions[i].x += velocities[i].x;
+                                    positions[i].y += velocities[i].y;
+                                    positions[i].z += velocities[i].z;
+                                }
+                            });
+                    }
+                });
+
+            registry.destroyEntities(chunkedEntities);
+        }
+
+        /**@brief Every thread works on the same component when shared, otherwise each thread has a component of its own.
+         */
+        inline void run_handle_benchmarks(BenchmarkRunner& runner, size_type threadCount, bool shared)
+        {
+            constexpr size_type operations = 20000;
+
+            auto& registry = engine_context::ecs();
+            auto entities = registry.createEntities(shared ? 1 : threadCount, bench_counter{});
+
+            std::string suffix = shared ? "_shared" : "_private";
+
+            runner.measure_threaded("ecs", "handle_read" + suffix, threadCount, operations, [&](size_type thread)
+                {
+                    auto handle = entities[shared ? 0 : thread].get_component_handle<bench_counter>();
+                    int64 sum = 0;
+                    for (size_type i = 0; i < operations; i++)
+                        sum += handle.read().value;
+                    do_not_optimize(sum);
+                });
+
+            runner.measure_threaded("ecs", "handle_write" + suffix, threadCount, operations, [&](size_type thread)
+                {
+                    auto handle = entities[shared ? 0 : thread].get_component_handle<bench_counter>();
+                    for (size_type i = 0; i < operations; i++)
+                        handle.write(bench_counter{ static_cast<int64>(i) });
+                });
+
+            runner.measure_threaded("ecs", "handle_fetch_add" + suffix, threadCount, operations, [&](size_type thread)
+                {
+                    auto handle = entities[shared ? 0 : thread].get_component_handle<bench_counter>();
+                    for (size_type i = 0; i < operations; i++)
+                        handle.fetch_add(bench_counter{ 1 });
+                });
+
+            registry.destroyEntities(entities);
+        }
+    }
+
+    /**@brief Benchmarks for the ecs suite.
+     */
+    inline void run_ecs_benchmarks(BenchmarkRunner& runner)
+    {
+        if (!runner.enabled("ecs"))
+            return;
+
+        auto& registry = engine_context::ecs();
+        registry.reportComponentType<bench_position>();
+        registry.reportComponentType<bench_velocity>();
+        registry.reportComponentType<bench_chunked_position>(ecs::storage_mode::chunked);
+        registry.reportComponentType<bench_chunked_velocity>(ecs::storage_mode::chunked);
+        registry.reportComponentType<bench_counter>();
+
+        for (size_type count : { 1000, 10000, 100000 })
+            detail::run_entity_benchmarks(runner, count);
+
+        for (size_type count : { 1000, 10000, 100000 })
+            detail::run_query_benchmarks(runner, count);
+
+        const size_type maxThreads = std::max<size_type>(std::thread::hardware_concurrency(), 1);
+        for (size_type threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            detail::run_handle_benchmarks(runner, threads, true);
+            detail::run_handle_benchmarks(runner, threads, false);
+        }
+    }
+}
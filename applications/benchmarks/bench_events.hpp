@@ -0,0 +1,89 @@
+#pragma once
+#include "bench_context.hpp"
+
+/**
+ * @file bench_events.hpp
+ * @brief Throughput of raising events on the event bus with different kinds of subscribers.
+ */
+
+namespace legion::benchmarks
+{
+    struct bench_event final : public events::event<bench_event>
+    {
+        size_type value;
+        explicit bench_event(size_type value) : value(value) {}
+    };
+
+    struct bench_batched_event final : public events::event<bench_batched_event>
+    {
+        size_type value;
+        explicit bench_batched_event(size_type value) : value(value) {}
+    };
+
+    struct bench_unobserved_event final : public events::event<bench_unobserved_event>
+    {
+        size_type value;
+        explicit bench_unobserved_event(size_type value) : value(value) {}
+    };
+
+    namespace detail
+    {
+        inline std::atomic<size_type> bench_event_sum = { 0 };
+
+        inline void on_bench_event(bench_event* event)
+        {
+            bench_event_sum.fetch_add(event->value, std::memory_order_relaxed);
+        }
+
+        inline void on_bench_event_batch(const std::vector<bench_batched_event>& events)
+        {
+            bench_event_sum.fetch_add(events.size(), std::memory_order_relaxed);
+        }
+
+        template<typename event_type>
+        void run_raise_workload(BenchmarkRunner& runner, std::string_view name, size_type threadCount, size_type operations, id_type dispatchPoint = invalid_id)
+        {
+            auto& eventBus = engine_context::eventBus();
+            auto dispatch = [&]()
+            {
+                if (dispatchPoint != invalid_id)
+                    eventBus.dispatchEvents(dispatchPoint);
+            };
+
+            // Deferred events of the previous run get delivered first, so every run raises into an empty queue.
+            runner.measure_threaded("events", name, threadCount, operations, dispatch, [&](size_type)
+                {
+                    for (size_type i = 0; i < operations; i++)
+                        eventBus.raiseEvent<event_type>(i);
+                });
+
+            dispatch();
+        }
+    }
+
+    /**@brief Benchmarks for the events suite.
+     */
+    inline void run_event_benchmarks(BenchmarkRunner& runner)
+    {
+        if (!runner.enabled("events"))
+            return;
+
+        constexpr size_type operations = 100000;
+
+        auto& eventBus = engine_context::eventBus();
+        eventBus.bindToEvent<bench_event>(delegate<void(bench_event*)>::create<&detail::on_bench_event>());
+
+        id_type dispatchPoint = events::dispatch_point(nameHash("benchmarks"), events::dispatch_phase::chain_end);
+        eventBus.bindToEventBatch<bench_batched_event>(delegate<void(const std::vector<bench_batched_event>&)>::create<&detail::on_bench_event_batch>(), dispatchPoint);
+
+        const size_type maxThreads = std::max<size_type>(std::thread::hardware_concurrency(), 1);
+        for (size_type threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            detail::run_raise_workload<bench_unobserved_event>(runner, "raise_unobserved", threads, operations);
+            detail::run_raise_workload<bench_event>(runner, "raise_immediate", threads, operations);
+            detail::run_raise_workload<bench_batched_event>(runner, "raise_batched", threads, operations, dispatchPoint);
+        }
+
+        do_not_optimize(detail::bench_event_sum);
+    }
+}
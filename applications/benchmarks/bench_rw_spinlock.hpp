@@ -0,0 +1,129 @@
+#pragma once
+#include "benchmark.hpp"
+#include <core/async/rw_spinlock.hpp>
+#include <core/async/spinlock.hpp>
+
+#include <algorithm>
+#include <shared_mutex>
+
+/**
+ * @file bench_rw_spinlock.hpp
+ * @brief Contention benchmarks of async::rw_spinlock against async::spinlock and std::shared_mutex.
+ */
+
+namespace legion::benchmarks
+{
+    namespace detail
+    {
+        template<typename lock_type>
+        struct lock_traits
+        {
+            static void lock_read(lock_type& lock) { lock.lock_shared(); }
+            static void unlock_read(lock_type& lock) { lock.unlock_shared(); }
+            static void lock_write(lock_type& lock) { lock.lock(); }
+            static void unlock_write(lock_type& lock) { lock.unlock(); }
+        };
+
+        template<>
+        struct lock_traits<async::spinlock>
+        {
+            static void lock_read(async::spinlock& lock) { lock.lock(); }
+            static void unlock_read(async::spinlock& lock) { lock.unlock(); }
+            static void lock_write(async::spinlock& lock) { lock.lock(); }
+            static void unlock_write(async::spinlock& lock) { lock.unlock(); }
+        };
+
+        /**@brief Every thread takes the lock for write once every writeInterval operations, and for read otherwise.
+         */
+        template<typename lock_type>
+        void run_lock_workload(BenchmarkRunner& runner, std::string_view name, size_type threadCount, size_type writeInterval, size_type operations)
+        {
+            using traits = lock_traits<lock_type>;
+
+            lock_type lock;
+            size_type sharedValue = 0;
+
+            runner.measure_threaded("rw_spinlock", name, threadCount, operations, [&](size_type threadIndex)
+                {
+                    size_type sum = 0;
+                    for (size_type i = 0; i < operations; i++)
+                    {
+                        if (writeInterval && (i + threadIndex) % writeInterval == 0)
+                        {
+                            traits::lock_write(lock);
+                            sharedValue++;
+                            traits::unlock_write(lock);
+                        }
+                        else
+                        {
+                            traits::lock_read(lock);
+                            sum += sharedValue;
+                            traits::unlock_read(lock);
+                        }
+                    }
+                    do_not_optimize(sum);
+                });
+        }
+
+        template<typename lock_type>
+        void run_lock_suite(BenchmarkRunner& runner, std::string_view lockName, size_type operations)
+        {
+            const size_type maxThreads = std::max<size_type>(std::thread::hardware_concurrency(), 2);
+
+            for (size_type threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+            {
+                run_lock_workload<lock_type>(runner, std::string(lockName) + "_read_only", threadCount, 0, operations);
+                run_lock_workload<lock_type>(runner, std::string(lockName) + "_read_heavy", threadCount, 100, operations);
+                run_lock_workload<lock_type>(runner, std::string(lockName) + "_mixed", threadCount, 4, operations);
+                run_lock_workload<lock_type>(runner, std::string(lockName) + "_write_only", threadCount, 1, operations);
+            }
+        }
+    }
+
+    /**@brief Compares the lock types under read-only, read-heavy, mixed and write-only contention for 1 up to hardware_concurrency threads.
+     *        Also measures the reentrant paths that only rw_spinlock supports: nested reads and elevating a read to a write.
+     */
+    inline void run_rw_spinlock_benchmarks(BenchmarkRunner& runner)
+    {
+        if (!runner.enabled("rw_spinlock"))
+            return;
+
+        constexpr size_type operations = 200000;
+
+        detail::run_lock_suite<async::rw_spinlock>(runner, "rw_spinlock", operations);
+        detail::run_lock_suite<std::shared_mutex>(runner, "shared_mutex", operations);
+        detail::run_lock_suite<async::spinlock>(runner, "spinlock", operations);
+
+        async::rw_spinlock lock;
+        runner.measure("rw_spinlock", "rw_spinlock_nested_read", 1, operations, [&]()
+            {
+                for (size_type i = 0; i < operations; i++)
+                {
+                    async::readonly_guard outer(lock);
+                    async::readonly_guard inner(lock);
+                }
+            });
+
+        runner.measure("rw_spinlock", "rw_spinlock_read_to_write", 1, operations, [&]()
+            {
+                for (size_type i = 0; i < operations; i++)
+                {
+                    async::readonly_guard outer(lock);
+                    async::readwrite_guard inner(lock);
+                }
+            });
+
+        // Holding more locks at once than fit in the thread_local table of a thread forces the fallback path.
+        std::vector<async::rw_spinlock> locks(32);
+        runner.measure("rw_spinlock", "rw_spinlock_many_held", locks.size(), operations, [&]()
+            {
+                for (size_type i = 0; i < operations / locks.size(); i++)
+                {
+                    for (auto& l : locks)
+                        l.lock_shared();
+                    for (auto& l : locks)
+                        l.unlock_shared();
+                }
+            });
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "bench_context.hpp"
+
+/**
+ * @file bench_scheduler.hpp
+ * @brief Overhead of queueing jobs on the scheduler and waiting for them.
+ */
+
+namespace legion::benchmarks
+{
+    /**@brief Benchmarks for the scheduler suite.
+     */
+    inline void run_scheduler_benchmarks(BenchmarkRunner& runner)
+    {
+        if (!runner.enabled("scheduler"))
+            return;
+
+        auto& scheduler = engine_context::scheduler();
+        constexpr size_type totalJobs = 1 << 16;
+
+        for (size_type jobsPerPool : { 1, 16, 256, 4096 })
+        {
+            const size_type pools = totalJobs / jobsPerPool;
+            std::atomic<size_type> executed = { 0 };
+
+            runner.measure("scheduler", "queue_jobs_wait", jobsPerPool, totalJobs, [&]()
+                {
+                    for (size_type i = 0; i < pools; i++)
+                        scheduler.queueJobs(jobsPerPool, [&]() { executed.fetch_add(1, std::memory_order_relaxed); }).wait();
+                });
+
+            do_not_optimize(executed);
+        }
+
+        runner.measure("scheduler", "queue_nested_jobs_wait", 64, 64 * 64, [&]()
+            {
+                scheduler.queueJobs(64, [&]()
+                    {
+                        scheduler.queueJobs(64, []() {}).wait();
+                    }).wait();
+            });
+    }
+}
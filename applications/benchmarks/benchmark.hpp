@@ -0,0 +1,215 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/platform/platform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @file benchmark.hpp
+ * @brief Minimal benchmark harness that reports results in a machine-readable format.
+ */
+
+namespace legion::benchmarks
+{
+    using namespace legion::core;
+
+    /**@class benchmark_result
+     * @brief Timings of the repetitions of a benchmark.
+     */
+    struct benchmark_result
+    {
+        std::string suite;
+        std::string name;
+        size_type parameter; // Workload size or thread count, depending on the benchmark.
+        size_type operations; // Per repetition.
+        size_type repetitions;
+        double minNs; // Fastest repetition.
+        double medianNs;
+
+        L_NODISCARD double min_ns_per_op() const noexcept { return operations ? minNs / static_cast<double>(operations) : 0.0; }
+        L_NODISCARD double ns_per_op() const noexcept { return operations ? medianNs / static_cast<double>(operations) : 0.0; }
+    };
+
+    enum struct output_format { csv, json };
+
+    /**@class BenchmarkRunner
+     * @brief Collects the results of all benchmarks and prints them once all of them have run.
+     */
+    class BenchmarkRunner
+    {
+    private:
+        std::vector<benchmark_result> m_results;
+        std::string m_filter;
+        size_type m_warmups;
+        size_type m_repetitions;
+
+        /**@brief Run a workload the configured amount of warmup and timed times.
+         * @param setup Prepares the state of a single run, not timed.
+         * @param run Runs the workload and returns how long it took in nanoseconds.
+         */
+        template<typename Setup, typename Run>
+        void repeat(std::string_view suite, std::string_view name, size_type parameter, size_type operations, Setup&& setup, Run&& run)
+        {
+            for (size_type i = 0; i < m_warmups; i++)
+            {
+                setup();
+                run();
+            }
+
+            std::vector<double> timings;
+            timings.reserve(m_repetitions);
+            for (size_type i = 0; i < m_repetitions; i++)
+            {
+                setup();
+                timings.push_back(run());
+            }
+
+            report(suite, name, parameter, operations, timings);
+        }
+
+    public:
+        /**@param warmups Untimed runs of every workload before the timed ones, to warm up caches, allocators and the branch predictor.
+         * @param repetitions Timed runs of every workload, reported as their minimum and median.
+         */
+        BenchmarkRunner(std::string_view filter = "", size_type warmups = 1, size_type repetitions = 5)
+            : m_filter(filter), m_warmups(warmups), m_repetitions(std::max<size_type>(repetitions, 1)) {}
+
+        /**@brief Whether benchmarks of a certain suite should run with the current filter.
+         */
+        L_NODISCARD bool enabled(std::string_view suite) const
+        {
+            return m_filter.empty() || suite.find(m_filter) != std::string_view::npos;
+        }
+
+        /**@brief Time a single threaded workload.
+         * @param setup Gets called before every run of the workload without being timed, to restore the state the workload expects.
+         * @param func Workload to time, gets called once per run and should perform the given amount of operations.
+         */
+        template<typename Setup, typename Func>
+        void measure(std::string_view suite, std::string_view name, size_type parameter, size_type operations, Setup&& setup, Func&& func)
+        {
+            repeat(suite, name, parameter, operations, setup, [&]()
+                {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    func();
+                    auto end = std::chrono::high_resolution_clock::now();
+                    return std::chrono::duration<double, std::nano>(end - start).count();
+                });
+        }
+
+        /**@brief Time a single threaded workload that can run repeatedly without any setup.
+         */
+        template<typename Func>
+        void measure(std::string_view suite, std::string_view name, size_type parameter, size_type operations, Func&& func)
+        {
+            measure(suite, name, parameter, operations, []() {}, func);
+        }
+
+        /**@brief Time a workload that runs on multiple threads at once. All threads start at the same time.
+         * @param setup Gets called before every run of the workload without being timed.
+         * @param func Workload of a single thread, gets called once per thread and run with the index of the thread.
+         * @param operationsPerThread Amount of operations func performs.
+         */
+        template<typename Setup, typename Func>
+        void measure_threaded(std::string_view suite, std::string_view name, size_type threadCount, size_type operationsPerThread, Setup&& setup, Func&& func)
+        {
+            repeat(suite, name, threadCount, threadCount * operationsPerThread, setup, [&]()
+                {
+                    std::atomic<size_type> ready = { 0 };
+                    std::atomic_bool go = { false };
+
+                    std::vector<std::thread> threads;
+                    threads.reserve(threadCount);
+                    for (size_type i = 0; i < threadCount; i++)
+                        threads.emplace_back([&, i]()
+                            {
+                                ready.fetch_add(1, std::memory_order_relaxed);
+                                while (!go.load(std::memory_order_acquire))
+                                    std::this_thread::yield();
+                                func(i);
+                            });
+
+                    while (ready.load(std::memory_order_relaxed) != threadCount)
+                        std::this_thread::yield();
+
+                    auto start = std::chrono::high_resolution_clock::now();
+                    go.store(true, std::memory_order_release);
+                    for (auto& thread : threads)
+                        thread.join();
+                    auto end = std::chrono::high_resolution_clock::now();
+                    return std::chrono::duration<double, std::nano>(end - start).count();
+                });
+        }
+
+        template<typename Func>
+        void measure_threaded(std::string_view suite, std::string_view name, size_type threadCount, size_type operationsPerThread, Func&& func)
+        {
+            measure_threaded(suite, name, threadCount, operationsPerThread, []() {}, func);
+        }
+
+        void report(std::string_view suite, std::string_view name, size_type parameter, size_type operations, std::vector<double> timings)
+        {
+            std::sort(timings.begin(), timings.end());
+            size_type middle = timings.size() / 2;
+            double median = timings.size() % 2 ? timings[middle] : (timings[middle - 1] + timings[middle]) * 0.5;
+
+            m_results.push_back(benchmark_result{ std::string(suite), std::string(name), parameter, operations, timings.size(), timings.front(), median });
+            std::cerr << suite << '/' << name << '/' << parameter << ": " << m_results.back().ns_per_op() << " ns/op (min " << m_results.back().min_ns_per_op() << ")\n";
+        }
+
+        L_NODISCARD const std::vector<benchmark_result>& results() const noexcept { return m_results; }
+
+        /**@brief Print all results. Progress is printed to stderr so stdout only contains the results.
+         */
+        void print(std::ostream& stream, output_format format) const
+        {
+            if (format == output_format::csv)
+            {
+                stream << "suite,name,parameter,operations,repetitions,min_ns,median_ns,min_ns_per_op,median_ns_per_op\n";
+                for (auto& result : m_results)
+                    stream << result.suite << ',' << result.name << ',' << result.parameter << ',' << result.operations << ',' << result.repetitions << ','
+                    << result.minNs << ',' << result.medianNs << ',' << result.min_ns_per_op() << ',' << result.ns_per_op() << '\n';
+                return;
+            }
+
+            stream << "[\n";
+            for (size_type i = 0; i < m_results.size(); i++)
+            {
+                auto& result = m_results[i];
+                stream << "  { \"suite\": \"" << result.suite << "\", \"name\": \"" << result.name << "\", \"parameter\": " << result.parameter
+                    << ", \"operations\": " << result.operations << ", \"repetitions\": " << result.repetitions
+                    << ", \"min_ns\": " << result.minNs << ", \"median_ns\": " << result.medianNs
+                    << ", \"min_ns_per_op\": " << result.min_ns_per_op() << ", \"median_ns_per_op\": " << result.ns_per_op()
+                    << (i + 1 < m_results.size() ? " },\n" : " }\n");
+            }
+            stream << "]\n";
+        }
+    };
+
+    namespace detail
+    {
+        // Only written, never read. The volatile store is what keeps the benchmarked value alive on compilers without GNU inline asm.
+        inline const void* volatile escapeSink = nullptr;
+    }
+
+    /**@brief Prevent the optimizer from removing a computation whose result is otherwise unused.
+     */
+    template<typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        // Escaping the address forces the value to be materialized.
+#if defined(LEGION_GCC) || defined(LEGION_CLANG_GCC)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        detail::escapeSink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+}
@@ -0,0 +1,71 @@
+#include "benchmark.hpp"
+#include "bench_rw_spinlock.hpp"
+#include "bench_delegate.hpp"
+#include "bench_ecs.hpp"
+#include "bench_scheduler.hpp"
+#include "bench_events.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+/**
+ * Usage: benchmarks [--json] [--out file] [--warmups n] [--repetitions n] [suite filter]
+ * Results are written to stdout, or the given file, as csv (default) or json. Progress is written to stderr.
+ * Every workload runs 1 untimed warmup and 5 timed repetitions by default, the minimum and median of the repetitions are reported.
+ * Engine log messages also end up on stdout, use --out when the results need to be parsed.
+ * Suites: rw_spinlock, delegate, ecs, scheduler, events.
+ */
+int main(int argc, char** argv)
+{
+    using namespace legion::benchmarks;
+
+    output_format format = output_format::csv;
+    std::string_view filter;
+    std::string_view outputPath;
+    legion::core::size_type warmups = 1;
+    legion::core::size_type repetitions = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+            format = output_format::json;
+        else if (std::strcmp(argv[i], "--csv") == 0)
+            format = output_format::csv;
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (std::strcmp(argv[i], "--warmups") == 0 && i + 1 < argc)
+            warmups = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            repetitions = std::strtoull(argv[++i], nullptr, 10);
+        else
+            filter = argv[i];
+    }
+
+    BenchmarkRunner runner(filter, warmups, repetitions);
+
+    // Sets up all the managers without ever running the engine loop.
+    legion::core::Engine engine(argc, argv);
+
+    run_rw_spinlock_benchmarks(runner);
+    run_delegate_benchmarks(runner);
+    run_ecs_benchmarks(runner);
+    run_scheduler_benchmarks(runner);
+    run_event_benchmarks(runner);
+
+    if (outputPath.empty())
+    {
+        runner.print(std::cout, format);
+        return 0;
+    }
+
+    std::ofstream file{ std::string(outputPath) };
+    if (!file.is_open())
+    {
+        std::cerr << "Could not open " << outputPath << '\n';
+        return 1;
+    }
+
+    runner.print(file, format);
+    return 0;
+}
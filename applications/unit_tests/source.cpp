@@ -14,6 +14,11 @@
 
 #include "doctest.h"
 #include "test_filesystem.hpp"
+#include "test_delegate.hpp"
+#include "test_ecs.hpp"
+#include "test_physics.hpp"
+#include "test_scenes.hpp"
+#include "test_tracing.hpp"
 
 using namespace legion;
 
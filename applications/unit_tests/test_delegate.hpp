@@ -0,0 +1,197 @@
+#pragma once
+#include <core/containers/delegate.hpp>
+#include <core/events/eventbus.hpp>
+
+#include <array>
+#include <memory>
+
+#include "doctest.h"
+
+inline namespace {
+
+    using namespace ::legion::core;
+
+    // Counts how often the callable itself gets moved, inline callables move along with the delegate, heap callables stay where they are.
+    template<size_type padding>
+    struct move_counting_callable
+    {
+        int* moves;
+        std::array<byte, padding> data{};
+
+        move_counting_callable(int* counter) noexcept : moves(counter) {}
+        move_counting_callable(const move_counting_callable& other) = default;
+        move_counting_callable(move_counting_callable&& other) noexcept : moves(other.moves), data(other.data) { (*moves)++; }
+
+        int operator()(int value) const { return value + 1; }
+    };
+
+    struct delegate_target
+    {
+        int calls = 0;
+
+        void count(int) { calls++; }
+    };
+
+    struct delegate_test_event : public events::event<delegate_test_event>
+    {
+        int value = 0;
+
+        delegate_test_event(int v) : value(v) {}
+    };
+
+    struct delegate_test_listener
+    {
+        int received = 0;
+
+        void onEvent(delegate_test_event* event) { received += event->value; }
+    };
+}
+
+TEST_CASE("[core:delegate] small callables are stored inside the delegate")
+{
+    int moves = 0;
+
+    SUBCASE("callables that fit the buffer move along with the delegate")
+    {
+        using callable = move_counting_callable<16>;
+        static_assert(::legion::core::detail::fits_inline_v<callable>);
+
+        delegate<int(int)> first = callable(&moves);
+        moves = 0;
+        delegate<int(int)> second = std::move(first);
+        CHECK_EQ(moves, 1);
+        CHECK_EQ(second(1), 2);
+    }
+
+    SUBCASE("callables bigger than the buffer stay on the heap")
+    {
+        using callable = move_counting_callable<delegate_inline_size>;
+        static_assert(!::legion::core::detail::fits_inline_v<callable>);
+
+        delegate<int(int)> first = callable(&moves);
+        moves = 0;
+        delegate<int(int)> second = std::move(first);
+        CHECK_EQ(moves, 0);
+        CHECK_EQ(second(1), 2);
+    }
+
+    SUBCASE("copies own a separate callable")
+    {
+        int calls = 0;
+        delegate<void()> first = [&calls, count = 0]() mutable { calls = ++count; };
+        delegate<void()> second = first;
+
+        first();
+        first();
+        second();
+        CHECK_EQ(calls, 1);
+    }
+}
+
+TEST_CASE("[core:delegate] move only delegates take callables that can't be copied")
+{
+    auto value = std::make_unique<int>(41);
+    move_only_delegate<int()> first = [value = std::move(value)]() { return *value + 1; };
+    move_only_delegate<int()> second = std::move(first);
+
+    CHECK(first.isNull());
+    CHECK_EQ(second(), 42);
+
+    move_only_multicast_delegate<void(int&)> multicast;
+    multicast += [owned = std::make_unique<int>(2)](int& sum) { sum += *owned; };
+    multicast += [owned = std::make_unique<int>(3)](int& sum) { sum += *owned; };
+
+    int sum = 0;
+    multicast(sum);
+    CHECK_EQ(sum, 5);
+
+    delegate<int()> copyable = []() { return 7; };
+    move_only_delegate<int()> converted = std::move(copyable);
+    CHECK_EQ(converted(), 7);
+}
+
+TEST_CASE("[core:delegate] equality")
+{
+    delegate_target target;
+    delegate_target other;
+
+    auto first = delegate<void(int)>::create<delegate_target, &delegate_target::count>(&target);
+    auto second = delegate<void(int)>::create<delegate_target, &delegate_target::count>(&target);
+    auto third = delegate<void(int)>::create<delegate_target, &delegate_target::count>(&other);
+
+    SUBCASE("member function delegates compare by function and object")
+    {
+        CHECK(first == second);
+        CHECK(first != third);
+    }
+
+    SUBCASE("owned callables are only equal to themselves")
+    {
+        auto lambda = [](int) {};
+        delegate<void(int)> a = lambda;
+        delegate<void(int)> b = a;
+
+        CHECK(a == a);
+        CHECK(a != b);
+        CHECK(a != first);
+    }
+
+    SUBCASE("multicast delegates remove member function delegates by value")
+    {
+        multicast_delegate<void(int)> multicast;
+        multicast += first;
+        multicast += third;
+
+        multicast -= second;
+        CHECK_EQ(multicast.size(), 1);
+
+        multicast(0);
+        CHECK_EQ(target.calls, 0);
+        CHECK_EQ(other.calls, 1);
+    }
+}
+
+TEST_CASE("[core:delegate] event bus subscriptions")
+{
+    events::EventBus bus;
+    delegate_test_listener listener;
+    auto callback = delegate<void(delegate_test_event*)>::create<delegate_test_listener, &delegate_test_listener::onEvent>(&listener);
+
+    SUBCASE("member function subscribers can be unbound")
+    {
+        bus.bindToEvent<delegate_test_event>(callback);
+        bus.raiseEvent<delegate_test_event>(2);
+        CHECK_EQ(listener.received, 2);
+
+        bus.unbindFromEvent<delegate_test_event>(callback);
+        bus.raiseEvent<delegate_test_event>(3);
+        CHECK_EQ(listener.received, 2);
+    }
+
+    SUBCASE("unbinding an equivalent lambda does nothing")
+    {
+        int received = 0;
+        delegate<void(delegate_test_event*)> lambda = [&received](delegate_test_event* event) { received += event->value; };
+
+        bus.bindToEvent<delegate_test_event>(lambda);
+        bus.unbindFromEvent<delegate_test_event>(lambda);
+        bus.raiseEvent<delegate_test_event>(4);
+        CHECK_EQ(received, 4);
+    }
+
+    SUBCASE("callbacks can bind while being notified")
+    {
+        int calls = 0;
+        bus.bindToEvent<delegate_test_event>([&](delegate_test_event*)
+            {
+                if (!calls++)
+                    bus.bindToEvent<delegate_test_event>(callback);
+            });
+
+        bus.raiseEvent<delegate_test_event>(5);
+        CHECK_EQ(listener.received, 0);
+
+        bus.raiseEvent<delegate_test_event>(6);
+        CHECK_EQ(listener.received, 6);
+    }
+}
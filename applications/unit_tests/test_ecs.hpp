@@ -0,0 +1,721 @@
+#pragma once
+#include <core/ecs/ecs.hpp>
+#include <core/defaults/hierarchysystem.hpp>
+
+#include <thread>
+
+#include "doctest.h"
+
+inline namespace {
+
+    using namespace ::legion::core;
+
+    // The tests run on the registry and event bus of the engine, the component handles already have access to them.
+    struct registry_access : public ecs::component_handle_base
+    {
+        static ecs::EcsRegistry& get() { return *m_registry; }
+        static events::EventBus& eventBus() { return *m_eventBus; }
+    };
+
+    struct buffered_value
+    {
+        int value = 0;
+    };
+
+    struct archetype_position
+    {
+        float x = 0.f, y = 0.f, z = 0.f;
+    };
+
+    struct archetype_tag
+    {
+        int64 value = 0;
+    };
+
+    // Owns heap memory, so a copy from a component that got moved away while the family grew comes out empty.
+    struct cloned_values
+    {
+        std::vector<int> values;
+    };
+
+    // Counts how often init ran on a value, copies keep the count of the component they were copied from.
+    struct prefab_counter
+    {
+        int inits = 0;
+
+        static void init(prefab_counter& value) { value.inits++; }
+    };
+
+    // Root with a sparse and an initialized family, one child with a chunked family and a grandchild with both a sparse and a chunked family.
+    ecs::entity_handle createPrefabTree(ecs::EcsRegistry& registry)
+    {
+        registry.reportComponentType<buffered_value>();
+        registry.reportComponentType<prefab_counter>();
+        registry.reportComponentType<archetype_position>(ecs::storage_mode::chunked);
+
+        ecs::entity_handle root = registry.createEntity();
+        root.set_name("prefab root");
+        root.add_component(buffered_value{ 1 });
+        root.add_component<prefab_counter>();
+
+        ecs::entity_handle first = registry.createEntity();
+        first.set_name("first");
+        first.set_parent(root);
+        first.add_component(archetype_position{ 1.f, 2.f, 3.f });
+
+        ecs::entity_handle second = registry.createEntity();
+        second.set_name("second");
+        second.set_parent(root);
+        second.add_component(buffered_value{ 2 });
+
+        ecs::entity_handle grandchild = registry.createEntity();
+        grandchild.set_name("grandchild");
+        grandchild.set_parent(first);
+        grandchild.add_component(buffered_value{ 3 });
+        grandchild.add_component(archetype_position{ 4.f, 5.f, 6.f });
+
+        return root;
+    }
+
+    // Walks a copy of a prefab alongside the entities it was created from and checks names, links and components.
+    void checkPrefabCopy(ecs::entity_handle expected, ecs::entity_handle actual, std::vector<std::pair<ecs::entity_handle, ecs::entity_handle>>& nodes)
+    {
+        REQUIRE(actual);
+        CHECK_NE(actual, expected);
+        CHECK_EQ(actual.get_name(), expected.get_name());
+        nodes.emplace_back(expected, actual);
+
+        REQUIRE_EQ(actual.has_component<buffered_value>(), expected.has_component<buffered_value>());
+        if (expected.has_component<buffered_value>())
+            CHECK_EQ(actual.read_component<buffered_value>().value, expected.read_component<buffered_value>().value);
+
+        REQUIRE_EQ(actual.has_component<prefab_counter>(), expected.has_component<prefab_counter>());
+        if (expected.has_component<prefab_counter>())
+            CHECK_EQ(actual.read_component<prefab_counter>().inits, 1); // Copied, not initialized again.
+
+        REQUIRE_EQ(actual.has_component<archetype_position>(), expected.has_component<archetype_position>());
+        if (expected.has_component<archetype_position>())
+        {
+            archetype_position value = actual.read_component<archetype_position>();
+            archetype_position source = expected.read_component<archetype_position>();
+            CHECK_EQ(value.x, source.x);
+            CHECK_EQ(value.y, source.y);
+            CHECK_EQ(value.z, source.z);
+        }
+
+        REQUIRE_EQ(actual.child_count(), expected.child_count());
+        for (size_type i = 0; i < expected.child_count(); i++)
+        {
+            CHECK_EQ(actual.get_child(i).get_parent(), actual);
+            checkPrefabCopy(expected.get_child(i), actual.get_child(i), nodes);
+        }
+    }
+
+    void checkWorldPosition(ecs::entity_handle entity, const math::vec3& expected)
+    {
+        REQUIRE(entity.has_component<world_transform>());
+        math::vec3 actual = entity.read_component<world_transform>().get_position();
+        CHECK_EQ(actual.x, doctest::Approx(expected.x));
+        CHECK_EQ(actual.y, doctest::Approx(expected.y));
+        CHECK_EQ(actual.z, doctest::Approx(expected.z));
+    }
+}
+
+TEST_CASE("[core:ecs] command buffer plays back in recording order")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<buffered_value>();
+    ecs::CommandBuffer& buffer = registry.getCommandBuffer();
+
+    SUBCASE("remove then add keeps the component")
+    {
+        ecs::entity_handle entity = registry.createEntity();
+        entity.add_component(buffered_value{ 1 });
+
+        buffer.removeComponent<buffered_value>(entity);
+        buffer.addComponent(entity, buffered_value{ 2 });
+        buffer.playback();
+
+        REQUIRE(entity.has_component<buffered_value>());
+        CHECK_EQ(entity.read_component<buffered_value>().value, 2);
+        entity.destroy();
+    }
+
+    SUBCASE("add then remove drops the component")
+    {
+        ecs::entity_handle entity = registry.createEntity();
+
+        buffer.addComponent(entity, buffered_value{ 3 });
+        buffer.removeComponent<buffered_value>(entity);
+        buffer.playback();
+
+        CHECK_FALSE(entity.has_component<buffered_value>());
+        entity.destroy();
+    }
+
+    SUBCASE("recorded entities only exist after playback")
+    {
+        ecs::entity_handle entity = buffer.createEntity();
+        buffer.addComponent(entity, buffered_value{ 4 });
+        CHECK_FALSE(registry.validateEntity(entity));
+
+        buffer.playback();
+        REQUIRE(registry.validateEntity(entity));
+        CHECK_EQ(entity.read_component<buffered_value>().value, 4);
+
+        buffer.destroyEntity(entity);
+        buffer.addComponent(entity, buffered_value{ 5 }); // Targets a destroyed entity and gets skipped.
+        buffer.playback();
+        CHECK_FALSE(registry.validateEntity(entity));
+        CHECK(buffer.empty());
+    }
+
+    SUBCASE("commands of different threads play back in recording order")
+    {
+        ecs::entity_handle entity = buffer.createEntity();
+        std::thread([&]() { buffer.addComponent(entity, buffered_value{ 6 }); }).join();
+        buffer.playback();
+
+        REQUIRE(registry.validateEntity(entity));
+        REQUIRE(entity.has_component<buffered_value>());
+        CHECK_EQ(entity.read_component<buffered_value>().value, 6);
+        entity.destroy();
+    }
+
+    SUBCASE("entities destroyed before they were ever created release their id")
+    {
+        ecs::entity_handle entity = buffer.createEntity();
+        buffer.destroyEntity(entity);
+        buffer.playback();
+        CHECK_FALSE(registry.validateEntity(entity));
+
+        ecs::entity_handle recycled = registry.createEntity();
+        CHECK_EQ(ecs::entity_index_of(recycled.get_id()), ecs::entity_index_of(entity.get_id()));
+        CHECK_FALSE(registry.validateEntity(entity));
+        recycled.destroy();
+    }
+}
+
+TEST_CASE("[core:ecs] entity index generations")
+{
+    ecs::entity_index index;
+
+    id_type first = index.reserve();
+    REQUIRE(index.insert(first));
+    CHECK(index.contains(first));
+    index.erase(first);
+    CHECK_FALSE(index.contains(first));
+
+    id_type second = index.reserve(); // Recycles the index of the first entity.
+    CHECK_EQ(ecs::entity_index_of(second), ecs::entity_index_of(first));
+    CHECK_EQ(ecs::entity_generation_of(second), ecs::entity_generation_of(first) + 1);
+    REQUIRE(index.insert(second));
+    CHECK_FALSE(index.contains(first));
+    CHECK_FALSE(index.claim(second));
+    index.erase(second);
+
+    CHECK_FALSE(index.claim(first)); // Outdated generations can't be claimed again.
+    CHECK_FALSE(index.claim(second));
+
+    id_type third = ecs::make_entity_id(ecs::entity_index_of(first), ecs::entity_generation_of(second) + 1);
+    REQUIRE(index.claim(third));
+    REQUIRE(index.insert(third));
+    CHECK(index.contains(third));
+    CHECK_FALSE(index.contains(second));
+    CHECK_EQ(index.size(), 1u);
+}
+
+TEST_CASE("[core:ecs] handles to destroyed entities stay invalid")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+
+    ecs::entity_handle destroyed = registry.createEntity();
+    REQUIRE(registry.validateEntity(destroyed));
+    destroyed.destroy();
+    CHECK_FALSE(registry.validateEntity(destroyed));
+
+    ecs::entity_handle recycled = registry.createEntity();
+    CHECK(registry.validateEntity(recycled));
+    CHECK_FALSE(registry.validateEntity(destroyed));
+
+    ecs::entity_handle restored = registry.createEntity(destroyed.get_id()); // The old id can't be revived, a new one gets handed out.
+    CHECK_NE(restored.get_id(), destroyed.get_id());
+    CHECK_FALSE(registry.validateEntity(destroyed));
+
+    recycled.destroy();
+    restored.destroy();
+}
+
+TEST_CASE("[core:ecs] cloning copies components while the family grows")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<cloned_values>();
+
+    ecs::entity_handle source = registry.createEntity();
+    source.add_component(cloned_values{ { 1, 2, 3 } });
+
+    // Every clone adds a component to the family, some of them reallocate the storage the source component lives in.
+    ecs::entity_container clones;
+    for (int i = 0; i < 100; i++)
+        clones.push_back(source.clone(true, false));
+
+    for (auto& clone : clones)
+    {
+        REQUIRE(clone.has_component<cloned_values>());
+        CHECK_EQ(clone.read_component<cloned_values>().values, std::vector<int>{ 1, 2, 3 });
+    }
+    CHECK_EQ(source.read_component<cloned_values>().values, std::vector<int>{ 1, 2, 3 });
+
+    registry.destroyEntities(clones);
+    source.destroy();
+}
+
+TEST_CASE("[core:ecs] prefabs")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    ecs::entity_handle original = createPrefabTree(registry);
+    REQUIRE_EQ(original.read_component<prefab_counter>().inits, 1);
+
+    ecs::Prefab prefab = registry.createPrefab(original);
+    REQUIRE_EQ(prefab.size(), 4u);
+    CHECK_EQ(prefab.family_count(), 3u); // The hierarchy is stored in the node tables instead.
+
+    SUBCASE("copies recreate the tree, copy every family and join the right queries")
+    {
+        auto sparseQuery = registry.createQuery<buffered_value>();
+        auto chunkedQuery = registry.createQuery<archetype_position>();
+        auto mixedQuery = registry.createQuery<buffered_value, archetype_position>();
+
+        ecs::entity_container roots = registry.instantiate(prefab, 5);
+        REQUIRE_EQ(roots.size(), 5u);
+
+        sparseQuery.queryEntities();
+        chunkedQuery.queryEntities();
+        mixedQuery.queryEntities();
+        auto contains = [](ecs::EntityQuery& query, const ecs::entity_handle& entity)
+        {
+            return std::any_of(query.begin(), query.end(), [&](const ecs::entity_handle& e) { return e.get_id() == entity.get_id(); });
+        };
+
+        ecs::entity_set worldChildren = ecs::entity_handle(world_entity_id).children();
+        for (auto& root : roots)
+        {
+            CHECK_EQ(root.get_parent(), ecs::entity_handle(world_entity_id));
+            CHECK(worldChildren.contains(root));
+
+            std::vector<std::pair<ecs::entity_handle, ecs::entity_handle>> nodes;
+            checkPrefabCopy(original, root, nodes);
+            CHECK_EQ(nodes.size(), prefab.size());
+
+            for (auto& [source, copy] : nodes)
+            {
+                CHECK_EQ(contains(sparseQuery, copy), source.has_component<buffered_value>());
+                CHECK_EQ(contains(chunkedQuery, copy), source.has_component<archetype_position>());
+                CHECK_EQ(contains(mixedQuery, copy), source.has_component<buffered_value>() && source.has_component<archetype_position>());
+            }
+        }
+
+        registry.destroyEntities(roots);
+    }
+
+    SUBCASE("a parent other than the world gets every root")
+    {
+        ecs::entity_handle parent = registry.createEntity();
+        ecs::entity_handle sibling = registry.createEntity();
+        sibling.set_parent(parent);
+
+        ecs::entity_container roots = registry.instantiate(prefab, 3, parent);
+        REQUIRE_EQ(roots.size(), 3u);
+        CHECK_EQ(parent.child_count(), 4u);
+
+        ecs::entity_set children = parent.children();
+        CHECK(children.contains(sibling));
+        for (auto& root : roots)
+        {
+            CHECK_EQ(root.get_parent(), parent);
+            CHECK(children.contains(root));
+            CHECK_FALSE(ecs::entity_handle(world_entity_id).children().contains(root));
+        }
+
+        ecs::entity_handle orphan = registry.createEntity(false);
+        REQUIRE_FALSE(orphan.has_component<hierarchy>());
+        ecs::entity_container adopted = registry.instantiate(prefab, 2, orphan);
+        REQUIRE_EQ(orphan.child_count(), 2u);
+        for (auto& root : adopted)
+            CHECK_EQ(root.get_parent(), orphan);
+
+        parent.destroy();
+        orphan.destroy();
+        for (auto& root : roots)
+            CHECK_FALSE(registry.validateEntity(root));
+    }
+
+    SUBCASE("zero copies and empty prefabs create nothing")
+    {
+        size_type entityCount = registry.getEntities().first.size();
+        size_type worldChildCount = ecs::entity_handle(world_entity_id).child_count();
+
+        CHECK(registry.instantiate(prefab, 0).empty());
+        CHECK(registry.instantiate(ecs::Prefab{}, 3).empty());
+
+        CHECK_EQ(registry.getEntities().first.size(), entityCount);
+        CHECK_EQ(ecs::entity_handle(world_entity_id).child_count(), worldChildCount);
+    }
+
+    original.destroy();
+}
+
+TEST_CASE("[core:ecs] change journal records added, written and removed components")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<buffered_value>();
+    auto* family = registry.getFamily<buffered_value>();
+    family->enable_change_journal();
+
+    std::vector<id_type> journal;
+    family->take_change_journal(journal);
+
+    ecs::entity_handle added = registry.createEntity();
+    ecs::entity_handle untouched = registry.createEntity();
+    added.add_component(buffered_value{ 1 });
+    untouched.add_component(buffered_value{ 2 });
+    family->take_change_journal(journal);
+    CHECK_EQ(journal.size(), 2u);
+
+    added.write_component(buffered_value{ 3 });
+    family->take_change_journal(journal);
+    REQUIRE_EQ(journal.size(), 1u);
+    CHECK_EQ(journal[0], added.get_id());
+
+    family->take_change_journal(journal);
+    CHECK(journal.empty());
+
+    untouched.remove_component<buffered_value>();
+    family->take_change_journal(journal);
+    REQUIRE_EQ(journal.size(), 1u);
+    CHECK_EQ(journal[0], untouched.get_id());
+
+    added.destroy();
+    untouched.destroy();
+}
+
+TEST_CASE("[core:ecs] archetype storage keeps components attached while moving entities between tables and chunks")
+{
+    ecs::ArchetypeStorage storage;
+    storage.report_component_type<archetype_position>();
+    storage.report_component_type<archetype_tag>();
+
+    storage.insert_component(1, archetype_position{ 1.f });
+    ecs::archetype_table* positions = storage.get_location(1).table;
+    REQUIRE(positions);
+
+    // Spill into a third chunk so that removing rows at the front pulls entities over from the last chunk.
+    const id_type count = positions->chunk_capacity() * 2 + 3;
+    for (id_type id = 2; id <= count; id++)
+        storage.insert_component(id, archetype_position{ static_cast<float>(id) });
+    REQUIRE_EQ(positions->chunk_count(), 3u);
+    REQUIRE_EQ(positions->size(), count);
+
+    auto checkStorage = [&](auto&& hasTag)
+    {
+        for (id_type id = 1; id <= count; id++)
+        {
+            auto* position = storage.get_component<archetype_position>(id);
+            REQUIRE(position);
+            CHECK_EQ(position->x, static_cast<float>(id));
+
+            auto* tag = storage.get_component<archetype_tag>(id);
+            CHECK_EQ(tag != nullptr, hasTag(id));
+            if (tag)
+                CHECK_EQ(tag->value, static_cast<int64>(id));
+        }
+
+        // The chunks themselves have to agree with the entity locations.
+        for (ecs::archetype_table* table : storage.tables())
+        {
+            REQUIRE_GE(table->column_index(typeHash<archetype_position>()), 0);
+            for (size_type chunk = 0; chunk < table->chunk_count(); chunk++)
+            {
+                archetype_position* components = table->column<archetype_position>(chunk);
+                for (size_type i = 0; i < table->chunk(chunk).size; i++)
+                {
+                    id_type entity = table->chunk(chunk).entities()[i];
+                    CHECK_EQ(components[i].x, static_cast<float>(entity));
+
+                    auto location = storage.get_location(entity);
+                    CHECK_EQ(location.table, table);
+                    CHECK_EQ(location.row, chunk * table->chunk_capacity() + i);
+                }
+            }
+        }
+    };
+
+    size_type generation = storage.generation();
+    for (id_type id = 2; id <= count; id += 2)
+        storage.insert_component(id, archetype_tag{ static_cast<int64>(id) });
+    CHECK_GT(storage.generation(), generation);
+    CHECK_EQ(positions->size(), count - count / 2);
+    checkStorage([](id_type id) { return id % 2 == 0; });
+
+    for (id_type id = 4; id <= count; id += 4)
+        storage.erase_component(id, typeHash<archetype_tag>());
+    checkStorage([](id_type id) { return id % 2 == 0 && id % 4 != 0; });
+
+    generation = storage.generation();
+    storage.insert_component(2, archetype_tag{ 2 }); // Already has the component, only the value gets assigned.
+    CHECK_EQ(storage.generation(), generation);
+
+    for (id_type id = 1; id <= count; id++)
+        storage.erase_entity(id);
+    for (ecs::archetype_table* table : storage.tables())
+        CHECK_EQ(table->size(), 0u);
+    CHECK_FALSE(storage.get_location(1).table);
+}
+
+TEST_CASE("[core:ecs] for_each_chunk visits every queried entity once")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<archetype_position>(ecs::storage_mode::chunked);
+    registry.reportComponentType<archetype_tag>(ecs::storage_mode::chunked);
+
+    ecs::entity_container tagged = registry.createEntities(1000, archetype_position{}, archetype_tag{});
+    ecs::entity_container untagged = registry.createEntities(10, archetype_position{});
+    auto query = registry.createQuery<archetype_position, archetype_tag>();
+
+    std::unordered_map<id_type, int> visits;
+    query.for_each_chunk<archetype_position, const archetype_tag>([&](size_type count, const id_type* entities, archetype_position* positions, const archetype_tag*)
+        {
+            for (size_type i = 0; i < count; i++)
+            {
+                visits[entities[i]]++;
+                positions[i].x = static_cast<float>(entities[i]);
+            }
+        });
+
+    CHECK_EQ(visits.size(), tagged.size());
+    for (auto& entity : tagged)
+    {
+        CHECK_EQ(visits[entity.get_id()], 1);
+        CHECK_EQ(entity.read_component<archetype_position>().x, static_cast<float>(entity.get_id()));
+    }
+
+    registry.destroyEntities(tagged);
+    registry.destroyEntities(untagged);
+}
+
+TEST_CASE("[core:ecs] queries don't report writes through their own views as changes")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<buffered_value>();
+
+    ecs::entity_handle entity = registry.createEntity();
+    entity.add_component(buffered_value{ 1 });
+
+    auto writer = registry.createQuery<buffered_value>();
+    auto reader = registry.createQuery<buffered_value>();
+    auto contains = [&](const ecs::entity_container& entities)
+    {
+        return std::any_of(entities.begin(), entities.end(), [&](const ecs::entity_handle& e) { return e.get_id() == entity.get_id(); });
+    };
+
+    // The first run reports everything, the second one only what changed since then.
+    for (int run = 0; run < 2; run++)
+    {
+        reader.queryEntities();
+        writer.queryEntities();
+    }
+    CHECK_FALSE(contains(writer.changed<buffered_value>()));
+
+    {
+        auto values = writer.view<buffered_value, ecs::access_mode::read_write>();
+        for (auto& value : values)
+            value.value++;
+    }
+
+    reader.queryEntities();
+    writer.queryEntities();
+    CHECK(contains(reader.changed<buffered_value>()));
+    CHECK_FALSE(contains(writer.changed<buffered_value>()));
+
+    entity.write_component(buffered_value{ 3 }); // Handle writes aren't attributed to any query.
+    writer.queryEntities();
+    CHECK(contains(writer.changed<buffered_value>()));
+
+    entity.destroy();
+}
+
+TEST_CASE("[core:ecs] batch reservation recycles free indices before growing")
+{
+    ecs::entity_index index;
+
+    std::vector<id_type> first;
+    index.reserve(4, std::back_inserter(first));
+    REQUIRE_EQ(first.size(), 4u);
+    for (id_type id : first)
+        REQUIRE(index.insert(id));
+    index.erase(first[1]);
+    index.erase(first[3]);
+
+    const size_type capacity = index.capacity();
+    std::vector<id_type> second;
+    index.reserve(3, std::back_inserter(second));
+    REQUIRE_EQ(second.size(), 3u);
+    CHECK_EQ(index.capacity(), capacity + 1);
+    for (id_type id : second)
+    {
+        CHECK(index.insert(id));
+        CHECK_NE(id, first[1]);
+        CHECK_NE(id, first[3]);
+    }
+    CHECK_EQ(index.size(), 5u);
+}
+
+TEST_CASE("[core:ecs] destroyEntities destroys entire hierarchies in one batch")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<buffered_value>();
+
+    ecs::entity_container roots = registry.createEntities(2, buffered_value{ 1 });
+    ecs::entity_container children = registry.createEntities(3, buffered_value{ 2 });
+    ecs::entity_handle grandchild = registry.createEntity();
+    children[0].set_parent(roots[0]);
+    children[1].set_parent(roots[0]);
+    children[2].set_parent(roots[1]);
+    grandchild.set_parent(children[0]);
+
+    SUBCASE("recursive")
+    {
+        registry.destroyEntities({ roots[0], children[0] }); // Listing a descendant as well must not destroy it twice.
+        CHECK_FALSE(registry.validateEntity(roots[0]));
+        CHECK_FALSE(registry.validateEntity(children[0]));
+        CHECK_FALSE(registry.validateEntity(children[1]));
+        CHECK_FALSE(registry.validateEntity(grandchild));
+        CHECK(registry.validateEntity(roots[1]));
+        CHECK(registry.validateEntity(children[2]));
+        registry.destroyEntities({ roots[1] });
+        CHECK_FALSE(registry.validateEntity(children[2]));
+    }
+
+    SUBCASE("non-recursive")
+    {
+        registry.destroyEntities({ roots[0] }, false);
+        CHECK_FALSE(registry.validateEntity(roots[0]));
+        REQUIRE(registry.validateEntity(children[0]));
+        CHECK_FALSE(children[0].get_parent());
+        CHECK(registry.validateEntity(grandchild));
+        registry.destroyEntities({ roots[1], children[0], children[1] });
+    }
+}
+
+TEST_CASE("[core:ecs] destroying an entity destroys all of its descendants")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<buffered_value>();
+
+    ecs::entity_handle root = registry.createEntity();
+    ecs::entity_handle child = registry.createEntity();
+    ecs::entity_handle grandchild = registry.createEntity();
+    ecs::entity_handle greatGrandchild = registry.createEntity();
+    child.set_parent(root);
+    grandchild.set_parent(child);
+    greatGrandchild.set_parent(grandchild);
+    ecs::entity_container tree{ root, child, grandchild, greatGrandchild };
+    for (auto& entity : tree)
+        entity.add_component(buffered_value{ 1 });
+
+    auto query = registry.createQuery<buffered_value>();
+    query.queryEntities();
+    auto contains = [&](const ecs::entity_handle& entity)
+    {
+        return std::any_of(query.begin(), query.end(), [&](const ecs::entity_handle& e) { return e.get_id() == entity.get_id(); });
+    };
+    for (auto& entity : tree)
+        REQUIRE(contains(entity));
+
+    root.destroy();
+    query.queryEntities();
+    for (auto& entity : tree)
+    {
+        CHECK_FALSE(registry.validateEntity(entity));
+        CHECK_FALSE(contains(entity));
+    }
+}
+
+TEST_CASE("[core:defaults] hierarchy system updates the world matrices of children")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    registry.reportComponentType<position>(ecs::storage_mode::chunked);
+    registry.reportComponentType<rotation>(ecs::storage_mode::chunked);
+    registry.reportComponentType<scale>(ecs::storage_mode::chunked);
+    registry.reportComponentType<world_transform>(ecs::storage_mode::chunked);
+
+    // The engine's own system isn't set up yet while the tests run, setup would also schedule a process for this instance.
+    HierarchySystem hierarchySystem;
+    registry.getFamily<position>()->enable_change_journal();
+    registry.getFamily<rotation>()->enable_change_journal();
+    registry.getFamily<scale>()->enable_change_journal();
+    registry.getFamily<hierarchy>()->enable_change_journal();
+
+    ecs::entity_handle parent = registry.createEntity();
+    parent.add_components<transform>(position(1.f, 0.f, 0.f), rotation(), scale(2.f));
+
+    ecs::entity_handle child = registry.createEntity();
+    child.set_parent(parent);
+    child.add_components<transform>(position(0.f, 1.f, 0.f), rotation(), scale());
+
+    ecs::entity_handle grandchild = registry.createEntity();
+    grandchild.set_parent(child);
+    grandchild.add_components<transform>(position(0.f, 0.f, 1.f), rotation(), scale());
+
+    hierarchySystem.update(time::span(0.f));
+    checkWorldPosition(parent, math::vec3(1.f, 0.f, 0.f));
+    checkWorldPosition(child, math::vec3(1.f, 2.f, 0.f));
+    checkWorldPosition(grandchild, math::vec3(1.f, 2.f, 2.f));
+
+    SUBCASE("children follow their parent when only the parent moves")
+    {
+        parent.write_component(position(5.f, 0.f, 0.f));
+        hierarchySystem.update(time::span(0.f));
+
+        checkWorldPosition(parent, math::vec3(5.f, 0.f, 0.f));
+        checkWorldPosition(child, math::vec3(5.f, 2.f, 0.f));
+        checkWorldPosition(grandchild, math::vec3(5.f, 2.f, 2.f));
+    }
+
+    SUBCASE("entities that haven't been updated yet compose their world matrix through their ancestors")
+    {
+        ecs::entity_handle added = registry.createEntity();
+        added.set_parent(grandchild);
+        added.add_components<transform>(position(1.f, 0.f, 0.f), rotation(), scale());
+
+        REQUIRE_FALSE(added.has_component<world_transform>());
+        math::vec3 worldPosition = HierarchySystem::worldTransform(added).get_position();
+        CHECK_EQ(worldPosition.x, doctest::Approx(3.f));
+        CHECK_EQ(worldPosition.y, doctest::Approx(2.f));
+        CHECK_EQ(worldPosition.z, doctest::Approx(2.f));
+
+        hierarchySystem.update(time::span(0.f));
+        checkWorldPosition(added, math::vec3(3.f, 2.f, 2.f));
+    }
+
+    SUBCASE("a parent and a child that both move use the new matrix of the parent")
+    {
+        child.write_component(position(0.f, 2.f, 0.f));
+        parent.write_component(position(-1.f, 0.f, 0.f));
+        hierarchySystem.update(time::span(0.f));
+
+        checkWorldPosition(child, math::vec3(-1.f, 4.f, 0.f));
+        checkWorldPosition(grandchild, math::vec3(-1.f, 4.f, 2.f));
+    }
+
+    SUBCASE("entities that lose their transform lose their world matrix")
+    {
+        child.remove_component<rotation>();
+        hierarchySystem.update(time::span(0.f));
+
+        CHECK_FALSE(child.has_component<world_transform>());
+        checkWorldPosition(grandchild, math::vec3(1.f, 0.f, 2.f));
+    }
+
+    parent.destroy();
+}
@@ -0,0 +1,874 @@
+#pragma once
+#include <physics/physics.hpp>
+#include <physics/broadphasecollisionalgorithms/broadphaseuniformgridnocaching.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "doctest.h"
+
+inline namespace {
+
+    using namespace ::legion::core;
+    namespace physics = ::legion::physics;
+
+    using collider_pair = std::pair<id_type, id_type>;
+
+    // Gives every physics component a box collider with its world bounds at the given position.
+    void placeBoxes(std::vector<physics::physicsComponent>& components, const std::vector<math::vec3>& positions, const std::vector<math::vec3>& sizes)
+    {
+        for (size_type i = 0; i < components.size(); i++)
+        {
+            if (components[i].colliders.empty())
+                components[i].AddBox(physics::cube_collider_params(sizes[i].x, sizes[i].z, sizes[i].y));
+
+            components[i].colliders[0]->UpdateTransformedTightBoundingVolume(math::translate(math::mat4(1.f), positions[i]));
+        }
+    }
+
+    std::vector<physics::physics_manifold_precursor> makePrecursors(std::vector<physics::physicsComponent>& components)
+    {
+        std::vector<physics::physics_manifold_precursor> precursors;
+        for (size_type i = 0; i < components.size(); i++)
+            precursors.emplace_back(math::mat4(1.f), &components[i], i, ecs::entity_handle(i + 1));
+        return precursors;
+    }
+
+    std::set<collider_pair> bruteForcePairs(std::vector<physics::physicsComponent>& components)
+    {
+        std::set<collider_pair> pairs;
+        for (size_type i = 0; i < components.size(); i++)
+            for (size_type j = i + 1; j < components.size(); j++)
+            {
+                auto [minI, maxI] = components[i].colliders[0]->GetMinMaxWorldAABB();
+                auto [minJ, maxJ] = components[j].colliders[0]->GetMinMaxWorldAABB();
+                if (minI.x <= maxJ.x && minJ.x <= maxI.x &&
+                    minI.y <= maxJ.y && minJ.y <= maxI.y &&
+                    minI.z <= maxJ.z && minJ.z <= maxI.z)
+                    pairs.emplace(i, j);
+            }
+        return pairs;
+    }
+
+    std::set<collider_pair> sweepAndPrunePairs(physics::BroadphaseSweepAndPrune& broadphase, std::vector<physics::physicsComponent>& components)
+    {
+        std::set<collider_pair> pairs;
+        for (auto& grouping : broadphase.collectPairs(makePrecursors(components)))
+        {
+            REQUIRE_EQ(grouping.size(), 2u);
+            CHECK(pairs.emplace(grouping[0].id, grouping[1].id).second); // Every pair is only reported once.
+        }
+        return pairs;
+    }
+
+    using tree_bounds = std::pair<math::vec3, math::vec3>;
+
+    bool boundsOverlap(const tree_bounds& a, const tree_bounds& b)
+    {
+        return a.first.x <= b.second.x && b.first.x <= a.second.x &&
+            a.first.y <= b.second.y && b.first.y <= a.second.y &&
+            a.first.z <= b.second.z && b.first.z <= a.second.z;
+    }
+
+    bool boundsContain(const tree_bounds& outer, const tree_bounds& inner)
+    {
+        return outer.first.x <= inner.first.x && outer.first.y <= inner.first.y && outer.first.z <= inner.first.z &&
+            inner.second.x <= outer.second.x && inner.second.y <= outer.second.y && inner.second.z <= outer.second.z;
+    }
+
+    // Proxies of a DynamicAABBTree together with the tight bounds they were last given, indexed by their user data.
+    struct tree_proxies
+    {
+        physics::DynamicAABBTree tree;
+        std::vector<int32> proxies;
+        std::vector<tree_bounds> bounds;
+
+        void insert(id_type id, const tree_bounds& aabb)
+        {
+            if (proxies.size() <= id)
+            {
+                proxies.resize(id + 1, physics::DynamicAABBTree::null_node);
+                bounds.resize(id + 1);
+            }
+            proxies[id] = tree.createProxy(aabb, id);
+            bounds[id] = aabb;
+        }
+
+        void move(id_type id, const tree_bounds& aabb)
+        {
+            tree.moveProxy(proxies[id], aabb, aabb.first - bounds[id].first);
+            bounds[id] = aabb;
+        }
+
+        void remove(id_type id)
+        {
+            tree.destroyProxy(proxies[id]);
+            proxies[id] = physics::DynamicAABBTree::null_node;
+        }
+
+        std::set<collider_pair> queryPairs() const
+        {
+            std::set<collider_pair> pairs;
+            for (int32 proxy : proxies)
+            {
+                if (proxy == physics::DynamicAABBTree::null_node)
+                    continue;
+
+                auto [low, high] = tree.getFatAABB(proxy);
+                tree.query(low, high, [&](int32 other)
+                    {
+                        id_type a = tree.getUserData(proxy);
+                        id_type b = tree.getUserData(other);
+                        if (a < b)
+                            pairs.emplace(a, b);
+                        return true;
+                    });
+            }
+            return pairs;
+        }
+
+        // The tree works on fat bounds, so it has to find exactly the pairs whose fat bounds overlap.
+        std::set<collider_pair> bruteForceFatPairs() const
+        {
+            std::set<collider_pair> pairs;
+            for (id_type i = 0; i < proxies.size(); i++)
+                for (id_type j = i + 1; j < proxies.size(); j++)
+                    if (proxies[i] != physics::DynamicAABBTree::null_node && proxies[j] != physics::DynamicAABBTree::null_node &&
+                        boundsOverlap(tree.getFatAABB(proxies[i]), tree.getFatAABB(proxies[j])))
+                        pairs.emplace(i, j);
+            return pairs;
+        }
+
+        // Every pair that actually overlaps needs to be among them.
+        std::set<collider_pair> bruteForceTightPairs() const
+        {
+            std::set<collider_pair> pairs;
+            for (id_type i = 0; i < proxies.size(); i++)
+                for (id_type j = i + 1; j < proxies.size(); j++)
+                    if (proxies[i] != physics::DynamicAABBTree::null_node && proxies[j] != physics::DynamicAABBTree::null_node &&
+                        boundsOverlap(bounds[i], bounds[j]))
+                        pairs.emplace(i, j);
+            return pairs;
+        }
+
+        void check() const
+        {
+            std::set<collider_pair> found = queryPairs();
+            CHECK_EQ(found, bruteForceFatPairs());
+
+            for (auto& pair : bruteForceTightPairs())
+                CHECK(found.count(pair));
+
+            size_type live = 0;
+            for (id_type id = 0; id < proxies.size(); id++)
+            {
+                if (proxies[id] == physics::DynamicAABBTree::null_node)
+                    continue;
+                live++;
+                CHECK(boundsContain(tree.getFatAABB(proxies[id]), bounds[id]));
+            }
+            CHECK_EQ(tree.getProxyCount(), live);
+
+            // Rotations keep the tree balanced, an AVL tree never gets higher than about 1.44 log2(n).
+            if (live > 1)
+                CHECK_LE(tree.getHeight(), static_cast<int32>(2.f * std::log2(static_cast<float>(live))) + 1);
+        }
+    };
+
+    void checkSameVec3(const math::vec3& actual, const math::vec3& expected)
+    {
+        CHECK_EQ(actual.x, doctest::Approx(expected.x));
+        CHECK_EQ(actual.y, doctest::Approx(expected.y));
+        CHECK_EQ(actual.z, doctest::Approx(expected.z));
+    }
+
+    // Integrates a single rigidbody the way the physics system did before the rigidbodies got packed.
+    physics::rigidbody integrateRigidbody(physics::rigidbody rb, float deltaTime)
+    {
+        rb.velocity += (rb.forceAccumulator * rb.inverseMass + physics::constants::gravity) * deltaTime;
+        rb.angularVelocity += (rb.torqueAccumulator * rb.globalInverseInertiaTensor) * deltaTime;
+        rb.resetAccumulators();
+        return rb;
+    }
+
+    // Runs a rigidbody_solver_buffer over chunks of the rigidbodies the same way the jobs of the physics system do.
+    void integratePacked(ecs::component_container<physics::rigidbody>& rigidbodies, const std::vector<byte>& hasRigidBodies, float deltaTime, bool scalar)
+    {
+        constexpr size_type chunkSize = physics::rigidbody_solver_buffer::simd_width * 2;
+
+        physics::rigidbody_solver_buffer buffer;
+        buffer.resize(rigidbodies.size());
+        for (size_type begin = 0; begin < rigidbodies.size(); begin += chunkSize)
+        {
+            size_type end = std::min(begin + chunkSize, rigidbodies.size());
+            buffer.gather(rigidbodies, hasRigidBodies, begin, end);
+            if (scalar)
+                buffer.integrate_scalar(deltaTime, begin, end);
+            else
+                buffer.integrate(deltaTime, begin, end);
+            buffer.scatter(rigidbodies, begin, end);
+        }
+    }
+
+    // The tests run before the modules are set up, so the components the physics system touches have to be reported by hand.
+    void reportPhysicsComponents(ecs::EcsRegistry& registry)
+    {
+        registry.reportComponentType<position>(ecs::storage_mode::chunked); // Same storage as the CoreModule reports them with, the first report wins.
+        registry.reportComponentType<rotation>(ecs::storage_mode::chunked);
+        registry.reportComponentType<scale>(ecs::storage_mode::chunked);
+        registry.reportComponentType<world_transform>(ecs::storage_mode::chunked);
+        registry.reportComponentType<physics::physicsComponent>();
+        registry.reportComponentType<physics::rigidbody>();
+        registry.reportComponentType<physics::identifier>();
+        registry.reportComponentType<physics::Fracturer>();
+    }
+
+    ecs::entity_handle createPhysicsBox(ecs::EcsRegistry& registry, math::vec3 pos, math::vec3 size)
+    {
+        auto entity = registry.createEntity();
+        entity.add_components<transform>(position(pos), rotation(), scale());
+
+        physics::physicsComponent physicsComponent;
+        physicsComponent.AddBox(physics::cube_collider_params(size.x, size.z, size.y));
+        entity.add_component(physicsComponent);
+        return entity;
+    }
+
+    // Records the boxes of every manifold the physics system reports a collision for, in the order they're reported.
+    struct collision_recorder
+    {
+        std::unordered_map<id_type, id_type> boxIndices;
+        std::vector<collider_pair> pairs;
+
+        void onCollision(physics::collision_event* event)
+        {
+            pairs.emplace_back(boxIndices.at(event->manifold->entityA), boxIndices.at(event->manifold->entityB));
+        }
+    };
+
+    // Steps a fresh physics system over a grid of overlapping boxes that all cover several cells of a uniform grid.
+    // Returns the pairs of the collisions of every step, the boxes are numbered in the order they were created in.
+    template<typename BroadPhaseType>
+    std::vector<std::vector<collider_pair>> recordGridCollisions(ecs::EcsRegistry& registry, size_type steps)
+    {
+        physics::PhysicsSystem::setBroadPhaseCollisionDetection<BroadPhaseType>(math::ivec3(1, 1, 1));
+        physics::PhysicsSystem system;
+        system.manifoldPrecursorQuery = registry.createQuery<position, rotation, scale, physics::physicsComponent>();
+
+        collision_recorder recorder;
+        std::vector<ecs::entity_handle> boxes;
+        for (size_type x = 0; x < 3; x++)
+            for (size_type z = 0; z < 3; z++)
+            {
+                // Neighbours are 1.2 apart and 1.5 wide, so every pair of neighbours, diagonal ones included, overlaps in multiple cells.
+                auto box = createPhysicsBox(registry, math::vec3(x * 1.2f, 0.6f, z * 1.2f), math::vec3(1.5f));
+                box.add_component<physics::rigidbody>();
+                recorder.boxIndices.emplace(box.get_id(), boxes.size());
+                boxes.push_back(box);
+            }
+
+        auto callback = delegate<void(physics::collision_event*)>::create<collision_recorder, &collision_recorder::onCollision>(&recorder);
+        registry_access::eventBus().bindToEvent<physics::collision_event>(callback);
+
+        std::vector<std::vector<collider_pair>> collisions;
+        for (size_type step = 0; step < steps; step++)
+        {
+            recorder.pairs.clear();
+            system.fixedUpdate(time::time_span<fast_time>(0.02f));
+            collisions.push_back(recorder.pairs);
+        }
+
+        registry_access::eventBus().unbindFromEvent<physics::collision_event>(callback);
+        for (auto& box : boxes)
+            registry.destroyEntity(box);
+
+        return collisions;
+    }
+
+    std::shared_ptr<physics::ConvexCollider> createUnitBox(const math::mat4& transform)
+    {
+        auto collider = std::make_shared<physics::ConvexCollider>();
+        collider->CreateBox(physics::cube_collider_params(1.f, 1.f, 1.f));
+        collider->UpdateTransformedTightBoundingVolume(transform);
+        return collider;
+    }
+
+    void checkSameFaceSeperation(physics::ConvexCollider* convexA, physics::ConvexCollider* convexB, const math::mat4& transformA, const math::mat4& transformB, bool& seperated)
+    {
+        physics::PointerEncapsulator<physics::HalfEdgeFace> colliderFace;
+        float colliderSeperation;
+        bool colliderResult = physics::PhysicsStatics::FindSeperatingAxisByExtremePointProjection(convexA, convexB, transformA, transformB, colliderFace, colliderSeperation);
+
+        physics::PointerEncapsulator<physics::HalfEdgeFace> worldFace;
+        float worldSeperation;
+        size_type faceIndex = 0;
+        bool worldResult = physics::PhysicsStatics::FindSeperatingAxisByExtremePointProjection(convexA->GetWorldData(), convexB->GetWorldData(),
+            convexB->GetHalfEdgeFaces(), worldFace, worldSeperation, faceIndex);
+
+        CHECK_EQ(worldResult, colliderResult);
+        CHECK_EQ(worldSeperation, doctest::Approx(colliderSeperation));
+        REQUIRE(colliderFace.ptr);
+        CHECK_EQ(worldFace.ptr, colliderFace.ptr);
+        REQUIRE_LT(faceIndex, convexB->GetHalfEdgeFaces().size());
+        CHECK_EQ(convexB->GetHalfEdgeFaces()[faceIndex], worldFace.ptr);
+
+        seperated = seperated || colliderResult;
+    }
+
+    void checkSameEdgeSeperation(physics::ConvexCollider* convexA, physics::ConvexCollider* convexB, const math::mat4& transformA, const math::mat4& transformB, bool& seperated)
+    {
+        physics::PointerEncapsulator<physics::HalfEdgeEdge> colliderRef, colliderInc;
+        math::vec3 colliderAxis;
+        float colliderSeperation;
+        bool colliderResult = physics::PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(convexA, convexB, transformA, transformB,
+            colliderRef, colliderInc, colliderAxis, colliderSeperation);
+
+        math::vec3 positionA = math::vec3(transformA[3]) + math::vec3(transformA * math::vec4(convexA->GetLocalCentroid(), 0));
+        const physics::convex_world_data& worldA = convexA->GetWorldData();
+        const physics::convex_world_data& worldB = convexB->GetWorldData();
+
+        physics::PointerEncapsulator<physics::HalfEdgeEdge> worldRef, worldInc;
+        math::vec3 worldAxis;
+        float worldSeperation;
+        size_type refIndex = 0;
+        size_type incIndex = 0;
+        bool worldResult = physics::PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(worldA, worldB, positionA,
+            worldRef, worldInc, worldAxis, worldSeperation, refIndex, incIndex);
+
+        CHECK_EQ(worldResult, colliderResult);
+        CHECK_EQ(worldSeperation, doctest::Approx(colliderSeperation));
+        CHECK_EQ(worldRef.ptr, colliderRef.ptr);
+        CHECK_EQ(worldInc.ptr, colliderInc.ptr);
+
+        if (colliderRef.ptr)
+        {
+            checkSameVec3(worldAxis, colliderAxis);
+            REQUIRE_LT(refIndex, worldA.edges.size());
+            REQUIRE_LT(incIndex, worldB.edges.size());
+            CHECK_EQ(worldA.edges[refIndex], worldRef.ptr);
+            CHECK_EQ(worldB.edges[incIndex], worldInc.ptr);
+        }
+
+        seperated = seperated || colliderResult;
+    }
+
+    // Runs every seperating axis test of a collision check both on the colliders and on their world data.
+    void checkSameSeperatingAxes(const math::mat4& transformA, const math::mat4& transformB, bool expectSeperated)
+    {
+        auto convexA = createUnitBox(transformA);
+        auto convexB = createUnitBox(transformB);
+
+        bool seperated = false;
+        checkSameFaceSeperation(convexA.get(), convexB.get(), transformA, transformB, seperated);
+        checkSameFaceSeperation(convexB.get(), convexA.get(), transformB, transformA, seperated);
+        checkSameEdgeSeperation(convexA.get(), convexB.get(), transformA, transformB, seperated);
+        CHECK_EQ(seperated, expectSeperated);
+    }
+}
+
+TEST_CASE("[physics] dynamic aabb tree finds the same pairs as brute force")
+{
+    constexpr size_type count = 200;
+    std::mt19937 generator(4321);
+    std::uniform_real_distribution<float> position(-20.f, 20.f);
+    std::uniform_real_distribution<float> size(0.5f, 4.f);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> jump(-10.f, 10.f);
+
+    auto randomBounds = [&]()
+    {
+        math::vec3 low(position(generator), position(generator) * 0.25f, position(generator));
+        return tree_bounds(low, low + math::vec3(size(generator), size(generator), size(generator)));
+    };
+
+    tree_proxies tree;
+    for (id_type id = 0; id < count; id++)
+        tree.insert(id, randomBounds());
+
+    SUBCASE("insert")
+    {
+        REQUIRE_FALSE(tree.bruteForceTightPairs().empty());
+        tree.check();
+    }
+
+    SUBCASE("move")
+    {
+        for (size_type frame = 0; frame < 10; frame++)
+        {
+            for (id_type id = 0; id < count; id++)
+            {
+                // Most proxies stay inside their fat bounds, every tenth one jumps far enough to need reinserting.
+                math::vec3 delta = id % 10 == frame ? math::vec3(jump(generator), jump(generator), jump(generator))
+                    : math::vec3(offset(generator), offset(generator), offset(generator)) * 0.1f;
+                auto aabb = tree.bounds[id];
+                tree.move(id, tree_bounds(aabb.first + delta, aabb.second + delta));
+            }
+            tree.check();
+        }
+    }
+
+    SUBCASE("remove")
+    {
+        for (id_type id = 0; id < count; id += 2)
+            tree.remove(id);
+        tree.check();
+
+        for (id_type id = 1; id < count; id += 2)
+            tree.remove(id);
+        tree.check();
+        CHECK_EQ(tree.tree.getHeight(), 0);
+    }
+
+    SUBCASE("reinsert")
+    {
+        for (size_type round = 0; round < 3; round++)
+        {
+            for (id_type id = round; id < count; id += 3)
+                tree.remove(id);
+            tree.check();
+
+            for (id_type id = round; id < count; id += 3)
+                tree.insert(id, randomBounds());
+            tree.check();
+        }
+    }
+}
+
+TEST_CASE("[physics] aabb tree broadphase finds every overlapping pair")
+{
+    constexpr size_type count = 200;
+    std::mt19937 generator(2468);
+    std::uniform_real_distribution<float> position(-20.f, 20.f);
+    std::uniform_real_distribution<float> size(0.5f, 4.f);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+    std::vector<physics::physicsComponent> components(count);
+    std::vector<math::vec3> positions(count);
+    std::vector<math::vec3> sizes(count);
+    for (size_type i = 0; i < count; i++)
+    {
+        positions[i] = math::vec3(position(generator), position(generator) * 0.25f, position(generator));
+        sizes[i] = math::vec3(size(generator), size(generator), size(generator));
+    }
+
+    physics::BroadphaseAABBTree broadphase;
+
+    for (size_type frame = 0; frame < 10; frame++)
+    {
+        placeBoxes(components, positions, sizes);
+
+        std::set<collider_pair> found;
+        for (auto& grouping : broadphase.collectPairs(makePrecursors(components)))
+        {
+            REQUIRE_EQ(grouping.size(), 2u);
+            collider_pair pair = std::minmax(grouping[0].id, grouping[1].id);
+            CHECK(found.insert(pair).second); // Every pair is only reported once.
+        }
+
+        for (auto& pair : bruteForcePairs(components))
+            CHECK(found.count(pair));
+
+        CHECK_EQ(broadphase.getTree().getProxyCount(), components.size());
+
+        for (auto& pos : positions)
+            pos += math::vec3(offset(generator), offset(generator), offset(generator));
+
+        if (frame == 5) // Components that aren't passed anymore leave the tree.
+            components.resize(count / 2);
+    }
+}
+
+TEST_CASE("[physics] sweep and prune finds the same pairs as brute force")
+{
+    constexpr size_type count = 200;
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> position(-20.f, 20.f);
+    std::uniform_real_distribution<float> size(0.5f, 4.f);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+    std::vector<physics::physicsComponent> components(count);
+    std::vector<math::vec3> positions(count);
+    std::vector<math::vec3> sizes(count);
+    for (size_type i = 0; i < count; i++)
+    {
+        positions[i] = math::vec3(position(generator), position(generator) * 0.25f, position(generator));
+        sizes[i] = math::vec3(size(generator), size(generator), size(generator));
+    }
+
+    physics::BroadphaseSweepAndPrune broadphase;
+
+    SUBCASE("first frame sorts from scratch")
+    {
+        placeBoxes(components, positions, sizes);
+        std::set<collider_pair> expected = bruteForcePairs(components);
+        REQUIRE_FALSE(expected.empty());
+        CHECK_EQ(sweepAndPrunePairs(broadphase, components), expected);
+    }
+
+    SUBCASE("following frames restore the previous order")
+    {
+        for (size_type frame = 0; frame < 10; frame++)
+        {
+            placeBoxes(components, positions, sizes);
+            CHECK_EQ(sweepAndPrunePairs(broadphase, components), bruteForcePairs(components));
+
+            for (auto& pos : positions)
+                pos += math::vec3(offset(generator), offset(generator), offset(generator));
+        }
+    }
+
+    SUBCASE("removed components drop out of the pairs")
+    {
+        placeBoxes(components, positions, sizes);
+        CHECK_EQ(sweepAndPrunePairs(broadphase, components), bruteForcePairs(components));
+
+        components.resize(count / 2);
+        CHECK_EQ(sweepAndPrunePairs(broadphase, components), bruteForcePairs(components));
+    }
+}
+
+TEST_CASE("[physics] a box resting on a static plane falls asleep")
+{
+    auto& registry = registry_access::get();
+    reportPhysicsComponents(registry);
+
+    // Driven by hand instead of through the physics process chain, so setup isn't called.
+    physics::PhysicsSystem::setBroadPhaseCollisionDetection<physics::BroadphaseBruteforce>();
+    physics::PhysicsSystem system;
+    system.manifoldPrecursorQuery = registry.createQuery<position, rotation, scale, physics::physicsComponent>();
+
+    auto plane = createPhysicsBox(registry, math::vec3(0.f, -0.5f, 0.f), math::vec3(20.f, 1.f, 20.f));
+    auto box = createPhysicsBox(registry, math::vec3(0.f, 0.5f, 0.f), math::vec3(1.f));
+    box.add_component<physics::rigidbody>();
+
+    // A few steps to settle on the plane, after which it should be asleep within timeToSleep.
+    constexpr float timeStep = 0.02f;
+    constexpr size_type settleSteps = 10;
+    const size_type sleepSteps = static_cast<size_type>(physics::constants::timeToSleep / timeStep) + 5;
+
+    for (size_type step = 0; step < settleSteps; step++)
+        system.fixedUpdate(time::time_span<fast_time>(timeStep));
+
+    CHECK_FALSE(box.get_component_handle<physics::rigidbody>().read().isAsleep);
+
+    for (size_type step = 0; step < sleepSteps; step++)
+        system.fixedUpdate(time::time_span<fast_time>(timeStep));
+
+    physics::rigidbody rb = box.get_component_handle<physics::rigidbody>().read();
+    CHECK(rb.isAsleep);
+    CHECK_EQ(math::length(rb.velocity), 0.f);
+    CHECK_GT(box.get_component_handle<position>().read().y, 0.f); // Still resting on the plane rather than falling through it.
+
+    registry.destroyEntity(box);
+    registry.destroyEntity(plane);
+}
+
+TEST_CASE("[physics] waking a sleeping rigidbody wakes everything it fell asleep with")
+{
+    auto& registry = registry_access::get();
+    reportPhysicsComponents(registry);
+
+    physics::PhysicsSystem::setBroadPhaseCollisionDetection<physics::BroadphaseBruteforce>();
+    physics::PhysicsSystem system;
+    system.manifoldPrecursorQuery = registry.createQuery<position, rotation, scale, physics::physicsComponent>();
+
+    auto plane = createPhysicsBox(registry, math::vec3(0.f, -0.5f, 0.f), math::vec3(20.f, 1.f, 20.f));
+
+    // A stack that falls asleep as one island, and a box next to it that falls asleep on its own.
+    std::vector<ecs::entity_handle> stack;
+    for (size_type i = 0; i < 4; i++)
+        stack.push_back(createPhysicsBox(registry, math::vec3(0.f, 0.5f + i, 0.f), math::vec3(1.f)));
+    auto loneBox = createPhysicsBox(registry, math::vec3(5.f, 0.5f, 0.f), math::vec3(1.f));
+
+    for (auto& box : stack)
+        box.add_component<physics::rigidbody>();
+    loneBox.add_component<physics::rigidbody>();
+
+    auto isAsleep = [](ecs::entity_handle entity) { return entity.get_component_handle<physics::rigidbody>().read().isAsleep; };
+
+    constexpr float timeStep = 0.02f;
+    const size_type maxSteps = static_cast<size_type>(physics::constants::timeToSleep / timeStep) * 10;
+    for (size_type step = 0; step < maxSteps && !(std::all_of(stack.begin(), stack.end(), isAsleep) && isAsleep(loneBox)); step++)
+        system.fixedUpdate(time::time_span<fast_time>(timeStep));
+
+    for (auto& box : stack)
+        REQUIRE(isAsleep(box));
+    REQUIRE(isAsleep(loneBox));
+
+    // Only the top box is touched, the contacts between the sleeping boxes below it aren't even checked.
+    auto topHandle = stack.back().get_component_handle<physics::rigidbody>();
+    physics::rigidbody top = topHandle.read();
+    top.wakeUp();
+    topHandle.write(top);
+
+    system.fixedUpdate(time::time_span<fast_time>(timeStep));
+
+    for (auto& box : stack)
+        CHECK_FALSE(isAsleep(box));
+    CHECK(isAsleep(loneBox));
+
+    for (auto& box : stack)
+        registry.destroyEntity(box);
+    registry.destroyEntity(loneBox);
+    registry.destroyEntity(plane);
+}
+
+TEST_CASE("[physics] pairs in several grid cells get one manifold in the same order every run")
+{
+    auto& registry = registry_access::get();
+    reportPhysicsComponents(registry);
+
+    constexpr size_type steps = 5;
+
+    // The grid that caches its cells can list a pair in either order once the boxes start moving.
+    auto checkBroadPhase = [&](auto collect)
+    {
+        std::vector<std::vector<collider_pair>> collisions = collect();
+        REQUIRE_EQ(collisions.size(), steps);
+
+        std::set<collider_pair> neighbours;
+        for (id_type a = 0; a < 9; a++)
+            for (id_type b = a + 1; b < 9; b++)
+                if (std::abs(static_cast<int>(a / 3) - static_cast<int>(b / 3)) <= 1 && std::abs(static_cast<int>(a % 3) - static_cast<int>(b % 3)) <= 1)
+                    neighbours.emplace(a, b);
+
+        for (size_type step = 0; step < steps; step++)
+        {
+            CAPTURE(step);
+            std::set<collider_pair> unique;
+            for (auto [a, b] : collisions[step])
+                CHECK(unique.emplace(math::min(a, b), math::max(a, b)).second);
+
+            if (step == 0)
+                CHECK_EQ(unique, neighbours);
+        }
+
+        CHECK_EQ(collect(), collisions);
+    };
+
+    SUBCASE("uniform grid")
+    {
+        checkBroadPhase([&]() { return recordGridCollisions<physics::BroadphaseUniformGridNoCaching>(registry, steps); });
+    }
+
+    SUBCASE("cached uniform grid")
+    {
+        checkBroadPhase([&]() { return recordGridCollisions<physics::BroadphaseUniformGrid>(registry, steps); });
+    }
+
+    physics::PhysicsSystem::setBroadPhaseCollisionDetection<physics::BroadphaseBruteforce>();
+}
+
+TEST_CASE("[physics] packed rigidbody integration matches integrating one body at a time")
+{
+    constexpr float deltaTime = 0.02f;
+    std::mt19937 generator(24);
+    std::uniform_real_distribution<float> value(-10.f, 10.f);
+    auto randomVec3 = [&]() { return math::vec3(value(generator), value(generator), value(generator)); };
+
+    SUBCASE("random bodies, sleeping bodies and entities without a rigidbody")
+    {
+        // Counts that aren't a multiple of the SIMD width leave a partial group at the end.
+        for (size_type count : { 1, 3, 5, 6, 130, 1001 })
+        {
+            CAPTURE(count);
+            ecs::component_container<physics::rigidbody> rigidbodies(count);
+            std::vector<byte> hasRigidBodies(count);
+            for (size_type i = 0; i < count; i++)
+            {
+                physics::rigidbody& rb = rigidbodies[i];
+                rb.inverseMass = std::abs(value(generator)) + 0.1f;
+                rb.velocity = randomVec3();
+                rb.angularVelocity = randomVec3();
+                rb.forceAccumulator = randomVec3();
+                rb.torqueAccumulator = randomVec3();
+                for (int column = 0; column < 3; column++)
+                    rb.globalInverseInertiaTensor[column] = randomVec3(); // Not symmetric, a transposed multiply gives a different result.
+
+                rb.isAsleep = i % 7 == 3;
+                hasRigidBodies[i] = i % 11 != 5;
+            }
+
+            for (bool scalar : { false, true })
+            {
+                CAPTURE(scalar);
+                ecs::component_container<physics::rigidbody> integrated = rigidbodies;
+                integratePacked(integrated, hasRigidBodies, deltaTime, scalar);
+
+                for (size_type i = 0; i < count; i++)
+                {
+                    CAPTURE(i);
+                    const physics::rigidbody& source = rigidbodies[i];
+                    const physics::rigidbody& actual = integrated[i];
+                    if (!hasRigidBodies[i] || source.isAsleep)
+                    {
+                        // Neither integrated nor reset.
+                        CHECK_EQ(actual.velocity, source.velocity);
+                        CHECK_EQ(actual.angularVelocity, source.angularVelocity);
+                        CHECK_EQ(actual.forceAccumulator, source.forceAccumulator);
+                        CHECK_EQ(actual.torqueAccumulator, source.torqueAccumulator);
+                        continue;
+                    }
+
+                    physics::rigidbody expected = integrateRigidbody(source, deltaTime);
+                    checkSameVec3(actual.velocity, expected.velocity);
+                    checkSameVec3(actual.angularVelocity, expected.angularVelocity);
+                    CHECK_EQ(actual.forceAccumulator, math::vec3(0.f));
+                    CHECK_EQ(actual.torqueAccumulator, math::vec3(0.f));
+                }
+            }
+        }
+    }
+
+    SUBCASE("the torque is multiplied as a row vector with the column major inertia tensor")
+    {
+        ecs::component_container<physics::rigidbody> rigidbodies(1);
+        std::vector<byte> hasRigidBodies{ true };
+        physics::rigidbody& rb = rigidbodies[0];
+        rb.globalInverseInertiaTensor = math::mat3(0.f);
+        rb.globalInverseInertiaTensor[1][0] = 2.f; // Column 1, row 0.
+        rb.torqueAccumulator = math::vec3(1.f, 0.f, 0.f);
+
+        for (bool scalar : { false, true })
+        {
+            CAPTURE(scalar);
+            ecs::component_container<physics::rigidbody> integrated = rigidbodies;
+            integratePacked(integrated, hasRigidBodies, deltaTime, scalar);
+            checkSameVec3(integrated[0].angularVelocity, math::vec3(0.f, 2.f * deltaTime, 0.f));
+        }
+    }
+}
+
+TEST_CASE("[physics] seperating axis tests on world data find the same features as on the colliders")
+{
+    const math::mat4 identity(1.f);
+
+    SUBCASE("separated boxes")
+    {
+        checkSameSeperatingAxes(identity, math::translate(identity, math::vec3(3.f, 0.5f, 0.25f)), true);
+    }
+
+    SUBCASE("face touching boxes")
+    {
+        checkSameSeperatingAxes(identity, math::translate(identity, math::vec3(0.99f, 0.25f, 0.1f)), false);
+    }
+
+    // A rotated around z and B around x, so the top edge of A crosses the bottom edge of B.
+    // The angles differ from 45 degrees so no two faces or edges are equally far apart.
+    const math::mat4 rotationA = math::toMat4(math::angleAxis(math::deg2rad(50.f), math::vec3(0.f, 0.f, 1.f)));
+    const math::mat4 rotationB = math::toMat4(math::angleAxis(math::deg2rad(40.f), math::vec3(1.f, 0.f, 0.f)));
+    const float touchingHeight = 0.5f * (std::cos(math::deg2rad(50.f)) + std::sin(math::deg2rad(50.f))) +
+        0.5f * (std::cos(math::deg2rad(40.f)) + std::sin(math::deg2rad(40.f)));
+
+    SUBCASE("edge touching boxes")
+    {
+        checkSameSeperatingAxes(rotationA, math::translate(identity, math::vec3(0.1f, touchingHeight - 0.01f, 0.2f)) * rotationB, false);
+    }
+
+    SUBCASE("edge separated boxes")
+    {
+        checkSameSeperatingAxes(rotationA, math::translate(identity, math::vec3(0.1f, touchingHeight + 0.3f, 0.2f)) * rotationB, true);
+    }
+}
+
+TEST_CASE("[physics] world data support points match testing one vertex at a time")
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+    for (size_type count = 1; count <= 13; count++)
+    {
+        CAPTURE(count);
+        std::vector<math::vec3> vertices(count);
+        for (auto& vertex : vertices)
+            vertex = math::vec3(dist(rng), dist(rng), dist(rng));
+
+        // The last vertex repeats the first, on a tie the lowest index has to win like in the scalar loop.
+        if (count > 4)
+            vertices.back() = vertices.front();
+
+        physics::convex_world_data worldData;
+        worldData.build(vertices, {}, math::translate(math::mat4(1.f), math::vec3(1.f, 2.f, 3.f)));
+        REQUIRE_EQ(worldData.vertexCount, count);
+        REQUIRE_EQ(worldData.vertexX.size() % physics::convex_world_data::simdWidth, 0u);
+
+        for (size_type test = 0; test < 32; test++)
+        {
+            math::vec3 direction(dist(rng), dist(rng), dist(rng));
+
+            size_type bestIndex = 0;
+            float bestDistance = std::numeric_limits<float>::lowest();
+            for (size_type i = 0; i < worldData.vertexCount; i++)
+            {
+                float distance = worldData.vertexX[i] * direction.x + worldData.vertexY[i] * direction.y + worldData.vertexZ[i] * direction.z;
+                if (distance > bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = i;
+                }
+            }
+
+            math::vec3 supportPoint;
+            float supportDistance = worldData.getSupportPoint(direction, supportPoint);
+            CHECK_EQ(supportDistance, bestDistance);
+            CHECK_EQ(supportPoint.x, worldData.vertexX[bestIndex]);
+            CHECK_EQ(supportPoint.y, worldData.vertexY[bestIndex]);
+            CHECK_EQ(supportPoint.z, worldData.vertexZ[bestIndex]);
+        }
+    }
+}
+
+TEST_CASE("[physics] a stale seperating axis hint can't separate touching colliders")
+{
+    auto& registry = registry_access::get();
+    reportPhysicsComponents(registry);
+    auto entityA = registry.createEntity();
+    auto entityB = registry.createEntity();
+
+    const math::mat4 transformA(1.f);
+    const math::mat4 transformB = math::translate(math::mat4(1.f), math::vec3(0.9f, 0.2f, 0.1f));
+    auto convexA = createUnitBox(transformA);
+    auto convexB = createUnitBox(transformB);
+
+    const size_type faceCount = convexA->GetHalfEdgeFaces().size();
+    const size_type edgeCount = convexA->GetWorldData().edges.size();
+
+    auto checkHint = [&](physics::seperating_axis_type type, size_type featureA, size_type featureB)
+    {
+        CAPTURE(static_cast<int>(type));
+        CAPTURE(featureA);
+        CAPTURE(featureB);
+
+        physics::physics_manifold manifold;
+        manifold.transformA = transformA;
+        manifold.transformB = transformB;
+        manifold.colliderA = convexA.get();
+        manifold.colliderB = convexB.get();
+        manifold.entityA = entityA;
+        manifold.entityB = entityB;
+        manifold.isColliding = false;
+        manifold.seperatingAxisHint = { type, featureA, featureB };
+
+        convexB->CheckCollisionWith(convexA.get(), manifold);
+        CHECK(manifold.isColliding);
+        CHECK_EQ(manifold.seperatingAxisHint.type, physics::seperating_axis_type::none);
+    };
+
+    // Every feature of both boxes, and indices past the end like a hint left over from a collider with more features.
+    for (size_type feature = 0; feature < faceCount + 2; feature++)
+    {
+        checkHint(physics::seperating_axis_type::faceA, feature, 0);
+        checkHint(physics::seperating_axis_type::faceB, 0, feature);
+    }
+
+    for (size_type edgeA = 0; edgeA < edgeCount + 2; edgeA++)
+        for (size_type edgeB = 0; edgeB < edgeCount + 2; edgeB++)
+            checkHint(physics::seperating_axis_type::edges, edgeA, edgeB);
+
+    registry.destroyEntity(entityA);
+    registry.destroyEntity(entityB);
+}
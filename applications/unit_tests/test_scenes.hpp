@@ -0,0 +1,241 @@
+#pragma once
+#include <core/core.hpp>
+#include <core/scenemanagement/scene_snapshot.hpp>
+#include <core/scenemanagement/scenemanager.hpp>
+
+#include <cstring>
+#include <filesystem>
+
+#include "doctest.h"
+
+inline namespace {
+
+    using namespace ::legion::core;
+
+    struct snapshot_test_value
+    {
+        int32 value = 0;
+        float weight = 0.f;
+    };
+
+    // Small tree with two component families, an entity without any components of its own family and a grandchild.
+    ecs::entity_handle createSnapshotTree(ecs::EcsRegistry& registry)
+    {
+        registry.reportComponentType<snapshot_test_value>();
+        registry.reportComponentType<position>(ecs::storage_mode::chunked); // Same storage as the CoreModule reports it with, the first report wins.
+
+        ecs::entity_handle root = registry.createEntity();
+        root.set_name("snapshot root");
+        root.add_component(snapshot_test_value{ 1, 0.5f });
+
+        ecs::entity_handle first = registry.createEntity();
+        first.set_name("first");
+        first.set_parent(root);
+        first.add_component(snapshot_test_value{ 2, 1.5f });
+
+        ecs::entity_handle second = registry.createEntity();
+        second.set_name("second");
+        second.set_parent(root);
+        second.add_component(position(1.f, 2.f, 3.f));
+
+        ecs::entity_handle grandchild = registry.createEntity();
+        grandchild.set_name("grandchild");
+        grandchild.set_parent(first);
+        grandchild.add_component(snapshot_test_value{ 3, 2.5f });
+        grandchild.add_component(position(4.f, 5.f, 6.f));
+
+        return root;
+    }
+
+    // Tree of more entities than fit in one streaming batch, every entity has three children so that parents and children end up in different batches.
+    ecs::entity_handle createLargeSnapshotTree(ecs::EcsRegistry& registry, size_type count)
+    {
+        registry.reportComponentType<snapshot_test_value>();
+        registry.reportComponentType<position>(ecs::storage_mode::chunked);
+
+        ecs::entity_container entities = registry.createEntities(count);
+        for (size_type i = 0; i < count; i++)
+        {
+            entities[i].set_name("entity " + std::to_string(i));
+            if (i)
+                entities[i].set_parent(entities[(i - 1) / 3]);
+
+            entities[i].add_component(snapshot_test_value{ static_cast<int32>(i), i * 0.5f });
+            if (i % 2)
+                entities[i].add_component(position(static_cast<float>(i), 0.f, 0.f));
+        }
+
+        return entities[0];
+    }
+
+    // Compares names, children and components of two trees, checkValues is false for families that shouldn't have been loaded.
+    void checkSameTree(ecs::entity_handle expected, ecs::entity_handle actual, bool checkValues = true)
+    {
+        REQUIRE(actual);
+        CHECK_EQ(actual.get_name(), expected.get_name());
+
+        if (checkValues)
+        {
+            REQUIRE_EQ(actual.has_component<snapshot_test_value>(), expected.has_component<snapshot_test_value>());
+            if (expected.has_component<snapshot_test_value>())
+            {
+                CHECK_EQ(actual.read_component<snapshot_test_value>().value, expected.read_component<snapshot_test_value>().value);
+                CHECK_EQ(actual.read_component<snapshot_test_value>().weight, expected.read_component<snapshot_test_value>().weight);
+            }
+        }
+        else
+            CHECK_FALSE(actual.has_component<snapshot_test_value>());
+
+        REQUIRE_EQ(actual.has_component<position>(), expected.has_component<position>());
+        if (expected.has_component<position>())
+            CHECK_EQ(static_cast<math::vec3>(actual.read_component<position>()), static_cast<math::vec3>(expected.read_component<position>()));
+
+        REQUIRE_EQ(actual.child_count(), expected.child_count());
+        for (size_type i = 0; i < expected.child_count(); i++)
+        {
+            CHECK_EQ(actual.get_child(i).get_parent(), actual);
+            checkSameTree(expected.get_child(i), actual.get_child(i), checkValues);
+        }
+    }
+
+    // Overwrites the stored layout hash of a component family inside a snapshot buffer.
+    void setSnapshotLayout(std::vector<byte>& buffer, id_type typeId, uint64 layout)
+    {
+        using namespace scenemanagement::detail;
+
+        snapshot_header header;
+        std::memcpy(&header, buffer.data(), sizeof(header));
+
+        for (size_type i = 0; i < header.familyCount; i++)
+        {
+            snapshot_family family;
+            byte* entry = buffer.data() + header.familiesOffset + i * sizeof(snapshot_family);
+            std::memcpy(&family, entry, sizeof(family));
+            if (family.typeId != typeId)
+                continue;
+
+            family.layout = layout;
+            std::memcpy(entry, &family, sizeof(family));
+            return;
+        }
+
+        FAIL("component family is missing from the snapshot");
+    }
+}
+
+TEST_CASE("[core:scenemanagement] snapshots")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    ecs::entity_handle original = createSnapshotTree(registry);
+    std::vector<byte> buffer = scenemanagement::SceneSnapshot::write(registry, original);
+
+    SUBCASE("reading a snapshot recreates the tree it was written from")
+    {
+        ecs::entity_handle copy = scenemanagement::SceneSnapshot::read(registry, buffer.data(), buffer.size());
+        checkSameTree(original, copy);
+        CHECK_FALSE(copy == original);
+        copy.destroy();
+    }
+
+    SUBCASE("families with a different layout hash get skipped")
+    {
+        CHECK_EQ(registry.getFamily<snapshot_test_value>()->snapshot_layout(), ecs::snapshot_layout_of_v<snapshot_test_value>);
+        setSnapshotLayout(buffer, typeHash<snapshot_test_value>(), ecs::snapshot_layout_of_v<snapshot_test_value> + 1);
+
+        ecs::entity_handle copy = scenemanagement::SceneSnapshot::read(registry, buffer.data(), buffer.size());
+        checkSameTree(original, copy, false);
+        copy.destroy();
+    }
+
+    SUBCASE("corrupt snapshots don't create anything")
+    {
+        size_type entityCount = registry.getEntities().first.size();
+
+        std::vector<byte> truncated(buffer.begin(), buffer.begin() + sizeof(scenemanagement::detail::snapshot_header) - 1);
+        CHECK_FALSE(scenemanagement::SceneSnapshot::read(registry, truncated.data(), truncated.size()));
+
+        buffer[0] = 'X';
+        CHECK_FALSE(scenemanagement::SceneSnapshot::read(registry, buffer.data(), buffer.size()));
+
+        CHECK_EQ(registry.getEntities().first.size(), entityCount);
+    }
+
+    original.destroy();
+}
+
+TEST_CASE("[core:scenemanagement] streaming snapshots")
+{
+    ecs::EcsRegistry& registry = registry_access::get();
+    scenemanagement::SceneStreamer& streamer = scenemanagement::SceneManager::get_streamer();
+
+    const size_type entityCount = scenemanagement::SceneStreamer::batch_size * 2 + 100;
+    ecs::entity_handle original = createLargeSnapshotTree(registry, entityCount);
+    std::string path = (std::filesystem::temp_directory_path() / "legion_stream_test.snapshot").string();
+    REQUIRE(scenemanagement::SceneSnapshot::save(registry, path, original));
+
+    ecs::entity_handle direct = scenemanagement::SceneSnapshot::load(registry, path);
+    checkSameTree(original, direct);
+
+    ecs::entity_handle completedRoot;
+    size_type completedCount = 0;
+    auto onComplete = [&](ecs::entity_handle root, const ecs::entity_container& entities)
+    {
+        completedRoot = root;
+        completedCount = entities.size();
+    };
+
+    SUBCASE("streaming frame by frame creates the same tree as loading directly")
+    {
+        time::span budget = streamer.getFrameBudget();
+        streamer.setFrameBudget(time::span(0.f)); // A single batch per update.
+
+        auto operation = streamer.stream(path, world_entity_id, onComplete);
+        size_type updates = 0;
+        while (!operation.is_done())
+        {
+            streamer.update();
+            if (!operation.root())
+                continue;
+            updates++;
+            CHECK_EQ(operation.root().get_parent(), ecs::entity_handle(world_entity_id));
+        }
+        streamer.setFrameBudget(budget);
+
+        CHECK_FALSE(operation.failed());
+        CHECK_GE(updates, 3u);
+        CHECK_EQ(completedRoot, operation.root());
+        CHECK_EQ(completedCount, entityCount);
+        checkSameTree(direct, operation.root());
+        operation.root().destroy();
+    }
+
+    SUBCASE("waiting on the integrating thread creates the same tree as loading directly")
+    {
+        auto operation = streamer.stream(path, world_entity_id, onComplete);
+        operation.wait();
+
+        REQUIRE(operation.is_done());
+        CHECK_FALSE(operation.failed());
+        CHECK_EQ(completedRoot, operation.root());
+        CHECK_EQ(completedCount, entityCount);
+        checkSameTree(direct, operation.root());
+        operation.root().destroy();
+    }
+
+    SUBCASE("missing files fail without creating anything")
+    {
+        auto operation = streamer.stream(path + ".missing", world_entity_id, onComplete);
+        operation.wait();
+
+        CHECK(operation.failed());
+        CHECK_FALSE(operation.root());
+        CHECK_FALSE(completedRoot);
+    }
+
+    CHECK_EQ(streamer.pendingStreams(), 0u);
+
+    direct.destroy();
+    original.destroy();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
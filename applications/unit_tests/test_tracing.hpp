@@ -0,0 +1,153 @@
+#pragma once
+#include <core/tracing/tracer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "doctest.h"
+
+inline namespace {
+
+    using namespace ::legion::core;
+
+    constexpr tracing::event_description trace_outer_scope{ "outer", __FILE__, __LINE__ };
+    constexpr tracing::event_description trace_inner_scope{ "inner", __FILE__, __LINE__ };
+
+    // Checks the properties every snapshot has, no matter how much got overwritten: every end closes an earlier begin and time never goes back.
+    void checkTraceEvents(const std::vector<tracing::trace_event>& events)
+    {
+        size_type depth = 0;
+        int64 lastTimestamp = -1;
+        for (auto& event : events)
+        {
+            REQUIRE((event.description == &trace_outer_scope || event.description == &trace_inner_scope));
+            CHECK_GE(event.timestamp, lastTimestamp);
+            lastTimestamp = event.timestamp;
+
+            if (event.begin)
+                depth++;
+            else
+            {
+                REQUIRE_GT(depth, 0u);
+                depth--;
+            }
+        }
+    }
+
+    // Records an outer scope around an inner scope, timestamps count up from the given one.
+    void writeTraceScopes(tracing::detail::thread_buffer& buffer, size_type count, int64& timestamp)
+    {
+        for (size_type i = 0; i < count; i++)
+        {
+            buffer.write(&trace_outer_scope, true, timestamp++);
+            buffer.write(&trace_inner_scope, true, timestamp++);
+            buffer.write(&trace_inner_scope, false, timestamp++);
+            buffer.write(&trace_outer_scope, false, timestamp++);
+        }
+    }
+}
+
+TEST_CASE("[core:tracing] thread buffers")
+{
+    tracing::detail::thread_buffer buffer(0);
+    std::vector<tracing::trace_event> events;
+    int64 timestamp = 0;
+
+    SUBCASE("snapshots return the records in the order they were written")
+    {
+        writeTraceScopes(buffer, 3, timestamp);
+        buffer.snapshot(events);
+
+        REQUIRE_EQ(events.size(), 12u);
+        for (size_type i = 0; i < events.size(); i++)
+        {
+            CHECK_EQ(events[i].timestamp, static_cast<int64>(i));
+            CHECK_EQ(events[i].begin, i % 4 < 2);
+            CHECK_EQ(events[i].description, (i % 4 == 0 || i % 4 == 3) ? &trace_outer_scope : &trace_inner_scope);
+        }
+    }
+
+    SUBCASE("wrapping around keeps the newest records and drops ends without a begin")
+    {
+        // One record short of four times the capacity, so the oldest record left in the buffer is the end of an inner scope.
+        writeTraceScopes(buffer, tracing::trace_buffer_capacity, timestamp);
+        buffer.write(&trace_outer_scope, true, timestamp++);
+        buffer.snapshot(events);
+
+        REQUIRE_FALSE(events.empty());
+        CHECK_LT(events.size(), tracing::trace_buffer_capacity);
+        CHECK(events.front().begin);
+        CHECK_EQ(events.back().timestamp, timestamp - 1);
+        checkTraceEvents(events);
+    }
+
+    SUBCASE("records from before a clear are left out")
+    {
+        writeTraceScopes(buffer, 2, timestamp);
+        buffer.tail.store(buffer.head.load());
+
+        buffer.snapshot(events);
+        CHECK(events.empty());
+
+        writeTraceScopes(buffer, 1, timestamp);
+        buffer.snapshot(events);
+        REQUIRE_EQ(events.size(), 4u);
+        CHECK_EQ(events.front().timestamp, 8);
+    }
+
+    SUBCASE("snapshots stay consistent while the owner keeps writing")
+    {
+        std::atomic_bool done = { false };
+        std::thread writer([&]()
+            {
+                int64 time = 0;
+                while (!done.load(std::memory_order_relaxed))
+                    writeTraceScopes(buffer, 64, time);
+            });
+
+        for (size_type i = 0; i < 50; i++)
+        {
+            events.clear();
+            buffer.snapshot(events);
+            checkTraceEvents(events);
+        }
+
+        done.store(true, std::memory_order_relaxed);
+        writer.join();
+    }
+}
+
+TEST_CASE("[core:tracing] captures and binary export")
+{
+    std::thread::id recordingThread;
+    std::thread recorder([&]()
+        {
+            recordingThread = std::this_thread::get_id();
+            tracing::scoped_event outer(trace_outer_scope);
+            tracing::scoped_event inner(trace_inner_scope);
+        });
+    recorder.join();
+
+    auto threads = tracing::Tracer::capture();
+    auto thread = std::find_if(threads.begin(), threads.end(), [&](const tracing::thread_capture& capture) { return capture.threadId == recordingThread; });
+    REQUIRE(thread != threads.end());
+    REQUIRE_EQ(thread->events.size(), 4u);
+    CHECK(thread->events[0].begin);
+    CHECK_EQ(thread->events[0].description, &trace_outer_scope);
+    CHECK_FALSE(thread->events[3].begin);
+    CHECK_EQ(thread->events[3].description, &trace_outer_scope);
+    checkTraceEvents(thread->events);
+
+    std::stringstream stream;
+    tracing::Tracer::write(stream, tracing::trace_format::binary);
+    std::string data = stream.str();
+
+    REQUIRE_GE(data.size(), 12u);
+    CHECK_EQ(data.substr(0, 8), "LGNTRACE");
+    uint32 version;
+    std::memcpy(&version, data.data() + 8, sizeof(version));
+    CHECK_EQ(version, 1u);
+}
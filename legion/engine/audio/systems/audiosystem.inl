@@ -118,7 +118,7 @@ namespace legion::audio
             auto sourceHandle = entity.get_component_handle<audio_source>();
 
             audio_source source = sourceHandle.read();
-            position p = entity.read_component<position>();
+            position p = HierarchySystem::worldTransform(entity).get_position();
             position& previousP = m_sourcePositions.at(sourceHandle);
             math::vec3 vel = previousP - p;
             previousP = p;
@@ -215,10 +215,10 @@ namespace legion::audio
 
         if (m_listenerEnt)
         {
-            position p = m_listenerEnt.read_component<position>();
-            rotation r = m_listenerEnt.read_component<rotation>();
+            world_transform listenerTransform = HierarchySystem::worldTransform(m_listenerEnt);
+            position p = listenerTransform.get_position();
 
-            setListener(p, r);
+            setListener(p, listenerTransform.get_rotation());
 
             math::vec3 vel = m_listenerPosition - p;
             m_listenerPosition = p;
@@ -237,7 +237,7 @@ namespace legion::audio
         // do something with a.
         initSource(a);
 
-        m_sourcePositions.emplace(handle, event->entity.read_component<position>());
+        m_sourcePositions.emplace(handle, HierarchySystem::worldTransform(event->entity).get_position());
 
         handle.write(a);
         ++sourceCount;
@@ -268,8 +268,9 @@ namespace legion::audio
         {
             // listener count == 1
             m_listenerEnt = event->entity;
-            setListener(event->entity.read_component<position>(), event->entity.read_component<rotation>());
-            m_listenerPosition = event->entity.read_component<position>();
+            world_transform listenerTransform = HierarchySystem::worldTransform(event->entity);
+            setListener(listenerTransform.get_position(), listenerTransform.get_rotation());
+            m_listenerPosition = listenerTransform.get_position();
         }
     }
 
@@ -3,6 +3,7 @@
 namespace legion::core::async
 {
     thread_local id_type this_job::m_id;
+    thread_local size_type own_jobs_only::m_depth = 0;
 
     id_type this_job::get_id() noexcept
     {
@@ -11,12 +11,33 @@ namespace legion::core::async
     {
         template<typename T>
         friend struct job_pool;
+        friend struct job_pool_base;
     private:
         static thread_local id_type m_id;
     public:
         static id_type get_id() noexcept;
     };
 
+    /**@class own_jobs_only
+     * @brief While an instance is alive, job_operation::wait on the current thread only executes jobs of the pool it waits on.
+     *        Waiting normally helps with any pending job, which deadlocks if the waiting thread holds a lock that such a job needs.
+     *        (e.g. EntityQuery::parallel_for keeps the viewed families read locked until all chunks are done)
+     */
+    struct own_jobs_only
+    {
+    private:
+        static thread_local size_type m_depth;
+
+    public:
+        own_jobs_only() noexcept { m_depth++; }
+        ~own_jobs_only() { m_depth--; }
+
+        own_jobs_only(const own_jobs_only&) = delete;
+        own_jobs_only& operator=(const own_jobs_only&) = delete;
+
+        L_NODISCARD static bool active() noexcept { return m_depth; }
+    };
+
     struct job_pool_base
     {
     protected:
@@ -36,6 +57,23 @@ namespace legion::core::async
             m_progress->advance_progress();
         }
 
+        /**@brief Pop and execute a single job of this pool.
+         * @note Restores this_job::get_id() afterwards so that jobs can execute other jobs while waiting on their own child jobs.
+         * @return bool True if a job was executed, false if there were no more jobs left to hand out.
+         */
+        bool execute_job()
+        {
+            id_type parentJobId = this_job::m_id;
+            runnable_base* job = pop_job();
+            if (!job)
+                return false;
+
+            job->execute();
+            complete_job();
+            this_job::m_id = parentJobId;
+            return true;
+        }
+
         bool is_done() const noexcept
         {
             return m_progress->is_done();
@@ -44,36 +82,29 @@ namespace legion::core::async
         virtual bool empty() const noexcept LEGION_PURE;
     };
 
-    template<typename Func, typename CompleteFunc>
+    /**@class job_operation
+     * @brief Handle to a queued job pool.
+     * @tparam HelpFunc Callable of signature bool() that executes a single pending job of any pool, returns false if there was nothing to execute.
+     */
+    template<typename Func, typename HelpFunc>
     struct job_operation : public async_operation<Func>
     {
     private:
-        CompleteFunc m_onComplete;
-
-        void execute_job() const noexcept
-        {
-            OPTICK_EVENT();
-            auto* job = jobPoolPtr->pop_job();
-            if (job)
-            {
-                job->execute();
-                jobPoolPtr->complete_job();
-            }
-
-            if (jobPoolPtr->is_done())
-            {
-                m_onComplete();
-            }
-        }
+        HelpFunc m_helpExecute;
 
     public:
         std::shared_ptr<job_pool_base> jobPoolPtr;
 
-        job_operation(const std::shared_ptr<async_progress>& progress, const std::shared_ptr<job_pool_base>& jobPool, const Func& repeater, const CompleteFunc& complete)
-            : async_operation<Func>(progress, repeater), m_onComplete(complete), jobPoolPtr(jobPool) {}
+        job_operation(const std::shared_ptr<async_progress>& progress, const std::shared_ptr<job_pool_base>& jobPool, const Func& repeater, const HelpFunc& helpExecute)
+            : async_operation<Func>(progress, repeater), m_helpExecute(helpExecute), jobPoolPtr(jobPool) {}
         job_operation(const job_operation&) = default;
         job_operation(job_operation&&) = default;
 
+        /**@brief Wait for all jobs of the pool to finish.
+         * @note Unless the priority is sleep the waiting thread executes jobs of the pool itself first. Once all of those are handed out it helps
+         *       with any other pending work until the last jobs of the pool are done, this keeps jobs that queue and wait on child jobs from starving the workers.
+         *       Inside an own_jobs_only scope the thread only executes jobs of the pool itself.
+         */
         virtual void wait(wait_priority priority = wait_priority_normal) const noexcept override
         {
             if (!jobPoolPtr)
@@ -82,34 +113,32 @@ namespace legion::core::async
             OPTICK_EVENT("legion::core::async::job_operation<T>::wait");
             while (!jobPoolPtr->is_done())
             {
+                if (priority != wait_priority::sleep && (jobPoolPtr->execute_job() || (!own_jobs_only::active() && m_helpExecute())))
+                    continue;
+
                 switch (priority)
                 {
                 case wait_priority::sleep:
                     std::this_thread::sleep_for(std::chrono::microseconds(1));
                     break;
                 case wait_priority::normal:
-                {
-                    execute_job();
-                    L_PAUSE_INSTRUCTION();
+                    std::this_thread::yield();
                     break;
-                }
                 case wait_priority::real_time:
                 default:
-                {
-                    execute_job();
+                    L_PAUSE_INSTRUCTION();
                     break;
                 }
-                }
             }
         }
     };
 
 #if !defined(DOXY_EXCLUDE)
-    template<typename Func, typename CompletionFunc>
+    template<typename Func, typename HelpFunc>
     job_operation(
         const std::shared_ptr<async_progress>&,
         const std::shared_ptr<job_pool_base>&,
-        const Func&, const CompletionFunc&) -> job_operation<Func, CompletionFunc>;
+        const Func&, const HelpFunc&) -> job_operation<Func, HelpFunc>;
 #endif
 
     template<typename Func>
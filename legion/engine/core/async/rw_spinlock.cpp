@@ -1,221 +1,338 @@
 #include <core/async/rw_spinlock.hpp>
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 #include <sstream>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 
 namespace legion::core::async
 {
     bool rw_spinlock::m_forceRelease = false;
     std::atomic_uint rw_spinlock::m_lastId = { 1 };
 
-    thread_local std::unordered_map<uint, int> rw_spinlock::m_localWriters;
-    thread_local std::unordered_map<uint, int> rw_spinlock::m_localReaders;
-    thread_local std::unordered_map<uint, lock_state> rw_spinlock::m_localState;
+    thread_local std::array<uint, rw_spinlock::local_state_capacity> rw_spinlock::m_localIds;
+    thread_local std::array<rw_spinlock::local_state, rw_spinlock::local_state_capacity> rw_spinlock::m_localStates;
+    thread_local size_type rw_spinlock::m_overflowCount = 0;
+    thread_local std::unordered_map<uint, rw_spinlock::local_state> rw_spinlock::m_overflowStates;
 
-    void rw_spinlock::read_lock(wait_priority priority) const
+    namespace
     {
-        OPTICK_EVENT();
-        if (m_forceRelease)
-            return;
+        // Amount of waits that only spin on the pause instruction before the thread starts yielding its time slice.
+        constexpr uint spin_iterations = 64;
+        // Amount of waits that yield before a thread that doesn't wait with real time priority gets parked.
+        constexpr uint yield_iterations = 256;
+        // Amount of waits a new reader defers to waiting writers before it reads anyway.
+        constexpr uint writer_preference_waits = spin_iterations + yield_iterations + 64;
+        // Longest a parked thread sleeps without being woken up, guards against a missed wake up ever becoming a hang.
+        constexpr std::chrono::microseconds max_park_duration{ 200 };
+
+        /**@brief Mutex and condition variable that parked threads wait on. Locks share a small fixed table of them by address.
+         */
+        struct parking_slot
+        {
+            std::mutex mutex;
+            std::condition_variable condition;
+        };
 
-        if (m_localState.at(m_id) != lock_state::idle) // If we're either already reading or writing then the lock doesn't need to be reacquired.
+        parking_slot& parking_slot_for(const void* address) noexcept
         {
-            // Report another local reader to the lock.
-            m_localReaders.at(m_id)++;
-            return;
+            static std::array<parking_slot, 64> slots;
+            return slots[(reinterpret_cast<std::uintptr_t>(address) / alignof(std::max_align_t)) % slots.size()];
         }
 
-        int state;
+        /**@brief Block the thread until ready returns true, a thread that changes the lock state wakes it through unpark.
+         */
+        template<typename Predicate>
+        void park(std::atomic_uint& parked, const void* address, Predicate& ready)
+        {
+            parking_slot& slot = parking_slot_for(address);
+            parked.fetch_add(1, std::memory_order_seq_cst); // Ordered before the check of ready, pairs with the fence in unpark.
+            {
+                std::unique_lock<std::mutex> guard(slot.mutex);
+                slot.condition.wait_for(guard, max_park_duration, ready);
+            }
+            parked.fetch_sub(1, std::memory_order_relaxed);
+        }
 
-        while (true)
+        /**@brief Wake up the threads parked on a lock, call after every change to the lock state that could let a waiting thread continue.
+         */
+        void unpark(const std::atomic_uint& parked, const void* address)
         {
-            // Read the current value and continue waiting until we're in a lockable state.
-            while ((state = m_lockState.load(std::memory_order_relaxed)) == (int)lock_state::write)
+            std::atomic_thread_fence(std::memory_order_seq_cst); // Either we see the parked thread, or it sees our change of the lock state.
+            if (!parked.load(std::memory_order_relaxed))
+                return;
+
+            parking_slot& slot = parking_slot_for(address);
+            std::lock_guard<std::mutex> guard(slot.mutex); // Can't slip in between the parked thread checking ready and going to sleep.
+            slot.condition.notify_all();
+        }
+
+        /**@brief Adaptive back-off: spin first, then yield, then park the thread until the lock state changes.
+         *        Real time waits never get parked, sleep waits get parked straight away.
+         */
+        struct adaptive_wait
+        {
+            uint iteration = 0;
+
+            template<typename Predicate>
+            void operator()(wait_priority priority, std::atomic_uint& parked, const void* address, Predicate& ready)
             {
-                OPTICK_EVENT("Acquire read lock");
-
-                switch (priority)
-                {
-                case wait_priority::sleep:
-                    std::this_thread::sleep_for(std::chrono::microseconds(1));
-                    break;
-                case wait_priority::normal:
-                    std::this_thread::yield();
-                    break;
-                case wait_priority::real_time:
-                default:
+                iteration++;
+                if (priority != wait_priority::sleep && iteration <= spin_iterations)
                     L_PAUSE_INSTRUCTION();
-                    break;
-                }
+                else if (priority == wait_priority::real_time || (priority != wait_priority::sleep && iteration <= spin_iterations + yield_iterations))
+                    std::this_thread::yield();
+                else
+                    park(parked, address, ready);
             }
+        };
+    }
+
+    rw_spinlock::local_state* rw_spinlock::find_local_state() const noexcept
+    {
+        for (size_type i = 0; i < local_state_capacity; i++)
+            if (m_localIds[i] == m_id)
+                return &m_localStates[i];
+
+        if (m_overflowCount)
+            if (auto itr = m_overflowStates.find(m_id); itr != m_overflowStates.end())
+                return &itr->second;
+
+        return nullptr;
+    }
+
+    rw_spinlock::local_state& rw_spinlock::create_local_state() const
+    {
+        for (size_type i = 0; i < local_state_capacity; i++)
+        {
+            if (!m_localIds[i])
+            {
+                m_localIds[i] = m_id;
+                m_localStates[i] = local_state{};
+                return m_localStates[i];
+            }
+        }
+
+        m_overflowCount++; // This thread holds a lot of locks at once, fall back to the slower bookkeeping.
+        return m_overflowStates[m_id];
+    }
+
+    void rw_spinlock::release_local_state(local_state& state) const
+    {
+        if (&state >= m_localStates.data() && &state < m_localStates.data() + local_state_capacity)
+        {
+            m_localIds[&state - m_localStates.data()] = 0;
+            return;
+        }
+
+        m_overflowStates.erase(m_id);
+        m_overflowCount--;
+    }
+
+    void rw_spinlock::acquire_read(wait_priority priority) const
+    {
+        if (!m_waitingWriters.load(std::memory_order_relaxed) && try_acquire_read())
+            return;
+
+        OPTICK_EVENT("Acquire read lock");
+        adaptive_wait wait;
+
+        // New readers let waiting writers go first, but only for a while. A thread that holds this lock for read and waits on other threads
+        // that want to read it as well (e.g. EntityQuery::parallel_for waiting on its jobs) would otherwise deadlock with the waiting writer.
+        auto mayRead = [&]()
+        {
+            return !(m_lockState.load() & writer_bit) && (!m_waitingWriters.load() || wait.iteration >= writer_preference_waits);
+        };
+
+        do
+        {
+            // Wait without touching the lock state until the writers are done.
+            while (!mayRead())
+                wait(priority, m_parked, this, mayRead);
+        } while (!try_acquire_read());
+    }
+
+    bool rw_spinlock::try_acquire_read() const
+    {
+        // Readers don't need to compare and swap, a single increment is enough if there is no writer.
+        if (!(m_lockState.fetch_add(1, std::memory_order_acquire) & writer_bit))
+            return true;
+
+        m_lockState.fetch_sub(1, std::memory_order_relaxed); // A writer got in first, take our increment back.
+        unpark(m_parked, this); // A writer that is waiting for the readers to leave might have parked on our increment.
+        return false;
+    }
+
+    void rw_spinlock::acquire_write(wait_priority priority) const
+    {
+        uint state = 0;
+        if (m_lockState.compare_exchange_strong(state, writer_bit, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+
+        OPTICK_EVENT("Acquire write lock");
+        m_waitingWriters.fetch_add(1, std::memory_order_relaxed); // Holds off new readers so that a stream of readers can't starve us.
+        adaptive_wait wait;
+        auto mayWrite = [&]() { return m_lockState.load() == 0; };
 
-            // Try to add a reader to the lock state. If the lock succeeded then we can continue.
-            if (m_lockState.compare_exchange_weak(state, state + (int)lock_state::read, std::memory_order_acquire, std::memory_order_relaxed))
-                break;
+        do
+        {
+            // Wait without touching the lock state until all readers and writers are done.
+            while (!mayWrite())
+                wait(priority, m_parked, this, mayWrite);
+
+            state = 0;
+        } while (!m_lockState.compare_exchange_weak(state, writer_bit, std::memory_order_acquire, std::memory_order_relaxed));
+
+        m_waitingWriters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void rw_spinlock::read_lock(wait_priority priority) const
+    {
+        if (m_forceRelease)
+            return;
+
+        if (local_state* local = find_local_state()) // If we're either already reading or writing then the lock doesn't need to be reacquired.
+        {
+            // Report another local reader to the lock.
+            local->readers++;
+            return;
         }
 
-        // Report another reader to the lock.
-        m_localReaders.at(m_id)++;
-        m_localState.at(m_id) = lock_state::read; // Set thread_local state to read.
+        acquire_read(priority);
+
+        local_state& local = create_local_state();
+        local.readers = 1;
+        local.state = lock_state::read; // Set thread_local state to read.
     }
 
     bool rw_spinlock::read_try_lock() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return true;
 
-        if (m_localState.at(m_id) != lock_state::idle) // If we're either already reading or writing then the lock doesn't need to be reacquired.
+        if (local_state* local = find_local_state()) // If we're either already reading or writing then the lock doesn't need to be reacquired.
         {
             // Report another local reader to the lock.
-            m_localReaders.at(m_id)++;
+            local->readers++;
             return true;
         }
 
-        // Expect idle as default.
-        int state;
-
-        if ((state = m_lockState.load(std::memory_order_relaxed)) == (int)lock_state::write || // Check if we can lock at all first to reduce LSU abuse on SMT CPUs if this occurs in a try_lock loop.
-            !m_lockState.compare_exchange_strong(state, state + (int)lock_state::read, std::memory_order_acquire, std::memory_order_relaxed)) // Try to add a reader to the lock state.
+        // Check if we can lock at all first to reduce LSU abuse on SMT CPUs if this occurs in a try_lock loop.
+        if ((m_lockState.load(std::memory_order_relaxed) & writer_bit) || !try_acquire_read())
             return false;
 
-        // Report another reader to the lock.
-        m_localReaders.at(m_id)++;
-        m_localState.at(m_id) = lock_state::read; // Set thread_local state to read.
+        local_state& local = create_local_state();
+        local.readers = 1;
+        local.state = lock_state::read; // Set thread_local state to read.
         return true;
     }
 
     void rw_spinlock::write_lock(wait_priority priority) const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
-        if (m_localState.at(m_id) == lock_state::read) // If we're currently only acquired for read we need to stop reading before requesting rw.
+        local_state* local = find_local_state();
+        if (local && local->state == lock_state::write) // If we're already writing then we don't need to reacquire the lock.
         {
-            read_unlock();
-            m_localReaders.at(m_id)++;
-        }
-        else if (m_localState.at(m_id) == lock_state::write) // If we're already writing then we don't need to reacquire the lock.
-        {
-            m_localWriters.at(m_id)++;
+            local->writers++;
             return;
         }
 
-        int state;
-
-        while (true)
+        if (local) // We're currently only acquired for read.
         {
-            // Read the current value and continue waiting until we're in a lockable state.
-            while ((state = m_lockState.load(std::memory_order_relaxed)) != (int)lock_state::idle)
+            uint state = 1;
+            // If we're the only reader we can elevate straight to write, otherwise we need to stop reading before requesting rw.
+            if (!m_lockState.compare_exchange_strong(state, writer_bit, std::memory_order_acquire, std::memory_order_relaxed))
             {
-                OPTICK_EVENT("Acquire write lock");
-
-                switch (priority)
-                {
-                case wait_priority::sleep:
-                    std::this_thread::sleep_for(std::chrono::microseconds(1));
-                    break;
-                case wait_priority::normal:
-                    std::this_thread::yield();
-                    break;
-                case wait_priority::real_time:
-                default:
-                    L_PAUSE_INSTRUCTION();
-                    break;
-                }
+                // Not atomic, another writer can get in between. ref: rw_spinlock::lock
+                m_lockState.fetch_sub(1, std::memory_order_release);
+                unpark(m_parked, this);
+                acquire_write(priority);
             }
-
-            // Try to set the lock state to write. If the lock succeeded then we can continue.
-            if (m_lockState.compare_exchange_weak(state, (int)lock_state::write, std::memory_order_acquire, std::memory_order_relaxed))
-                break;
         }
-
+        else
+        {
+            acquire_write(priority);
+            local = &create_local_state();
+        }
 
         m_writer = std::this_thread::get_id();
-        m_localWriters.at(m_id)++;
-        m_localState.at(m_id) = lock_state::write; // Set thread_local state to write.
+        local->writers++;
+        local->state = lock_state::write; // Set thread_local state to write.
     }
 
     bool rw_spinlock::write_try_lock() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return true;
 
-        bool relock = false;
-        if (m_localState.at(m_id) == lock_state::read) // If we're currently only acquired for read we need to stop reading before requesting rw.
+        local_state* local = find_local_state();
+        if (local && local->state == lock_state::write) // If we're already writing then we don't need to reacquire the lock.
         {
-            relock = true;
-            read_unlock();
-            m_localReaders.at(m_id)++;
-        }
-        else if (m_localState.at(m_id) == lock_state::write) // If we're already writing then we don't need to reacquire the lock.
-        {
-            m_localWriters.at(m_id)++;
+            local->writers++;
             return true;
         }
 
-        // Expect idle as default.
-        int state = (int)lock_state::idle;
+        // Expect idle, or only ourselves as reader if we're already reading.
+        uint state = local ? 1 : 0;
 
-        if ((state = m_lockState.load(std::memory_order_relaxed)) != (int)lock_state::idle || // Check if we can lock at all first to reduce LSU abuse on SMT CPUs if this occurs in a try_lock loop.
-            !m_lockState.compare_exchange_strong(state, (int)lock_state::write, std::memory_order_acquire, std::memory_order_relaxed)) // Try to set the lock state to write.
-        {
-            if (relock)
-            {
-                m_localReaders.at(m_id)--;
-                read_lock();
-            }
+        if (m_lockState.load(std::memory_order_relaxed) != state || // Check if we can lock at all first to reduce LSU abuse on SMT CPUs if this occurs in a try_lock loop.
+            !m_lockState.compare_exchange_strong(state, writer_bit, std::memory_order_acquire, std::memory_order_relaxed)) // Try to set the lock state to write.
             return false;
-        }
+
+        if (!local)
+            local = &create_local_state();
 
         m_writer = std::this_thread::get_id();
-        m_localWriters.at(m_id)++;
-        m_localState.at(m_id) = lock_state::write; // Set thread_local state to write.
+        local->writers++;
+        local->state = lock_state::write; // Set thread_local state to write.
         return true;
     }
 
     void rw_spinlock::read_unlock() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
-        auto& localReaders = m_localReaders.at(m_id);
-        localReaders--;
-
-        if (localReaders > 0 || m_localWriters.at(m_id) > 0) // Another local guard is still alive that will unlock the lock for this thread.
-        {
+        local_state* local = find_local_state();
+        if (!local)
             return;
-        }
 
-        m_lockState.fetch_sub((int)lock_state::read, std::memory_order_release);
+        if (--local->readers > 0 || local->writers > 0) // Another local guard is still alive that will unlock the lock for this thread.
+            return;
 
-        m_localState.at(m_id) = lock_state::idle; // Set thread_local state to idle.
+        m_lockState.fetch_sub(1, std::memory_order_release);
+        release_local_state(*local); // Set thread_local state to idle.
+        unpark(m_parked, this);
     }
 
     void rw_spinlock::write_unlock() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
-        auto& localWriters = m_localWriters.at(m_id);
-        localWriters--;
+        local_state* local = find_local_state();
+        if (!local)
+            return;
 
-        if (localWriters > 0) // Another local guard is still alive that will unlock the lock for this thread.
+        if (--local->writers > 0) // Another local guard is still alive that will unlock the lock for this thread.
         {
             return;
         }
-        else if (m_localReaders.at(m_id) > 0)
+        else if (local->readers > 0)
         {
-            m_lockState.store((int)lock_state::read, std::memory_order_release);
-            m_localState.at(m_id) = lock_state::read; // Set thread_local state to idle.
+            m_lockState.fetch_sub(writer_bit - 1, std::memory_order_release); // Swap the writer bit for a single reader.
+            local->state = lock_state::read; // Set thread_local state to read.
+            unpark(m_parked, this);
             return;
         }
 
-        m_lockState.store((int)lock_state::idle, std::memory_order_release);
-        m_localState.at(m_id) = lock_state::idle; // Set thread_local state to idle.
+        m_lockState.fetch_sub(writer_bit, std::memory_order_release);
+        release_local_state(*local); // Set thread_local state to idle.
+        unpark(m_parked, this);
     }
 
     void rw_spinlock::force_release(bool release)
@@ -228,7 +345,7 @@ namespace legion::core::async
         if (m_forceRelease)
             return;
 
-        assert_msg("Attempted to move a rw_spinlock that was locked.", source.m_lockState.load(std::memory_order_relaxed) == (int)lock_state::idle);
+        assert_msg("Attempted to move a rw_spinlock that was locked.", source.m_lockState.load(std::memory_order_relaxed) == 0);
         m_id = source.m_id;
     }
 
@@ -237,24 +354,16 @@ namespace legion::core::async
         if (m_forceRelease)
             return *this;
 
-        assert_msg("Attempted to move a rw_spinlock that was locked.", source.m_lockState.load(std::memory_order_relaxed) == (int)lock_state::idle);
+        assert_msg("Attempted to move a rw_spinlock that was locked.", source.m_lockState.load(std::memory_order_relaxed) == 0);
         m_id = source.m_id;
         return *this;
     }
 
     void rw_spinlock::lock(lock_state permissionLevel, wait_priority priority) const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
-        if (!m_localState.count(m_id))
-        {
-            m_localWriters.emplace(m_id, 0);
-            m_localReaders.emplace(m_id, 0);
-            m_localState.emplace(m_id, lock_state_idle);
-        }
-
         switch (permissionLevel)
         {
         case lock_state::read:
@@ -268,17 +377,9 @@ namespace legion::core::async
 
     bool rw_spinlock::try_lock(lock_state permissionLevel) const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return true;
 
-        if (!m_localState.count(m_id))
-        {
-            m_localWriters.emplace(m_id, 0);
-            m_localReaders.emplace(m_id, 0);
-            m_localState.emplace(m_id, lock_state_idle);
-        }
-
         switch (permissionLevel)
         {
         case lock_state::read:
@@ -292,7 +393,6 @@ namespace legion::core::async
 
     void rw_spinlock::unlock(lock_state permissionLevel) const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
@@ -309,7 +409,6 @@ namespace legion::core::async
 
     void rw_spinlock::lock_shared() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
@@ -318,7 +417,6 @@ namespace legion::core::async
 
     bool rw_spinlock::try_lock_shared() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return true;
 
@@ -327,7 +425,6 @@ namespace legion::core::async
 
     void rw_spinlock::unlock_shared() const
     {
-        OPTICK_EVENT();
         if (m_forceRelease)
             return;
 
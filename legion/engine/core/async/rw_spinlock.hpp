@@ -29,6 +29,15 @@ namespace legion::core::async
      *		 Read-only operations will only wait for Read-Write operations to be finished.
      * @note Read-Write operations cannot happen simultaneously and will wait for each other.
      *		 Read-Write operations will also wait for any Read-only operations to be finished.
+     * @note Uncontended locking is a single atomic operation plus a scan of a small thread_local table of the locks the thread holds.
+     *       Contended waits spin, then yield and finally park the thread on a condition variable until the lock gets released,
+     *       depending on the wait_priority.
+     * @note Writers are preferred. While a writer waits, threads that don't hold the lock yet and block for read permission let it go first.
+     *       They only defer for a bounded amount of waits, so a thread that holds the lock for read and waits on other readers can't deadlock.
+     *       try_lock doesn't defer to waiting writers.
+     * @warning Elevating a read lock to a write lock is only atomic if the thread is the only reader.
+     *          Otherwise the read permission is released before waiting for write permission, another writer can get in between.
+     *          Anything read before elevating may be stale afterwards, read it again once the write lock is held.
      * @ref legion::core::async::readonly_guard
      * @ref legion::core::async::readwrite_guard
      * @ref legion::core::async::readonly_multiguard
@@ -38,18 +47,53 @@ namespace legion::core::async
     struct rw_spinlock final
     {
     private:
+        /**@brief Reentrancy bookkeeping of a single thread for a single lock.
+         */
+        struct local_state
+        {
+            int readers = 0;
+            int writers = 0;
+            lock_state state = lock_state::idle;
+        };
+
+        /**@brief Amount of locks a thread can hold at the same time before the bookkeeping falls back to a hash map.
+         */
+        static constexpr size_type local_state_capacity = 16;
+
+        /**@brief Bit of m_lockState that is set while a thread has write permission. The other bits count the readers.
+         */
+        static constexpr uint writer_bit = 1u << 31;
+
         static bool m_forceRelease;
         static std::atomic_uint m_lastId;
 
-        static thread_local std::unordered_map<uint, int> m_localWriters;
-        static thread_local std::unordered_map<uint, int> m_localReaders;
-        static thread_local std::unordered_map<uint, lock_state> m_localState;
+        // Ids of the locks this thread currently holds, 0 means the slot is unused. Kept separate from the states so a lookup scans a single cache line.
+        static thread_local std::array<uint, local_state_capacity> m_localIds;
+        static thread_local std::array<local_state, local_state_capacity> m_localStates;
+        static thread_local size_type m_overflowCount;
+        static thread_local std::unordered_map<uint, local_state> m_overflowStates;
 
         uint m_id = m_lastId.fetch_add(1, std::memory_order_relaxed);
-        // State of the lock. -1 means that a thread has write permission. 0 means that the lock is unlocked. 1+ means that there are N amount of readers.
-        mutable  std::atomic_int m_lockState = { 0 };
+        // State of the lock. writer_bit means that a thread has write permission, the remaining bits are the amount of readers.
+        // Readers that fail to lock because of a writer briefly add to the count before backing off.
+        mutable std::atomic_uint m_lockState = { 0 };
+        // Amount of writers waiting for the lock, new readers hold off while this is non zero.
+        mutable std::atomic_uint m_waitingWriters = { 0 };
+        // Amount of threads parked on this lock, unlocking only has to wake anyone up if this is non zero.
+        mutable std::atomic_uint m_parked = { 0 };
         mutable std::thread::id m_writer;
 
+        /**@brief Find the bookkeeping of this lock for the current thread.
+         * @return local_state* nullptr if the current thread doesn't hold this lock.
+         */
+        local_state* find_local_state() const noexcept;
+        local_state& create_local_state() const;
+        void release_local_state(local_state& state) const;
+
+        void acquire_read(wait_priority priority) const;
+        bool try_acquire_read() const;
+        void acquire_write(wait_priority priority) const;
+
         void read_lock(wait_priority priority = wait_priority::real_time) const;
 
         bool read_try_lock() const;
@@ -78,6 +122,8 @@ namespace legion::core::async
          *		 Locking for write after already being locked for readonly in the same thread
          *       will attempt to elevate lock permission of this thread to write.
          *		 Locking for write multiple times will remain in write.
+         * @warning Elevation releases the read permission first if other threads are reading as well, so other writers can modify
+         *          the guarded data before this thread gets write permission. Re-read anything that was read before elevating.
          * @param permissionLevel
          */
         void lock(lock_state permissionLevel = lock_state::write, wait_priority priority = wait_priority::real_time) const;
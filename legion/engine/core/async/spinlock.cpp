@@ -1,5 +1,5 @@
 #include <core/async/spinlock.hpp>
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::async
 {
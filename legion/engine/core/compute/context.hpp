@@ -5,7 +5,7 @@
 #include <utility>
 #include <core/data/image.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file context.hpp
@@ -13,7 +13,7 @@
 #include <core/detail/internals.hpp>
 #include <core/filesystem/resource.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::compute {
 
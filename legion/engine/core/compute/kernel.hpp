@@ -6,7 +6,7 @@
 #include <variant>
 #include <map>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::compute
 {
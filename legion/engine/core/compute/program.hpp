@@ -7,7 +7,7 @@
 #include <functional>
 #include <string>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file program.hpp
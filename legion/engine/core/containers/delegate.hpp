@@ -17,13 +17,163 @@
 //Original publication: https://www.codeproject.com/Articles/1170503/The-Impossibly-Fast-Cplusplus-Delegates-Fixed
 
 
+
 #include <vector>
 #include <functional>
 #include <utility>
+#include <type_traits>
+#include <new>
+#include <cstddef>
+#include <core/platform/platform.hpp>
 #include <core/types/primitives.hpp>
 
+/**
+ * @file delegate.hpp
+ * @brief Fast type erased function references with small buffer storage for lambdas and other callables.
+ */
+
 namespace legion::core
 {
+    /**@brief Amount of bytes a callable can take up while still being stored inside the delegate itself.
+     *        Bigger callables, or callables that can throw while moving, get allocated on the heap instead.
+     */
+    constexpr size_type delegate_inline_size = 48;
+
+    template <typename T, bool copyable> class basic_delegate;
+    template <typename T, bool copyable> class basic_multicast_delegate;
+
+    /**@brief Copyable delegate, copying clones any callable it owns.
+     */
+    template <typename T>
+    using delegate = basic_delegate<T, true>;
+
+    /**@brief Delegate that can only be moved, never clones and can therefore also store move only callables.
+     */
+    template <typename T>
+    using move_only_delegate = basic_delegate<T, false>;
+
+    template <typename T>
+    using multicast_delegate = basic_multicast_delegate<T, true>;
+
+    template <typename T>
+    using move_only_multicast_delegate = basic_multicast_delegate<T, false>;
+
+    namespace detail
+    {
+        union delegate_storage
+        {
+            void* pointer;
+            alignas(std::max_align_t) byte buffer[delegate_inline_size];
+        };
+
+        /**@brief Lifetime operations of a callable owned by a delegate. Delegates that only reference an object or function don't have any.
+         */
+        struct delegate_ops
+        {
+            void(*copy)(const delegate_storage& source, delegate_storage& target);
+            void(*move)(delegate_storage& source, delegate_storage& target) noexcept;
+            void(*destroy)(delegate_storage& storage) noexcept;
+        };
+
+        template<typename callable_type>
+        constexpr bool fits_inline_v = sizeof(callable_type) <= delegate_inline_size && alignof(callable_type) <= alignof(delegate_storage) && std::is_nothrow_move_constructible_v<callable_type>;
+
+        template<typename callable_type>
+        L_NODISCARD callable_type* inline_ptr(delegate_storage& storage) noexcept
+        {
+            return std::launder(reinterpret_cast<callable_type*>(storage.buffer));
+        }
+
+        template<typename callable_type>
+        void inline_copy(const delegate_storage& source, delegate_storage& target)
+        {
+            new (target.buffer) callable_type(*inline_ptr<callable_type>(const_cast<delegate_storage&>(source)));
+        }
+
+        template<typename callable_type>
+        void inline_move(delegate_storage& source, delegate_storage& target) noexcept
+        {
+            callable_type* ptr = inline_ptr<callable_type>(source);
+            new (target.buffer) callable_type(std::move(*ptr));
+            ptr->~callable_type();
+        }
+
+        template<typename callable_type>
+        void inline_destroy(delegate_storage& storage) noexcept
+        {
+            inline_ptr<callable_type>(storage)->~callable_type();
+        }
+
+        template<typename callable_type>
+        void heap_copy(const delegate_storage& source, delegate_storage& target)
+        {
+            target.pointer = new callable_type(*static_cast<const callable_type*>(source.pointer));
+        }
+
+        inline void heap_move(delegate_storage& source, delegate_storage& target) noexcept
+        {
+            target.pointer = source.pointer;
+            source.pointer = nullptr;
+        }
+
+        template<typename callable_type>
+        void heap_destroy(delegate_storage& storage) noexcept
+        {
+            delete static_cast<callable_type*>(storage.pointer);
+        }
+
+        template<typename callable_type, bool copyable>
+        constexpr delegate_ops make_delegate_ops() noexcept
+        {
+            delegate_ops ops{ nullptr, nullptr, nullptr };
+            if constexpr (fits_inline_v<callable_type>)
+            {
+                if constexpr (copyable)
+                    ops.copy = &inline_copy<callable_type>;
+                ops.move = &inline_move<callable_type>;
+                ops.destroy = &inline_destroy<callable_type>;
+            }
+            else
+            {
+                if constexpr (copyable)
+                    ops.copy = &heap_copy<callable_type>;
+                ops.move = &heap_move;
+                ops.destroy = &heap_destroy<callable_type>;
+            }
+            return ops;
+        }
+
+        /**@brief One table per callable type, move only delegates leave copy empty so the callable never needs to be copyable.
+         */
+        template<typename callable_type, bool copyable>
+        inline constexpr delegate_ops delegate_ops_v = make_delegate_ops<callable_type, copyable>();
+
+        template<bool copyable>
+        struct copy_policy {};
+
+        template<>
+        struct copy_policy<false>
+        {
+            copy_policy() = default;
+            copy_policy(const copy_policy&) = delete;
+            copy_policy(copy_policy&&) = default;
+            copy_policy& operator=(const copy_policy&) = delete;
+            copy_policy& operator=(copy_policy&&) = default;
+        };
+
+        template<typename T>
+        struct is_delegate : std::false_type {};
+
+        template<typename T, bool copyable>
+        struct is_delegate<basic_delegate<T, copyable>> : std::true_type {};
+
+        template<typename T, bool copyable>
+        struct is_delegate<basic_multicast_delegate<T, copyable>> : std::true_type {};
+
+        template<typename T>
+        constexpr bool is_delegate_v = is_delegate<std::decay_t<T>>::value;
+    }
+
     template<typename T>
     class delegate_base;
 
@@ -31,347 +181,311 @@ namespace legion::core
     class delegate_base<return_type(parameter_types...)>
     {
     protected:
+        using storage_type = detail::delegate_storage;
 
-        using stub_type = return_type(*)(void* this_ptr, parameter_types...);
-
-        using allocator = void* (*)(void*);
-        using deleter = void(*)(void*);
+        /**@brief Stubs get the storage of the delegate and know themselves whether it holds a pointer or the callable itself.
+         *        This keeps invocation down to a single indirect call.
+         */
+        using stub_type = return_type(*)(storage_type& storage, parameter_types...);
 
         struct invocation_element
         {
-            invocation_element() = default;
-            invocation_element(void* this_ptr, stub_type aStub, allocator aCopy = nullptr, allocator aMove = nullptr, deleter aDelete = nullptr) : object(this_ptr), stub(aStub), copy(aCopy), move(aMove), del(aDelete) {}
-            invocation_element(const invocation_element& source)
+            invocation_element() noexcept { storage.pointer = nullptr; }
+
+            invocation_element(void* this_ptr, stub_type aStub) noexcept : stub(aStub) { storage.pointer = this_ptr; }
+
+            invocation_element(const invocation_element& source) { source.clone(*this); }
+
+            invocation_element(invocation_element&& source) noexcept { source.moveTo(*this); }
+
+            ~invocation_element() { reset(); }
+
+            invocation_element& operator=(const invocation_element& source)
             {
-                if (source.copy != nullptr)
+                if (this != &source)
                 {
-                    object = source.copy(source.object);
+                    reset();
+                    source.clone(*this);
                 }
-                else
-                    object = source.object;
-                stub = source.stub;
-                copy = source.copy;
-                move = source.move;
-                del = source.del;
+                return *this;
             }
-            invocation_element(invocation_element&& source)
+
+            invocation_element& operator=(invocation_element&& source) noexcept
             {
-                if (source.move != nullptr)
+                if (this != &source)
                 {
-                    object = source.move(source.object);
+                    reset();
+                    source.moveTo(*this);
                 }
-                else
-                    object = source.object;
-                stub = source.stub;
-                copy = source.copy;
-                move = source.move;
-                del = source.del;
-            }
-
-            ~invocation_element()
-            {
-                if (del != nullptr)
-                    del(object);
+                return *this;
             }
 
-            invocation_element& operator=(const invocation_element& source)
+            /**@brief Construct a callable into the element, inline if it fits.
+             */
+            template<typename callable_type, bool copyable, typename arg_type>
+            void emplace(arg_type&& callable)
             {
-                if (source.copy != nullptr)
+                reset();
+                if constexpr (detail::fits_inline_v<callable_type>)
                 {
-                    object = source.copy(source.object);
+                    new (storage.buffer) callable_type(std::forward<arg_type>(callable));
+                    stub = &inline_stub<callable_type>;
                 }
                 else
-                    object = source.object;
-                stub = source.stub;
-                copy = source.copy;
-                move = source.move;
-                del = source.del;
-                return *this;
+                {
+                    storage.pointer = new callable_type(std::forward<arg_type>(callable));
+                    stub = &heap_stub<callable_type>;
+                }
+                ops = &detail::delegate_ops_v<callable_type, copyable>;
             }
 
-            invocation_element& operator=(invocation_element&& source)
+            void clone(invocation_element& target) const
             {
-                if (source.move != nullptr)
-                {
-                    object = source.move(source.object);
-                }
+                if (ops)
+                    ops->copy(storage, target.storage);
                 else
-                    object = source.object;
-                stub = source.stub;
-                copy = source.copy;
-                move = source.move;
-                del = source.del;
-                return *this;
+                    target.storage.pointer = storage.pointer;
+                target.stub = stub;
+                target.ops = ops;
             }
 
-            void Clone(invocation_element& target) const
+            void moveTo(invocation_element& target) noexcept
             {
-                if (copy != nullptr)
-                {
-                    target.object = copy(object);
-                }
+                if (ops)
+                    ops->move(storage, target.storage);
                 else
-                    target.object = object;
+                    target.storage.pointer = storage.pointer;
                 target.stub = stub;
-                target.copy = copy;
-                target.move = move;
-                target.del = del;
+                target.ops = ops;
+                stub = nullptr;
+                ops = nullptr;
+            }
+
+            void reset() noexcept
+            {
+                if (ops)
+                    ops->destroy(storage);
+                storage.pointer = nullptr;
+                stub = nullptr;
+                ops = nullptr;
+            }
+
+            return_type invoke(parameter_types... arguments) const
+            {
+                return stub(const_cast<storage_type&>(storage), std::forward<parameter_types>(arguments)...);
             }
 
+            /**@brief Referenced functions compare equal when they call the same function on the same object.
+             *        Owned callables are only equal to themselves, every copy of a delegate owns a separate copy of the callable.
+             */
             bool operator ==(const invocation_element& other) const
             {
-                return other.stub == stub && (object == other.object || (copy == other.copy && move == other.move && del == other.del));
+                if (other.stub != stub)
+                    return false;
+                if (ops || other.ops)
+                    return this == &other;
+                return storage.pointer == other.storage.pointer;
             }
             bool operator !=(const invocation_element& other) const
             {
-                return other.stub != stub || (object != other.object || (copy != other.copy || move != other.move || del != other.del));
+                return !(*this == other);
             }
 
-            void* object = nullptr;
+            storage_type storage;
             stub_type stub = nullptr;
-            allocator copy = nullptr;
-            allocator move = nullptr;
-            deleter del = nullptr;
+            const detail::delegate_ops* ops = nullptr;
         };
-    };
-
 
-    template <typename T> class delegate;
-    template <typename T> class multicast_delegate;
+        template <class owner_type, return_type(owner_type::* func_type)(parameter_types...)>
+        static return_type method_stub(storage_type& storage, parameter_types... arguments)
+        {
+            owner_type* p = static_cast<owner_type*>(storage.pointer);
+            return (p->*func_type)(std::forward<parameter_types>(arguments)...);
+        }
 
-    template<typename return_type, typename ...parameter_types>
-    class delegate<return_type(parameter_types...)> final : private delegate_base<return_type(parameter_types...)>
-    {
-    public:
-        delegate() = default;
-        delegate(delegate&&) = default;
-        delegate& operator=(delegate&&) = default;
-        delegate(const delegate& other) = default;
+        template <class owner_type, return_type(owner_type::* func_type)(parameter_types...) const>
+        static return_type const_method_stub(storage_type& storage, parameter_types... arguments)
+        {
+            owner_type* const p = static_cast<owner_type*>(storage.pointer);
+            return (p->*func_type)(std::forward<parameter_types>(arguments)...);
+        }
 
-        bool isNull() const
+        template <return_type(*func_type)(parameter_types...)>
+        static return_type function_stub(storage_type&, parameter_types... arguments)
         {
-            return m_invocation.stub == nullptr;
+            return (func_type)(std::forward<parameter_types>(arguments)...);
         }
 
-        bool operator ==(void* ptr) const
+        template <typename lambda_type>
+        static return_type inline_stub(storage_type& storage, parameter_types... arguments)
         {
-            return (ptr == nullptr) && isNull();
+            return (*detail::inline_ptr<lambda_type>(storage))(std::forward<parameter_types>(arguments)...);
         }
-        bool operator !=(void* ptr) const
+
+        template <typename lambda_type>
+        static return_type heap_stub(storage_type& storage, parameter_types... arguments)
         {
-            return (ptr != nullptr) || (!isNull());
+            return (*static_cast<lambda_type*>(storage.pointer))(std::forward<parameter_types>(arguments)...);
         }
+    };
+
+    /**@class basic_delegate
+     * @brief Reference to a free function, member function or callable.
+     *        Callables up to delegate_inline_size bytes are stored inline, so creating, copying and invoking those never allocates.
+     * @tparam copyable Whether the delegate can be copied. Use the delegate and move_only_delegate aliases.
+     */
+    template<typename return_type, typename ...parameter_types, bool copyable>
+    class basic_delegate<return_type(parameter_types...), copyable> final : private delegate_base<return_type(parameter_types...)>, private detail::copy_policy<copyable>
+    {
+        using base = delegate_base<return_type(parameter_types...)>;
+        using invocation_element = typename base::invocation_element;
+
+        template <typename T, bool> friend class basic_delegate;
+        template <typename T, bool> friend class basic_multicast_delegate;
 
-        delegate(std::nullptr_t)
+        template<typename lambda_type>
+        using enable_if_callable = std::enable_if_t<!detail::is_delegate_v<lambda_type> && !std::is_same_v<std::decay_t<lambda_type>, std::nullptr_t>, int>;
+
+    public:
+        basic_delegate() = default;
+        basic_delegate(basic_delegate&&) noexcept = default;
+        basic_delegate& operator=(basic_delegate&&) noexcept = default;
+
+        basic_delegate(const basic_delegate& other) = default;
+        basic_delegate& operator=(const basic_delegate& other) = default;
+
+        /**@brief Move a copyable delegate into a move only one, the callable is moved along without cloning.
+         */
+        template<bool other_copyable, std::enable_if_t<other_copyable && !copyable, int> = 0>
+        basic_delegate(basic_delegate<return_type(parameter_types...), other_copyable>&& other) noexcept : m_invocation(std::move(other.m_invocation)) {}
+
+        basic_delegate(std::nullptr_t) noexcept {}
+
+        template <typename lambda_type, enable_if_callable<lambda_type> = 0>
+        basic_delegate(lambda_type&& lambda)
         {
+            m_invocation.template emplace<std::decay_t<lambda_type>, copyable>(std::forward<lambda_type>(lambda));
         }
 
-        delegate& operator=(std::nullptr_t)
+        basic_delegate& operator=(std::nullptr_t) noexcept
         {
-            m_invocation.stub = nullptr;
+            m_invocation.reset();
             return *this;
         }
 
-        void clear()
+        template <typename lambda_type, enable_if_callable<lambda_type> = 0>
+        basic_delegate& operator =(lambda_type&& instance)
         {
-            m_invocation.stub = nullptr;
+            m_invocation.template emplace<std::decay_t<lambda_type>, copyable>(std::forward<lambda_type>(instance));
+            return *this;
         }
 
-        template <typename lambda_type>
-        delegate(const lambda_type& lambda)
+        bool isNull() const
         {
-            assign((void*)(new lambda_type(lambda)), lambda_stub<lambda_type>,
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(*p));
-                },
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(std::move(*p)));
-                },
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    delete p;
-                });
+            return m_invocation.stub == nullptr;
         }
 
-        delegate& operator =(const delegate& other)
+        void clear()
         {
-            other.m_invocation.Clone(m_invocation);
-            return *this;
+            m_invocation.reset();
         }
 
-        template <typename lambda_type>
-        delegate& operator =(const lambda_type& instance)
+        bool operator ==(void* ptr) const
         {
-            assign((void*)(new lambda_type(instance)), lambda_stub<lambda_type>,
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(*p));
-                },
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(std::move(*p)));
-                },
-                    [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    delete p;
-                });
-            return *this;
+            return (ptr == nullptr) && isNull();
+        }
+        bool operator !=(void* ptr) const
+        {
+            return (ptr != nullptr) || (!isNull());
         }
 
-        bool operator == (const delegate& other) const
+        bool operator == (const basic_delegate& other) const
         {
             return m_invocation == other.m_invocation;
         }
-        bool operator != (const delegate& other) const
+        bool operator != (const basic_delegate& other) const
         {
             return m_invocation != other.m_invocation;
         }
 
-        bool operator ==(const multicast_delegate<return_type(parameter_types...)>& other) const
+        bool operator ==(const basic_multicast_delegate<return_type(parameter_types...), copyable>& other) const
         {
             return other == (*this);
         }
-        bool operator !=(const multicast_delegate<return_type(parameter_types...)>& other) const
+        bool operator !=(const basic_multicast_delegate<return_type(parameter_types...), copyable>& other) const
         {
             return other != (*this);
         }
 
         template <class owner_type, return_type(owner_type::* func_type)(parameter_types...)>
-        static delegate create(owner_type* instance)
+        static basic_delegate create(owner_type* instance)
         {
-            return delegate(instance, method_stub<owner_type, func_type>);
+            return basic_delegate(instance, &base::template method_stub<owner_type, func_type>);
         }
 
         template <class owner_type, return_type(owner_type::* func_type)(parameter_types...) const>
-        static delegate create(owner_type const* instance)
+        static basic_delegate create(owner_type const* instance)
         {
-            return delegate(const_cast<owner_type*>(instance), const_method_stub<owner_type, func_type>);
+            return basic_delegate(const_cast<owner_type*>(instance), &base::template const_method_stub<owner_type, func_type>);
         }
 
         template <return_type(*func_type)(parameter_types...)>
-        static delegate create()
+        static basic_delegate create()
         {
-            return delegate(nullptr, function_stub<func_type>);
+            return basic_delegate(nullptr, &base::template function_stub<func_type>);
         }
 
         template <typename lambda_type>
-        static delegate create(const lambda_type& instance)
+        static basic_delegate create(const lambda_type& instance)
         {
-            return delegate((void*)(new lambda_type(instance)), lambda_stub<lambda_type>,
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(*p));
-                },
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    return (void*)(new lambda_type(std::move(*p)));
-                },
-                [](void* ptr)
-                {
-                    lambda_type* p = reinterpret_cast<lambda_type*>(ptr);
-                    delete p;
-                });
-        }
-
-        return_type operator()(parameter_types... arguments) const
-        {
-            return (*m_invocation.stub)(m_invocation.object, arguments...);
-        }
-        return_type invoke(parameter_types... arguments) const
-        {
-            return (*m_invocation.stub)(m_invocation.object, arguments...);
+            basic_delegate result;
+            result.m_invocation.template emplace<lambda_type, copyable>(instance);
+            return result;
         }
 
-    private:
-        delegate(void* anObject, typename delegate_base<return_type(parameter_types...)>::stub_type aStub,
-            typename delegate_base<return_type(parameter_types...)>::allocator aCopy = nullptr,
-            typename delegate_base<return_type(parameter_types...)>::allocator aMove = nullptr,
-            typename delegate_base<return_type(parameter_types...)>::deleter aDelete = nullptr)
+        template <typename lambda_type, std::enable_if_t<!std::is_lvalue_reference_v<lambda_type>, int> = 0>
+        static basic_delegate create(lambda_type&& instance)
         {
-            m_invocation.object = anObject;
-            m_invocation.stub = aStub;
-            m_invocation.copy = aCopy;
-            m_invocation.move = aMove;
-            m_invocation.del = aDelete;
+            basic_delegate result;
+            result.m_invocation.template emplace<std::decay_t<lambda_type>, copyable>(std::move(instance));
+            return result;
         }
 
-        void assign(void* anObject, typename delegate_base<return_type(parameter_types...)>::stub_type aStub,
-            typename delegate_base<return_type(parameter_types...)>::allocator aCopy = nullptr,
-            typename delegate_base<return_type(parameter_types...)>::allocator aMove = nullptr,
-            typename delegate_base<return_type(parameter_types...)>::deleter aDelete = nullptr)
-        {
-            m_invocation.object = anObject;
-            m_invocation.stub = aStub;
-            m_invocation.copy = aCopy;
-            m_invocation.move = aMove;
-            m_invocation.del = aDelete;
-        }
-
-        template <class owner_type, return_type(owner_type::* func_type)(parameter_types...)>
-        static return_type method_stub(void* this_ptr, parameter_types... arguments)
-        {
-            owner_type* p = static_cast<owner_type*>(this_ptr);
-            return (p->*func_type)(arguments...);
-        }
-
-        template <class owner_type, return_type(owner_type::* func_type)(parameter_types...) const>
-        static return_type const_method_stub(void* this_ptr, parameter_types... arguments)
+        return_type operator()(parameter_types... arguments) const
         {
-            owner_type* const p = static_cast<owner_type*>(this_ptr);
-            return (p->*func_type)(arguments...);
+            return m_invocation.invoke(std::forward<parameter_types>(arguments)...);
         }
-
-        template <return_type(*func_type)(parameter_types...)>
-        static return_type function_stub(void* this_ptr, parameter_types... arguments)
+        return_type invoke(parameter_types... arguments) const
         {
-            return (func_type)(arguments...);
+            return m_invocation.invoke(std::forward<parameter_types>(arguments)...);
         }
 
-        template <typename lambda_type>
-        static return_type lambda_stub(void* this_ptr, parameter_types... arguments)
-        {
-            lambda_type* p = static_cast<lambda_type*>(this_ptr);
-            return (p->operator())(arguments...);
-        }
+    private:
+        basic_delegate(void* anObject, typename base::stub_type aStub) noexcept : m_invocation(anObject, aStub) {}
 
-        friend class multicast_delegate<return_type(parameter_types...)>;
-        typename delegate_base<return_type(parameter_types...)>::invocation_element m_invocation;
+        invocation_element m_invocation;
     };
 
-    template<typename return_type, typename ...parameter_types>
-    class multicast_delegate<return_type(parameter_types...)> final : private delegate_base<return_type(parameter_types...)>
+    /**@class basic_multicast_delegate
+     * @brief List of delegates that all get invoked together.
+     * @tparam copyable Whether the multicast delegate can be copied. Use the multicast_delegate and move_only_multicast_delegate aliases.
+     */
+    template<typename return_type, typename ...parameter_types, bool copyable>
+    class basic_multicast_delegate<return_type(parameter_types...), copyable> final : private delegate_base<return_type(parameter_types...)>, private detail::copy_policy<copyable>
     {
-    public:
-
-        multicast_delegate() = default;
-        multicast_delegate(multicast_delegate&&) = default;
-        multicast_delegate& operator=(multicast_delegate&&) = default;
-        multicast_delegate(const multicast_delegate& other) = default;
+        using base = delegate_base<return_type(parameter_types...)>;
+        using invocation_element = typename base::invocation_element;
+        using delegate_type = basic_delegate<return_type(parameter_types...), copyable>;
 
-        multicast_delegate& operator =(const multicast_delegate& other)
-        {
-            m_invocationList.clear();
-
-            for (auto& invocation : other.m_invocationList)
-                m_invocationList.emplace_back(invocation);
-
-            return *this;
-        }
+        template<typename lambda_type>
+        using enable_if_callable = std::enable_if_t<!detail::is_delegate_v<lambda_type>, int>;
 
-        ~multicast_delegate()
-        {
-            m_invocationList.clear();
-        }
+    public:
+        basic_multicast_delegate() = default;
+        basic_multicast_delegate(basic_multicast_delegate&&) noexcept = default;
+        basic_multicast_delegate& operator=(basic_multicast_delegate&&) noexcept = default;
+        basic_multicast_delegate(const basic_multicast_delegate& other) = default;
+        basic_multicast_delegate& operator =(const basic_multicast_delegate& other) = default;
 
         bool isNull() const
         {
@@ -383,6 +497,11 @@ namespace legion::core
             return m_invocationList.size();
         }
 
+        void clear()
+        {
+            m_invocationList.clear();
+        }
+
         bool operator ==(void* ptr) const
         {
             return (ptr == nullptr) && isNull();
@@ -392,118 +511,120 @@ namespace legion::core
             return (ptr != nullptr) || (!isNull());
         }
 
-        bool operator ==(const multicast_delegate& other) const
+        bool operator ==(const basic_multicast_delegate& other) const
         {
-            if (m_invocationList.size() != other.m_invocationList.size())
-                return false;
-
-            auto anotherIt = other.m_invocationList.begin();
-            for (auto it = m_invocationList.begin(); it != m_invocationList.end(); ++it)
-                if (*it != *anotherIt) return false;
-
-            return true;
+            return m_invocationList == other.m_invocationList;
         }
 
-        bool operator !=(const multicast_delegate& other) const
+        bool operator !=(const basic_multicast_delegate& other) const
         {
             return !(*this == other);
         }
 
-        bool operator ==(const delegate<return_type(parameter_types...)>& other) const
+        bool operator ==(const delegate_type& other) const
         {
             if (isNull() && other.isNull())
                 return true;
             if (other.isNull() || (size() != 1))
                 return false;
 
-            return (other.m_invocation == *m_invocationList.begin());
+            return (other.m_invocation == m_invocationList.front());
         }
 
-        bool operator !=(const delegate<return_type(parameter_types...)>& other) const
+        bool operator !=(const delegate_type& other) const
         {
             return !(*this == other);
         }
 
-        multicast_delegate& operator +=(const multicast_delegate& other)
+        basic_multicast_delegate& operator +=(const basic_multicast_delegate& other)
         {
-            for (auto& item : other.m_invocationList) // clone, not copy; flattens hierarchy:
-                m_invocationList.emplace_back(item.object, item.stub);
+            static_assert(copyable, "Move only multicast delegates can only take delegates by rvalue.");
+            m_invocationList.insert(m_invocationList.end(), other.m_invocationList.begin(), other.m_invocationList.end());
             return *this;
         }
 
-        template <typename lambda_type>
-        multicast_delegate& operator +=(const lambda_type& lambda)
+        basic_multicast_delegate& operator +=(basic_multicast_delegate&& other)
         {
-            delegate<return_type(parameter_types...)> d = delegate<return_type(parameter_types...)>::template create<lambda_type>(lambda);
-            return *this += d;
+            m_invocationList.reserve(m_invocationList.size() + other.m_invocationList.size());
+            for (auto& item : other.m_invocationList)
+                m_invocationList.push_back(std::move(item));
+            other.m_invocationList.clear();
+            return *this;
         }
 
-        multicast_delegate& operator +=(const delegate<return_type(parameter_types...)>& other)
+        template <typename lambda_type, enable_if_callable<lambda_type> = 0>
+        basic_multicast_delegate& operator +=(lambda_type&& lambda)
         {
-            if (other.isNull())
-                return *this;
+            invocation_element invocation;
+            invocation.template emplace<std::decay_t<lambda_type>, copyable>(std::forward<lambda_type>(lambda));
+            m_invocationList.push_back(std::move(invocation));
+            return *this;
+        }
 
-            m_invocationList.emplace_back(other.m_invocation.object, other.m_invocation.stub);
+        basic_multicast_delegate& operator +=(const delegate_type& other)
+        {
+            static_assert(copyable, "Move only multicast delegates can only take delegates by rvalue.");
+            if (!other.isNull())
+                m_invocationList.push_back(other.m_invocation);
             return *this;
         }
 
-        void operator()(parameter_types... arguments) const
+        basic_multicast_delegate& operator +=(delegate_type&& other)
         {
-            for (auto& item : m_invocationList)
-                (*(item.stub))(item.object, arguments...);
+            if (!other.isNull())
+                m_invocationList.push_back(std::move(other.m_invocation));
+            return *this;
         }
 
-        void invoke(parameter_types... arguments) const
+        /**@brief Remove the last added delegate that's equal to the given one.
+         * @note Only works for delegates to functions and member functions. Delegates that own a callable (e.g. a lambda) can't be removed by value,
+         *       the list holds its own copy of the callable which never compares equal to the given one.
+         */
+        basic_multicast_delegate& operator -=(const delegate_type& other)
+        {
+            for (auto it = m_invocationList.rbegin(); it != m_invocationList.rend(); ++it)
+                if (*it == other.m_invocation)
+                {
+                    m_invocationList.erase(std::next(it).base());
+                    break;
+                }
+            return *this;
+        }
+
+        void operator()(parameter_types... arguments) const
         {
             for (auto& item : m_invocationList)
-                (*(item.stub))(item.object, arguments...);
+                item.stub(const_cast<typename base::storage_type&>(item.storage), arguments...);
         }
 
-        template<typename return_handler>
-        void operator()(parameter_types... arguments, return_handler handler) const
+        void invoke(parameter_types... arguments) const
         {
-            size_type index = 0;
             for (auto& item : m_invocationList)
-            {
-                return_type value = (*(item.stub))(item.object, arguments...);
-                handler(index, &value);
-                ++index;
-            }
+                item.stub(const_cast<typename base::storage_type&>(item.storage), arguments...);
         }
 
+        /**@brief Invoke all delegates and hand each return value to a handler.
+         * @param handler Callable taking the index of the delegate and a pointer to its return value.
+         */
         template<typename return_handler>
-        void invoke(parameter_types... arguments, return_handler handler) const
+        void operator()(parameter_types... arguments, return_handler&& handler) const
         {
             size_type index = 0;
             for (auto& item : m_invocationList)
             {
-                return_type value = (*(item.stub))(item.object, arguments...);
+                return_type value = item.stub(const_cast<typename base::storage_type&>(item.storage), arguments...);
                 handler(index, &value);
                 ++index;
             }
         }
 
-        void operator()(parameter_types... arguments, delegate<void(size_type, return_type*)> handler) const
-        {
-            operator() < decltype(handler) > (arguments..., handler);
-        }
-
-        void invoke(parameter_types... arguments, delegate<void(size_type, return_type*)> handler) const
-        {
-            operator() < decltype(handler) > (arguments..., handler);
-        }
-
-        void operator()(parameter_types... arguments, std::function<void(size_type, return_type*)> handler) const
-        {
-            operator() < decltype(handler) > (arguments..., handler);
-        }
-
-        void invoke(parameter_types... arguments, std::function<void(size_type, return_type*)> handler) const
+        template<typename return_handler>
+        void invoke(parameter_types... arguments, return_handler&& handler) const
         {
-            operator() < decltype(handler) > (arguments..., handler);
+            operator()<return_handler>(arguments..., std::forward<return_handler>(handler));
         }
 
     private:
-        std::vector<typename delegate_base<return_type(parameter_types...)>::invocation_element> m_invocationList;
+        std::vector<invocation_element> m_invocationList;
     };
 }
@@ -8,7 +8,7 @@
 #include <core/types/primitives.hpp>
 #include <core/containers/iterator_tricks.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file hashed_sparse_set.hpp
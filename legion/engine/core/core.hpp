@@ -11,6 +11,7 @@
 #include <core/common/common.hpp>
 #include <core/types/types.hpp>
 #include <core/time/time.hpp>
+#include <core/tracing/tracing.hpp>
 #include <core/async/async.hpp>
 #include <core/containers/containers.hpp>
 #include <core/ecs/ecs.hpp>
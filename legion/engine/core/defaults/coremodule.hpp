@@ -33,11 +33,12 @@ namespace legion::core
             compute::Context::init();
             log::info("Done creating OpenCL");
 
-            reportComponentType<position>();
-            reportComponentType<rotation>();
-            reportComponentType<scale>();
-            reportComponentType<velocity>();
-            reportComponentType<mesh_filter>();
+            reportComponentType<position>(ecs::storage_mode::chunked);
+            reportComponentType<rotation>(ecs::storage_mode::chunked);
+            reportComponentType<scale>(ecs::storage_mode::chunked);
+            reportComponentType<world_transform>(ecs::storage_mode::chunked);
+            reportComponentType<velocity>(ecs::storage_mode::chunked);
+            reportComponentType<mesh_filter>(ecs::storage_mode::chunked);
             reportComponentType<use_embedded_material>();
             reportComponentType<scenemanagement::scene>();
             reportSystem<HierarchySystem>();
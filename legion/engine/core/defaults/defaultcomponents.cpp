@@ -1,39 +1,26 @@
 #include <core/defaults/defaultcomponents.hpp>
+#include <core/defaults/hierarchysystem.hpp>
 
 namespace legion::core
 {
     L_NODISCARD std::tuple<position, rotation, scale> transform::get_local_components()
     {
         OPTICK_EVENT();
-
         auto& [positionH, rotationH, scaleH] = handles;
-
-        position p = positionH.read();
-        rotation r = rotationH.read();
-        scale s = scaleH.read();
-
-        auto parent = positionH.entity.get_parent();
-        if (!parent.get_id())
-            return std::tuple<position, rotation, scale>(p, r, s);
-
-        transform transf = parent.get_component_handles<transform>();
-        if (transf)
-        {
-            position pp = transf.get<position>().read();
-            rotation pr = transf.get<rotation>().read();
-            scale ps = transf.get<scale>().read();
-
-            return std::tuple<position, rotation, scale>(pp - p, r * math::inverse(pr), s / ps);
-        }
-
-        return std::tuple<position, rotation, scale>(p, r, s);
+        return std::tuple<position, rotation, scale>(positionH.read(), rotationH.read(), scaleH.read());
     }
 
-    L_NODISCARD math::mat4 transform::get_local_to_world_matrix()
+    L_NODISCARD math::mat4 transform::get_local_to_parent_matrix()
     {
         OPTICK_EVENT();
         auto& [positionH, rotationH, scaleH] = handles;
         return math::compose(scaleH.read(), rotationH.read(), positionH.read());
     }
 
+    L_NODISCARD math::mat4 transform::get_local_to_world_matrix()
+    {
+        OPTICK_EVENT();
+        return HierarchySystem::worldMatrix(std::get<0>(handles).entity);
+    }
+
 }
@@ -133,6 +133,38 @@ namespace legion::core
 
     };
 
+    /**@class world_transform
+     * @brief Cached local to world matrix of an entity with a transform, kept up to date once per frame by the HierarchySystem.
+     * @note position, rotation and scale are relative to the parent of the entity, for children of the world that is world space.
+     */
+    struct world_transform
+    {
+        math::mat4 matrix = math::mat4(1.f);
+
+        L_NODISCARD position get_position() const
+        {
+            return math::vec3(matrix[3]);
+        }
+
+        /**@brief Rotation of the entity in world space, assumes the scale of the entity and its ancestors is positive.
+         */
+        L_NODISCARD rotation get_rotation() const
+        {
+            OPTICK_EVENT();
+            return math::quat_cast(math::mat3(math::normalize(math::vec3(matrix[0])), math::normalize(math::vec3(matrix[1])), math::normalize(math::vec3(matrix[2]))));
+        }
+
+        L_NODISCARD scale get_scale() const
+        {
+            return math::vec3(math::length(math::vec3(matrix[0])), math::length(math::vec3(matrix[1])), math::length(math::vec3(matrix[2])));
+        }
+
+        L_NODISCARD math::vec3 forward() const
+        {
+            return math::normalize(math::mat3(matrix) * math::vec3::forward);
+        }
+    };
+
     struct transform : public ecs::archetype<position, rotation, scale>
     {
         using base = ecs::archetype<position, rotation, scale>;
@@ -148,14 +180,13 @@ namespace legion::core
             return math::inverse(get_local_to_world_matrix());
         }
 
+        /**@brief Get the local to world matrix.
+         * @note Returns the world_transform cached at the last update of the HierarchySystem if there is one,
+         *       otherwise the matrix gets composed from the transforms of the entity and its ancestors.
+         */
         L_NODISCARD math::mat4 get_local_to_world_matrix();
 
-        L_NODISCARD math::mat4 get_local_to_parent_matrix()
-        {
-            OPTICK_EVENT();
-            auto [position, rotation, scale] = get_local_components();
-            return math::compose(scale, rotation, position);
-        }
+        L_NODISCARD math::mat4 get_local_to_parent_matrix();
 
     };
 
@@ -1,215 +1,195 @@
 #include <core/defaults/hierarchysystem.hpp>
 
-void legion::core::HierarchySystem::onPositionModified(events::component_modification<position>* event)
+namespace legion::core
 {
-    OPTICK_EVENT();
-    if (!event->entity.has_component<hierarchy>())
-        return;
-
-    position diff = event->newValue - event->oldValue;
-    auto children = event->entity.children();
-
-    m_scheduler->queueJobs(children.size(), [&]()
+    L_NODISCARD math::mat4 HierarchySystem::parentWorldMatrix(ecs::entity_handle entity)
+    {
+        OPTICK_EVENT();
+        while (entity.has_component<hierarchy>())
         {
-            auto& child = children[async::this_job::get_id()];
-            child.write_component<position>(child.read_component<position>() + diff);
-        }).wait();
-}
+            entity = entity.get_parent();
+            if (!entity || entity.get_id() == world_entity_id)
+                break;
 
-void legion::core::HierarchySystem::onRotationModified(events::component_modification<rotation>* event)
-{
-    OPTICK_EVENT();
-    if (!event->entity.has_component<hierarchy>())
-        return;
-
-    rotation diff = event->newValue * math::inverse(event->oldValue);
-    position pos = event->entity.read_component<position>();
-    auto children = event->entity.children();
-    m_scheduler->queueJobs(children.size(), [&]()
-        {
-            auto& child = children[async::this_job::get_id()];
-            child.write_component<position>(pos + (math::toMat3(diff) * (child.read_component<position>() - pos)));
-            child.write_component<rotation>(diff * child.read_component<rotation>());
-        }).wait();
-}
+            if (entity.has_component<world_transform>())
+                return entity.read_component<world_transform>().matrix;
+        }
 
-void legion::core::HierarchySystem::onScaleModified(events::component_modification<scale>* event)
-{
-    OPTICK_EVENT();
-    if (!event->entity.has_component<hierarchy>())
-        return;
-
-    scale diff = event->newValue / event->oldValue;
-    position pos = event->entity.read_component<position>();
-    auto children = event->entity.children();
-    m_scheduler->queueJobs(children.size(), [&]()
-        {
-            auto& child = children[async::this_job::get_id()];
-            child.write_component<position>(pos + (diff * (child.read_component<position>() - pos)));
-            child.write_component<scale>(child.read_component<scale>() * diff);
-        }).wait();
-}
+        return math::mat4(1.f);
+    }
 
-void legion::core::HierarchySystem::onPositionBulkModified(events::bulk_component_modification<position>* event)
-{
-    OPTICK_EVENT();
-    const auto& entities = event->entities;
-    const auto& oldValues = event->oldValues;
-    const auto& newValues = event->newValues;
+    L_NODISCARD math::mat4 HierarchySystem::worldMatrix(ecs::entity_handle entity)
+    {
+        OPTICK_EVENT();
+        auto worldH = entity.get_component_handle<world_transform>();
+        if (worldH)
+            return worldH.read().matrix;
 
-    size_type count = entities.size();
+        math::mat4 localMatrix = math::compose(
+            entity.has_component<scale>() ? entity.read_component<scale>() : scale(),
+            entity.has_component<rotation>() ? entity.read_component<rotation>() : rotation(),
+            entity.has_component<position>() ? entity.read_component<position>() : position());
 
-    ecs::component_container<position> diffs;
-    diffs.resize(count);
+        if (entity.has_component<hierarchy>())
+        {
+            ecs::entity_handle parent = entity.get_parent();
+            if (parent && parent.get_id() != world_entity_id)
+                return worldMatrix(parent) * localMatrix;
+        }
 
-    std::vector<byte> hasChildren;
-    hasChildren.resize(count);
+        return localMatrix;
+    }
 
-    std::vector<ecs::entity_set> children;
-    children.resize(count);
+    bool HierarchySystem::hasDirtyAncestor(ecs::entity_handle entity)
+    {
+        m_ancestors.clear();
+        bool dirty = false;
 
-    m_scheduler->queueJobs(count, [&]()
+        ecs::entity_handle ancestor = entity;
+        while (ancestor.has_component<hierarchy>())
         {
-            auto i = async::this_job::get_id();
-            if (entities[i].has_component<hierarchy>())
+            ancestor = ancestor.get_parent();
+            if (!ancestor || ancestor.get_id() == world_entity_id)
+                break;
+
+            auto itr = m_dirtyAbove.find(ancestor);
+            if (itr != m_dirtyAbove.end())
             {
-                children[i] = entities[i].read_component<hierarchy>().children;
-                hasChildren[i] = children[i].size() > 0;
+                dirty = itr->second;
+                break;
             }
-            else
-                hasChildren[i] = false;
-        }).then(count, [&]()
+
+            m_ancestors.push_back(ancestor);
+            if (m_dirty.contains(ancestor))
             {
-                auto i = async::this_job::get_id();
-                if (hasChildren[i])
-                    diffs[i] = newValues[i] - oldValues[i];
-            }).wait();
+                dirty = true;
+                break;
+            }
+        }
 
-        for (int i = 0; i < count; i++)
+        // Every walked ancestor is below the point where the walk stopped, so they share its answer.
+        for (id_type id : m_ancestors)
+            m_dirtyAbove.emplace(id, dirty);
+        return dirty;
+    }
+
+    void HierarchySystem::collectDirtyRoots()
+    {
+        OPTICK_EVENT();
+        m_dirty.clear();
+        m_dirtyAbove.clear();
+        collectChanged<position>();
+        collectChanged<rotation>();
+        collectChanged<scale>();
+        collectChanged<hierarchy>();
+
+        // Only entities with a transform count as dirty, a changed entity without one, like a scene root, mustn't hide its children.
+        m_changed.clear();
+        for (auto& entity : m_dirty)
         {
-            OPTICK_EVENT("Update child");
-            if (!hasChildren[i])
+            // The journal also holds entities that got destroyed since they changed.
+            if (!entity.valid())
                 continue;
 
-            m_scheduler->queueJobs(children[i].size(), [&]()
-                {
-                    auto& child = children[i][async::this_job::get_id()];
-                    child.write_component<position>(child.read_component<position>() + diffs[i]);
-                }).wait();
-        }
-}
-
-void legion::core::HierarchySystem::onRotationBulkModified(events::bulk_component_modification<rotation>* event)
-{
-    OPTICK_EVENT();
-    const auto& entities = event->entities;
-    const auto& oldValues = event->oldValues;
-    const auto& newValues = event->newValues;
-
-    size_type count = entities.size();
-
-    ecs::component_container<rotation> diffs;
-    diffs.resize(count);
+            if (!entity.has_components<position, rotation, scale>())
+            {
+                // Removing part of the transform is journaled too, only entities that had a world matrix affect their children.
+                if (!entity.has_component<world_transform>())
+                    continue;
+                entity.remove_component<world_transform>();
+            }
 
-    std::vector<byte> hasChildren;
-    hasChildren.resize(count);
+            m_changed.push_back(entity);
+        }
 
-    std::vector<ecs::entity_set> children;
-    children.resize(count);
+        m_dirty.clear();
+        for (auto& entity : m_changed)
+            m_dirty.insert(entity);
 
-    m_scheduler->queueJobs(count, [&]()
+        m_level.clear();
+        for (auto& entity : m_changed)
+        {
+            // Entities below another dirty entity get updated as part of that entity's subtree.
+            if (!hasDirtyAncestor(entity))
+                m_level.push_back(transform_node{ entity, static_cast<index_type>(m_level.size()) });
+        }
+    }
+
+    void HierarchySystem::updateLevel()
+    {
+        OPTICK_EVENT();
+        size_type count = m_level.size();
+        m_matrices.resize(count);
+        m_transformed.clear();
+        m_transformedNodes.clear();
+
+        // Components can't be added while the families are viewed, so new entities get their world_transform up front.
+        for (size_type i = 0; i < count; i++)
         {
-            auto i = async::this_job::get_id();
-            if (entities[i].has_component<hierarchy>())
+            ecs::entity_handle entity = m_level[i].entity;
+            if (entity.has_components<position, rotation, scale>())
             {
-                children[i] = entities[i].read_component<hierarchy>().children;
-                hasChildren[i] = children[i].size() > 0;
+                if (!entity.has_component<world_transform>())
+                    entity.add_component<world_transform>();
+
+                m_transformed.push_back(entity);
+                m_transformedNodes.push_back(i);
             }
-            else
-                hasChildren[i] = false;
-        }).then(count, [&]()
-            {
-                auto i = async::this_job::get_id();
-                if (hasChildren[i])
-                    diffs[i] = newValues[i] * math::inverse(oldValues[i]);
-            }).wait();
+            else // Entities without a transform only group their children.
+                m_matrices[i] = m_parentMatrices[m_level[i].parent];
+        }
 
-        for (int i = 0; i < count; i++)
         {
-            OPTICK_EVENT("Update child");
-            if (!hasChildren[i])
-                continue;
-
-            position pos = entities[i].read_component<position>();
+            ecs::read_view<position> positions(m_ecs->getFamily<position>(), m_transformed);
+            ecs::read_view<rotation> rotations(m_ecs->getFamily<rotation>(), m_transformed);
+            ecs::read_view<scale> scales(m_ecs->getFamily<scale>(), m_transformed);
+            ecs::write_view<world_transform> worldTransforms(m_ecs->getFamily<world_transform>(), m_transformed);
 
-            m_scheduler->queueJobs(children[i].size(), [&]()
+            parallelFor(m_transformed.size(), [&](size_type i)
                 {
-                    auto& child = children[i][async::this_job::get_id()];
-                    child.write_component<position>(pos + (math::toMat3(diffs[i]) * (child.read_component<position>() - pos)));
-                    child.write_component<rotation>(diffs[i] * child.read_component<rotation>());
-                }).wait();
+                    size_type node = m_transformedNodes[i];
+                    m_matrices[node] = m_parentMatrices[m_level[node].parent] * math::compose(scales[i], rotations[i], positions[i]);
+                    worldTransforms[i].matrix = m_matrices[node];
+                });
         }
-}
-
-void legion::core::HierarchySystem::onScaleBulkModified(events::bulk_component_modification<scale>* event)
-{
-    OPTICK_EVENT();
-    const auto& entities = event->entities;
-    const auto& oldValues = event->oldValues;
-    const auto& newValues = event->newValues;
 
-    size_type count = entities.size();
+        // The children are read in place, the family stays read locked until the entire level is gathered.
+        m_nextLevel.clear();
+        auto* hierarchies = m_ecs->getFamily<hierarchy>();
+        async::readonly_guard guard(hierarchies->get_lock());
+        for (size_type i = 0; i < count; i++)
+            for (auto& child : hierarchies->get_component(m_level[i].entity).children)
+                m_nextLevel.push_back(transform_node{ child, static_cast<index_type>(i) });
+    }
 
-    ecs::component_container<scale> diffs;
-    diffs.resize(count);
+    void HierarchySystem::update(time::span deltaTime)
+    {
+        OPTICK_EVENT();
+        (void)deltaTime;
 
-    std::vector<byte> hasChildren;
-    hasChildren.resize(count);
+        collectDirtyRoots();
 
-    std::vector<ecs::entity_set> children;
-    children.resize(count);
-
-    m_scheduler->queueJobs(count, [&]()
-        {
-            auto i = async::this_job::get_id();
-            if (entities[i].has_component<hierarchy>())
-            {
-                children[i] = entities[i].read_component<hierarchy>().children;
-                hasChildren[i] = children[i].size() > 0;
-            }
-            else
-                hasChildren[i] = false;
-        }).then(count, [&]()
+        m_parentMatrices.resize(m_level.size());
+        parallelFor(m_level.size(), [&](size_type i)
             {
-                auto i = async::this_job::get_id();
-                if (hasChildren[i])
-                    diffs[i] = newValues[i] / oldValues[i];
-            }).wait();
+                m_parentMatrices[i] = parentWorldMatrix(m_level[i].entity);
+            });
 
-        for (int i = 0; i < count; i++)
+        // Every level only depends on the matrices of the level above it.
+        while (!m_level.empty())
         {
-            OPTICK_EVENT("Update child");
-
-            if (!hasChildren[i])
-                continue;
-
-            position pos = entities[i].read_component<position>();
-
-            m_scheduler->queueJobs(children[i].size(), [&]()
-                {
-                    auto& child = children[i][async::this_job::get_id()];
-                    child.write_component<position>(pos + (diffs[i] * (child.read_component<position>() - pos)));
-                    child.write_component<scale>(child.read_component<scale>() * diffs[i]);
-                }).wait();
+            updateLevel();
+            std::swap(m_level, m_nextLevel);
+            std::swap(m_parentMatrices, m_matrices);
         }
-}
-
-void legion::core::HierarchySystem::setup()
-{
-    bindToEvent<events::component_modification<position>, &HierarchySystem::onPositionModified>();
-    bindToEvent<events::component_modification<rotation>, &HierarchySystem::onRotationModified>();
-    bindToEvent<events::component_modification<scale>, &HierarchySystem::onScaleModified>();
-    bindToEvent<events::bulk_component_modification<position>, &HierarchySystem::onPositionBulkModified>();
-    bindToEvent<events::bulk_component_modification<rotation>, &HierarchySystem::onRotationBulkModified>();
-    bindToEvent<events::bulk_component_modification<scale>, &HierarchySystem::onScaleBulkModified>();
+    }
+
+    void HierarchySystem::setup()
+    {
+        m_ecs->getFamily<position>()->enable_change_journal();
+        m_ecs->getFamily<rotation>()->enable_change_journal();
+        m_ecs->getFamily<scale>()->enable_change_journal();
+        m_ecs->getFamily<hierarchy>()->enable_change_journal();
+        createProcess<&HierarchySystem::update>("Update").reads<position, rotation, scale, hierarchy>().writes<world_transform>();
+    }
 }
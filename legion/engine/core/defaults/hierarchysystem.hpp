@@ -2,18 +2,113 @@
 #include <core/engine/system.hpp>
 #include <core/defaults/defaultcomponents.hpp>
 
+#include <unordered_map>
+
 namespace legion::core
 {
+    /**@class HierarchySystem
+     * @brief Keeps the world_transform of every entity with a transform up to date.
+     *        Entities whose position, rotation, scale or parent changed since the previous frame are dirty. The families of those
+     *        components keep a change journal, so finding the dirty entities doesn't scan every transform. Once per frame the
+     *        subtrees below the dirty entities get updated level by level, every level is split into jobs on the scheduler.
+     */
     class HierarchySystem : public System<HierarchySystem>
     {
+    private:
+        /**@brief Entity in one level of the update pass.
+         */
+        struct transform_node
+        {
+            ecs::entity_handle entity;
+            index_type parent; // Index of the world matrix of the parent in m_parentMatrices.
+        };
+
+        static constexpr size_type m_jobSize = 64;
+
+        ecs::entity_set m_dirty;
+        std::vector<id_type> m_journal;
+        ecs::entity_container m_changed;
+        std::unordered_map<id_type, bool> m_dirtyAbove; // Whether an entity or any of its ancestors is dirty, filled in while collecting the dirty roots.
+        std::vector<id_type> m_ancestors;
+
+        std::vector<transform_node> m_level;
+        std::vector<transform_node> m_nextLevel;
+        std::vector<math::mat4> m_matrices;
+        std::vector<math::mat4> m_parentMatrices;
+        ecs::entity_container m_transformed;        // Entities of the level that have a transform.
+        std::vector<size_type> m_transformedNodes;  // Index in m_level of every entity in m_transformed.
+
+        /**@brief Run func for every index in [0, count), split into jobs of m_jobSize indices.
+         */
+        template<typename Func>
+        void parallelFor(size_type count, Func&& func)
+        {
+            size_type jobCount = (count + m_jobSize - 1) / m_jobSize;
+            auto runJob = [&](size_type jobIndex)
+            {
+                size_type end = std::min((jobIndex + 1) * m_jobSize, count);
+                for (size_type i = jobIndex * m_jobSize; i < end; i++)
+                    func(i);
+            };
+
+            if (jobCount <= 1) // Not worth the overhead of queueing a job.
+            {
+                if (jobCount)
+                    runJob(0);
+                return;
+            }
+
+            async::own_jobs_only restrictHelp; // The viewed families are read locked, jobs of other pools might need to write them.
+            m_scheduler->queueJobs(jobCount, [&]()
+                {
+                    runJob(async::this_job::get_id());
+                }).wait();
+        }
+
+        /**@brief Move the change journal of the component_type family into m_dirty.
+         */
+        template<typename component_type>
+        void collectChanged()
+        {
+            m_ecs->getFamily<component_type>()->take_change_journal(m_journal);
+            for (id_type id : m_journal)
+                m_dirty.insert(ecs::entity_handle(id));
+        }
+
+        /**@brief Whether any ancestor of the entity is in m_dirty.
+         * @note Every ancestor that gets walked is memoized in m_dirtyAbove, so checking all dirty entities visits every ancestor at most once.
+         */
+        bool hasDirtyAncestor(ecs::entity_handle entity);
+
+        /**@brief Collect the entities that changed since the previous update and aren't below another changed entity.
+         *        Entities that lost their transform also lose their world_transform and get collected so that their children are updated.
+         */
+        void collectDirtyRoots();
+
+        /**@brief Update the world matrices of all nodes in m_level and gather their children into m_nextLevel.
+         */
+        void updateLevel();
+
     public:
-        void onPositionModified(events::component_modification<position>* event);
-        void onRotationModified(events::component_modification<rotation>* event);
-        void onScaleModified(events::component_modification<scale>* event);
+        /**@brief World matrix of the closest ancestor with a cached world_transform, identity if there is none.
+         */
+        L_NODISCARD static math::mat4 parentWorldMatrix(ecs::entity_handle entity);
+
+        /**@brief Local to world matrix of an entity.
+         * @note Returns the world_transform cached at the last update if there is one, otherwise the matrix gets composed from the
+         *       position, rotation and scale of the entity and its ancestors. Missing components count as identity.
+         */
+        L_NODISCARD static math::mat4 worldMatrix(ecs::entity_handle entity);
+
+        /**@brief World transform of an entity, for consumers that need the world position, rotation or direction of an entity.
+         * @ref legion::core::HierarchySystem::worldMatrix
+         */
+        L_NODISCARD static world_transform worldTransform(ecs::entity_handle entity)
+        {
+            return world_transform{ worldMatrix(entity) };
+        }
 
-        void onPositionBulkModified(events::bulk_component_modification<position>* event);
-        void onRotationBulkModified(events::bulk_component_modification<rotation>* event);
-        void onScaleBulkModified(events::bulk_component_modification<scale>* event);
+        void update(time::span deltaTime);
 
         virtual void setup();
     };
@@ -0,0 +1,325 @@
+#include <core/ecs/archetype_storage.hpp>
+#include <algorithm>
+
+namespace legion::core::ecs
+{
+    archetype_chunk::archetype_chunk(size_type bytes)
+    {
+        data = static_cast<byte*>(::operator new(bytes, std::align_val_t(archetype_chunk_alignment)));
+    }
+
+    archetype_chunk::~archetype_chunk()
+    {
+        ::operator delete(data, std::align_val_t(archetype_chunk_alignment));
+    }
+
+    archetype_table::archetype_table(const std::vector<id_type>& signature, std::vector<const component_type_info*>&& types)
+        : m_signature(signature), m_types(std::move(types)), m_offsets(m_types.size()), m_tickOffsets(m_types.size())
+    {
+        OPTICK_EVENT();
+        size_type bytesPerEntity = sizeof(id_type);
+        for (auto* type : m_types)
+            bytesPerEntity += type->size + sizeof(component_ticks);
+
+        // Calculates the offsets of all columns for a certain capacity and returns the total amount of bytes required.
+        auto layout = [&](size_type capacity)
+        {
+            size_type offset = capacity * sizeof(id_type);
+            for (size_type i = 0; i < m_types.size(); i++)
+            {
+                size_type alignment = m_types[i]->alignment;
+                offset = (offset + alignment - 1) / alignment * alignment;
+                m_offsets[i] = offset;
+                offset += capacity * m_types[i]->size;
+
+                offset = (offset + alignof(component_ticks) - 1) / alignof(component_ticks) * alignof(component_ticks);
+                m_tickOffsets[i] = offset;
+                offset += capacity * sizeof(component_ticks);
+            }
+            return offset;
+        };
+
+        m_chunkCapacity = std::max<size_type>(archetype_chunk_size / bytesPerEntity, 1);
+        while (m_chunkCapacity > 1 && layout(m_chunkCapacity) > archetype_chunk_size) // Alignment padding might push us over the chunk size.
+            m_chunkCapacity--;
+
+        m_chunkBytes = layout(m_chunkCapacity); // Can exceed archetype_chunk_size for very large components.
+    }
+
+    int archetype_table::column_index(id_type typeId) const noexcept
+    {
+        auto itr = std::lower_bound(m_signature.begin(), m_signature.end(), typeId);
+        if (itr == m_signature.end() || *itr != typeId)
+            return -1;
+        return static_cast<int>(itr - m_signature.begin());
+    }
+
+    bool archetype_table::contains(const std::vector<id_type>& sortedTypes) const noexcept
+    {
+        return std::includes(m_signature.begin(), m_signature.end(), sortedTypes.begin(), sortedTypes.end());
+    }
+
+    size_type archetype_table::allocate_row(id_type entityId)
+    {
+        size_type row = m_size++;
+        size_type chunkIndex = row / m_chunkCapacity;
+
+        if (chunkIndex >= m_chunks.size())
+            m_chunks.push_back(std::make_unique<archetype_chunk>(m_chunkBytes));
+
+        archetype_chunk& chunk = *m_chunks[chunkIndex];
+        chunk.entities()[row % m_chunkCapacity] = entityId;
+        chunk.size++;
+        return row;
+    }
+
+    id_type archetype_table::remove_row(size_type row)
+    {
+        size_type last = m_size - 1;
+        id_type movedEntity = invalid_id;
+
+        for (size_type i = 0; i < m_types.size(); i++)
+        {
+            void* dst = get(row, i);
+            m_types[i]->destroy(dst);
+
+            if (row != last) // Fill the hole with the last entity to keep the table dense.
+            {
+                void* src = get(last, i);
+                m_types[i]->moveConstruct(dst, src);
+                m_types[i]->destroy(src);
+                get_ticks(row, i) = get_ticks(last, i);
+            }
+        }
+
+        if (row != last)
+        {
+            movedEntity = entity(last);
+            m_chunks[row / m_chunkCapacity]->entities()[row % m_chunkCapacity] = movedEntity;
+        }
+
+        m_chunks[last / m_chunkCapacity]->size--;
+        m_size--;
+
+        // Keep at most one empty chunk around so that entities oscillating around a chunk boundary don't allocate every time.
+        while (m_chunks.size() > 1 && m_chunks[m_chunks.size() - 1]->size == 0 && m_chunks[m_chunks.size() - 2]->size == 0)
+            m_chunks.pop_back();
+
+        return movedEntity;
+    }
+
+    archetype_table* ArchetypeStorage::get_table(const std::vector<id_type>& signature)
+    {
+        OPTICK_EVENT();
+        auto itr = m_tables.find(signature);
+        if (itr != m_tables.end())
+            return itr->second.get();
+
+        std::vector<const component_type_info*> types;
+        types.reserve(signature.size());
+        for (id_type typeId : signature)
+            types.push_back(&m_typeInfos.at(typeId));
+
+        auto* table = new archetype_table(signature, std::move(types));
+        m_tables.emplace(signature, std::unique_ptr<archetype_table>(table));
+        m_tableList.push_back(table);
+        return table;
+    }
+
+    archetype_table* ArchetypeStorage::get_table_with(archetype_table* source, id_type typeId)
+    {
+        if (!source)
+            return get_table({ typeId });
+
+        if (auto itr = source->m_addEdges.find(typeId); itr != source->m_addEdges.end())
+            return itr->second;
+
+        std::vector<id_type> signature = source->m_signature;
+        signature.insert(std::upper_bound(signature.begin(), signature.end(), typeId), typeId);
+
+        archetype_table* target = get_table(signature);
+        source->m_addEdges[typeId] = target;
+        target->m_removeEdges[typeId] = source;
+        return target;
+    }
+
+    archetype_table* ArchetypeStorage::get_table_without(archetype_table* source, id_type typeId)
+    {
+        if (source->m_signature.size() <= 1)
+            return nullptr;
+
+        if (auto itr = source->m_removeEdges.find(typeId); itr != source->m_removeEdges.end())
+            return itr->second;
+
+        std::vector<id_type> signature = source->m_signature;
+        signature.erase(std::lower_bound(signature.begin(), signature.end(), typeId));
+
+        archetype_table* target = get_table(signature);
+        source->m_removeEdges[typeId] = target;
+        target->m_addEdges[typeId] = source;
+        return target;
+    }
+
+    size_type ArchetypeStorage::move_entity(id_type entityId, entity_location& location, archetype_table* target)
+    {
+        OPTICK_EVENT();
+        archetype_table* source = location.table;
+        size_type newRow = target->allocate_row(entityId);
+
+        for (size_type i = 0; i < target->m_types.size(); i++)
+        {
+            int sourceColumn = source->column_index(target->m_signature[i]);
+            if (sourceColumn >= 0)
+            {
+                target->m_types[i]->moveConstruct(target->get(newRow, i), source->get(location.row, static_cast<size_type>(sourceColumn)));
+                target->get_ticks(newRow, i) = source->get_ticks(location.row, static_cast<size_type>(sourceColumn));
+            }
+        }
+
+        // Destroys the moved-from husks together with any components that don't exist in the target.
+        id_type movedEntity = source->remove_row(location.row);
+        if (movedEntity != invalid_id)
+            m_locations.at(movedEntity).row = location.row;
+
+        location.table = target;
+        location.row = newRow;
+        return newRow;
+    }
+
+    void* ArchetypeStorage::get_component(id_type entityId, id_type typeId) const
+    {
+        auto itr = m_locations.find(entityId);
+        if (itr == m_locations.end())
+            return nullptr;
+
+        const entity_location& location = itr->second;
+        int column = location.table->column_index(typeId);
+        if (column < 0)
+            return nullptr;
+
+        return location.table->get(location.row, static_cast<size_type>(column));
+    }
+
+    component_ticks* ArchetypeStorage::get_ticks(id_type entityId, id_type typeId) const
+    {
+        auto itr = m_locations.find(entityId);
+        if (itr == m_locations.end())
+            return nullptr;
+
+        const entity_location& location = itr->second;
+        int column = location.table->column_index(typeId);
+        if (column < 0)
+            return nullptr;
+
+        return &location.table->get_ticks(location.row, static_cast<size_type>(column));
+    }
+
+    void* ArchetypeStorage::insert_component(id_type entityId, id_type typeId, void* value, bool move)
+    {
+        OPTICK_EVENT();
+        const component_type_info& info = m_typeInfos.at(typeId);
+        tick_type tick = change_tick::current();
+
+        auto itr = m_locations.find(entityId);
+        size_type row;
+        archetype_table* target;
+
+        if (itr == m_locations.end())
+        {
+            target = get_table_with(nullptr, typeId);
+            row = target->allocate_row(entityId);
+            m_locations.emplace(entityId, entity_location{ target, row });
+        }
+        else
+        {
+            entity_location& location = itr->second;
+            int column = location.table->column_index(typeId);
+            if (column >= 0) // Entity already has the component, just overwrite the value.
+            {
+                void* ptr = location.table->get(location.row, static_cast<size_type>(column));
+                if (value && move)
+                {
+                    info.moveAssign(ptr, value);
+                }
+                else
+                {
+                    info.destroy(ptr);
+                    if (value)
+                        info.copyConstruct(ptr, value);
+                    else
+                        info.defaultConstruct(ptr);
+                }
+                location.table->get_ticks(location.row, static_cast<size_type>(column)).changed = tick;
+                return ptr;
+            }
+
+            target = get_table_with(location.table, typeId);
+            row = move_entity(entityId, location, target);
+        }
+
+        m_generation++;
+
+        size_type column = static_cast<size_type>(target->column_index(typeId));
+        void* ptr = target->get(row, column);
+        target->get_ticks(row, column) = component_ticks{ tick, tick };
+        if (!value)
+            info.defaultConstruct(ptr);
+        else if (move)
+            info.moveConstruct(ptr, value);
+        else
+            info.copyConstruct(ptr, value);
+
+        return ptr;
+    }
+
+    void ArchetypeStorage::erase_component(id_type entityId, id_type typeId)
+    {
+        OPTICK_EVENT();
+        auto itr = m_locations.find(entityId);
+        if (itr == m_locations.end())
+            return;
+
+        entity_location& location = itr->second;
+        if (location.table->column_index(typeId) < 0)
+            return;
+
+        m_generation++;
+
+        archetype_table* target = get_table_without(location.table, typeId);
+        if (target)
+        {
+            move_entity(entityId, location, target);
+            return;
+        }
+
+        // Last chunked component of the entity, the entity leaves the storage entirely.
+        id_type movedEntity = location.table->remove_row(location.row);
+        if (movedEntity != invalid_id)
+            m_locations.at(movedEntity).row = location.row;
+        m_locations.erase(itr);
+    }
+
+    void ArchetypeStorage::erase_entity(id_type entityId)
+    {
+        OPTICK_EVENT();
+        auto itr = m_locations.find(entityId);
+        if (itr == m_locations.end())
+            return;
+
+        m_generation++;
+
+        entity_location& location = itr->second;
+        id_type movedEntity = location.table->remove_row(location.row);
+        if (movedEntity != invalid_id)
+            m_locations.at(movedEntity).row = location.row;
+        m_locations.erase(itr);
+    }
+
+    ArchetypeStorage::entity_location ArchetypeStorage::get_location(id_type entityId) const
+    {
+        auto itr = m_locations.find(entityId);
+        if (itr == m_locations.end())
+            return entity_location{};
+        return itr->second;
+    }
+}
@@ -0,0 +1,320 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/types/type_util.hpp>
+#include <core/platform/platform.hpp>
+#include <core/async/rw_spinlock.hpp>
+#include <core/ecs/change_tick.hpp>
+
+#include <map>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include <core/tracing/tracing.hpp>
+
+/**
+ * @file archetype_storage.hpp
+ * @brief Chunked structure-of-arrays component storage grouped by component composition.
+ */
+
+namespace legion::core::ecs
+{
+    /**@brief Storage mode a component family can be reported with.
+     * @ref legion::core::ecs::EcsRegistry::reportComponentType
+     */
+    enum struct storage_mode { sparse, chunked };
+
+    /**@brief Size in bytes of a single archetype chunk.
+     */
+    constexpr size_type archetype_chunk_size = 16 * 1024;
+
+    /**@brief Alignment of the memory blocks used for archetype chunks. (cache line size)
+     */
+    constexpr size_type archetype_chunk_alignment = 64;
+
+    /**@class component_type_info
+     * @brief Type erased construction and destruction info of a component type. Required to move components between archetypes.
+     */
+    struct component_type_info
+    {
+        id_type typeId = invalid_id;
+        size_type size = 0;
+        size_type alignment = 0;
+
+        void(*defaultConstruct)(void* dst) = nullptr;
+        void(*copyConstruct)(void* dst, const void* src) = nullptr;
+        void(*moveConstruct)(void* dst, void* src) = nullptr;
+        void(*moveAssign)(void* dst, void* src) = nullptr;
+        void(*destroy)(void* ptr) = nullptr;
+
+        template<typename component_type>
+        static component_type_info create()
+        {
+            component_type_info info;
+            info.typeId = typeHash<component_type>();
+            info.size = sizeof(component_type);
+            info.alignment = alignof(component_type);
+            info.defaultConstruct = [](void* dst) { new (dst) component_type(); };
+            info.copyConstruct = [](void* dst, const void* src) { new (dst) component_type(*static_cast<const component_type*>(src)); };
+            info.moveConstruct = [](void* dst, void* src) { new (dst) component_type(std::move(*static_cast<component_type*>(src))); };
+            info.moveAssign = [](void* dst, void* src) { *static_cast<component_type*>(dst) = std::move(*static_cast<component_type*>(src)); };
+            info.destroy = [](void* ptr) { static_cast<component_type*>(ptr)->~component_type(); };
+            return info;
+        }
+    };
+
+    /**@class archetype_chunk
+     * @brief Fixed size block of memory that stores the entity ids and one contiguous array per component type of an archetype.
+     *        Every component array is followed by an array with the change ticks of those components.
+     */
+    struct archetype_chunk
+    {
+        byte* data = nullptr;
+        size_type size = 0;
+
+        explicit archetype_chunk(size_type bytes);
+        ~archetype_chunk();
+
+        archetype_chunk(const archetype_chunk&) = delete;
+        archetype_chunk& operator=(const archetype_chunk&) = delete;
+
+        /**@brief Entity ids of the entities stored in this chunk. (always at the start of the chunk)
+         */
+        L_NODISCARD id_type* entities() const noexcept { return reinterpret_cast<id_type*>(data); }
+    };
+
+    class ArchetypeStorage;
+
+    /**@class archetype_table
+     * @brief All entities with the exact same chunked component composition, stored in fixed size chunks.
+     * @note All chunks except for the last one are always completely filled.
+     */
+    class archetype_table
+    {
+        friend class ArchetypeStorage;
+    private:
+        std::vector<id_type> m_signature;
+        std::vector<const component_type_info*> m_types;
+        std::vector<size_type> m_offsets;
+        std::vector<size_type> m_tickOffsets;
+
+        size_type m_chunkCapacity = 0;
+        size_type m_chunkBytes = 0;
+        size_type m_size = 0;
+
+        std::vector<std::unique_ptr<archetype_chunk>> m_chunks;
+
+        std::unordered_map<id_type, archetype_table*> m_addEdges;
+        std::unordered_map<id_type, archetype_table*> m_removeEdges;
+
+        /**@brief Appends a new row for the entity, does NOT construct any of the components.
+         * @return size_type Index of the new row.
+         */
+        size_type allocate_row(id_type entityId);
+
+        /**@brief Destroys all components of a row and fills the hole with the last row of the table.
+         * @return id_type Id of the entity that was moved into the row, invalid_id if no entity was moved.
+         */
+        id_type remove_row(size_type row);
+
+    public:
+        archetype_table(const std::vector<id_type>& signature, std::vector<const component_type_info*>&& types);
+
+        /**@brief Sorted list of the component type ids stored in this table.
+         */
+        L_NODISCARD const std::vector<id_type>& signature() const noexcept { return m_signature; }
+
+        /**@brief Index of the column of a certain component type, -1 if this table doesn't store the type.
+         */
+        L_NODISCARD int column_index(id_type typeId) const noexcept;
+
+        /**@brief Checks if this table stores all the given component types.
+         * @param sortedTypes Sorted list of component type ids.
+         */
+        L_NODISCARD bool contains(const std::vector<id_type>& sortedTypes) const noexcept;
+
+        /**@brief Amount of entities stored in this table.
+         */
+        L_NODISCARD size_type size() const noexcept { return m_size; }
+
+        /**@brief Max amount of entities a single chunk of this table can store.
+         */
+        L_NODISCARD size_type chunk_capacity() const noexcept { return m_chunkCapacity; }
+
+        L_NODISCARD size_type chunk_count() const noexcept { return m_chunks.size(); }
+
+        L_NODISCARD archetype_chunk& chunk(size_type index) const { return *m_chunks[index]; }
+
+        /**@brief Get the start of the array of a certain column inside a chunk.
+         */
+        L_NODISCARD void* column(size_type chunkIndex, size_type columnIndex) const noexcept
+        {
+            return m_chunks[chunkIndex]->data + m_offsets[columnIndex];
+        }
+
+        /**@brief Get the component array of a certain type inside a chunk.
+         * @return component_type* Pointer to the first element, nullptr if this table doesn't store the type.
+         */
+        template<typename component_type>
+        L_NODISCARD component_type* column(size_type chunkIndex) const noexcept
+        {
+            int idx = column_index(typeHash<component_type>());
+            if (idx < 0)
+                return nullptr;
+            return reinterpret_cast<component_type*>(column(chunkIndex, static_cast<size_type>(idx)));
+        }
+
+        /**@brief Get a component in a certain row.
+         */
+        L_NODISCARD void* get(size_type row, size_type columnIndex) const noexcept
+        {
+            return m_chunks[row / m_chunkCapacity]->data + m_offsets[columnIndex] + (row % m_chunkCapacity) * m_types[columnIndex]->size;
+        }
+
+        /**@brief Get the change tick array of a certain column inside a chunk.
+         */
+        L_NODISCARD component_ticks* ticks(size_type chunkIndex, size_type columnIndex) const noexcept
+        {
+            return reinterpret_cast<component_ticks*>(m_chunks[chunkIndex]->data + m_tickOffsets[columnIndex]);
+        }
+
+        /**@brief Get the change ticks of a component in a certain row.
+         */
+        L_NODISCARD component_ticks& get_ticks(size_type row, size_type columnIndex) const noexcept
+        {
+            return ticks(row / m_chunkCapacity, columnIndex)[row % m_chunkCapacity];
+        }
+
+        /**@brief Get the entity in a certain row.
+         */
+        L_NODISCARD id_type entity(size_type row) const noexcept
+        {
+            return m_chunks[row / m_chunkCapacity]->entities()[row % m_chunkCapacity];
+        }
+    };
+
+    /**@class ArchetypeStorage
+     * @brief Owner of all archetype tables. Stores components of families reported with storage_mode::chunked.
+     *        Entities with the same chunked component composition share a table, adding or removing a chunked component moves the entity between tables.
+     * @note Apart from report_component_type none of the functions of this class lock, use ArchetypeStorage::get_lock().
+     */
+    class ArchetypeStorage
+    {
+    public:
+        /**@class entity_location
+         * @brief Table and row an entity's chunked components are stored at.
+         */
+        struct entity_location
+        {
+            archetype_table* table = nullptr;
+            size_type row = 0;
+        };
+
+    private:
+        mutable async::rw_spinlock m_lock;
+
+        std::unordered_map<id_type, component_type_info> m_typeInfos;
+        std::map<std::vector<id_type>, std::unique_ptr<archetype_table>> m_tables;
+        std::vector<archetype_table*> m_tableList;
+        std::unordered_map<id_type, entity_location> m_locations;
+        size_type m_generation = 0;
+
+        archetype_table* get_table(const std::vector<id_type>& signature);
+        archetype_table* get_table_with(archetype_table* source, id_type typeId);
+        archetype_table* get_table_without(archetype_table* source, id_type typeId);
+
+        /**@brief Moves an entity to a new table, moving all shared components over. Components absent in the target are destroyed.
+         * @return size_type Row in the new table.
+         */
+        size_type move_entity(id_type entityId, entity_location& location, archetype_table* target);
+
+    public:
+        ArchetypeStorage() = default;
+
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+        /**@brief Lock that guards all data in this storage. Shared by all chunked component families.
+         */
+        L_NODISCARD async::rw_spinlock& get_lock() const noexcept { return m_lock; }
+
+        /**@brief Counter that gets incremented by every structural change, adding or removing a chunked component of any family.
+         *        All chunked families share the tables, so any structural change can move the components of every chunked family.
+         *        Pointers into the storage are only valid as long as the generation they were fetched at is still current.
+         */
+        L_NODISCARD size_type generation() const noexcept { return m_generation; }
+
+        /**@brief Make a component type known to the storage.
+         */
+        template<typename component_type>
+        void report_component_type()
+        {
+            async::readwrite_guard guard(m_lock);
+            m_typeInfos.emplace(typeHash<component_type>(), component_type_info::create<component_type>());
+        }
+
+        L_NODISCARD bool is_chunked(id_type typeId) const { return m_typeInfos.count(typeId); }
+
+        /**@brief Thread unsafe component fetch.
+         * @return void* Pointer to the component, nullptr if the entity doesn't have the component.
+         */
+        L_NODISCARD void* get_component(id_type entityId, id_type typeId) const;
+
+        template<typename component_type>
+        L_NODISCARD component_type* get_component(id_type entityId) const
+        {
+            return static_cast<component_type*>(get_component(entityId, typeHash<component_type>()));
+        }
+
+        L_NODISCARD bool has_component(id_type entityId, id_type typeId) const { return get_component(entityId, typeId) != nullptr; }
+
+        /**@brief Thread unsafe fetch of the change ticks of a component.
+         * @return component_ticks* Pointer to the ticks, nullptr if the entity doesn't have the component.
+         */
+        L_NODISCARD component_ticks* get_ticks(id_type entityId, id_type typeId) const;
+
+        /**@brief Adds a component to an entity, moving the entity to the table with the new composition.
+         * @param value Pointer to the value to initialize the component with, nullptr to default construct.
+         * @param move Whether the value may be moved from or needs to be copied.
+         * @note If the entity already has the component the value gets assigned instead and only the changed tick is updated.
+         * @return void* Pointer to the new component. Only valid until the next structural change of any chunked family.
+         */
+        void* insert_component(id_type entityId, id_type typeId, void* value = nullptr, bool move = false);
+
+        template<typename component_type>
+        component_type* insert_component(id_type entityId, component_type&& value)
+        {
+            return static_cast<component_type*>(insert_component(entityId, typeHash<component_type>(), &value, true));
+        }
+
+        /**@brief Removes a component from an entity, moving the entity to the table with the new composition.
+         */
+        void erase_component(id_type entityId, id_type typeId);
+
+        /**@brief Removes all chunked components of an entity.
+         */
+        void erase_entity(id_type entityId);
+
+        /**@brief Location of an entity, table is nullptr if the entity doesn't have any chunked components.
+         */
+        L_NODISCARD entity_location get_location(id_type entityId) const;
+
+        /**@brief All tables that currently exist.
+         */
+        L_NODISCARD const std::vector<archetype_table*>& tables() const noexcept { return m_tableList; }
+
+        /**@brief Invoke a function for every table that stores at least all of the given component types.
+         * @param sortedTypes Sorted list of component type ids.
+         * @param func Function that takes an archetype_table&.
+         */
+        template<typename Func>
+        void for_each_table(const std::vector<id_type>& sortedTypes, Func&& func) const
+        {
+            OPTICK_EVENT();
+            for (archetype_table* table : m_tableList)
+                if (table->size() && table->contains(sortedTypes))
+                    func(*table);
+        }
+    };
+}
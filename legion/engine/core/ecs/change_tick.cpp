@@ -0,0 +1,6 @@
+#include <core/ecs/change_tick.hpp>
+
+namespace legion::core::ecs
+{
+    std::atomic<tick_type> change_tick::m_tick{ 1 };
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/platform/platform.hpp>
+
+#include <atomic>
+
+/**
+ * @file change_tick.hpp
+ * @brief Tick based change detection of components.
+ */
+
+namespace legion::core::ecs
+{
+    using tick_type = uint64;
+
+    /**@class component_ticks
+     * @brief Ticks at which a component was added to its entity and last changed. Stored alongside each component.
+     */
+    struct component_ticks
+    {
+        tick_type added = 0;
+        tick_type changed = 0;
+    };
+
+    /**@class change_tick
+     * @brief Global monotonic counter used to stamp component additions and changes.
+     *        Queries advance the counter each run and compare stamps against the tick of their previous run.
+     * @ref legion::core::ecs::EntityQuery::changed
+     * @ref legion::core::ecs::EntityQuery::added
+     */
+    struct change_tick
+    {
+    private:
+        static std::atomic<tick_type> m_tick;
+
+    public:
+        /**@brief Tick that modifications get stamped with right now.
+         */
+        L_NODISCARD static tick_type current() noexcept
+        {
+            return m_tick.load(std::memory_order_acquire);
+        }
+
+        /**@brief Move to the next tick.
+         * @return tick_type The tick before advancing. Everything stamped after this call has a higher tick.
+         */
+        static tick_type advance() noexcept
+        {
+            return m_tick.fetch_add(1, std::memory_order_acq_rel);
+        }
+    };
+}
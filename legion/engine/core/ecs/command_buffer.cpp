@@ -0,0 +1,163 @@
+#include <core/ecs/command_buffer.hpp>
+#include <core/ecs/ecsregistry.hpp>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+namespace legion::core::ecs
+{
+    CommandBuffer::~CommandBuffer()
+    {
+        for (auto& [_, commands] : m_commands)
+            for (auto& command : commands)
+                if (command.type == command_type::create_entity)
+                    m_registry.releaseEntityId(command.entityId);
+    }
+
+    void CommandBuffer::record(entity_command&& command)
+    {
+        std::thread::id threadId = std::this_thread::get_id();
+        command.sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            async::readonly_guard guard(m_lock); // Only the owning thread pushes into a list, so a read lock is enough.
+            if (auto itr = m_commands.find(threadId); itr != m_commands.end())
+            {
+                itr->second.push_back(std::move(command));
+                return;
+            }
+        }
+
+        async::readwrite_guard guard(m_lock); // First command of this thread, the list still needs to be made.
+        m_commands[threadId].push_back(std::move(command));
+    }
+
+    entity_handle CommandBuffer::createEntity(bool worldChild)
+    {
+        OPTICK_EVENT();
+        id_type entityId = m_registry.reserveEntityId();
+        record(entity_command{ command_type::create_entity, entityId, invalid_id, nullptr, worldChild, 0 });
+        return entity_handle(entityId);
+    }
+
+    void CommandBuffer::destroyEntity(id_type entityId, bool recurse)
+    {
+        OPTICK_EVENT();
+        record(entity_command{ command_type::destroy_entity, entityId, invalid_id, nullptr, recurse, 0 });
+    }
+
+    void CommandBuffer::addComponent(id_type entityId, id_type componentTypeId)
+    {
+        OPTICK_EVENT();
+        record(entity_command{ command_type::add_component, entityId, componentTypeId, nullptr, true, 0 });
+    }
+
+    void CommandBuffer::removeComponent(id_type entityId, id_type componentTypeId)
+    {
+        OPTICK_EVENT();
+        record(entity_command{ command_type::remove_component, entityId, componentTypeId, nullptr, true, 0 });
+    }
+
+    size_type CommandBuffer::size() const
+    {
+        async::readonly_guard guard(m_lock);
+        size_type count = 0;
+        for (auto& [_, commands] : m_commands)
+            count += commands.size();
+        return count;
+    }
+
+    void CommandBuffer::playback()
+    {
+        OPTICK_EVENT();
+        std::vector<entity_command> commands;
+
+        {
+            async::readwrite_guard guard(m_lock);
+            for (auto& [_, threadCommands] : m_commands)
+            {
+                commands.insert(commands.end(), std::make_move_iterator(threadCommands.begin()), std::make_move_iterator(threadCommands.end()));
+                threadCommands.clear();
+            }
+        }
+
+        if (commands.empty())
+            return;
+
+        // Merge the lists of all threads back into the order the commands were recorded in.
+        std::sort(commands.begin(), commands.end(), [](const entity_command& lhs, const entity_command& rhs) { return lhs.sequence < rhs.sequence; });
+
+        // An entity that gets created and destroyed again without any command in between targeting it never has to exist.
+        {
+            std::unordered_map<id_type, size_type> creations;
+            std::vector<bool> skipped(commands.size(), false);
+            for (size_type i = 0; i < commands.size(); i++)
+            {
+                const entity_command& command = commands[i];
+                if (command.type == command_type::create_entity)
+                {
+                    creations[command.entityId] = i;
+                    continue;
+                }
+
+                auto itr = creations.find(command.entityId);
+                if (itr == creations.end())
+                    continue;
+
+                if (command.type == command_type::destroy_entity)
+                {
+                    skipped[itr->second] = true;
+                    skipped[i] = true;
+                    m_registry.releaseEntityId(command.entityId);
+                }
+                creations.erase(itr);
+            }
+
+            size_type kept = 0;
+            for (size_type i = 0; i < commands.size(); i++)
+                if (!skipped[i])
+                    commands[kept++] = std::move(commands[i]);
+            commands.resize(kept);
+        }
+
+        entity_container entities;
+        std::vector<void*> values;
+
+        // Commands are never reordered, later commands can depend on earlier ones. (e.g. remove and re-add of the same component)
+        // Only runs of consecutive commands that do the same operation get batched together.
+        auto start = commands.begin();
+        while (start != commands.end())
+        {
+            auto last = std::find_if(start, commands.end(), [&](const entity_command& command)
+                {
+                    return command.type != start->type || command.componentTypeId != start->componentTypeId || command.flag != start->flag;
+                });
+
+            entities.clear();
+            values.clear();
+            for (auto itr = start; itr != last; ++itr)
+            {
+                entities.push_back(itr->entityId);
+                values.push_back(itr->value.get());
+            }
+
+            switch (start->type)
+            {
+            case command_type::create_entity:
+                m_registry.insertEntityBatch(entities, start->flag);
+                break;
+            case command_type::add_component:
+                m_registry.insertComponentBatch(start->componentTypeId, entities, values);
+                break;
+            case command_type::remove_component:
+                m_registry.eraseComponentBatch(start->componentTypeId, entities);
+                break;
+            case command_type::destroy_entity:
+                m_registry.destroyEntities(entities, start->flag);
+                break;
+            }
+
+            start = last;
+        }
+    }
+}
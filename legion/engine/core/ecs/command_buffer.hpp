@@ -0,0 +1,127 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/types/type_util.hpp>
+#include <core/platform/platform.hpp>
+#include <core/async/rw_spinlock.hpp>
+#include <core/ecs/entity_handle.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <core/tracing/tracing.hpp>
+
+/**
+ * @file command_buffer.hpp
+ * @brief Deferred recording of structural ECS changes.
+ */
+
+namespace legion::core::ecs
+{
+    class EcsRegistry;
+
+    /**@brief Type of structural change recorded in a command buffer.
+     */
+    enum struct command_type { create_entity, add_component, remove_component, destroy_entity };
+
+    /**@class entity_command
+     * @brief Single recorded structural change.
+     */
+    struct entity_command
+    {
+        command_type type;
+        id_type entityId = invalid_id;
+        id_type componentTypeId = invalid_id;
+        std::shared_ptr<void> value; // Starting value of an added component, nullptr to default construct.
+        bool flag = true; // worldChild for create_entity, recurse for destroy_entity.
+        uint64 sequence = 0; // Position in the recording order of all threads, assigned by the command buffer.
+    };
+
+    /**@class CommandBuffer
+     * @brief Records entity creation, entity destruction and component addition/removal from any thread without touching the ECS.
+     *        Calling playback applies all recorded changes in batches, every batch only updates the queries once.
+     * @note Commands are played back in the order a thread recorded them, so removing and then re-adding a component leaves the component in place.
+     *       Consecutive commands of the same type (and component type) form one batch, record similar commands together to get bigger batches.
+     *       Every command gets a sequence number when it's recorded, the lists of all threads are merged by that number.
+     *       Commands of different threads therefore play back in the order they were recorded in, not in the order the threads first recorded something.
+     * @note Entities that get created and destroyed in the same playback without any other command targeting them are never created,
+     *       their reserved ids are released instead. Ids of entities whose creation never got played back are released when the buffer is destroyed.
+     * @note The registry owns a command buffer that gets played back at the end of every frame on the main thread. ref: EcsRegistry::getCommandBuffer()
+     */
+    class CommandBuffer
+    {
+    private:
+        EcsRegistry& m_registry;
+
+        mutable async::rw_spinlock m_lock;
+        std::unordered_map<std::thread::id, std::vector<entity_command>> m_commands; // Every thread records into its own list.
+        std::atomic<uint64> m_sequence = { 0 };
+
+        void record(entity_command&& command);
+
+    public:
+        CommandBuffer(EcsRegistry& registry) : m_registry(registry) {}
+        ~CommandBuffer();
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        /**@brief Record the creation of a new entity.
+         * @param worldChild Whether the entity should be parented to the world.
+         * @return entity_handle Handle to the entity that will be created on playback. The id is reserved immediately
+         *         so the handle can be used in other commands, but the entity only becomes valid after playback.
+         */
+        entity_handle createEntity(bool worldChild = true);
+
+        /**@brief Record the destruction of an entity.
+         * @param recurse Whether to also destroy all children of the entity.
+         */
+        void destroyEntity(id_type entityId, bool recurse = true);
+
+        /**@brief Record the addition of a default constructed component.
+         */
+        void addComponent(id_type entityId, id_type componentTypeId);
+
+        template<typename component_type>
+        void addComponent(id_type entityId)
+        {
+            addComponent(entityId, typeHash<component_type>());
+        }
+
+        /**@brief Record the addition of a component with a starting value.
+         * @note The value is copied or moved into the buffer.
+         */
+        template<typename component_type>
+        void addComponent(id_type entityId, component_type&& value)
+        {
+            using value_type = std::remove_cv_t<std::remove_reference_t<component_type>>;
+            entity_command command{ command_type::add_component, entityId, typeHash<value_type>(), nullptr, true, 0 };
+            command.value = std::make_shared<value_type>(std::forward<component_type>(value));
+            record(std::move(command));
+        }
+
+        /**@brief Record the removal of a component.
+         */
+        void removeComponent(id_type entityId, id_type componentTypeId);
+
+        template<typename component_type>
+        void removeComponent(id_type entityId)
+        {
+            removeComponent(entityId, typeHash<component_type>());
+        }
+
+        /**@brief Amount of commands that are waiting for playback.
+         */
+        L_NODISCARD size_type size() const;
+
+        L_NODISCARD bool empty() const { return size() == 0; }
+
+        /**@brief Apply all recorded commands to the registry and clear the buffer.
+         * @note Commands recorded during playback will wait for the next playback.
+         */
+        void playback();
+    };
+}
@@ -6,7 +6,7 @@
 #include <core/ecs/entity_handle.hpp>
 #include <core/platform/platform.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file component_handle.hpp
@@ -110,7 +110,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type old;
             {
@@ -122,10 +124,13 @@ namespace legion::core::ecs
 #endif
 
                 component_type& ref = family->get_component(entity);
-                old = ref;
+                if (raiseEvent)
+                    old = ref;
                 ref = value;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), std::cref(value));
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), std::cref(value));
             return value;
         }
 
@@ -137,7 +142,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type old;
             {
@@ -149,10 +156,13 @@ namespace legion::core::ecs
 #endif
 
                 component_type& ref = family->get_component(entity);
-                old = ref;
+                if (raiseEvent)
+                    old = ref;
                 ref = value;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), value);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), value);
             return value;
         }
 
@@ -165,7 +175,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -178,11 +190,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 modifier(comp);
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -191,7 +206,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -204,11 +221,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 modifier(comp);
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -220,7 +240,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -233,11 +255,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 comp = comp + value;
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -249,7 +274,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -262,11 +289,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 comp = comp + value;
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -278,7 +308,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -291,11 +323,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 comp = comp * value;
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -307,7 +342,9 @@ namespace legion::core::ecs
         {
             OPTICK_EVENT();
 
+            detail::assert_outside_parallel_for();
             component_pool<component_type>* family = m_registry->getFamily<component_type>();
+            bool raiseEvent = m_eventBus->hasSubscribers<events::component_modification<component_type>>();
 
             component_type ret;
             component_type old;
@@ -320,11 +357,14 @@ namespace legion::core::ecs
 #endif
 
                 component_type& comp = family->get_component(entity);
-                old = comp;
+                if (raiseEvent)
+                    old = comp;
                 comp = comp * value;
                 ret = comp;
+                family->mark_changed(entity);
             }
-            m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::component_modification<component_type>>(entity, std::move(old), ret);
             return ret;
         }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <core/async/rw_spinlock.hpp>
+#include <core/async/spinlock.hpp>
 #include <core/async/transferable_atomic.hpp>
 #include <core/platform/platform.hpp>
 #include <core/containers/atomic_sparse_map.hpp>
@@ -8,6 +9,9 @@
 #include <core/events/events.hpp>
 #include <core/ecs/component_meta.hpp>
 #include <core/ecs/component_container.hpp>
+#include <core/ecs/archetype_storage.hpp>
+#include <core/ecs/change_tick.hpp>
+#include <core/ecs/component_view.hpp>
 
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/memory.hpp>
@@ -15,10 +19,14 @@
 #include <cereal/archives/portable_binary.hpp>
 
 #include <core/serialization/serializationmeta.hpp>
+#include <core/serialization/memory_streambuf.hpp>
 
 #include <functional>
+#include <memory>
+#include <sstream>
+#include <cstring>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file component_pool.hpp
@@ -30,6 +38,61 @@ namespace legion::core::ecs
 
     using entity_container = std::vector<entity_handle>;
 
+    /**@brief How a component family is stored in a binary scene snapshot.
+     */
+    enum struct snapshot_encoding : uint8
+    {
+        raw,                // Array of the components, loaded with a single memcpy.
+        cereal,             // Components written one after another through their serialize or save/load functions.
+        default_construct   // Nothing stored, the components get default constructed on load.
+    };
+
+    /**@brief Encoding a component type gets in binary scene snapshots.
+     *        Trivially copyable components without a save/load pair are stored raw, specialize this to pick a different encoding.
+     *        concurrent_decode tells whether the components may be decoded on a worker thread while a scene streams in.
+     */
+    template<typename component_type>
+    struct snapshot_encoding_of
+    {
+        static constexpr bool has_serialize = serialization::has_serialize<component_type, void(cereal::BinaryOutputArchive&)>::value;
+        static constexpr bool has_save_load = serialization::has_save<component_type, void(cereal::BinaryOutputArchive&)>::value &&
+                                              serialization::has_load<component_type, void(cereal::BinaryInputArchive&)>::value;
+        static constexpr bool concurrent_decode = true;
+
+        static constexpr snapshot_encoding value =
+            std::is_trivially_copyable_v<component_type> && !has_save_load ? snapshot_encoding::raw :
+            has_serialize || has_save_load ? snapshot_encoding::cereal : snapshot_encoding::default_construct;
+    };
+
+    template<typename component_type>
+    constexpr snapshot_encoding snapshot_encoding_of_v = snapshot_encoding_of<component_type>::value;
+
+    /**@brief Version of the stored layout of a component type, specialize this and bump the value whenever the members of a
+     *        component change without changing its size, for example when two members of the same type swap places.
+     */
+    template<typename component_type>
+    struct snapshot_layout_version
+    {
+        static constexpr uint32 value = 0;
+    };
+
+    /**@brief Layout hash stored per family in binary scene snapshots, families with a different hash don't get loaded.
+     *        Raw components also hash their size and alignment, other encodings only depend on the version.
+     */
+    template<typename component_type>
+    constexpr uint64 snapshot_layout_of_v = snapshot_encoding_of_v<component_type> == snapshot_encoding::raw ?
+        (static_cast<uint64>(sizeof(component_type)) << 24 | static_cast<uint64>(alignof(component_type)) << 16) ^ (static_cast<uint64>(snapshot_layout_version<component_type>::value) * 0x9E3779B97F4A7C15ull) :
+        static_cast<uint64>(snapshot_layout_version<component_type>::value);
+
+    /**@brief Components of a single family that haven't been added to any entity yet, for example decoded from a binary scene snapshot or stored in a prefab.
+     * @ref legion::core::ecs::component_pool_base::decode_snapshot
+     * @ref legion::core::ecs::component_pool_base::stage_components
+     */
+    struct component_staging_base
+    {
+        virtual ~component_staging_base() = default;
+    };
+
     /**@class component_pool_base
      * @brief Base class of legion::core::ecs::component_pool
      */
@@ -45,19 +108,69 @@ namespace legion::core::ecs
         virtual void create_component(id_type entityId, void* value) LEGION_PURE;
         virtual void destroy_component(id_type entityId) LEGION_PURE;
 
+        virtual void create_components(const entity_container& entities, void* prototype) LEGION_PURE;
+        virtual void destroy_components(const entity_container& entities) LEGION_PURE;
+
         virtual void clone_component(id_type dst, id_type src) LEGION_PURE;
 
+        L_NODISCARD virtual storage_mode get_storage_mode() const LEGION_PURE;
+
         virtual void serialize(cereal::JSONOutputArchive& oarchive, id_type entityId) LEGION_PURE;
         virtual void serialize(cereal::BinaryOutputArchive& oarchive, id_type entityId) LEGION_PURE;
 
         virtual void serialize(cereal::JSONInputArchive& oarchive, id_type entityId) LEGION_PURE;
         virtual void serialize(cereal::BinaryInputArchive& oarchive, id_type entityId) LEGION_PURE;
 
+        /**@brief Append the components of a batch of entities to a binary scene snapshot blob.
+         * @return snapshot_encoding How the components were written.
+         */
+        virtual snapshot_encoding write_snapshot(const entity_container& entities, std::vector<byte>& blob) const LEGION_PURE;
+
+        /**@brief Layout hash of the component type that gets stored next to the blob.
+         * @ref legion::core::ecs::snapshot_layout_of_v
+         */
+        L_NODISCARD virtual uint64 snapshot_layout() const noexcept LEGION_PURE;
+
+        /**@brief Decode a blob written by write_snapshot without touching the family.
+         * @note Safe to call from any thread if concurrent_snapshot_decode() returns true.
+         * @param count Amount of components stored in the blob.
+         * @param layout Layout hash the blob was written with.
+         * @return std::unique_ptr<component_staging_base> The decoded components, nullptr if the blob doesn't match the component type or its layout.
+         */
+        L_NODISCARD virtual std::unique_ptr<component_staging_base> decode_snapshot(size_type count, const byte* data, size_type size, snapshot_encoding encoding, uint64 layout) const LEGION_PURE;
+
+        /**@brief Whether decode_snapshot can run on another thread than the one adding the components.
+         * @ref legion::core::ecs::snapshot_encoding_of
+         */
+        L_NODISCARD virtual bool concurrent_snapshot_decode() const noexcept LEGION_PURE;
+
+        /**@brief Move a range of decoded components into the family.
+         * @note The family only gets locked once and component_type::init does NOT get called, the stored values are complete.
+         * @param entities Entities to add the components to.
+         * @param staging Components returned by decode_snapshot.
+         * @param offset Index of the component in staging that belongs to the first entity.
+         */
+        virtual void insert_snapshot(const entity_container& entities, component_staging_base& staging, size_type offset) LEGION_PURE;
+
+        /**@brief Copy the components of a batch of entities, the family only gets locked once.
+         * @return std::unique_ptr<component_staging_base> The copies in the same order as the entities.
+         */
+        L_NODISCARD virtual std::unique_ptr<component_staging_base> stage_components(const entity_container& entities) const LEGION_PURE;
+
+        /**@brief Add copies of staged components to a batch of entities, entity i gets a copy of staged component i % the amount of staged components.
+         * @note The family only gets locked once and component_type::init does NOT get called.
+         * @param entities Entities to add the components to, a multiple of the amount of staged components.
+         * @param staging Components returned by stage_components.
+         */
+        virtual void instantiate_components(const entity_container& entities, const component_staging_base& staging) LEGION_PURE;
+
         virtual ~component_pool_base() = default;
     };
 
     /**@class component_pool
      * @brief Thread-safe container to store a component family in.
+     * @note Families reported with storage_mode::chunked don't own their components,
+     *       the components are stored in the ArchetypeStorage of the registry and the family's lock is the lock of the storage.
      * @tparam component_type Type of component.
      */
     template<typename component_type>
@@ -65,14 +178,74 @@ namespace legion::core::ecs
     {
     private:
         sparse_map<id_type, component_type> m_components;
+        sparse_map<id_type, component_ticks> m_ticks;
         mutable async::rw_spinlock m_lock;
 
         events::EventBus* m_eventBus;
         EcsRegistry* m_registry;
+        ArchetypeStorage* m_archetypes = nullptr;
         component_type m_nullComp;
+        size_type m_generation = 0; // Structural changes of a sparse family, chunked families use the generation of the ArchetypeStorage.
+
+        std::atomic_bool m_journalEnabled = { false };
+        async::spinlock m_journalLock;
+        std::vector<id_type> m_journal; // Entities whose component was added, written or removed since the last take_change_journal.
+
+        struct component_staging : public component_staging_base
+        {
+            std::vector<component_type> values;
+        };
+
+        /**@brief Thread unsafe component lookup.
+         * @return component_type* Pointer to the component or nullptr if the entity doesn't have the component.
+         */
+        L_NODISCARD component_type* find_component(id_type entityId) const
+        {
+            if (m_archetypes)
+                return m_archetypes->template get_component<component_type>(entityId);
+
+            if (m_components.contains(entityId))
+                return const_cast<component_type*>(&m_components.at(entityId));
+            return nullptr;
+        }
+
+        void record_change(id_type entityId)
+        {
+            if (!m_journalEnabled.load(std::memory_order_relaxed))
+                return;
+
+            std::lock_guard guard(m_journalLock);
+            m_journal.push_back(entityId);
+        }
+
+        /**@brief Thread unsafe change tick lookup.
+         * @return component_ticks* Pointer to the ticks or nullptr if the entity doesn't have the component.
+         */
+        L_NODISCARD component_ticks* find_ticks(id_type entityId) const
+        {
+            if (m_archetypes)
+                return m_archetypes->get_ticks(entityId, typeHash<component_type>());
+
+            if (m_ticks.contains(entityId))
+                return const_cast<component_ticks*>(&m_ticks.at(entityId));
+            return nullptr;
+        }
+
     public:
         component_pool() = default;
-        component_pool(EcsRegistry* registry, events::EventBus* eventBus) : m_eventBus(eventBus), m_registry(registry) {}
+
+        /**@param archetypes Archetype storage to store the components in, nullptr for storage_mode::sparse.
+         */
+        component_pool(EcsRegistry* registry, events::EventBus* eventBus, ArchetypeStorage* archetypes = nullptr) : m_eventBus(eventBus), m_registry(registry), m_archetypes(archetypes)
+        {
+            if (m_archetypes)
+                m_archetypes->template report_component_type<component_type>();
+        }
+
+        L_NODISCARD storage_mode get_storage_mode() const override
+        {
+            return m_archetypes ? storage_mode::chunked : storage_mode::sparse;
+        }
 
         void serialize(cereal::JSONOutputArchive& oarchive, id_type entityId) override
         {
@@ -85,15 +258,15 @@ namespace legion::core::ecs
 
             if constexpr (serialization::has_serialize<component_type, void(cereal::JSONOutputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 oarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].serialize(oarchive);
+                get_component(entityId).serialize(oarchive);
             }
             else if constexpr (serialization::has_save<component_type, void(cereal::JSONOutputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 oarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].save(oarchive);
+                get_component(entityId).save(oarchive);
             }
             else
             {
@@ -111,15 +284,15 @@ namespace legion::core::ecs
 
             if constexpr (serialization::has_serialize<component_type, void(cereal::BinaryOutputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 oarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].serialize(oarchive);
+                get_component(entityId).serialize(oarchive);
             }
             else if constexpr (serialization::has_save<component_type, void(cereal::BinaryOutputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 oarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].save(oarchive);
+                get_component(entityId).save(oarchive);
             }
             else
             {
@@ -138,15 +311,15 @@ namespace legion::core::ecs
             std::string componentType = std::string(nameOfType<component_type>());
             if constexpr (serialization::has_serialize<component_type, void(cereal::JSONOutputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 iarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].serialize(iarchive);
+                get_component(entityId).serialize(iarchive);
             }
             else if constexpr (serialization::has_load<component_type, void(cereal::JSONInputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 iarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].load(iarchive);
+                get_component(entityId).load(iarchive);
             }
             else
             {
@@ -165,15 +338,15 @@ namespace legion::core::ecs
             std::string componentType = std::string(nameOfType<component_type>());
             if constexpr (serialization::has_serialize<component_type, void(cereal::BinaryInputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 iarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].serialize(iarchive);
+                get_component(entityId).serialize(iarchive);
             }
             else if constexpr (serialization::has_load<component_type, void(cereal::BinaryInputArchive&)>::value)
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 iarchive(cereal::make_nvp("Component Name", componentType));
-                m_components[entityId].load(iarchive);
+                get_component(entityId).load(iarchive);
             }
             else
             {
@@ -185,6 +358,8 @@ namespace legion::core::ecs
          */
         async::rw_spinlock& get_lock() const noexcept
         {
+            if (m_archetypes)
+                return m_archetypes->get_lock();
             return m_lock;
         }
 
@@ -194,15 +369,15 @@ namespace legion::core::ecs
             auto* container = new component_container<component_type>();
             container->resize(entities.size());
 
-            async::readonly_guard guard(m_lock);
+            async::readonly_guard guard(get_lock());
             for (int i = 0; i < entities.size(); i++)
             {
                 OPTICK_EVENT("Get component");
 #ifdef LGN_SAFE_MODE
-                if (m_components.contains(entities[i]))
-                    container->at(i) = m_components.at(entities[i]);
+                if (component_type* comp = find_component(entities[i]))
+                    container->at(i) = *comp;
 #else
-                container->at(i) = m_components.at(entities[i]);
+                container->at(i) = *find_component(entities[i]);
 #endif
             }
 
@@ -221,15 +396,15 @@ namespace legion::core::ecs
                 return;
 #endif
 
-            async::readonly_guard guard(m_lock);
+            async::readonly_guard guard(get_lock());
             for (int i = 0; i < entities.size(); i++)
             {
                 OPTICK_EVENT("Get component");
 #ifdef LGN_SAFE_MODE
-                if (m_components.contains(entities[i]))
-                    container[i] = m_components.at(entities[i]);
+                if (component_type* comp = find_component(entities[i]))
+                    container[i] = *comp;
 #else
-                container[i] = m_components.at(entities[i]);
+                container[i] = *find_component(entities[i]);
 #endif
             }
         }
@@ -244,24 +419,181 @@ namespace legion::core::ecs
                 return;
 #endif
 
+            // The old values are only needed when someone listens to the modification event.
+            bool raiseEvent = m_eventBus->hasSubscribers<events::bulk_component_modification<component_type>>();
+            tick_type tick = change_tick::current();
+
             component_container<component_type> modifications;
-            modifications.resize(entities.size());
+            if (raiseEvent)
+                modifications.resize(entities.size());
 
             {
-                async::readonly_guard guard(m_lock);
+                async::readonly_guard guard(get_lock());
                 for (int i = 0; i < entities.size(); i++)
                 {
-                    auto& ent = entities[i];
-                    if (m_components.contains(ent))
+                    if (component_type* ref = find_component(entities[i]))
                     {
-                        component_type& ref = m_components.at(ent);
-                        modifications[i] = ref;
-                        ref = container[i];
+                        if (raiseEvent)
+                            modifications[i] = *ref;
+                        *ref = container[i];
+                        find_ticks(entities[i])->changed = tick;
                     }
                 }
             }
+            record_changes(entities);
+
+            if (raiseEvent)
+                m_eventBus->raiseEvent<events::bulk_component_modification<component_type>>(entities, modifications, container);
+        }
+
+        /**@brief The default component that get_component_pointers points entities without the component to.
+         */
+        L_NODISCARD const component_type* null_component() const noexcept { return &m_nullComp; }
+
+        /**@brief Thread unsafe fetch of pointers to the components of multiple entities, use component_pool::get_lock and lock for at least read_only before calling this function.
+         * @note Entities without the component get a pointer to a default component.
+         * @note The pointers are only valid while component_pool::structural_generation doesn't change. For sparse families that is until
+         *       the next component of this family is created or destroyed, for chunked families until a component of ANY chunked family is
+         *       created or destroyed, since all chunked families share the same tables.
+         * @param entities Entities to get the components of.
+         * @param pointers Output list, will be resized to the amount of entities.
+         */
+        void get_component_pointers(const entity_container& entities, std::vector<component_type*>& pointers)
+        {
+            OPTICK_EVENT();
+            pointers.resize(entities.size());
+            for (size_type i = 0; i < entities.size(); i++)
+            {
+                component_type* comp = find_component(entities[i]);
+                pointers[i] = comp ? comp : &m_nullComp;
+            }
+        }
+
+        /**@brief Thread unsafe fetch of pointers to the components and their change ticks of multiple entities.
+         * @note Entities without the component get a pointer to a default component and nullptr as ticks.
+         *       The ticks are written by read_write views, sharing dummy ticks between views on different threads would be a data race.
+         * @ref legion::core::ecs::component_pool::get_component_pointers(const entity_container&, std::vector<component_type*>&)
+         */
+        void get_component_pointers(const entity_container& entities, std::vector<component_type*>& pointers, std::vector<component_ticks*>& ticks)
+        {
+            OPTICK_EVENT();
+            pointers.resize(entities.size());
+            ticks.resize(entities.size());
+            for (size_type i = 0; i < entities.size(); i++)
+            {
+                component_type* comp = find_component(entities[i]);
+                pointers[i] = comp ? comp : &m_nullComp;
+
+                ticks[i] = find_ticks(entities[i]);
+            }
+        }
+
+        /**@brief Counter that changes whenever pointers to components of this family may have been invalidated.
+         *        Store it together with pointers you keep around and compare it before using them again.
+         * @ref legion::core::ecs::ArchetypeStorage::generation
+         */
+        L_NODISCARD size_type structural_generation() const noexcept
+        {
+            return m_archetypes ? m_archetypes->generation() : m_generation;
+        }
+
+        /**@brief Thread unsafe fetch of the change ticks of a component, use component_pool::get_lock and lock for at least read_only before calling this function.
+         * @return component_ticks Ticks of the component, zeroed ticks if the entity doesn't have the component.
+         */
+        L_NODISCARD component_ticks get_ticks(id_type entityId) const
+        {
+            if (component_ticks* ticks = find_ticks(entityId))
+                return *ticks;
+            return component_ticks{};
+        }
+
+        /**@brief Thread unsafe scan over the change ticks of all components of this family, use component_pool::get_lock and lock for at least read_only before calling this function.
+         *        The ticks are read in place, chunked families get one call per archetype chunk, sparse families a single call for the entire family.
+         * @param func Function that takes (const id_type* entities, const component_ticks* ticks, size_type count, const archetype_table* table).
+         *        table is the archetype table the chunk belongs to, nullptr for sparse families.
+         */
+        template<typename Func>
+        void for_each_ticks(Func&& func) const
+        {
+            OPTICK_EVENT();
+            if (!m_archetypes)
+            {
+                if (m_ticks.size())
+                    func(m_ticks.keys().data(), m_ticks.values().data(), m_ticks.size(), static_cast<const archetype_table*>(nullptr));
+                return;
+            }
+
+            for (const archetype_table* table : m_archetypes->tables())
+            {
+                int column = table->column_index(typeHash<component_type>());
+                if (column < 0 || !table->size())
+                    continue;
+
+                for (size_type chunk = 0; chunk < table->chunk_count(); chunk++)
+                {
+                    size_type start = chunk * table->chunk_capacity();
+                    if (start >= table->size()) // The table keeps one spare chunk around, which can trail a partially filled one.
+                        break;
+
+                    size_type count = std::min(table->chunk_capacity(), table->size() - start);
+                    func(table->chunk(chunk).entities(), table->ticks(chunk, static_cast<size_type>(column)), count, table);
+                }
+            }
+        }
+
+        /**@brief Thread unsafe stamp of the component as changed this tick, use component_pool::get_lock and lock for at least read_only before calling this function.
+         */
+        void mark_changed(id_type entityId)
+        {
+            if (component_ticks* ticks = find_ticks(entityId))
+            {
+                ticks->changed = change_tick::current();
+                record_change(entityId);
+            }
+        }
+
+        /**@brief Start keeping a journal of the entities whose component gets added, written or removed.
+         *        Lets systems that only care about changed components find them without scanning the change ticks of the entire family.
+         * @ref legion::core::ecs::component_pool::take_change_journal
+         */
+        void enable_change_journal() noexcept
+        {
+            m_journalEnabled.store(true, std::memory_order_relaxed);
+        }
+
+        /**@brief Record a batch of entities as changed in the journal, if the journal is enabled.
+         * @note Only needed for writes that bypass the family, like writes through a read_write component_view.
+         */
+        void record_changes(const entity_container& entities)
+        {
+            if (!m_journalEnabled.load(std::memory_order_relaxed) || entities.empty())
+                return;
+
+            std::lock_guard guard(m_journalLock);
+            m_journal.insert(m_journal.end(), entities.begin(), entities.end());
+        }
+
+        /**@brief Record the entities of an archetype chunk as changed in the journal, if the journal is enabled.
+         * @ref legion::core::ecs::component_pool::record_changes(const entity_container&)
+         */
+        void record_changes(const id_type* entities, size_type count)
+        {
+            if (!m_journalEnabled.load(std::memory_order_relaxed) || !count)
+                return;
 
-            m_eventBus->raiseEvent<events::bulk_component_modification<component_type>>(entities, modifications, container);
+            std::lock_guard guard(m_journalLock);
+            m_journal.insert(m_journal.end(), entities, entities + count);
+        }
+
+        /**@brief Thread-safe swap of the journal with the given list, the journal restarts empty.
+         * @note Entities can appear more than once and might have been destroyed since they were recorded.
+         * @param entities [out] Entities whose component was added, written or removed since the previous call, the previous contents are discarded.
+         */
+        void take_change_journal(std::vector<id_type>& entities)
+        {
+            entities.clear();
+            std::lock_guard guard(m_journalLock);
+            std::swap(entities, m_journal);
         }
 
         /**@brief Thread-safe check for whether an entity has the component.
@@ -270,11 +602,12 @@ namespace legion::core::ecs
         L_NODISCARD bool has_component(id_type entityId) const override
         {
             OPTICK_EVENT();
-            async::readonly_guard guard(m_lock);
-            return m_components.contains(entityId);
+            async::readonly_guard guard(get_lock());
+            return find_component(entityId) != nullptr;
         }
 
         /**@brief Thread unsafe component fetch, use component_pool::get_lock and lock for at least read_only before calling this function.
+         * @note The reference is invalidated the same way as the pointers of component_pool::get_component_pointers.
          * @param entityId ID of entity you want to get the component from.
          * @ref component_pool::get_lock()
          * @ref legion::core::async::rw_spinlock
@@ -282,12 +615,13 @@ namespace legion::core::ecs
         L_NODISCARD component_type& get_component(id_type entityId)
         {
             OPTICK_EVENT();
-            if (m_components.contains(entityId))
-                return m_components.at(entityId);
+            if (component_type* comp = find_component(entityId))
+                return *comp;
             return m_nullComp;
         }
 
         /**@brief Thread unsafe component fetch, use component_pool::get_lock and lock for at least read_only before calling this function.
+         * @note The reference is invalidated the same way as the pointers of component_pool::get_component_pointers.
          * @param entityId ID of entity you want to get the component from.
          * @ref component_pool::get_lock()
          * @ref legion::core::async::rw_spinlock
@@ -295,8 +629,8 @@ namespace legion::core::ecs
         L_NODISCARD const component_type& get_component(id_type entityId) const
         {
             OPTICK_EVENT();
-            if (m_components.contains(entityId))
-                return m_components.at(entityId);
+            if (component_type* comp = find_component(entityId))
+                return *comp;
             return m_nullComp;
         }
 
@@ -308,9 +642,32 @@ namespace legion::core::ecs
         void create_component(id_type entityId) override
         {
             OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
+            if (m_archetypes)
+            {
+                // init might add other chunked components to this entity which would move our component, so init a local value first.
+                component_type value{};
+                if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
+                    component_type::init(value, entity_handle(entityId));
+                else if constexpr (detail::has_init<component_type, void(component_type&)>::value)
+                    component_type::init(value);
+
+                {
+                    async::readwrite_guard guard(get_lock());
+                    m_archetypes->insert_component(entityId, std::move(value));
+                }
+
+                record_change(entityId);
+                m_eventBus->raiseEvent<events::component_creation<component_type>>(entity_handle(entityId));
+                return;
+            }
+
             {
                 async::readwrite_guard guard(m_lock);
+                m_generation++;
                 m_components.emplace(entityId);
+                tick_type tick = change_tick::current();
+                m_ticks[entityId] = component_ticks{ tick, tick };
             }
 
             if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
@@ -324,6 +681,7 @@ namespace legion::core::ecs
                 component_type::init(m_components[entityId]);
             }
 
+            record_change(entityId);
             m_eventBus->raiseEvent<events::component_creation<component_type>>(entity_handle(entityId));
         }
 
@@ -336,9 +694,31 @@ namespace legion::core::ecs
         void create_component(id_type entityId, void* value) override
         {
             OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
+            if (m_archetypes)
+            {
+                component_type temp = *reinterpret_cast<component_type*>(value);
+                if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
+                    component_type::init(temp, entity_handle(entityId));
+                else if constexpr (detail::has_init<component_type, void(component_type&)>::value)
+                    component_type::init(temp);
+
+                {
+                    async::readwrite_guard guard(get_lock());
+                    m_archetypes->insert_component(entityId, std::move(temp));
+                }
+
+                record_change(entityId);
+                m_eventBus->raiseEvent<events::component_creation<component_type>>(entity_handle(entityId));
+                return;
+            }
+
             {
                 async::readwrite_guard guard(m_lock);
+                m_generation++;
                 m_components[entityId] = *reinterpret_cast<component_type*>(value);
+                tick_type tick = change_tick::current();
+                m_ticks[entityId] = component_ticks{ tick, tick };
             }
 
             if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
@@ -352,6 +732,7 @@ namespace legion::core::ecs
                 component_type::init(m_components[entityId]);
             }
 
+            record_change(entityId);
             m_eventBus->raiseEvent<events::component_creation<component_type>>(entity_handle(entityId));
         }
 
@@ -364,16 +745,143 @@ namespace legion::core::ecs
         void destroy_component(id_type entityId) override
         {
             OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
             m_eventBus->raiseEvent<events::component_destruction<component_type>>(entity_handle(entityId));
 
             if constexpr (detail::has_destroy<component_type, void(component_type&)>::value)
             {
-                async::readonly_guard rguard(m_lock);
-                component_type::destroy(m_components[entityId]);
+                async::readonly_guard rguard(get_lock());
+                if (component_type* comp = find_component(entityId))
+                    component_type::destroy(*comp);
+            }
+
+            {
+                async::readwrite_guard wguard(get_lock());
+                if (m_archetypes)
+                    m_archetypes->erase_component(entityId, typeHash<component_type>());
+                else
+                {
+                    m_generation++;
+                    m_components.erase(entityId);
+                    m_ticks.erase(entityId);
+                }
+            }
+
+            record_change(entityId);
+        }
+
+        /**@brief Creates the same component for a batch of entities in a thread-safe way, the family only gets locked once.
+         * @note Calls component_type::init if it exists.
+         * @note Raises a single events::bulk_component_creation<component_type> event.
+         *       events::component_creation<component_type> only gets raised per entity if anything is subscribed to it.
+         * @param entities Entities to add the component to.
+         * @param prototype Pointer to component_type to initialize all the components with, nullptr to default construct.
+         */
+        void create_components(const entity_container& entities, void* prototype) override
+        {
+            OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
+            const component_type initial = prototype ? *reinterpret_cast<component_type*>(prototype) : component_type{};
+
+            if (m_archetypes)
+            {
+                // init might add other chunked components to the entities which would move our components, so init local values first.
+                std::vector<component_type> values(entities.size(), initial);
+                if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
+                {
+                    for (size_type i = 0; i < entities.size(); i++)
+                        component_type::init(values[i], entities[i]);
+                }
+                else if constexpr (detail::has_init<component_type, void(component_type&)>::value)
+                {
+                    for (auto& value : values)
+                        component_type::init(value);
+                }
+
+                async::readwrite_guard guard(get_lock());
+                for (size_type i = 0; i < entities.size(); i++)
+                    m_archetypes->insert_component(entities[i], std::move(values[i]));
+            }
+            else
+            {
+                {
+                    async::readwrite_guard guard(m_lock);
+                    m_generation++;
+                    m_components.reserve(m_components.size() + entities.size());
+                    m_ticks.reserve(m_ticks.size() + entities.size());
+
+                    tick_type tick = change_tick::current();
+                    for (entity_handle entity : entities)
+                    {
+                        m_components[entity] = initial;
+                        m_ticks[entity] = component_ticks{ tick, tick };
+                    }
+                }
+
+                if constexpr (detail::has_init<component_type, void(component_type&, entity_handle)>::value)
+                {
+                    async::readonly_guard rguard(m_lock);
+                    for (entity_handle entity : entities)
+                        component_type::init(m_components[entity], entity);
+                }
+                else if constexpr (detail::has_init<component_type, void(component_type&)>::value)
+                {
+                    async::readonly_guard rguard(m_lock);
+                    for (entity_handle entity : entities)
+                        component_type::init(m_components[entity]);
+                }
             }
 
-            async::readwrite_guard wguard(m_lock);
-            m_components.erase(entityId);
+            record_changes(entities);
+            if (m_eventBus->hasSubscribers<events::component_creation<component_type>>())
+                for (entity_handle entity : entities)
+                    m_eventBus->raiseEvent<events::component_creation<component_type>>(entity);
+
+            m_eventBus->raiseEvent<events::bulk_component_creation<component_type>>(entities);
+        }
+
+        /**@brief Destroys the components of a batch of entities in a thread-safe way, the family only gets locked once.
+         * @note Calls component_type::destroy if it exists.
+         * @note Raises a single events::bulk_component_destruction<component_type> event.
+         *       events::component_destruction<component_type> only gets raised per entity if anything is subscribed to it.
+         * @param entities Entities to remove the component from.
+         */
+        void destroy_components(const entity_container& entities) override
+        {
+            OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
+            if (m_eventBus->hasSubscribers<events::component_destruction<component_type>>())
+                for (entity_handle entity : entities)
+                    m_eventBus->raiseEvent<events::component_destruction<component_type>>(entity);
+
+            m_eventBus->raiseEvent<events::bulk_component_destruction<component_type>>(entities);
+
+            if constexpr (detail::has_destroy<component_type, void(component_type&)>::value)
+            {
+                async::readonly_guard rguard(get_lock());
+                for (entity_handle entity : entities)
+                    if (component_type* comp = find_component(entity))
+                        component_type::destroy(*comp);
+            }
+
+            {
+                async::readwrite_guard wguard(get_lock());
+                if (!m_archetypes)
+                    m_generation++;
+
+                for (entity_handle entity : entities)
+                {
+                    if (m_archetypes)
+                        m_archetypes->erase_component(entity, typeHash<component_type>());
+                    else
+                    {
+                        m_components.erase(entity);
+                        m_ticks.erase(entity);
+                    }
+                }
+            }
+
+            record_changes(entities);
         }
 
         /**
@@ -382,15 +890,221 @@ namespace legion::core::ecs
         void clone_component(id_type dst, id_type src) override
         {
             OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
             static_assert(std::is_copy_constructible<component_type>::value,
                 "cannot copy component, therefore component cannot be cloned onto new entity!");
 
             {
-                async::readwrite_guard guard(m_lock);
-                m_components[dst] = m_components[src];
+                async::readwrite_guard guard(get_lock());
+                if (m_archetypes)
+                {
+                    component_type value = get_component(src); // Copy first, inserting can move the source component.
+                    m_archetypes->insert_component(dst, std::move(value));
+                }
+                else
+                {
+                    m_generation++;
+                    component_type value = m_components[src]; // Inserting dst can reallocate the source component.
+                    m_components[dst] = std::move(value);
+                    tick_type tick = change_tick::current();
+                    m_ticks[dst] = component_ticks{ tick, tick };
+                }
             }
 
+            record_change(dst);
             m_eventBus->raiseEvent<events::component_creation<component_type>>(entity_handle(dst));
         }
+
+        /**@brief Adds a batch of complete components to the family in a thread-safe way, the family only gets locked once.
+         * @note Does NOT call component_type::init.
+         * @note Raises a single events::bulk_component_creation<component_type> event.
+         *       events::component_creation<component_type> only gets raised per entity if anything is subscribed to it.
+         * @param entities Entities to add the components to.
+         * @param valueAt Callable that takes the index of an entity and returns its component, either by value or as reference to copy from.
+         */
+        template<typename ValueFunc>
+        void insert_components_with(const entity_container& entities, ValueFunc&& valueAt)
+        {
+            OPTICK_EVENT();
+            detail::assert_outside_parallel_for();
+            {
+                async::readwrite_guard guard(get_lock());
+                if (m_archetypes)
+                {
+                    for (size_type i = 0; i < entities.size(); i++)
+                    {
+                        component_type value = valueAt(i);
+                        m_archetypes->insert_component(entities[i], std::move(value));
+                    }
+                }
+                else
+                {
+                    m_generation++;
+                    m_components.reserve(m_components.size() + entities.size());
+                    m_ticks.reserve(m_ticks.size() + entities.size());
+
+                    tick_type tick = change_tick::current();
+                    for (size_type i = 0; i < entities.size(); i++)
+                    {
+                        m_components[entities[i]] = valueAt(i);
+                        m_ticks[entities[i]] = component_ticks{ tick, tick };
+                    }
+                }
+            }
+
+            record_changes(entities);
+            if (m_eventBus->hasSubscribers<events::component_creation<component_type>>())
+                for (entity_handle entity : entities)
+                    m_eventBus->raiseEvent<events::component_creation<component_type>>(entity);
+
+            m_eventBus->raiseEvent<events::bulk_component_creation<component_type>>(entities);
+        }
+
+        /**@brief Moves a batch of complete components into the family in a thread-safe way, the family only gets locked once.
+         * @param entities Entities to add the components to.
+         * @param values Component per entity, the components get moved out of the array.
+         * @ref legion::core::ecs::component_pool::insert_components_with
+         */
+        void insert_components(const entity_container& entities, component_type* values)
+        {
+            insert_components_with(entities, [&](size_type i) { return std::move(values[i]); });
+        }
+
+        /**@brief Moves a batch of complete components into the family in a thread-safe way, the family only gets locked once.
+         * @ref legion::core::ecs::component_pool::insert_components(const entity_container&, component_type*)
+         */
+        void insert_components(const entity_container& entities, std::vector<component_type>&& values)
+        {
+            insert_components(entities, values.data());
+        }
+
+        snapshot_encoding write_snapshot(const entity_container& entities, std::vector<byte>& blob) const override
+        {
+            OPTICK_EVENT();
+            constexpr snapshot_encoding encoding = snapshot_encoding_of_v<component_type>;
+
+            if constexpr (encoding == snapshot_encoding::raw)
+            {
+                size_type offset = blob.size();
+                blob.resize(offset + entities.size() * sizeof(component_type));
+
+                async::readonly_guard guard(get_lock());
+                for (size_type i = 0; i < entities.size(); i++)
+                    std::memcpy(blob.data() + offset + i * sizeof(component_type), &get_component(entities[i]), sizeof(component_type));
+            }
+            else if constexpr (encoding == snapshot_encoding::cereal)
+            {
+                // Copy first, save functions might access other families.
+                std::vector<component_type> values;
+                values.reserve(entities.size());
+                {
+                    async::readonly_guard guard(get_lock());
+                    for (entity_handle entity : entities)
+                        values.push_back(get_component(entity));
+                }
+
+                std::ostringstream stream(std::ios::binary);
+                {
+                    cereal::BinaryOutputArchive archive(stream);
+                    for (auto& value : values)
+                    {
+                        if constexpr (snapshot_encoding_of<component_type>::has_save_load)
+                            value.save(archive);
+                        else
+                            value.serialize(archive);
+                    }
+                }
+
+                std::string data = stream.str();
+                blob.insert(blob.end(), data.begin(), data.end());
+            }
+
+            return encoding;
+        }
+
+        uint64 snapshot_layout() const noexcept override
+        {
+            return snapshot_layout_of_v<component_type>;
+        }
+
+        std::unique_ptr<component_staging_base> decode_snapshot(size_type count, const byte* data, size_type size, snapshot_encoding encoding, uint64 layout) const override
+        {
+            OPTICK_EVENT();
+            if (layout != snapshot_layout_of_v<component_type>)
+                return nullptr;
+
+            auto staging = std::make_unique<component_staging>();
+            staging->values.resize(count);
+
+            if (encoding == snapshot_encoding::raw)
+            {
+                if constexpr (std::is_trivially_copyable_v<component_type>)
+                {
+                    if (size != count * sizeof(component_type))
+                        return nullptr;
+                    std::memcpy(staging->values.data(), data, size);
+                }
+                else
+                    return nullptr;
+            }
+            else if (encoding == snapshot_encoding::cereal)
+            {
+                if constexpr (snapshot_encoding_of<component_type>::has_save_load || snapshot_encoding_of<component_type>::has_serialize)
+                {
+                    serialization::memory_streambuf buffer(data, size);
+                    std::istream stream(&buffer);
+                    try
+                    {
+                        cereal::BinaryInputArchive archive(stream);
+                        for (auto& value : staging->values)
+                        {
+                            if constexpr (snapshot_encoding_of<component_type>::has_save_load)
+                                value.load(archive);
+                            else
+                                value.serialize(archive);
+                        }
+                    }
+                    catch (const cereal::Exception&) // Blob ended early.
+                    {
+                        return nullptr;
+                    }
+                }
+                else
+                    return nullptr;
+            }
+
+            return staging;
+        }
+
+        bool concurrent_snapshot_decode() const noexcept override
+        {
+            return snapshot_encoding_of<component_type>::concurrent_decode;
+        }
+
+        void insert_snapshot(const entity_container& entities, component_staging_base& staging, size_type offset) override
+        {
+            insert_components(entities, static_cast<component_staging&>(staging).values.data() + offset);
+        }
+
+        std::unique_ptr<component_staging_base> stage_components(const entity_container& entities) const override
+        {
+            OPTICK_EVENT();
+            static_assert(std::is_copy_constructible<component_type>::value,
+                "cannot copy component, therefore component cannot be stored in a prefab!");
+
+            auto staging = std::make_unique<component_staging>();
+            staging->values.reserve(entities.size());
+
+            async::readonly_guard guard(get_lock());
+            for (entity_handle entity : entities)
+                staging->values.push_back(get_component(entity));
+            return staging;
+        }
+
+        void instantiate_components(const entity_container& entities, const component_staging_base& staging) override
+        {
+            auto& values = static_cast<const component_staging&>(staging).values;
+            insert_components_with(entities, [&](size_type i) -> const component_type& { return values[i % values.size()]; });
+        }
     };
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/platform/platform.hpp>
+
+#include <array>
+#include <functional>
+
+/**
+ * @file component_signature.hpp
+ */
+
+namespace legion::core::ecs
+{
+    /**@class component_signature
+     * @brief Fixed size bitset describing a component composition. Every reported component type owns one bit.
+     * @ref legion::core::ecs::EcsRegistry::getSignatureIndex
+     */
+    class component_signature
+    {
+    public:
+        static constexpr size_type bits_per_word = sizeof(bitfield64) * 8;
+        static constexpr size_type word_count = (LEGION_MAX_COMPONENT_TYPES + bits_per_word - 1) / bits_per_word;
+
+    private:
+        std::array<bitfield64, word_count> m_words{};
+
+    public:
+        void set(size_type index) noexcept
+        {
+            m_words[index / bits_per_word] |= bitfield64(1) << (index % bits_per_word);
+        }
+
+        void reset(size_type index) noexcept
+        {
+            m_words[index / bits_per_word] &= ~(bitfield64(1) << (index % bits_per_word));
+        }
+
+        L_NODISCARD bool test(size_type index) const noexcept
+        {
+            return m_words[index / bits_per_word] & (bitfield64(1) << (index % bits_per_word));
+        }
+
+        /**@brief Checks if all bits set in other are also set in this signature.
+         */
+        L_NODISCARD bool contains(const component_signature& other) const noexcept
+        {
+            for (size_type i = 0; i < word_count; i++)
+                if ((m_words[i] & other.m_words[i]) != other.m_words[i])
+                    return false;
+            return true;
+        }
+
+        L_NODISCARD bool empty() const noexcept
+        {
+            for (bitfield64 word : m_words)
+                if (word)
+                    return false;
+            return true;
+        }
+
+        L_NODISCARD bool operator==(const component_signature& other) const noexcept { return m_words == other.m_words; }
+        L_NODISCARD bool operator!=(const component_signature& other) const noexcept { return m_words != other.m_words; }
+
+        L_NODISCARD size_type hash() const noexcept
+        {
+            size_type result = 0;
+            for (bitfield64 word : m_words)
+                result ^= std::hash<bitfield64>{}(word) + 0x9e3779b9 + (result << 6) + (result >> 2);
+            return result;
+        }
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<legion::core::ecs::component_signature>
+    {
+        std::size_t operator()(const legion::core::ecs::component_signature& signature) const noexcept
+        {
+            return signature.hash();
+        }
+    };
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/platform/platform.hpp>
+#include <core/async/rw_spinlock.hpp>
+#include <core/ecs/change_tick.hpp>
+
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <core/tracing/tracing.hpp>
+
+/**
+ * @file component_view.hpp
+ * @brief In place access to the components of all entities in a query, without copying the components.
+ */
+
+namespace legion::core::ecs
+{
+    class entity_handle;
+    using entity_container = std::vector<entity_handle>;
+
+    template<typename component_type>
+    class component_pool;
+
+    namespace detail
+    {
+        /**@brief Amount of EntityQuery::parallel_for and EntityQuery::for_each_chunk chunks the current thread is running.
+         */
+        inline thread_local size_type parallelForDepth = 0;
+
+        /**@brief Asserts that the current thread isn't running a chunk of EntityQuery::parallel_for.
+         *        The thread that called parallel_for keeps the viewed families read locked until all chunks are done,
+         *        a chunk that needs write permission on one of those families would wait on that thread while it waits on the chunk.
+         */
+        inline void assert_outside_parallel_for() noexcept
+        {
+            assert(parallelForDepth == 0 && "Structural changes and component handle writes aren't allowed inside EntityQuery::parallel_for or for_each_chunk.");
+        }
+    }
+
+    /**@brief Access mode of a component view.
+     * @ref legion::core::ecs::component_view
+     */
+    enum struct access_mode { read_only, read_write };
+
+    /**@brief Access mode required for a possibly const qualified component type.
+     */
+    template<typename component_type>
+    constexpr access_mode access_mode_for = std::is_const_v<component_type> ? access_mode::read_only : access_mode::read_write;
+
+    /**@class component_view
+     * @brief View of the components of a family for all entities of a query.
+     *        Unlike EntityQuery::get the components are not copied, the view references the components in the pool.
+     *        The view is not a contiguous span of the storage. Creating it looks up every entity once and stores a pointer per entity,
+     *        after that access is a single indirection. Contiguous access to the components of chunked families goes through EntityQuery::for_each_chunk.
+     *        Index i of the view belongs to the entity at index i of the query.
+     * @note The view keeps the family read locked for its entire lifetime. Adding or removing components of the same family
+     *       on other threads will block until the view is destroyed, so keep views short lived.
+     * @note The view is invalidated by structural changes the lock doesn't block, like the viewing thread itself adding or removing components.
+     *       For chunked families that includes components of any other chunked family. Debug builds assert on access to an invalidated view.
+     * @note Writes through a read_write view are not broadcast as modification events.
+     *       Instead every component accessed through a read_write view gets stamped as changed at the tick the view was created with.
+     *       Views created by EntityQuery::view use the tick of the query's current run, so the query doesn't report its own writes as changes.
+     *       Families with a change journal record every viewed entity as changed when a read_write view is created, accessed or not.
+     * @tparam component_type Type of component to view.
+     * @tparam mode Whether the components can be modified through the view or not.
+     */
+    template<typename component_type, access_mode mode = access_mode::read_only>
+    class component_view
+    {
+    public:
+        using value_type = std::conditional_t<mode == access_mode::read_only, const component_type, component_type>;
+        using reference = value_type&;
+        using pointer = value_type*;
+
+        /**@class iterator
+         * @brief Random access iterator that yields references to the viewed components.
+         */
+        class iterator
+        {
+        private:
+            typename std::vector<component_type*>::const_iterator m_itr;
+            typename std::vector<component_ticks*>::const_iterator m_ticksItr;
+            tick_type m_tick = 0;
+
+            void stamp(std::ptrdiff_t offset = 0) const noexcept
+            {
+                if constexpr (mode == access_mode::read_write)
+                    if (component_ticks* ticks = m_ticksItr[offset])
+                        ticks->changed = m_tick;
+            }
+
+            void advance_ticks(std::ptrdiff_t n) noexcept
+            {
+                if constexpr (mode == access_mode::read_write)
+                    m_ticksItr += n;
+            }
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = component_view::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = component_view::pointer;
+            using reference = component_view::reference;
+
+            iterator() = default;
+            iterator(typename std::vector<component_type*>::const_iterator itr, typename std::vector<component_ticks*>::const_iterator ticksItr, tick_type tick) noexcept
+                : m_itr(itr), m_ticksItr(ticksItr), m_tick(tick) {}
+
+            L_NODISCARD reference operator*() const noexcept { stamp(); return **m_itr; }
+            L_NODISCARD pointer operator->() const noexcept { stamp(); return *m_itr; }
+            L_NODISCARD reference operator[](difference_type n) const noexcept { stamp(n); return *m_itr[n]; }
+
+            iterator& operator++() noexcept { ++m_itr; advance_ticks(1); return *this; }
+            iterator operator++(int) noexcept { iterator tmp = *this; ++*this; return tmp; }
+            iterator& operator--() noexcept { --m_itr; advance_ticks(-1); return *this; }
+            iterator operator--(int) noexcept { iterator tmp = *this; --*this; return tmp; }
+
+            iterator& operator+=(difference_type n) noexcept { m_itr += n; advance_ticks(n); return *this; }
+            iterator& operator-=(difference_type n) noexcept { m_itr -= n; advance_ticks(-n); return *this; }
+            L_NODISCARD iterator operator+(difference_type n) const noexcept { iterator tmp = *this; return tmp += n; }
+            L_NODISCARD iterator operator-(difference_type n) const noexcept { iterator tmp = *this; return tmp -= n; }
+            L_NODISCARD difference_type operator-(const iterator& other) const noexcept { return m_itr - other.m_itr; }
+
+            L_NODISCARD bool operator==(const iterator& other) const noexcept { return m_itr == other.m_itr; }
+            L_NODISCARD bool operator!=(const iterator& other) const noexcept { return m_itr != other.m_itr; }
+            L_NODISCARD bool operator<(const iterator& other) const noexcept { return m_itr < other.m_itr; }
+        };
+
+    private:
+        async::rw_spinlock* m_lock = nullptr;
+        std::vector<component_type*> m_components;
+        std::vector<component_ticks*> m_ticks; // Only used by read_write views, nullptr for entities without the component.
+        const component_type* m_nullComp = nullptr; // What entities without the component point to.
+        tick_type m_tick = 0;
+#if defined(LEGION_DEBUG)
+        const component_pool<component_type>* m_pool = nullptr;
+        size_type m_structuralGeneration = 0;
+#endif
+
+        void validate() const noexcept
+        {
+#if defined(LEGION_DEBUG)
+            assert((!m_pool || m_pool->structural_generation() == m_structuralGeneration) && "component_view used after a structural change invalidated it.");
+#endif
+        }
+
+    public:
+        /**@brief Creates a view and read locks the family.
+         * @param pool Component family to view.
+         * @param entities Entities to view the components of.
+         * @param tick Tick that components accessed through a read_write view get stamped with.
+         */
+        component_view(component_pool<component_type>* pool, const entity_container& entities, tick_type tick = change_tick::current()) : m_lock(&pool->get_lock()), m_nullComp(pool->null_component())
+        {
+            OPTICK_EVENT();
+            m_lock->lock(async::lock_state_read);
+#if defined(LEGION_DEBUG)
+            m_pool = pool;
+            m_structuralGeneration = pool->structural_generation();
+#endif
+            if constexpr (mode == access_mode::read_write)
+            {
+                m_tick = tick;
+                pool->get_component_pointers(entities, m_components, m_ticks);
+                pool->record_changes(entities); // The view can't tell which components get written, so every viewed entity is journaled.
+            }
+            else
+                pool->get_component_pointers(entities, m_components);
+        }
+
+        component_view() = default;
+
+        component_view(const component_view&) = delete;
+        component_view& operator=(const component_view&) = delete;
+
+        component_view(component_view&& other) noexcept : m_lock(other.m_lock), m_components(std::move(other.m_components)), m_ticks(std::move(other.m_ticks)), m_nullComp(other.m_nullComp), m_tick(other.m_tick)
+        {
+#if defined(LEGION_DEBUG)
+            m_pool = other.m_pool;
+            m_structuralGeneration = other.m_structuralGeneration;
+#endif
+            other.m_lock = nullptr;
+        }
+
+        component_view& operator=(component_view&& other) noexcept
+        {
+            if (this == &other)
+                return *this;
+
+            if (m_lock)
+                m_lock->unlock(async::lock_state_read);
+
+            m_lock = other.m_lock;
+            m_components = std::move(other.m_components);
+            m_ticks = std::move(other.m_ticks);
+            m_nullComp = other.m_nullComp;
+            m_tick = other.m_tick;
+#if defined(LEGION_DEBUG)
+            m_pool = other.m_pool;
+            m_structuralGeneration = other.m_structuralGeneration;
+#endif
+            other.m_lock = nullptr;
+            return *this;
+        }
+
+        ~component_view()
+        {
+            if (m_lock)
+                m_lock->unlock(async::lock_state_read);
+        }
+
+        L_NODISCARD reference operator[](size_type index) const noexcept
+        {
+            validate();
+            if constexpr (mode == access_mode::read_write)
+                if (component_ticks* ticks = m_ticks[index])
+                    ticks->changed = m_tick;
+            return *m_components[index];
+        }
+
+        L_NODISCARD reference at(size_type index) const
+        {
+            validate();
+            if constexpr (mode == access_mode::read_write)
+                if (component_ticks* ticks = m_ticks.at(index))
+                    ticks->changed = m_tick;
+            return *m_components.at(index);
+        }
+
+        /**@brief Whether the entity at index has a component of this family, entities without one view a default component.
+         *        Unlike entity_handle::has_component this doesn't lock anything.
+         */
+        L_NODISCARD bool contains(size_type index) const noexcept { return m_components[index] != m_nullComp; }
+
+        L_NODISCARD size_type size() const noexcept { return m_components.size(); }
+        L_NODISCARD bool empty() const noexcept { return m_components.empty(); }
+
+        L_NODISCARD iterator begin() const noexcept { validate(); return iterator(m_components.cbegin(), m_ticks.cbegin(), m_tick); }
+        L_NODISCARD iterator end() const noexcept { return iterator(m_components.cend(), m_ticks.cend(), m_tick); }
+    };
+
+    template<typename component_type>
+    using read_view = component_view<component_type, access_mode::read_only>;
+
+    template<typename component_type>
+    using write_view = component_view<component_type, access_mode::read_write>;
+}
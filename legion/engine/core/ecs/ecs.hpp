@@ -6,8 +6,14 @@
  */
 
 #include <core/ecs/component_pool.hpp>
+#include <core/ecs/archetype_storage.hpp>
+#include <core/ecs/component_view.hpp>
+#include <core/ecs/change_tick.hpp>
+#include <core/ecs/entity_index.hpp>
 #include <core/ecs/entity_handle.hpp>
 #include <core/ecs/component_handle.hpp>
+#include <core/ecs/command_buffer.hpp>
+#include <core/ecs/prefab.hpp>
 #include <core/ecs/entityquery.hpp>
 #include <core/ecs/queryregistry.hpp>
 #include <core/ecs/ecsregistry.hpp>
@@ -5,10 +5,12 @@
 #include <core/defaults/defaultcomponents.hpp>
 #include <core/events/eventbus.hpp>
 
+#include <iterator>
+#include <map>
+#include <unordered_set>
+
 namespace legion::core::ecs
 {
-    // 2 because the world entity is 1 and 0 is invalid_id
-    id_type EcsRegistry::m_nextEntityId = 2;
     entity_handle EcsRegistry::world = entity_handle(world_entity_id);
 
     void EcsRegistry::recursiveDestroyEntityInternal(id_type entityId)
@@ -26,12 +28,16 @@ namespace legion::core::ecs
             m_entities.erase(entity_handle(entityId)); // Erase the entity from the entity list first, invalidating the entity and stopping any other function from being called on this entity.
         }
 
+        // Fetch the children before the hierarchy component gets destroyed along with the rest.
+        entity_set children;
+        if (hasComponent<hierarchy>(entityId))
+            children = entity_handle(entityId).children();
+
         entity_data data = {};
 
         {
             async::readwrite_guard guard(m_entityDataLock); // Request read-write permission for the entity data list.
-            data = std::move(m_entityData[entityId]); // Fetch data of entity to destroy.
-            m_entityData.erase(entityId); // We can also safely erase the data since the entity has already been invalidated.
+            data = m_entityIndex.erase(entityId); // Fetch data of entity to destroy and recycle its index. We can safely do this since the entity has already been invalidated.
         }
 
         {
@@ -42,25 +48,62 @@ namespace legion::core::ecs
             }
         }
 
-        if (hasComponent<hierarchy>(entityId))
-        {
-            auto children = entity_handle(entityId).children();
-            for (entity_handle& child : children.reverse_range())	// Destroy all children.
-                recursiveDestroyEntityInternal(child);
-        }
+        for (entity_handle& child : children.reverse_range())	// Destroy all children.
+            recursiveDestroyEntityInternal(child);
     }
 
-    EcsRegistry::EcsRegistry(events::EventBus* eventBus) : m_families(), m_entityData(), m_entities(), m_queryRegistry(*this), m_eventBus(eventBus)
+    EcsRegistry::EcsRegistry(events::EventBus* eventBus) : m_families(), m_entityIndex(world_entity_id + 1), m_entities(), m_archetypes(), m_queryRegistry(*this), m_commandBuffer(*this), m_eventBus(eventBus)
     {
         entity_handle::m_registry = this;
         entity_handle::m_eventBus = eventBus;
         // Create world entity.
-        m_entityData.emplace(world_entity_id, entity_data());
+        if (m_entityIndex.claim(world_entity_id))
+            m_entityIndex.insert(world_entity_id);
         m_entities.emplace(world_entity_id);
         reportComponentType<hierarchy>();
         world.add_component<hierarchy>();
     }
 
+    size_type EcsRegistry::assignSignatureIndex(id_type componentTypeId)
+    {
+        if (auto itr = m_signatureIndices.find(componentTypeId); itr != m_signatureIndices.end())
+            return itr->second;
+
+        size_type index = m_signatureIndices.size();
+        if (index >= LEGION_MAX_COMPONENT_TYPES)
+            throw legion_exception_msg("Too many component types, increase LEGION_MAX_COMPONENT_TYPES.");
+
+        m_signatureIndices.emplace(componentTypeId, index);
+        return index;
+    }
+
+    bool EcsRegistry::isComponentTypeReported(id_type componentTypeId) const
+    {
+        async::readonly_guard guard(m_familyLock);
+        return m_families.count(componentTypeId);
+    }
+
+    size_type EcsRegistry::getSignatureIndex(id_type componentTypeId)
+    {
+        {
+            async::readonly_guard guard(m_familyLock);
+            if (auto itr = m_signatureIndices.find(componentTypeId); itr != m_signatureIndices.end())
+                return itr->second;
+        }
+
+        async::readwrite_guard guard(m_familyLock);
+        return assignSignatureIndex(componentTypeId);
+    }
+
+    component_signature EcsRegistry::getSignature(const hashed_sparse_set<id_type>& componentTypes)
+    {
+        OPTICK_EVENT();
+        component_signature signature;
+        for (id_type componentTypeId : componentTypes)
+            signature.set(getSignatureIndex(componentTypeId));
+        return signature;
+    }
+
     component_pool_base* EcsRegistry::getFamily(id_type componentTypeId)
     {
         OPTICK_EVENT();
@@ -80,7 +123,8 @@ namespace legion::core::ecs
     {
         OPTICK_EVENT();
         async::readonly_guard guard(m_entityDataLock);
-        return m_entityData[entityId].components.contains(componentTypeId);
+        const entity_data* data = m_entityIndex.find(entityId);
+        return data && data->components.contains(componentTypeId);
     }
 
     component_handle_base EcsRegistry::getComponent(id_type entityId, id_type componentTypeId)
@@ -98,10 +142,15 @@ namespace legion::core::ecs
 #endif
 
         getFamily(componentTypeId)->create_component(entityId);
+        size_type signatureIndex = getSignatureIndex(componentTypeId);
 
         {
             async::readonly_guard guard(m_entityDataLock);
-            m_entityData[entityId].components.insert(componentTypeId); // Is fine because the lock only locks order changes in the container, not the values themselves.
+            if (entity_data* data = m_entityIndex.find(entityId)) // Is fine because the lock only locks order changes in the container, not the values themselves.
+            {
+                data->components.insert(componentTypeId);
+                data->signature.set(signatureIndex);
+            }
         }
 
         m_queryRegistry.evaluateEntityChange(entityId, componentTypeId, false);
@@ -120,10 +169,15 @@ namespace legion::core::ecs
 #endif
 
         getFamily(componentTypeId)->clone_component(destinationEntity, sourceEntity);
+        size_type signatureIndex = getSignatureIndex(componentTypeId);
 
         {
             async::readonly_guard guard(m_entityDataLock);
-            m_entityData[destinationEntity].components.insert(componentTypeId); // Is fine because the lock only locks order changes in the container, not the values themselves.
+            if (entity_data* data = m_entityIndex.find(destinationEntity)) // Is fine because the lock only locks order changes in the container, not the values themselves.
+            {
+                data->components.insert(componentTypeId);
+                data->signature.set(signatureIndex);
+            }
         }
 
         m_queryRegistry.evaluateEntityChange(destinationEntity, componentTypeId, false);
@@ -140,10 +194,15 @@ namespace legion::core::ecs
 #endif
 
         getFamily(componentTypeId)->create_component(entityId, value);
+        size_type signatureIndex = getSignatureIndex(componentTypeId);
 
         {
             async::readonly_guard guard(m_entityDataLock);
-            m_entityData[entityId].components.insert(componentTypeId); // Is fine because the lock only locks order changes in the container, not the values themselves.
+            if (entity_data* data = m_entityIndex.find(entityId)) // Is fine because the lock only locks order changes in the container, not the values themselves.
+            {
+                data->components.insert(componentTypeId);
+                data->signature.set(signatureIndex);
+            }
         }
 
         m_queryRegistry.evaluateEntityChange(entityId, componentTypeId, false);
@@ -161,10 +220,15 @@ namespace legion::core::ecs
 
         m_queryRegistry.evaluateEntityChange(entityId, componentTypeId, true);
         getFamily(componentTypeId)->destroy_component(entityId);
+        size_type signatureIndex = getSignatureIndex(componentTypeId);
 
         {
             async::readonly_guard guard(m_entityDataLock);
-            m_entityData[entityId].components.erase(componentTypeId); // Is fine because the lock only locks order changes in the container, not the values themselves.
+            if (entity_data* data = m_entityIndex.find(entityId)) // Is fine because the lock only locks order changes in the container, not the values themselves.
+            {
+                data->components.erase(componentTypeId);
+                data->signature.reset(signatureIndex);
+            }
         }
     }
 
@@ -173,30 +237,23 @@ namespace legion::core::ecs
         OPTICK_EVENT();
         if (!entityId)
             return false;
-        async::readonly_guard guard(m_entityLock);
-        return m_entities.contains(entityId);
+        async::readonly_guard guard(m_entityDataLock);
+        return m_entityIndex.contains(entityId); // Also rejects handles to destroyed entities whose index was recycled, their generation is outdated.
     }
 
     entity_handle EcsRegistry::createEntity(bool worldChild, id_type entityId)
     {
         OPTICK_EVENT();
         id_type id;
-        if (!entityId)
-            id = m_nextEntityId++;
-        else
-        {
-            id = entityId;
-            m_nextEntityId = entityId + 1;
-        }
-
-        if (validateEntity(id))
-            return createEntity(worldChild);
-
-        entity_data data{};
 
         {
             async::readwrite_guard guard(m_entityDataLock);  // We need write permission now because we hope to insert a new item.
-            m_entityData.emplace(id, std::move(data));
+            if (entityId && m_entityIndex.claim(entityId))
+                id = entityId;
+            else
+                id = m_entityIndex.reserve(); // Either no id was requested or the requested id is already in use.
+
+            m_entityIndex.insert(id);
         }
 
         if (worldChild)
@@ -219,6 +276,18 @@ namespace legion::core::ecs
         return createEntity(worldChild,entityId);
     }
 
+    id_type EcsRegistry::reserveEntityId()
+    {
+        async::readwrite_guard guard(m_entityDataLock);
+        return m_entityIndex.reserve();
+    }
+
+    void EcsRegistry::releaseEntityId(id_type entityId)
+    {
+        async::readwrite_guard guard(m_entityDataLock);
+        m_entityIndex.release(entityId);
+    }
+
 
 
     void EcsRegistry::destroyEntity(id_type entityId, bool recurse)
@@ -230,7 +299,19 @@ namespace legion::core::ecs
 #endif
 
         m_queryRegistry.markEntityDestruction(entityId); // Remove entity from any queries.
+        entity_data data = detachEntityInternal(entityId, recurse);
+
+        {
+            async::readonly_guard guard(m_familyLock); // Technically possibly deadlocks. However the only write op on families happen when creating the family. Will also lock atomic_sparse_map::m_container_lock for the family.
+            for (id_type componentTypeId : data.components) // Destroy all components attached to this entity.
+            {
+                m_families[componentTypeId]->destroy_component(entityId);
+            }
+        }
+    }
 
+    entity_data EcsRegistry::detachEntityInternal(id_type entityId, bool recurse)
+    {
         entity_handle entity(entityId);
 
         {
@@ -250,17 +331,335 @@ namespace legion::core::ecs
 
         {
             async::readwrite_guard guard(m_entityDataLock); // Request read-write permission for the entity data list.
-            data = std::move(m_entityData[entityId]); // Fetch data of entity to destroy.
-            m_entityData.erase(entityId); // We can also safely erase the data since the entity has already been invalidated.
+            data = m_entityIndex.erase(entityId); // Fetch data of entity to destroy and recycle its index. We can safely do this since the entity has already been invalidated.
         }
 
+        return data;
+    }
+
+    entity_container EcsRegistry::createEntities(size_type count, bool worldChild)
+    {
+        OPTICK_EVENT();
+        entity_container entities;
+        entities.reserve(count);
+
         {
-            async::readonly_guard guard(m_familyLock); // Technically possibly deadlocks. However the only write op on families happen when creating the family. Will also lock atomic_sparse_map::m_container_lock for the family.
-            for (id_type componentTypeId : data.components) // Destroy all components attached to this entity.
+            async::readwrite_guard guard(m_entityDataLock); // Reserve all ids at once.
+            m_entityIndex.reserve(count, std::back_inserter(entities));
+        }
+
+        insertEntityBatch(entities, worldChild);
+        return entities;
+    }
+
+    void EcsRegistry::destroyEntities(const entity_container& entities, bool recurse)
+    {
+        OPTICK_EVENT();
+        entity_container destroyed;
+        destroyed.reserve(entities.size());
+        std::unordered_set<id_type> visited;
+
+        for (entity_handle entity : entities)
+            if (validateEntity(entity) && visited.insert(entity.get_id()).second)
+                destroyed.push_back(entity);
+
+        const size_type rootCount = destroyed.size();
+
+        if (recurse) // Gather all descendants up front so the entire tree goes through the batched paths below.
+        {
+            OPTICK_EVENT("Gather descendants");
+            for (size_type i = 0; i < destroyed.size(); i++)
             {
-                m_families[componentTypeId]->destroy_component(entityId);
+                entity_handle entity = destroyed[i];
+                if (!hasComponent<hierarchy>(entity))
+                    continue;
+
+                for (entity_handle child : entity.children())
+                    if (visited.insert(child.get_id()).second)
+                        destroyed.push_back(child);
+            }
+        }
+
+        m_queryRegistry.markEntitiesDestruction(destroyed); // Remove all entities from the queries at once.
+
+        {
+            async::readwrite_guard guard(m_entityLock);
+            for (size_type i = 0; i < rootCount; i++) // The parents of all descendants get destroyed as well, only the roots need to be detached.
+                destroyed[i].set_parent(invalid_id, false);
+            for (entity_handle entity : destroyed)
+                m_entities.erase(entity);
+        }
+
+        if (!recurse)
+            for (size_type i = 0; i < rootCount; i++)
+            {
+                if (!hasComponent<hierarchy>(destroyed[i]))
+                    continue;
+
+                auto children = destroyed[i].children();
+                for (entity_handle& child : children.reverse_range())
+                    child.set_parent(invalid_id, false);
+            }
+
+        std::unordered_map<id_type, entity_container> componentBatches;
+        {
+            async::readwrite_guard guard(m_entityDataLock);
+            for (entity_handle entity : destroyed)
+            {
+                entity_data data = m_entityIndex.erase(entity);
+                for (id_type componentTypeId : data.components)
+                    componentBatches[componentTypeId].push_back(entity);
+            }
+        }
+
+        async::readonly_guard guard(m_familyLock);
+        for (auto& [componentTypeId, batch] : componentBatches) // Destroy the components per family.
+            m_families[componentTypeId]->destroy_components(batch);
+    }
+
+    void EcsRegistry::insertEntityBatch(const entity_container& entities, bool worldChild)
+    {
+        OPTICK_EVENT();
+        {
+            async::readwrite_guard guard(m_entityDataLock);
+            for (entity_handle entity : entities)
+                m_entityIndex.insert(entity);
+        }
+
+        if (worldChild)
+        {
+            component_pool<hierarchy>* family = getFamily<hierarchy>();
+            async::readonly_guard rguard(family->get_lock());
+            auto& children = family->get_component(world_entity_id).children;
+            for (entity_handle entity : entities)
+                children.insert(entity);
+        }
+
+        async::readwrite_guard guard(m_entityLock);
+        for (entity_handle entity : entities)
+            m_entities.emplace(entity);
+    }
+
+    void EcsRegistry::insertComponentBatch(id_type componentTypeId, const entity_container& entities, void* prototype)
+    {
+        OPTICK_EVENT();
+        entity_container created;
+        created.reserve(entities.size());
+
+        for (entity_handle entity : entities)
+            if (validateEntity(entity))
+                created.push_back(entity);
+
+        getFamily(componentTypeId)->create_components(created, prototype);
+        setSignatureBits(created, componentTypeId, true);
+        m_queryRegistry.evaluateEntityChanges(created, componentTypeId, false);
+    }
+
+    void EcsRegistry::insertComponentBatch(id_type componentTypeId, const entity_container& entities, const std::vector<void*>& values)
+    {
+        OPTICK_EVENT();
+        component_pool_base* family = getFamily(componentTypeId);
+
+        entity_container created;
+        created.reserve(entities.size());
+
+        for (size_type i = 0; i < entities.size(); i++)
+        {
+            entity_handle entity = entities[i];
+            if (!validateEntity(entity)) // The entity might have been destroyed before the playback.
+                continue;
+
+            if (values[i])
+                family->create_component(entity, values[i]);
+            else
+                family->create_component(entity);
+            created.push_back(entity);
+        }
+
+        setSignatureBits(created, componentTypeId, true);
+        m_queryRegistry.evaluateEntityChanges(created, componentTypeId, false);
+    }
+
+    void EcsRegistry::insertComponentSnapshot(id_type componentTypeId, const entity_container& entities, component_staging_base& staging, size_type offset)
+    {
+        OPTICK_EVENT();
+        getFamily(componentTypeId)->insert_snapshot(entities, staging, offset);
+        setSignatureBits(entities, componentTypeId, true);
+        m_queryRegistry.evaluateEntityChanges(entities, componentTypeId, false);
+    }
+
+    Prefab EcsRegistry::createPrefab(entity_handle root)
+    {
+        OPTICK_EVENT();
+        Prefab prefab;
+        entity_container nodes;
+
+        // Depth first so that parents always come before their children.
+        std::vector<std::pair<entity_handle, uint32>> stack{ { root, Prefab::no_parent } };
+        while (!stack.empty())
+        {
+            auto [entity, parent] = stack.back();
+            stack.pop_back();
+
+            uint32 index = static_cast<uint32>(nodes.size());
+            nodes.push_back(entity);
+            prefab.m_parents.push_back(parent);
+            prefab.m_children.emplace_back();
+            if (parent != Prefab::no_parent)
+                prefab.m_children[parent].push_back(index);
+
+            std::string name;
+            if (hasComponent<hierarchy>(entity))
+            {
+                hierarchy hry = entity.read_component<hierarchy>();
+                name = hry.name;
+                for (auto& child : hry.children.reverse_range()) // Reversed so the children keep their order.
+                    stack.emplace_back(child, index);
+            }
+            prefab.m_names.push_back(std::move(name));
+        }
+
+        // The hierarchy is rebuilt from the node tables instead.
+        std::map<id_type, std::vector<uint32>> familyNodes;
+        for (uint32 i = 0; i < nodes.size(); i++)
+            for (id_type componentTypeId : getEntityData(nodes[i]).components)
+                if (componentTypeId != typeHash<hierarchy>())
+                    familyNodes[componentTypeId].push_back(i);
+
+        entity_container familyEntities;
+        prefab.m_families.reserve(familyNodes.size());
+        for (auto& [componentTypeId, indices] : familyNodes)
+        {
+            familyEntities.clear();
+            for (uint32 index : indices)
+                familyEntities.push_back(nodes[index]);
+
+            prefab.m_families.push_back(Prefab::prefab_family{ componentTypeId, std::move(indices), getFamily(componentTypeId)->stage_components(familyEntities) });
+        }
+
+        return prefab;
+    }
+
+    entity_container EcsRegistry::instantiate(const Prefab& prefab, size_type count, entity_handle parent)
+    {
+        OPTICK_EVENT();
+        size_type size = prefab.size();
+        if (!count || !size)
+            return entity_container();
+
+        // Copy i of node j is entity i * size + j.
+        entity_container entities = createEntities(count * size, false);
+        entity_container roots;
+        roots.reserve(count);
+
+        {
+            OPTICK_EVENT("Link hierarchy");
+            std::vector<hierarchy> hierarchies(entities.size());
+            for (size_type instance = 0; instance < count; instance++)
+            {
+                size_type offset = instance * size;
+                roots.push_back(entities[offset]);
+
+                for (size_type node = 0; node < size; node++)
+                {
+                    hierarchy& hry = hierarchies[offset + node];
+                    hry.name = prefab.m_names[node];
+
+                    uint32 parentNode = prefab.m_parents[node];
+                    hry.parent = parentNode == Prefab::no_parent ? parent : entities[offset + parentNode];
+
+                    for (uint32 child : prefab.m_children[node])
+                        hry.children.insert(entities[offset + child]);
+                }
+            }
+
+            insertComponents(entities, std::move(hierarchies));
+
+            if (parent && hasComponent<hierarchy>(parent))
+            {
+                // Insert in place like insertEntityBatch, copying the children of the parent (usually the world) would cost more than the whole batch.
+                component_pool<hierarchy>* family = getFamily<hierarchy>();
+                async::readonly_guard rguard(family->get_lock());
+                auto& children = family->get_component(parent).children;
+                for (auto& root : roots)
+                    children.insert(root);
+            }
+            else if (parent)
+            {
+                hierarchy parentHry;
+                for (auto& root : roots)
+                    parentHry.children.insert(root);
+                parent.add_component(parentHry);
+            }
+        }
+
+        {
+            OPTICK_EVENT("Copy families");
+            entity_container familyEntities;
+            for (auto& family : prefab.m_families)
+            {
+                familyEntities.clear();
+                familyEntities.reserve(count * family.nodes.size());
+                for (size_type instance = 0; instance < count; instance++)
+                    for (uint32 node : family.nodes)
+                        familyEntities.push_back(entities[instance * size + node]);
+
+                getFamily(family.typeId)->instantiate_components(familyEntities, *family.components);
+                setSignatureBits(familyEntities, family.typeId, true);
+                m_queryRegistry.evaluateEntityChanges(familyEntities, family.typeId, false);
+            }
+        }
+
+        if (m_eventBus->hasSubscribers<events::parent_change>())
+            for (auto& root : roots)
+                m_eventBus->raiseEvent<events::parent_change>(root, invalid_id, parent);
+
+        return roots;
+    }
+
+    void EcsRegistry::eraseComponentBatch(id_type componentTypeId, const entity_container& entities)
+    {
+        OPTICK_EVENT();
+        entity_container erased;
+        erased.reserve(entities.size());
+
+        for (entity_handle entity : entities)
+            if (validateEntity(entity) && hasComponent(entity, componentTypeId))
+                erased.push_back(entity);
+
+        m_queryRegistry.evaluateEntityChanges(erased, componentTypeId, true);
+        getFamily(componentTypeId)->destroy_components(erased);
+        setSignatureBits(erased, componentTypeId, false);
+    }
+
+    void EcsRegistry::setSignatureBits(const entity_container& entities, id_type componentTypeId, bool value)
+    {
+        size_type signatureIndex = getSignatureIndex(componentTypeId);
+
+        async::readonly_guard guard(m_entityDataLock);
+        for (entity_handle entity : entities)
+        {
+            entity_data* data = m_entityIndex.find(entity); // Is fine because the lock only locks order changes in the container, not the values themselves.
+            if (!data)
+                continue;
+
+            if (value)
+            {
+                data->components.insert(componentTypeId);
+                data->signature.set(signatureIndex);
+            }
+            else
+            {
+                data->components.erase(componentTypeId);
+                data->signature.reset(signatureIndex);
             }
-        }        
+        }
+    }
+
+    void EcsRegistry::playbackCommands()
+    {
+        OPTICK_EVENT();
+        m_commandBuffer.playback();
     }
 
     L_NODISCARD entity_handle EcsRegistry::getEntity(id_type entityId)
@@ -280,18 +679,22 @@ namespace legion::core::ecs
 #ifdef LGN_SAFE_MODE
         if (!validateEntity(entityId))
             return entity_data();
+
+        if (hasComponent<hierarchy>(entityId))
+        {
+            component_pool<hierarchy>* family = getFamily<hierarchy>();
+            async::readonly_guard rguard(family->get_lock());
+            entity_handle& parent = family->get_component(entityId).parent;
+            if (parent && !validateEntity(parent)) // Re-validate parent.
+                parent = invalid_id;
+        }
 #endif
 
         async::readonly_guard guard(m_entityDataLock);
 
-#ifdef LGN_SAFE_MODE
-        entity_data& data = m_entityData[entityId]; // Is fine because the lock only locks order changes in the container, not the values themselves.
-        if (data.parent && !validateEntity(data.parent)) // Re-validate parent.
-            data.parent = invalid_id;
-        return data;
-#else
-        return m_entityData[entityId]; // Is fine because the lock only locks order changes in the container, not the values themselves.
-#endif
+        if (const entity_data* data = m_entityIndex.find(entityId)) // Is fine because the lock only locks order changes in the container, not the values themselves.
+            return *data;
+        return entity_data();
 
     }
 
@@ -303,8 +706,23 @@ namespace legion::core::ecs
             return;
 #endif
 
+        component_signature signature = getSignature(data.components); // Rebuild the signature in case only the component list was filled in.
+
+        async::readonly_guard guard(m_entityDataLock);
+        if (entity_data* entityData = m_entityIndex.find(entityId))
+        {
+            *entityData = data;
+            entityData->signature = signature;
+        }
+    }
+
+    L_NODISCARD component_signature EcsRegistry::getEntitySignature(id_type entityId)
+    {
+        OPTICK_EVENT();
         async::readonly_guard guard(m_entityDataLock);
-        m_entityData[entityId] = data;
+        if (const entity_data* data = m_entityIndex.find(entityId))
+            return data->signature;
+        return component_signature();
     }
 
     L_NODISCARD entity_handle EcsRegistry::getEntityParent(id_type entityId)
@@ -4,10 +4,15 @@
 #include <core/common/common.hpp>
 #include <core/async/async.hpp>
 #include <core/ecs/component_pool.hpp>
+#include <core/ecs/archetype_storage.hpp>
+#include <core/ecs/component_signature.hpp>
+#include <core/ecs/entity_index.hpp>
 #include <core/ecs/queryregistry.hpp>
 #include <core/ecs/entityquery.hpp>
 #include <core/ecs/entity_handle.hpp>
 #include <core/ecs/archetype.hpp>
+#include <core/ecs/command_buffer.hpp>
+#include <core/ecs/prefab.hpp>
 
 #include <utility>
 #include <memory>
@@ -27,41 +32,74 @@ namespace legion::core::ecs
     template<typename component_type>
     class component_handle;
 
-    /**@class entity_data
-     * @brief Internal data-structure used to store hierarchy and composition data of an entity.
-     */
-    struct entity_data
-    {
-        hashed_sparse_set<id_type> components;
-    };
-
     /**@class EcsRegistry
      * @brief Manager and owner of all ECS related objects.
      */
     class EcsRegistry
     {
+        friend class CommandBuffer;
     private:
-        static id_type m_nextEntityId;
-
         mutable async::rw_spinlock m_familyLock;
         std::unordered_map<id_type, std::unique_ptr<component_pool_base>> m_families;
         std::unordered_map<id_type, std::string> m_componentNames;
+        std::unordered_map<id_type, size_type> m_signatureIndices;
 
 
         mutable async::rw_spinlock m_entityDataLock;
-        std::unordered_map<id_type, entity_data> m_entityData;
+        entity_index m_entityIndex;
 
         mutable async::rw_spinlock m_entityLock;
         entity_set m_entities;
         sparse_map<id_type, std::string> m_entityNames;
 
+        ArchetypeStorage m_archetypes;
         QueryRegistry m_queryRegistry;
+        CommandBuffer m_commandBuffer;
         events::EventBus* m_eventBus;
 
         /**@brief Internal function for recursively destroying all children and children of children etc.
          */
         void recursiveDestroyEntityInternal(id_type entityId);
 
+        /**@brief Invalidates an entity that has already been removed from all queries and detaches it from the hierarchy.
+         * @return entity_data Data of the entity, the components still need to be destroyed.
+         */
+        entity_data detachEntityInternal(id_type entityId, bool recurse);
+
+        /**@brief Creates a batch of entities with reserved ids.
+         */
+        void insertEntityBatch(const entity_container& entities, bool worldChild);
+
+        /**@brief Adds a component with the same starting value to a batch of entities, the queries only get updated once for the entire batch.
+         * @param prototype Starting value of the components, nullptr to default construct.
+         */
+        void insertComponentBatch(id_type componentTypeId, const entity_container& entities, void* prototype);
+
+        /**@brief Adds a component of the same type to a batch of entities, the queries only get updated once for the entire batch.
+         * @param values Starting values of the components per entity, nullptr entries get default constructed.
+         */
+        void insertComponentBatch(id_type componentTypeId, const entity_container& entities, const std::vector<void*>& values);
+
+        template<typename component_type>
+        void insertComponentBatch(const entity_container& entities, component_type&& prototype)
+        {
+            std::remove_cv_t<std::remove_reference_t<component_type>> temp = prototype;
+            insertComponentBatch(typeHash<std::remove_cv_t<std::remove_reference_t<component_type>>>(), entities, &temp);
+        }
+
+        /**@brief Removes a component of the same type from a batch of entities, the queries only get updated once for the entire batch.
+         */
+        void eraseComponentBatch(id_type componentTypeId, const entity_container& entities);
+
+        /**@brief Updates the composition data of a batch of entities after a component was added or removed.
+         */
+        void setSignatureBits(const entity_container& entities, id_type componentTypeId, bool value);
+
+        /**@brief Gives a component type a bit in the component signatures. Requires write permission on m_familyLock.
+         * @throws legion::core::exception When more than LEGION_MAX_COMPONENT_TYPES component types are used.
+         */
+        size_type assignSignatureIndex(id_type componentTypeId);
+
     public:
         static entity_handle world;
 
@@ -79,11 +117,23 @@ namespace legion::core::ecs
          */
         template<typename component_type>
         void reportComponentType(std::optional<std::string> name = std::nullopt)
+        {
+            reportComponentType<component_type>(storage_mode::sparse, name);
+        }
+
+        /**@brief Reports component type to the registry with a specific storage mode.
+         * @tparam component_type Type of struct you with to add as a component.
+         * @param mode storage_mode::sparse stores the family in its own sparse map,
+         *             storage_mode::chunked stores the family together with the other chunked families of the entity in archetype chunks.
+         * @ref legion::core::ecs::ArchetypeStorage
+         */
+        template<typename component_type>
+        void reportComponentType(storage_mode mode, std::optional<std::string> name = std::nullopt)
         {
             OPTICK_EVENT();
             async::readwrite_guard guard(m_familyLock);
             if (!m_families.count(typeHash<component_type>())) {
-                m_families[typeHash<component_type>()] = std::make_unique<component_pool<component_type>>(this, m_eventBus);
+                m_families[typeHash<component_type>()] = std::make_unique<component_pool<component_type>>(this, m_eventBus, mode == storage_mode::chunked ? &m_archetypes : nullptr);
                 if (name.has_value())
                 {
                     m_componentNames[typeHash<component_type>()] = name.value();
@@ -91,6 +141,7 @@ namespace legion::core::ecs
                 else {
                     m_componentNames[typeHash<component_type>()] = std::string(nameOfType<component_type>());
                 }
+                assignSignatureIndex(typeHash<component_type>());
             }
         }
 
@@ -105,6 +156,13 @@ namespace legion::core::ecs
             return static_cast<component_pool<component_type>*>(getFamily(typeHash<component_type>()));
         }
 
+        /**@brief Get the storage that owns the components of all families reported with storage_mode::chunked.
+         */
+        L_NODISCARD ArchetypeStorage& getArchetypeStorage() noexcept
+        {
+            return m_archetypes;
+        }
+
         async::rw_spinlock& getEntityLock() const
         {
             return m_entityLock;
@@ -127,6 +185,19 @@ namespace legion::core::ecs
          */
         L_NODISCARD component_pool_base* getFamily(id_type componentTypeId);
 
+        /**@brief Check whether a component type has been reported.
+         */
+        L_NODISCARD bool isComponentTypeReported(id_type componentTypeId) const;
+
+        /**@brief Get the index of the bit that represents a certain component type in component signatures.
+         * @note Component types that weren't reported yet get assigned a new index.
+         */
+        L_NODISCARD size_type getSignatureIndex(id_type componentTypeId);
+
+        /**@brief Create the signature of a certain component combination.
+         */
+        L_NODISCARD component_signature getSignature(const hashed_sparse_set<id_type>& componentTypes);
+
         /**@brief Check if an entity has a certain component.
          * @param entityId Id of the entity.
          * @param componentTypeId Type id of component to check for.
@@ -319,7 +390,7 @@ namespace legion::core::ecs
 
         /**@brief Check if entity exists.
          * @param entityId Id of entity you wish to check if it exists.
-         * @returns bool True if entity exists, false if it doesn't or if the id is invalid_id.
+         * @returns bool True if entity exists, false if it doesn't, if the id is invalid_id or if the id belongs to an entity that was destroyed.
          */
         L_NODISCARD bool validateEntity(id_type entityId);
 
@@ -330,12 +401,91 @@ namespace legion::core::ecs
 
         L_NODISCARD entity_handle createEntity(id_type entityId, bool worldChild = true);
 
+        /**@brief Create a batch of new entities at once.
+         * @param count Amount of entities to create.
+         * @param worldChild Whether the entities should be parented to the world.
+         * @returns entity_container Handles to the new entities.
+         * @note All ids get reserved at once and every container is only locked once for the entire batch.
+         */
+        L_NODISCARD entity_container createEntities(size_type count, bool worldChild = true);
+
+        /**@brief Create a batch of new entities that all start with the same components.
+         * @param count Amount of entities to create.
+         * @param prototype... Starting values of the components every entity gets.
+         * @returns entity_container Handles to the new entities.
+         * @note Every family is only locked once and raises a single events::bulk_component_creation event.
+         */
+        template<typename component_type, typename... component_types CNDOXY(doesnt_inherit_from<std::remove_reference_t<component_type>, archetype_base> = 0)>
+        L_NODISCARD entity_container createEntities(size_type count, component_type&& prototype, component_types&&... prototypes)
+        {
+            OPTICK_EVENT();
+            entity_container entities = createEntities(count);
+            insertComponentBatch(entities, std::forward<component_type>(prototype));
+            (insertComponentBatch(entities, std::forward<component_types>(prototypes)), ...);
+            return entities;
+        }
+
+        /**@brief Adds a component with its own starting value to every entity of a batch.
+         * @param entities Entities to add the component to, they must not have the component yet.
+         * @param values Starting value per entity.
+         * @note The family is only locked once, the queries only get updated once and component_type::init does NOT get called.
+         */
+        template<typename component_type>
+        void insertComponents(const entity_container& entities, std::vector<component_type>&& values)
+        {
+            OPTICK_EVENT();
+            getFamily<component_type>()->insert_components(entities, std::move(values));
+            setSignatureBits(entities, typeHash<component_type>(), true);
+            m_queryRegistry.evaluateEntityChanges(entities, typeHash<component_type>(), false);
+        }
+
+        /**@brief Adds a range of components decoded from a binary scene snapshot to a batch of entities.
+         * @note The family is only locked once and the queries only get updated once.
+         * @param staging Components returned by component_pool_base::decode_snapshot of the family.
+         * @param offset Index of the component in staging that belongs to the first entity.
+         * @ref legion::core::ecs::component_pool_base::insert_snapshot
+         */
+        void insertComponentSnapshot(id_type componentTypeId, const entity_container& entities, component_staging_base& staging, size_type offset);
+
+        /**@brief Capture the subtree of an entity as a prefab.
+         * @note The components get copied family by family, every family is only locked once.
+         * @ref legion::core::ecs::Prefab
+         */
+        L_NODISCARD Prefab createPrefab(entity_handle root);
+
+        /**@brief Create copies of a prefab in one go.
+         * @note All ids get reserved at once, every family is only locked once and raises a single events::bulk_component_creation event,
+         *       and the hierarchy of all copies gets linked in a single pass. component_type::init does NOT get called, the components are copies.
+         * @param prefab Prefab to copy.
+         * @param count Amount of copies.
+         * @param parent Entity to parent the root of every copy to.
+         * @returns entity_container Root entity of every copy.
+         */
+        entity_container instantiate(const Prefab& prefab, size_type count, entity_handle parent = world_entity_id);
+
+        /**@brief Reserve an id for an entity that will be created later, for example by a command buffer.
+         * @note The entity is not valid until it gets created with the reserved id.
+         */
+        L_NODISCARD id_type reserveEntityId();
+
+        /**@brief Give back an id reserved with reserveEntityId that will never be used to create an entity.
+         */
+        void releaseEntityId(id_type entityId);
+
         /**@brief Destroys entity and all of its components.
          * @param entityId Id of entity you wish to destroy.
          * @param recurse Do you wish to destroy all children and children of children etc as well? True by default.
          */
         void destroyEntity(id_type entityId, bool recurse = true);
 
+        /**@brief Destroys a batch of entities and all of their components.
+         * @param entities Entities you wish to destroy.
+         * @param recurse Do you wish to destroy all children and children of children etc as well? True by default.
+         * @note The queries get updated once for the entire batch and the components are destroyed per family.
+         *       With recurse all descendants are gathered first and go through the same batches as the given entities.
+         */
+        void destroyEntities(const entity_container& entities, bool recurse = true);
+
         /**@brief Get entity handle for a certain entity id.
          * @param entityId Id of entity you want a handle to.
          * @returns entity_handle Handle to the requested entity. (may be invalid if the entity doesn't exist)
@@ -350,6 +500,10 @@ namespace legion::core::ecs
         L_NODISCARD entity_data getEntityData(id_type entityId);
         void setEntityData(id_type entityId, const entity_data& data);
 
+        /**@brief Get the component signature of an entity. Cheaper than getEntityData when only the composition is needed.
+         */
+        L_NODISCARD component_signature getEntitySignature(id_type entityId);
+
         L_NODISCARD entity_handle getEntityParent(id_type entityId);
 
         /**@brief Get a container with ALL entities.
@@ -357,6 +511,19 @@ namespace legion::core::ecs
          */
         L_NODISCARD std::pair<entity_set&, async::rw_spinlock&> getEntities();
 
+        /**@brief Get the command buffer that gets played back at the end of every frame.
+         *        Use it to defer structural changes from systems running on other threads.
+         */
+        L_NODISCARD CommandBuffer& getCommandBuffer() noexcept
+        {
+            return m_commandBuffer;
+        }
+
+        /**@brief Applies all structural changes recorded in the registry's command buffer.
+         * @note Called by the scheduler at the end of every main thread frame.
+         */
+        void playbackCommands();
+
         /**@brief Get a query for your component combination.
          * @tparam component_types Variadic parameter types of all component types you wish to query for.
          * @returns EntityQuery Query that will query the entities with the requested components.
@@ -403,3 +570,4 @@ namespace legion::core::ecs
 
 #include <core/ecs/entity_handle.inl>
 #include <core/ecs/archetype.inl>
+#include <core/ecs/entityquery.inl>
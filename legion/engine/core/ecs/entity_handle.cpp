@@ -2,7 +2,7 @@
 #include <core/ecs/ecsregistry.hpp>
 #include <core/ecs/component_handle.hpp>
 #include <core/defaults/defaultcomponents.hpp>
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::ecs
 {
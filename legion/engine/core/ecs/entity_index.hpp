@@ -0,0 +1,253 @@
+#pragma once
+#include <core/types/primitives.hpp>
+#include <core/platform/platform.hpp>
+#include <core/containers/hashed_sparse_set.hpp>
+#include <core/ecs/component_signature.hpp>
+
+#include <limits>
+#include <vector>
+
+/**
+ * @file entity_index.hpp
+ * @brief Generational entity ids and the dense index that stores the per entity data of the registry.
+ */
+
+namespace legion::core::ecs
+{
+    /**@brief Amount of low bits of an entity id that store the index of the entity, the remaining high bits store the generation.
+     */
+    constexpr id_type entity_index_bits = 32;
+
+    /**@brief Index of an entity inside the dense entity index.
+     */
+    L_NODISCARD constexpr uint32 entity_index_of(id_type entityId) noexcept
+    {
+        return static_cast<uint32>(entityId & ((id_type(1) << entity_index_bits) - 1));
+    }
+
+    /**@brief Generation of an entity id. Increases every time the index of the entity gets recycled.
+     */
+    L_NODISCARD constexpr uint32 entity_generation_of(id_type entityId) noexcept
+    {
+        return static_cast<uint32>(entityId >> entity_index_bits);
+    }
+
+    /**@brief Combine an index and a generation into an entity id.
+     *        Generation 0 ids are equal to their index, so ids from before entities were generational stay the same.
+     */
+    L_NODISCARD constexpr id_type make_entity_id(uint32 index, uint32 generation) noexcept
+    {
+        return (static_cast<id_type>(generation) << entity_index_bits) | static_cast<id_type>(index);
+    }
+
+    /**@class entity_data
+     * @brief Internal data-structure used to store hierarchy and composition data of an entity.
+     */
+    struct entity_data
+    {
+        hashed_sparse_set<id_type> components;
+        component_signature signature;
+    };
+
+    /**@class entity_index
+     * @brief Dense array of entity data indexed by the index part of entity ids with a free-list of recycled indices.
+     *        Lookups are a bounds check, a generation compare and an array access. Handles to destroyed entities are detected by their
+     *        outdated generation, and memory stays bounded by the maximum amount of entities alive at the same time.
+     * @note Not thread safe, the registry guards it with its entity data lock.
+     */
+    class entity_index
+    {
+    private:
+        enum struct slot_state : uint8 { free, reserved, alive, retired };
+
+        struct slot
+        {
+            entity_data data;
+            uint32 generation = 0;
+            slot_state state = slot_state::free;
+        };
+
+        std::vector<slot> m_slots;
+        std::vector<uint32> m_freeList; // May contain indices that were claimed explicitly in the meantime, those get skipped.
+        size_type m_aliveCount = 0;
+
+        L_NODISCARD const slot* find_slot(id_type entityId) const noexcept
+        {
+            uint32 index = entity_index_of(entityId);
+            if (index >= m_slots.size())
+                return nullptr;
+
+            const slot& s = m_slots[index];
+            if (s.generation != entity_generation_of(entityId))
+                return nullptr;
+            return &s;
+        }
+
+    public:
+        /**@param reservedIndices Amount of indices at the start that will never be handed out by reserve. (0 is invalid_id, 1 is the world)
+         */
+        explicit entity_index(uint32 reservedIndices = 2) : m_slots(reservedIndices) {}
+
+        /**@brief Reserve a new entity id, recycling the index of a destroyed entity if possible.
+         *        The id stays reserved until it's either inserted or released.
+         */
+        L_NODISCARD id_type reserve()
+        {
+            while (!m_freeList.empty())
+            {
+                uint32 index = m_freeList.back();
+                m_freeList.pop_back();
+
+                slot& s = m_slots[index];
+                if (s.state != slot_state::free)
+                    continue;
+
+                s.state = slot_state::reserved;
+                return make_entity_id(index, s.generation);
+            }
+
+            uint32 index = static_cast<uint32>(m_slots.size());
+            m_slots.emplace_back().state = slot_state::reserved;
+            return make_entity_id(index, 0);
+        }
+
+        /**@brief Reserve multiple new entity ids at once. Recycled indices get handed out first, the rest are appended with a single resize.
+         * @param out Output iterator that receives the reserved ids.
+         */
+        template<typename OutputIt>
+        void reserve(size_type count, OutputIt out)
+        {
+            while (count && !m_freeList.empty())
+            {
+                uint32 index = m_freeList.back();
+                m_freeList.pop_back();
+
+                slot& s = m_slots[index];
+                if (s.state != slot_state::free)
+                    continue;
+
+                s.state = slot_state::reserved;
+                *out++ = make_entity_id(index, s.generation);
+                count--;
+            }
+
+            size_type first = m_slots.size();
+            m_slots.resize(first + count);
+            for (size_type index = first; index < m_slots.size(); index++)
+            {
+                m_slots[index].state = slot_state::reserved;
+                *out++ = make_entity_id(static_cast<uint32>(index), 0);
+            }
+        }
+
+        /**@brief Reserve a specific entity id, used when restoring entities with known ids.
+         * @return bool False if the index of the id is already in use,
+         *         or if the generation of the id was already handed out before. (that would revive handles to a destroyed entity)
+         */
+        L_NODISCARD bool claim(id_type entityId)
+        {
+            uint32 index = entity_index_of(entityId);
+            if (index == invalid_id)
+                return false;
+
+            while (m_slots.size() <= index)
+            {
+                uint32 newIndex = static_cast<uint32>(m_slots.size());
+                m_slots.emplace_back();
+                if (newIndex != index)
+                    m_freeList.push_back(newIndex);
+            }
+
+            slot& s = m_slots[index];
+            if (s.state != slot_state::free || entity_generation_of(entityId) < s.generation)
+                return false;
+
+            s.generation = entity_generation_of(entityId);
+            s.state = slot_state::reserved;
+            return true;
+        }
+
+        /**@brief Turn a reserved id into a live entity with empty data.
+         * @return entity_data* Data of the new entity, nullptr if the id wasn't reserved.
+         */
+        entity_data* insert(id_type entityId)
+        {
+            slot* s = const_cast<slot*>(find_slot(entityId));
+            if (!s || s->state != slot_state::reserved)
+                return nullptr;
+
+            s->state = slot_state::alive;
+            s->data = entity_data{};
+            m_aliveCount++;
+            return &s->data;
+        }
+
+        /**@brief Get the data of a live entity.
+         * @return entity_data* nullptr if the entity doesn't exist or the id is outdated.
+         */
+        L_NODISCARD entity_data* find(id_type entityId) noexcept
+        {
+            const slot* s = find_slot(entityId);
+            if (!s || s->state != slot_state::alive)
+                return nullptr;
+            return const_cast<entity_data*>(&s->data);
+        }
+
+        L_NODISCARD const entity_data* find(id_type entityId) const noexcept
+        {
+            const slot* s = find_slot(entityId);
+            if (!s || s->state != slot_state::alive)
+                return nullptr;
+            return &s->data;
+        }
+
+        L_NODISCARD bool contains(id_type entityId) const noexcept { return find(entityId) != nullptr; }
+
+        /**@brief Destroy a live entity and recycle its index.
+         * @return entity_data The data the entity had, empty if the entity didn't exist.
+         */
+        entity_data erase(id_type entityId)
+        {
+            slot* s = const_cast<slot*>(find_slot(entityId));
+            if (!s || s->state != slot_state::alive)
+                return entity_data{};
+
+            entity_data data = std::move(s->data);
+            s->data = entity_data{};
+            m_aliveCount--;
+            release(*s, entity_index_of(entityId));
+            return data;
+        }
+
+        /**@brief Give back a reserved id that will never be inserted.
+         */
+        void release(id_type entityId)
+        {
+            slot* s = const_cast<slot*>(find_slot(entityId));
+            if (s && s->state == slot_state::reserved)
+                release(*s, entity_index_of(entityId));
+        }
+
+        /**@brief Amount of live entities.
+         */
+        L_NODISCARD size_type size() const noexcept { return m_aliveCount; }
+
+        /**@brief Amount of indices in use, alive or not.
+         */
+        L_NODISCARD size_type capacity() const noexcept { return m_slots.size(); }
+
+    private:
+        void release(slot& s, uint32 index)
+        {
+            if (s.generation == std::numeric_limits<uint32>::max())
+            {
+                s.state = slot_state::retired; // Retire the index instead of wrapping around, otherwise very old handles could become valid again.
+                return;
+            }
+
+            s.state = slot_state::free;
+            s.generation++;
+            m_freeList.push_back(index);
+        }
+    };
+}
@@ -4,10 +4,12 @@
 #include <core/ecs/entity_handle.hpp>
 #include <core/containers/hashed_sparse_set.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::ecs
 {
+    scheduling::Scheduler* EntityQuery::m_scheduler = nullptr;
+
     EntityQuery::EntityQuery(id_type id, QueryRegistry* registry, EcsRegistry* ecsRegistry) : m_registry(registry), m_ecsRegistry(ecsRegistry), m_id(id)
     {
         m_registry->addReference(m_id);
@@ -18,6 +20,8 @@ namespace legion::core::ecs
         m_id = other.m_id;
         m_registry = other.m_registry;
         m_ecsRegistry = other.m_ecsRegistry;
+        m_lastTick = other.m_lastTick;
+        m_currentTick = other.m_currentTick;
         other.m_id = invalid_id;
     }
 
@@ -26,6 +30,8 @@ namespace legion::core::ecs
         m_id = other.m_id;
         m_registry = other.m_registry;
         m_ecsRegistry = other.m_ecsRegistry;
+        m_lastTick = other.m_lastTick;
+        m_currentTick = other.m_currentTick;
         m_registry->addReference(m_id);
     }
 
@@ -34,6 +40,8 @@ namespace legion::core::ecs
         m_id = other.m_id;
         m_registry = other.m_registry;
         m_ecsRegistry = other.m_ecsRegistry;
+        m_lastTick = other.m_lastTick;
+        m_currentTick = other.m_currentTick;
         other.m_id = invalid_id;
         return *this;
     }
@@ -43,6 +51,8 @@ namespace legion::core::ecs
         m_id = other.m_id;
         m_registry = other.m_registry;
         m_ecsRegistry = other.m_ecsRegistry;
+        m_lastTick = other.m_lastTick;
+        m_currentTick = other.m_currentTick;
         m_registry->addReference(m_id);
         return *this;
     }
@@ -62,6 +72,8 @@ namespace legion::core::ecs
     void EntityQuery::queryEntities()
     {
         OPTICK_EVENT();
+        m_lastTick = m_currentTick;
+        m_currentTick = change_tick::advance();
         m_localcopy = &m_registry->getEntities(m_id);
     }
 
@@ -159,4 +171,13 @@ namespace legion::core::ecs
         OPTICK_EVENT();
         return m_localcopy->size();
     }
+
+    hashed_sparse_set<id_type> EntityQuery::componentTypes() const
+    {
+        OPTICK_EVENT();
+        if (!m_id)
+            return hashed_sparse_set<id_type>();
+
+        return m_registry->getComponentTypes(m_id);
+    }
 }
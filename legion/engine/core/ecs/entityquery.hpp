@@ -6,11 +6,23 @@
 #include <core/ecs/entity_handle.hpp>
 #include <core/ecs/archetype.hpp>
 #include <core/ecs/component_container.hpp>
+#include <core/ecs/component_view.hpp>
+#include <core/ecs/change_tick.hpp>
 
 /**
  * @file entityquery.hpp
  */
 
+namespace legion::core
+{
+    class Engine;
+}
+
+namespace legion::core::scheduling
+{
+    class Scheduler;
+}
+
 namespace legion::core::ecs
 {
     class QueryRegistry;
@@ -22,12 +34,30 @@ namespace legion::core::ecs
      */
     class EntityQuery
     {
+        friend class legion::core::Engine;
     private:
+        static scheduling::Scheduler* m_scheduler;
+
         QueryRegistry* m_registry;
         EcsRegistry* m_ecsRegistry;
         id_type m_id;
         const entity_container* m_localcopy;
 
+        tick_type m_lastTick = 0;
+        tick_type m_currentTick = 0;
+
+        template<typename component_type, typename Predicate>
+        void filter(Predicate&& predicate, entity_container& result) const;
+
+        /**@brief Tick that writes through the views of this handle get stamped with.
+         *        The tick reserved by the current run is only compared against by the next run of this handle, which skips it.
+         *        Other queries that started their run before this one compare against older ticks and still see the writes.
+         */
+        L_NODISCARD tick_type write_tick() const noexcept
+        {
+            return m_currentTick ? m_currentTick : change_tick::current(); // No run yet, nothing to hide the writes from.
+        }
+
     public:
         EntityQuery(id_type id, QueryRegistry* registry, EcsRegistry* ecsRegistry);
         EntityQuery() = default;
@@ -55,7 +85,87 @@ namespace legion::core::ecs
             submit(typeHash<component_type>());
         }
 
+        /**@brief Get a view of a certain component type for all queried entities that references the components instead of copying them.
+         * @note Creating the view costs a lookup per entity, create it once per run instead of once per access.
+         *       Queries over chunked families can skip the lookups by iterating the chunks with for_each_chunk() instead.
+         * @note Call queryEntities() first, the view indexes the same way as the local entity list.
+         * @note The family stays read locked for the lifetime of the view.
+         * @tparam component_type Type of component to view.
+         * @tparam mode Whether the view allows modifying the components or not.
+         * @return component_view<component_type, mode> View whose index i belongs to the entity at index i of the query.
+         * @ref legion::core::ecs::component_view
+         */
+        template<typename component_type, access_mode mode = access_mode::read_only>
+        L_NODISCARD component_view<component_type, mode> view() const;
+
+        /**@brief Run a function for every queried entity. The entities are split into chunks that run as jobs on the worker threads of the scheduler.
+         *        Blocks until all chunks are done, the calling thread helps executing chunks while waiting.
+         * @note Call queryEntities() first.
+         * @note Components are accessed in place through views, so there is nothing to submit afterwards. Mark a component type const for read-only access.
+         * @warning Don't create or destroy components or write components through handles inside func, debug builds assert on it.
+         *          The requested families stay read locked by the calling thread until all chunks are done, a chunk that waits for write permission
+         *          on one of them would never get it. Write through the components passed to func instead, or defer structural changes with a command buffer.
+         * @tparam component_types Types of components to pass to func.
+         * @param chunkSize Max amount of entities per job.
+         * @param func Function that takes either (entity_handle, component_types&...) or (size_type index, entity_handle, component_types&...).
+         */
+        template<typename... component_types, typename Func>
+        void parallel_for(size_type chunkSize, Func&& func) const;
+
+        /**@brief Run a function for every archetype chunk that stores queried entities, passing contiguous arrays of the requested components.
+         *        Unlike view() and parallel_for() nothing gets looked up per entity, the arrays point straight into the chunks.
+         * @note Only works if every queried and every requested component type was reported with storage_mode::chunked.
+         *       Queried entities that don't have all of the requested types are skipped.
+         * @note Doesn't use the local entity list, so calling queryEntities() first isn't required. Chunks are visited in storage order.
+         * @note The change ticks of the components of a non-const type get stamped for the entire chunk before func runs,
+         *       the same way accessing them through a read_write view would.
+         * @warning All chunked families stay read locked until the last chunk is done, the same restrictions as for parallel_for apply to func.
+         * @tparam component_types Types of components to pass to func. Mark a component type const for read-only access.
+         * @param func Function that takes (size_type count, const id_type* entities, component_types*... components).
+         * @throws legion::core::exception When one of the queried or requested component types isn't stored chunked.
+         */
+        template<typename... component_types, typename Func>
+        void for_each_chunk(Func&& func) const;
+
+        /**@brief Get all queried entities whose component of a certain type changed since the previous run of this query handle.
+         * @note A run is a call to queryEntities(). Changes are writes through component handles, submits and read_write views.
+         * @note Writes through the views, parallel_for and for_each_chunk of this handle get stamped with the tick of its current run,
+         *       so the next run doesn't report the handle's own writes. Writes through component handles and submits are stamped with the global tick
+         *       and do show up in the next run, even if they were made by the system that owns this handle.
+         * @note On the first run all components count as changed.
+         * @note The change ticks of the family are scanned in place, only entities with a changed component get checked against the query.
+         *       The result is in storage order and contains the entities that match the query right now, not just the ones in the local entity list.
+         * @tparam component_type Type of component to check. Doesn't have to be one of the queried types.
+         * @param result [out] Cleared and filled with the entities, pass the same container every run to reuse its memory.
+         */
+        template<typename component_type>
+        void changed(entity_container& result) const;
+
+        /**@brief Get all queried entities whose component of a certain type changed since the previous run of this query handle.
+         * @ref legion::core::ecs::EntityQuery::changed(entity_container&) const
+         */
+        template<typename component_type>
+        L_NODISCARD entity_container changed() const;
+
+        /**@brief Get all queried entities that got a component of a certain type added since the previous run of this query handle.
+         * @note A run is a call to queryEntities().
+         * @note On the first run all components count as added.
+         * @note Scans the change ticks in place the same way as changed() does.
+         * @tparam component_type Type of component to check. Doesn't have to be one of the queried types.
+         * @param result [out] Cleared and filled with the entities, pass the same container every run to reuse its memory.
+         */
+        template<typename component_type>
+        void added(entity_container& result) const;
+
+        /**@brief Get all queried entities that got a component of a certain type added since the previous run of this query handle.
+         * @ref legion::core::ecs::EntityQuery::added(entity_container&) const
+         */
+        template<typename component_type>
+        L_NODISCARD entity_container added() const;
+
         /**@brief Update the local copy of the entity list according to the query.
+         * @note Also starts a new run for change detection.
+         * @ref legion::core::ecs::EntityQuery::changed
          */
         void queryEntities();
 
@@ -126,5 +236,10 @@ namespace legion::core::ecs
         /**@brief Get amount of entities that were found with the queried component types.
          */
         size_type size();
+
+        /**@brief Get the type ids of the components this query queries.
+         * @note Can be used to declare the component access of a process. ref: scheduling::Process::reads()
+         */
+        L_NODISCARD hashed_sparse_set<id_type> componentTypes() const;
     };
 }
@@ -0,0 +1,176 @@
+#pragma once
+#include <core/scheduling/scheduler.hpp>
+
+#include <algorithm>
+
+namespace legion::core::ecs
+{
+    template<typename component_type, access_mode mode>
+    L_NODISCARD component_view<component_type, mode> EntityQuery::view() const
+    {
+        OPTICK_EVENT();
+        return component_view<component_type, mode>(m_ecsRegistry->getFamily<component_type>(), *m_localcopy, write_tick());
+    }
+
+    template<typename component_type, typename Predicate>
+    void EntityQuery::filter(Predicate&& predicate, entity_container& result) const
+    {
+        OPTICK_EVENT();
+        result.clear();
+        component_pool<component_type>* family = m_ecsRegistry->getFamily<component_type>();
+
+        // Archetype tables that store all queried types only contain queried entities, no need to check those against the query.
+        static thread_local std::vector<id_type> queryTypes;
+        m_registry->getSortedComponentTypes(m_id, queryTypes);
+
+        // Entities that passed the predicate but might not be queried. They get checked once the family is unlocked.
+        static thread_local entity_container unchecked;
+        unchecked.clear();
+
+        {
+            async::readonly_guard guard(family->get_lock());
+            family->for_each_ticks([&](const id_type* entities, const component_ticks* ticks, size_type count, const archetype_table* table)
+                {
+                    entity_container& target = table && table->contains(queryTypes) ? result : unchecked;
+                    for (size_type i = 0; i < count; i++)
+                        if (predicate(ticks[i]))
+                            target.emplace_back(entities[i]);
+                });
+        }
+
+        m_registry->retainQueried(m_id, unchecked);
+        result.insert(result.end(), unchecked.begin(), unchecked.end());
+    }
+
+    template<typename component_type>
+    void EntityQuery::changed(entity_container& result) const
+    {
+        filter<component_type>([lastTick = m_lastTick](const component_ticks& ticks) { return ticks.changed > lastTick; }, result);
+    }
+
+    template<typename component_type>
+    L_NODISCARD entity_container EntityQuery::changed() const
+    {
+        entity_container result;
+        changed<component_type>(result);
+        return result;
+    }
+
+    template<typename component_type>
+    void EntityQuery::added(entity_container& result) const
+    {
+        filter<component_type>([lastTick = m_lastTick](const component_ticks& ticks) { return ticks.added > lastTick; }, result);
+    }
+
+    template<typename component_type>
+    L_NODISCARD entity_container EntityQuery::added() const
+    {
+        entity_container result;
+        added<component_type>(result);
+        return result;
+    }
+
+    template<typename... component_types, typename Func>
+    void EntityQuery::parallel_for(size_type chunkSize, Func&& func) const
+    {
+        OPTICK_EVENT();
+        const entity_container& entities = *m_localcopy;
+        size_type count = entities.size();
+        if (!count)
+            return;
+
+        if (!chunkSize)
+            chunkSize = count;
+
+        std::tuple<component_view<std::remove_const_t<component_types>, access_mode_for<component_types>>...> views{
+            view<std::remove_const_t<component_types>, access_mode_for<component_types>>()... };
+
+        auto runChunk = [&](size_type chunkIndex)
+        {
+            OPTICK_EVENT("Query chunk");
+            async::own_jobs_only restrictHelp; // The viewed families are read locked, jobs of other pools might need to write them.
+            detail::parallelForDepth++;
+            size_type start = chunkIndex * chunkSize;
+            size_type end = std::min(start + chunkSize, count);
+
+            for (size_type i = start; i < end; i++)
+            {
+                std::apply([&](auto&... compViews)
+                    {
+                        if constexpr (std::is_invocable_v<Func&, size_type, entity_handle, component_types&...>)
+                            func(i, entities[i], compViews[i]...);
+                        else
+                            func(entities[i], compViews[i]...);
+                    }, views);
+            }
+            detail::parallelForDepth--;
+        };
+
+        size_type chunkCount = (count + chunkSize - 1) / chunkSize;
+        if (chunkCount == 1 || !m_scheduler) // Not worth the overhead of queueing a job.
+        {
+            for (size_type chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+                runChunk(chunkIndex);
+            return;
+        }
+
+        async::own_jobs_only restrictHelp; // Keep the thread that holds the view locks from picking up unrelated jobs while it waits.
+        m_scheduler->queueJobs(chunkCount, [&]()
+            {
+                runChunk(async::this_job::get_id());
+            }).wait();
+    }
+
+    template<typename... component_types, typename Func>
+    void EntityQuery::for_each_chunk(Func&& func) const
+    {
+        OPTICK_EVENT();
+        ArchetypeStorage& storage = m_ecsRegistry->getArchetypeStorage();
+
+        std::vector<id_type> types;
+        m_registry->getSortedComponentTypes(m_id, types);
+        (types.push_back(typeHash<std::remove_const_t<component_types>>()), ...);
+        std::sort(types.begin(), types.end());
+        types.erase(std::unique(types.begin(), types.end()), types.end());
+
+        std::tuple<component_pool<std::remove_const_t<component_types>>*...> families{ m_ecsRegistry->getFamily<std::remove_const_t<component_types>>()... };
+
+        async::readonly_guard guard(storage.get_lock());
+        for (id_type type : types)
+            if (!storage.is_chunked(type))
+                throw legion_exception_msg("EntityQuery::for_each_chunk requires every queried and requested component type to be stored chunked.");
+
+        const tick_type tick = write_tick();
+
+        // Takes a null pointer of the possibly const qualified component type to know whether and which column to stamp.
+        auto markWritten = [&](const archetype_table& table, size_type chunk, size_type count, const id_type* entities, auto* typeTag)
+        {
+            using component_type = std::remove_const_t<std::remove_pointer_t<decltype(typeTag)>>;
+            if constexpr (access_mode_for<std::remove_pointer_t<decltype(typeTag)>> == access_mode::read_write)
+            {
+                component_ticks* ticks = table.ticks(chunk, static_cast<size_type>(table.column_index(typeHash<component_type>())));
+                for (size_type i = 0; i < count; i++)
+                    ticks[i].changed = tick;
+                std::get<component_pool<component_type>*>(families)->record_changes(entities, count);
+            }
+        };
+
+        async::own_jobs_only restrictHelp;
+        detail::parallelForDepth++;
+        storage.for_each_table(types, [&](archetype_table& table)
+            {
+                for (size_type chunk = 0; chunk < table.chunk_count(); chunk++)
+                {
+                    size_type start = chunk * table.chunk_capacity();
+                    if (start >= table.size()) // Only the trailing chunk can be empty.
+                        break;
+
+                    size_type count = std::min(table.chunk_capacity(), table.size() - start);
+                    const id_type* entities = table.chunk(chunk).entities();
+                    (markWritten(table, chunk, count, entities, static_cast<component_types*>(nullptr)), ...);
+                    func(count, entities, static_cast<component_types*>(table.template column<std::remove_const_t<component_types>>(chunk))...);
+                }
+            });
+        detail::parallelForDepth--;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <core/types/primitives.hpp>
+#include <core/ecs/component_pool.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file prefab.hpp
+ */
+
+namespace legion::core::ecs
+{
+    class EcsRegistry;
+
+    /**@class Prefab
+     * @brief Pre-resolved template of an entity subtree that can be instantiated many times at once.
+     *        The nodes are stored depth first with their parent and child indices, the components are stored as copies per component family.
+     * @note Created with EcsRegistry::createPrefab and instantiated with EcsRegistry::instantiate.
+     *       The prefab doesn't follow changes made to the source entities after it was created.
+     */
+    class Prefab
+    {
+        friend class EcsRegistry;
+    public:
+        static constexpr uint32 no_parent = static_cast<uint32>(-1);
+
+    private:
+        struct prefab_family
+        {
+            id_type typeId;
+            std::vector<uint32> nodes; // Nodes that have a component of this family, ascending.
+            std::unique_ptr<component_staging_base> components; // One component per node.
+        };
+
+        std::vector<uint32> m_parents; // Parent index per node, no_parent for the root.
+        std::vector<std::vector<uint32>> m_children;
+        std::vector<std::string> m_names;
+        std::vector<prefab_family> m_families;
+
+    public:
+        Prefab() = default;
+        Prefab(Prefab&&) = default;
+        Prefab& operator=(Prefab&&) = default;
+
+        /**@brief Amount of entities in a single instance.
+         */
+        L_NODISCARD size_type size() const noexcept { return m_parents.size(); }
+
+        /**@brief Whether the prefab has no entities.
+         */
+        L_NODISCARD bool empty() const noexcept { return m_parents.empty(); }
+
+        /**@brief Amount of component families the prefab stores.
+         */
+        L_NODISCARD size_type family_count() const noexcept { return m_families.size(); }
+    };
+}
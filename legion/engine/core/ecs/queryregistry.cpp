@@ -9,15 +9,48 @@ namespace legion::core::ecs
     hashed_sparse_set<QueryRegistry*> QueryRegistry::m_validRegistries;
 
     thread_local std::unordered_map<id_type, std::pair<float, entity_container>> QueryRegistry::m_localCopies;
-    thread_local std::unordered_map<id_type, std::unordered_map<id_type, std::unique_ptr<component_container_base>>> QueryRegistry::m_localComponents;
+    thread_local std::unordered_map<id_type, std::unordered_map<id_type, std::pair<bool, std::unique_ptr<component_container_base>>>> QueryRegistry::m_localComponents;
     time::clock<fast_time> QueryRegistry::m_clock;
 
+    void QueryRegistry::unindexQuery(id_type queryId)
+    {
+        // Other queries can share the signature, those stay indexed and the oldest of them takes over the lookup.
+        if (auto itr = m_signatureQueries.find(m_signatures[queryId]); itr != m_signatureQueries.end())
+        {
+            auto& queries = itr->second;
+            queries.erase(std::remove(queries.begin(), queries.end(), queryId), queries.end());
+            if (queries.empty())
+                m_signatureQueries.erase(itr);
+        }
+
+        for (id_type componentTypeId : m_componentTypes[queryId])
+        {
+            auto& queries = m_componentQueries[componentTypeId];
+            queries.erase(std::remove(queries.begin(), queries.end(), queryId), queries.end());
+        }
+    }
+
+    void QueryRegistry::indexQuery(id_type queryId)
+    {
+        m_signatureQueries[m_signatures[queryId]].push_back(queryId); // An older query with the same signature stays first in line.
+
+        for (id_type componentTypeId : m_componentTypes[queryId])
+            m_componentQueries[componentTypeId].push_back(queryId);
+    }
+
     void QueryRegistry::addComponentType(id_type queryId, id_type componentTypeId)
     {
         OPTICK_EVENT();
+        size_type signatureIndex = m_registry.getSignatureIndex(componentTypeId);
+        component_signature signature;
+
         {
             async::readwrite_guard guard(m_componentLock); // In this case the lock handles both the sparse_map and the contained hashed_sparse_sets
+            unindexQuery(queryId);
             m_componentTypes.at(queryId).insert(componentTypeId); // We insert the new component type we wish to track.
+            m_signatures[queryId].set(signatureIndex);
+            indexQuery(queryId);
+            signature = m_signatures[queryId];
         }
 
         bool modified = false;
@@ -26,12 +59,12 @@ namespace legion::core::ecs
         std::vector<entity_handle> toRemove;
 
         {
-            async::readonly_multiguard mguard(m_entityLock, m_componentLock);
+            async::readonly_guard guard(m_entityLock);
             auto& [_, entityList] = m_entityLists.at(queryId);
             for (int i = 0; i < entityList.size(); i++) // Iterate over all tracked entities.
             {
                 entity_handle entity = entityList.at(i); // Get the id from the keys of the map.
-                if (!m_registry.getEntityData(entity).components.contains(m_componentTypes[queryId])) // Check component composition
+                if (!m_registry.getEntitySignature(entity).contains(signature)) // Check component composition
                     toRemove.push_back(entity); // Mark for erasure if the component composition doesn't overlap with the query.
             }
         }
@@ -48,14 +81,14 @@ namespace legion::core::ecs
         // Next we need to filter through all the entities to get all the new ones that apply to the new query.
 
         auto [entities, entitiesLock] = m_registry.getEntities(); // getEntities returns a pair of both the container as well as the lock that should be locked by you when operating on it.
-        async::mixed_multiguard mguard(entitiesLock, async::lock_state_read, m_componentLock, async::lock_state_read, m_entityLock, async::lock_state_write); // Lock locks.
+        async::mixed_multiguard mguard(entitiesLock, async::lock_state_read, m_entityLock, async::lock_state_write); // Lock locks.
         auto& [lastModified, entityList] = m_entityLists.at(queryId);
         for (entity_handle entity : entities) // Iterate over all entities.
         {
             if (entityList.contains(entity)) // If the entity is already tracked, continue to the next entity.
                 continue;
 
-            if (m_registry.getEntityData(entity).components.contains(m_componentTypes[queryId])) // Check if the queried components completely overlaps the components in the entity.
+            if (m_registry.getEntitySignature(entity).contains(signature)) // Check if the queried components completely overlaps the components in the entity.
             {
                 modified = true;
                 entityList.insert(entity); // Insert entity into tracking list.
@@ -69,21 +102,28 @@ namespace legion::core::ecs
     void QueryRegistry::removeComponentType(id_type queryId, id_type componentTypeId)
     {
         OPTICK_EVENT();
+        size_type signatureIndex = m_registry.getSignatureIndex(componentTypeId);
+        component_signature signature;
+
         {
             async::readwrite_guard guard(m_componentLock);
+            unindexQuery(queryId);
             m_componentTypes[queryId].erase(componentTypeId); // Remove component from query list.
+            m_signatures[queryId].reset(signatureIndex);
+            indexQuery(queryId);
+            signature = m_signatures[queryId];
         }
 
         // Then we remove all the entities that no longer overlap with the query.
         std::vector<entity_handle> toRemove;
 
         {
-            async::readonly_multiguard mguard(m_entityLock, m_componentLock);
+            async::readonly_guard guard(m_entityLock);
             auto& [_, entityList] = m_entityLists.at(queryId);
             for (int i = 0; i < entityList.size(); i++) // Iterate over all tracked entities.
             {
                 entity_handle entity = entityList.at(i); // Get the id from the keys of the map.
-                if (!m_registry.getEntity(entity).component_composition().contains(m_componentTypes[queryId])) // Check component composition
+                if (!m_registry.getEntitySignature(entity).contains(signature)) // Check component composition
                     toRemove.push_back(entity); // Mark for erasure if the component composition doesn't overlap with the query.
             }
         }
@@ -103,24 +143,28 @@ namespace legion::core::ecs
         OPTICK_EVENT();
         entity_handle entity(entityId);
 
+        component_signature entitySignature;
+        if (!removal)
+            entitySignature = m_registry.getEntitySignature(entityId); // Fetch the composition once instead of once per query.
+
         async::mixed_multiguard mmguard(m_entityLock, async::lock_state_write, m_componentLock, async::lock_state_read); // We lock now so that we don't need to reacquire the locks every iteration.
 
-        for (int i = 0; i < m_entityLists.size(); i++)
-        {
-            id_type queryId = m_entityLists.keys()[i];
-            if (!m_componentTypes[queryId].contains(componentTypeId)) // This query doesn't care about this component type.
-                continue;
+        auto itr = m_componentQueries.find(componentTypeId);
+        if (itr == m_componentQueries.end()) // No query cares about this component type.
+            return;
 
+        for (id_type queryId : itr->second) // Only the queries that query this component type can be affected.
+        {
             auto& [lastModified, entityList] = m_entityLists.at(queryId);
-            if (entityList.contains(entity))
+            if (removal)
             {
-                if (removal)
+                if (entityList.contains(entity))
                 {
                     entityList.erase(entity); // Erase the entity from the query's tracking list if the component was removed from the entity.
                     lastModified = m_clock.elapsedTime();
                 }
             }
-            else if (m_registry.getEntityData(entityId).components.contains(m_componentTypes[queryId]))
+            else if (entitySignature.contains(m_signatures[queryId]) && !entityList.contains(entity))
             {
                 entityList.insert(entity); // If the entity also contains all the other required components for this query, then add this entity to the tracking list.
                 lastModified = m_clock.elapsedTime();
@@ -132,11 +176,15 @@ namespace legion::core::ecs
     {
         OPTICK_EVENT();
         entity_handle entity(entityId);
+        component_signature entitySignature = m_registry.getEntitySignature(entityId);
 
-        async::readwrite_guard guard(m_entityLock);
+        async::mixed_multiguard mmguard(m_entityLock, async::lock_state_write, m_componentLock, async::lock_state_read);
         for (int i = 0; i < m_entityLists.size(); i++) // Iterate over all query tracking lists.
         {
             id_type queryId = m_entityLists.keys()[i];
+            if (!entitySignature.contains(m_signatures[queryId])) // The entity can't be in a query it doesn't match.
+                continue;
+
             auto& [lastModified, entityList] = m_entityLists.at(queryId);
             if (entityList.contains(entity))
             {
@@ -146,16 +194,97 @@ namespace legion::core::ecs
         }
     }
 
-    id_type QueryRegistry::getQueryId(const hashed_sparse_set<id_type>& componentTypes)
+    void QueryRegistry::evaluateEntityChanges(const entity_container& entities, id_type componentTypeId, bool removal)
     {
         OPTICK_EVENT();
-        async::readonly_guard guard(m_componentLock);
+        if (entities.empty())
+            return;
+
+        std::vector<component_signature> entitySignatures;
+        if (!removal)
+        {
+            entitySignatures.reserve(entities.size());
+            for (entity_handle entity : entities)
+                entitySignatures.push_back(m_registry.getEntitySignature(entity));
+        }
 
-        for (auto [id, types] : m_componentTypes)
+        async::mixed_multiguard mmguard(m_entityLock, async::lock_state_write, m_componentLock, async::lock_state_read);
+
+        auto itr = m_componentQueries.find(componentTypeId);
+        if (itr == m_componentQueries.end())
+            return;
+
+        for (id_type queryId : itr->second)
         {
-            if (types == componentTypes) // Iterate over all component type lists of all queries and check if it's the same as the requested list.
-                return id;
+            auto& [lastModified, entityList] = m_entityLists.at(queryId);
+            const component_signature& querySignature = m_signatures[queryId];
+            bool modified = false;
+
+            for (size_type i = 0; i < entities.size(); i++)
+            {
+                const entity_handle& entity = entities[i];
+                if (removal)
+                {
+                    if (entityList.contains(entity))
+                    {
+                        entityList.erase(entity);
+                        modified = true;
+                    }
+                }
+                else if (entitySignatures[i].contains(querySignature) && !entityList.contains(entity))
+                {
+                    entityList.insert(entity);
+                    modified = true;
+                }
+            }
+
+            if (modified)
+                lastModified = m_clock.elapsedTime();
         }
+    }
+
+    void QueryRegistry::markEntitiesDestruction(const entity_container& entities)
+    {
+        OPTICK_EVENT();
+        if (entities.empty())
+            return;
+
+        std::vector<component_signature> entitySignatures;
+        entitySignatures.reserve(entities.size());
+        for (entity_handle entity : entities)
+            entitySignatures.push_back(m_registry.getEntitySignature(entity));
+
+        async::mixed_multiguard mmguard(m_entityLock, async::lock_state_write, m_componentLock, async::lock_state_read);
+        for (int i = 0; i < m_entityLists.size(); i++)
+        {
+            id_type queryId = m_entityLists.keys()[i];
+            const component_signature& querySignature = m_signatures[queryId];
+            auto& [lastModified, entityList] = m_entityLists.at(queryId);
+            bool modified = false;
+
+            for (size_type j = 0; j < entities.size(); j++)
+            {
+                const entity_handle& entity = entities[j];
+                if (entitySignatures[j].contains(querySignature) && entityList.contains(entity))
+                {
+                    entityList.erase(entity);
+                    modified = true;
+                }
+            }
+
+            if (modified)
+                lastModified = m_clock.elapsedTime();
+        }
+    }
+
+    id_type QueryRegistry::getQueryId(const hashed_sparse_set<id_type>& componentTypes)
+    {
+        OPTICK_EVENT();
+        component_signature signature = m_registry.getSignature(componentTypes);
+
+        async::readonly_guard guard(m_componentLock);
+        if (auto itr = m_signatureQueries.find(signature); itr != m_signatureQueries.end())
+            return itr->second.front();
 
         return invalid_id;
     }
@@ -180,10 +309,31 @@ namespace legion::core::ecs
         return m_componentTypes[queryId];
     }
 
+    void QueryRegistry::getSortedComponentTypes(id_type queryId, std::vector<id_type>& types)
+    {
+        OPTICK_EVENT();
+        async::readonly_guard guard(m_componentLock);
+        auto& componentTypes = m_componentTypes.at(queryId);
+        types.assign(componentTypes.begin(), componentTypes.end());
+        std::sort(types.begin(), types.end());
+    }
+
+    void QueryRegistry::retainQueried(id_type queryId, entity_container& entities)
+    {
+        OPTICK_EVENT();
+        if (entities.empty())
+            return;
+
+        async::readonly_guard guard(m_entityLock);
+        auto& [_, entityList] = m_entityLists.at(queryId);
+        entities.erase(std::remove_if(entities.begin(), entities.end(), [&](entity_handle entity) { return !entityList.contains(entity); }), entities.end());
+    }
+
     id_type QueryRegistry::addQuery(const hashed_sparse_set<id_type>& componentTypes)
     {
         OPTICK_EVENT();
         id_type queryId;
+        component_signature signature = m_registry.getSignature(componentTypes);
 
         { // Write permitted critical section for m_entityLists
             async::readwrite_multiguard mguard(m_referenceLock, m_entityLock, m_componentLock);
@@ -194,6 +344,8 @@ namespace legion::core::ecs
             m_references.emplace(queryId); // Create a new reference count.
 
             m_componentTypes.emplace(queryId, componentTypes); // Insert component type list for query.
+            m_signatures.emplace(queryId, signature);
+            indexQuery(queryId);
         }
 
         { // Next we need to filter through all the entities to get all the new ones that apply to the new query.
@@ -202,7 +354,7 @@ namespace legion::core::ecs
             auto& [lastModified, entityList] = m_entityLists.at(queryId);
 
             for (entity_handle entity : entities) // Iterate over all entities.
-                if (m_registry.getEntityData(entity).components.contains(componentTypes)) // Check if the queried components completely overlaps the components in the entity.
+                if (m_registry.getEntitySignature(entity).contains(signature)) // Check if the queried components completely overlaps the components in the entity.
                 {
                     entityList.insert(entity); // Insert entity into tracking list.
                 }
@@ -221,36 +373,30 @@ namespace legion::core::ecs
         auto& [localModified, localList] = m_localCopies[queryId];
         if (lastModified > localModified)
         {
-            {
-                OPTICK_EVENT("Get entities");
-                localList.clear();
-                localList.assign(entityList.begin(), entityList.end());
-            }
-
-            auto& localComps = m_localComponents[queryId];
-            auto& compTypes = m_componentTypes.at(queryId);
+            OPTICK_EVENT("Get entities");
+            localList.clear();
+            localList.assign(entityList.begin(), entityList.end());
+        }
 
-            for (auto compType : compTypes)
-            {
-                if (!localComps.count(compType))
-                    localComps.emplace(compType, std::unique_ptr<component_container_base>(m_registry.getFamily(compType)->get_components(localList)));
-                else
-                    m_registry.getFamily(compType)->get_components(localList, *localComps.at(compType));
-            }
+        auto& localComps = m_localComponents[queryId];
+        auto& compTypes = m_componentTypes.at(queryId);
 
-            {
-                OPTICK_EVENT("Remove old component types");
-                std::vector<id_type> toRemove;
+        // Component copies are only made when requested through getComponents, views don't need them.
+        for (auto& [compType, localComp] : localComps)
+            localComp.first = true;
 
-                for (auto& [compType, compList] : localComps)
-                {
-                    if (!compTypes.contains(compType))
-                        toRemove.push_back(compType);
-                }
+        {
+            OPTICK_EVENT("Remove old component types");
+            std::vector<id_type> toRemove;
 
-                for (auto compType : toRemove)
-                    localComps.erase(compType);
+            for (auto& [compType, compList] : localComps)
+            {
+                if (!compTypes.contains(compType))
+                    toRemove.push_back(compType);
             }
+
+            for (auto compType : toRemove)
+                localComps.erase(compType);
         }
 
         return localList;
@@ -258,12 +404,22 @@ namespace legion::core::ecs
 
     component_container_base& QueryRegistry::getComponents(id_type queryId, id_type componentTypeId)
     {
-        return *m_localComponents.at(queryId).at(componentTypeId);
+        OPTICK_EVENT();
+        auto& [stale, container] = m_localComponents[queryId][componentTypeId];
+        const entity_container& localList = m_localCopies.at(queryId).second;
+
+        if (!container)
+            container = std::unique_ptr<component_container_base>(m_registry.getFamily(componentTypeId)->get_components(localList));
+        else if (stale)
+            m_registry.getFamily(componentTypeId)->get_components(localList, *container);
+
+        stale = false;
+        return *container;
     }
 
     void QueryRegistry::submit(id_type queryId, id_type componentTypeId)
     {
-        m_registry.getFamily(componentTypeId)->set_components(m_localCopies.at(queryId).second, *(m_localComponents.at(queryId).at(componentTypeId)));
+        m_registry.getFamily(componentTypeId)->set_components(m_localCopies.at(queryId).second, *(m_localComponents.at(queryId).at(componentTypeId).second));
     }
 
     void QueryRegistry::addReference(id_type queryId)
@@ -292,9 +448,11 @@ namespace legion::core::ecs
         {
             async::readwrite_multiguard mguard(m_referenceLock, m_entityLock, m_componentLock);
 
+            unindexQuery(queryId);
             m_references.erase(queryId);
             m_entityLists.erase(queryId);
             m_componentTypes.erase(queryId);
+            m_signatures.erase(queryId);
         }
     }
 
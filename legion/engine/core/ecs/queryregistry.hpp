@@ -5,6 +5,7 @@
 #include <core/ecs/entityquery.hpp>
 #include <core/ecs/archetype.hpp>
 #include <core/ecs/component_container.hpp>
+#include <core/ecs/component_signature.hpp>
 #include <core/time/clock.hpp>
 
 /**
@@ -32,7 +33,8 @@ namespace legion::core::ecs
         sparse_map<id_type, std::pair<float, entity_set>> m_entityLists;
 
         static thread_local std::unordered_map<id_type, std::pair<float, entity_container>> m_localCopies;
-        static thread_local std::unordered_map<id_type, std::unordered_map<id_type, std::unique_ptr<component_container_base>>> m_localComponents;
+        // Per query and component type the local copies of the components and whether they're outdated.
+        static thread_local std::unordered_map<id_type, std::unordered_map<id_type, std::pair<bool, std::unique_ptr<component_container_base>>>> m_localComponents;
         static time::clock<fast_time> m_clock;
 
         mutable async::rw_spinlock m_referenceLock;
@@ -40,6 +42,9 @@ namespace legion::core::ecs
 
         mutable async::rw_spinlock m_componentLock;
         sparse_map<id_type, hashed_sparse_set<id_type>> m_componentTypes;
+        sparse_map<id_type, component_signature> m_signatures;
+        std::unordered_map<component_signature, std::vector<id_type>> m_signatureQueries; // Lookup of queries by their exact signature, oldest query first.
+        std::unordered_map<id_type, std::vector<id_type>> m_componentQueries; // Reverse index of all the queries that query a certain component type.
 
         id_type m_lastQueryId = 1;
 
@@ -53,6 +58,22 @@ namespace legion::core::ecs
          */
         id_type addQuery(const hashed_sparse_set<id_type>& componentTypes);
 
+        /**@brief Unlinks a query from the signature lookup and the reverse index. Requires write permission on m_componentLock.
+         */
+        void unindexQuery(id_type queryId);
+
+        /**@brief Links a query to the signature lookup and the reverse index. Requires write permission on m_componentLock.
+         */
+        void indexQuery(id_type queryId);
+
+        /**@brief Copies the type ids of the components a query queries for into types, sorted.
+         */
+        void getSortedComponentTypes(id_type queryId, std::vector<id_type>& types);
+
+        /**@brief Removes all entities that aren't part of a query from a list, the remaining entities keep their order.
+         */
+        void retainQueried(id_type queryId, entity_container& entities);
+
     public:
         static bool isValid(QueryRegistry* reg) { return m_validRegistries.contains(reg); }
 
@@ -90,11 +111,24 @@ namespace legion::core::ecs
          */
         void evaluateEntityChange(id_type entityId, id_type componentTypeId, bool removal);
 
+        /**@brief Mark the same change in component composition for a batch of entities.
+         *        Every affected query gets locked and updated only once for the entire batch.
+         * @param entities Ids of the entities in question.
+         * @param componentTypeId Type id of component that was added or removed.
+         * @param removal Whether the component was added or removed.
+         */
+        void evaluateEntityChanges(const entity_container& entities, id_type componentTypeId, bool removal);
+
         /**@brief Mark an entity destruction. (removes entity from all queries.
          * @param entityId Id of the entity in question.
          */
         void markEntityDestruction(id_type entityId);
 
+        /**@brief Mark the destruction of a batch of entities. (removes the entities from all queries)
+         * @param entities Ids of the entities in question.
+         */
+        void markEntitiesDestruction(const entity_container& entities);
+
         /**@brief Get query id of a query that requests a certain component combination.
          * @param componentTypes Sparse map containing all component type ids that would need to be queried.
          * @return id_type Id of the matching query or invalid_id if none was found.
@@ -151,6 +185,9 @@ namespace legion::core::ecs
          */
         const entity_container& getEntities(id_type queryId);
 
+        /**@brief Get a thread local copy of the components of a certain type for all entities of a query.
+         * @note The copy is only refreshed on the first call after getEntities, prefer EntityQuery::view to avoid the copy entirely.
+         */
         component_container_base& getComponents(id_type queryId, id_type componentTypeId);
         void submit(id_type queryId, id_type componentTypeId);
 
@@ -39,6 +39,7 @@ namespace legion::core
         events::EventBus m_eventbus;
         ecs::EcsRegistry m_ecs;
         scheduling::Scheduler m_scheduler;
+        scenemanagement::SceneStreamer m_sceneStreamer;
 
     public:
 
@@ -46,10 +47,11 @@ namespace legion::core
 
         Engine(int argc, char** argv) : m_modules(), m_eventbus(), m_ecs(&m_eventbus), m_cliargs(argv, argv + argc),
 #if defined(LEGION_LOW_POWER)
-            m_scheduler(&m_eventbus, true, LEGION_MIN_THREADS)
+            m_scheduler(&m_eventbus, true, LEGION_MIN_THREADS),
 #else
-            m_scheduler(&m_eventbus, false, LEGION_MIN_THREADS)
+            m_scheduler(&m_eventbus, false, LEGION_MIN_THREADS),
 #endif
+            m_sceneStreamer(&m_ecs, &m_scheduler)
         {
             log::setup();
             eventbus = &m_eventbus;
@@ -61,7 +63,11 @@ namespace legion::core
             SystemBase::m_scheduler = &m_scheduler;
             ecs::component_handle_base::m_registry = &m_ecs;
             ecs::component_handle_base::m_eventBus = &m_eventbus;
+            ecs::EntityQuery::m_scheduler = &m_scheduler;
+            m_scheduler.subscribeToFrameEnd<ecs::EcsRegistry, &ecs::EcsRegistry::playbackCommands>(&m_ecs);
+            m_scheduler.subscribeToFrameEnd<scenemanagement::SceneStreamer, &scenemanagement::SceneStreamer::update>(&m_sceneStreamer);
             scenemanagement::SceneManager::m_ecs = &m_ecs;
+            scenemanagement::SceneManager::m_streamer = &m_sceneStreamer;
 
             reportModule<CoreModule>();
         }
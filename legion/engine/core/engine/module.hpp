@@ -54,6 +54,12 @@ namespace legion::core
             m_ecs->reportComponentType<component_type>();
         }
 
+        template<typename component_type>
+        void reportComponentType(ecs::storage_mode mode)
+        {
+            m_ecs->reportComponentType<component_type>(mode);
+        }
+
     public:
         virtual void setup() LEGION_PURE;
 
@@ -38,8 +38,12 @@ namespace legion::core
     class System : public SystemBase
     {
     protected:
+        /**@brief Create a process that executes a member function on a process chain.
+         * @return scheduling::Process& The new process. Declare the component access of the process on it to let it run concurrently
+         *         with other systems, e.g: createProcess<&MySystem::update>("Update").reads<position>().writes<velocity>();
+         */
         template <void(SelfType::* func_type)(time::time_span<fast_time>), size_type charc>
-        void createProcess(const char(&processChainName)[charc], time::time_span<fast_time> interval = 0)
+        scheduling::Process& createProcess(const char(&processChainName)[charc], time::time_span<fast_time> interval = 0)
         {
             OPTICK_EVENT();
             std::string name = std::string(processChainName) + nameOfType<SelfType>() + std::to_string(interval) + std::to_string(force_cast<intptr_t>(func_type)[0]);
@@ -49,9 +53,10 @@ namespace legion::core
             m_processes.insert(id, std::move(process));
 
             m_scheduler->hookProcess<charc>(processChainName, m_processes[id].get());
+            return *m_processes[id];
         }
 
-        void createProcess(cstring processChainName, delegate<void(time::time_span<fast_time>)>&& operation, time::time_span<fast_time> interval = 0)
+        scheduling::Process& createProcess(cstring processChainName, delegate<void(time::time_span<fast_time>)>&& operation, time::time_span<fast_time> interval = 0)
         {
             OPTICK_EVENT();
             std::string name = std::string(processChainName) + nameOfType<SelfType>() + std::to_string(interval);
@@ -62,6 +67,7 @@ namespace legion::core
             m_processes.insert(id, std::move(process));
 
             m_scheduler->hookProcess(processChainName, m_processes[id].get());
+            return *m_processes[id];
         }
 
         void destroyProcess(cstring processChainName, time::time_span<fast_time> interval = 0)
@@ -88,6 +94,13 @@ namespace legion::core
             return m_ecs->createEntity(worldChild);
         }
 
+        /**@brief Get the command buffer for structural changes that should be applied at the end of the frame.
+         */
+        L_NODISCARD ecs::CommandBuffer& getCommandBuffer()
+        {
+            return m_ecs->getCommandBuffer();
+        }
+
         template<typename... component_types>
         L_NODISCARD ecs::EntityQuery createQuery()
         {
@@ -176,6 +189,34 @@ namespace legion::core
             m_eventBus->bindToEvent<event_type>(callback);
         }
 
+        template <typename event_type, void(SelfType::* func_type)(event_type*) CNDOXY(inherits_from<event_type, events::event<event_type>> = 0)>
+        void unbindFromEvent()
+        {
+            OPTICK_EVENT();
+            m_eventBus->unbindFromEvent<event_type>(delegate<void(event_type*)>::template create<SelfType, func_type>(static_cast<SelfType*>(this)));
+        }
+
+        /**@brief Remove a callback linked with bindToEvent.
+         * @note Does nothing for callbacks that own a callable like a lambda, the bus keeps its own copy of those. ref: events::EventBus::unbindFromEvent()
+         */
+        template<typename event_type CNDOXY(inherits_from<event_type, events::event<event_type>> = 0)>
+        void unbindFromEvent(const delegate<void(event_type*)>& callback)
+        {
+            OPTICK_EVENT();
+            m_eventBus->unbindFromEvent<event_type>(callback);
+        }
+
+        /**@brief Receive all events of a certain type raised during a frame in a single call on the thread of a process chain.
+         * @param processChainName Name of the process chain to receive the events on.
+         * @param phase Whether to receive the events at the start or the end of the frame of the chain.
+         */
+        template <typename event_type, void(SelfType::* func_type)(const std::vector<event_type>&), size_type charc CNDOXY(inherits_from<event_type, events::event<event_type>> = 0)>
+        void bindToEventBatch(const char(&processChainName)[charc], events::dispatch_phase phase = events::dispatch_phase::chain_start)
+        {
+            OPTICK_EVENT();
+            m_eventBus->bindToEventBatch<event_type>(delegate<void(const std::vector<event_type>&)>::template create<SelfType, func_type>(static_cast<SelfType*>(this)), nameHash<charc>(processChainName), phase);
+        }
+
     public:
         System() : SystemBase(typeHash<SelfType>(), nameOfType<SelfType>()) {}
     };
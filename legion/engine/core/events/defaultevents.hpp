@@ -41,6 +41,20 @@ namespace legion::core::events
 
     };
 
+    template<typename component_type>
+    struct bulk_component_creation : public event<bulk_component_creation<component_type>>
+    {
+        const ecs::entity_container& entities;
+
+        bulk_component_creation(bulk_component_creation&&) = default;
+        bulk_component_creation(const bulk_component_creation&) = default;
+        bulk_component_creation(const ecs::entity_container& entities) : entities(entities) {}
+
+        virtual bool persistent() override { return false; }
+        virtual bool unique() override { return false; }
+
+    };
+
     template<typename component_type>
     struct component_modification : public event<component_modification<component_type>>
     {
@@ -84,4 +98,17 @@ namespace legion::core::events
         virtual bool persistent() override { return false; }
         virtual bool unique() override { return false; }
     };
+
+    template<typename component_type>
+    struct bulk_component_destruction : public event<bulk_component_destruction<component_type>>
+    {
+        const ecs::entity_container& entities;
+
+        bulk_component_destruction(bulk_component_destruction&&) = default;
+        bulk_component_destruction(const bulk_component_destruction&) = default;
+        bulk_component_destruction(const ecs::entity_container& entities) : entities(entities) {}
+
+        virtual bool persistent() override { return false; }
+        virtual bool unique() override { return false; }
+    };
 }
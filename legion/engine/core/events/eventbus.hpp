@@ -4,23 +4,358 @@
 #include <core/containers/hashed_sparse_set.hpp>
 #include <core/types/types.hpp>
 #include <core/events/event.hpp>
+#include <core/async/rw_spinlock.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
+#include <atomic>
+#include <limits>
 #include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 /**@file eventbus.hpp
  */
 
 namespace legion::core::events
 {
+    /**@brief Moment within a frame of a process chain at which deferred events get delivered.
+     */
+    enum struct dispatch_phase : uint8 { chain_start, chain_end };
+
+    namespace detail
+    {
+        L_NODISCARD constexpr id_type combine_ids(id_type seed, id_type value) noexcept
+        {
+            return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+        }
+
+        /**@class deferred_queue_base
+         * @brief Type erased queue of events of a single type waiting for delivery at a dispatch point.
+         */
+        struct deferred_queue_base
+        {
+            virtual ~deferred_queue_base() = default;
+
+            /**@brief Copy an event into the queue. Lock free, can be called from any thread.
+             */
+            virtual void push(event_base& value) LEGION_PURE;
+
+            /**@brief Deliver all queued events to the subscribers in a single batch.
+             * @param callbacksLock Lock that guards the subscribers, it's only held while copying them and not during the callbacks.
+             */
+            virtual void dispatch(async::rw_spinlock& callbacksLock) LEGION_PURE;
+        };
+
+        /**@class deferred_queue
+         * @brief Lock free multi producer queue of events of a certain type that gets drained by the thread of the dispatch point.
+         *        The nodes live in chunks owned by the queue and get recycled after every dispatch,
+         *        so once the queue has grown to the amount of events of a busy frame raising an event doesn't allocate anymore.
+         */
+        template<typename event_type>
+        struct deferred_queue final : public deferred_queue_base
+        {
+            static constexpr uint32 null_node = std::numeric_limits<uint32>::max();
+            static constexpr uint32 first_chunk_size = 64;
+            static constexpr uint32 max_chunks = 24; // Every chunk is twice as big as the previous one.
+
+            struct node
+            {
+                alignas(event_type) byte value[sizeof(event_type)];
+                std::atomic<uint32> next;
+            };
+
+            std::atomic<node*> chunks[max_chunks] = {};
+            std::atomic<uint32> chunkCount = { 0 };
+            std::atomic<bool> growing = { false };
+
+            std::atomic<uint32> head = { null_node }; // Queued events, newest first.
+            std::atomic<uint64> freeList = { null_node }; // Index of the first free node in the low bits, a tag against ABA in the high bits.
+
+            std::vector<event_type> batch; // Reused between dispatches.
+            multicast_delegate<void(const std::vector<event_type>&)> callbacks;
+            multicast_delegate<void(const std::vector<event_type>&)> receivers; // Copy of the callbacks that gets invoked, reused between dispatches.
+
+            ~deferred_queue()
+            {
+                for (uint32 index = head.exchange(null_node, std::memory_order_acquire); index != null_node; index = at(index).next.load(std::memory_order_relaxed))
+                    value_of(index).~event_type();
+
+                uint32 count = chunkCount.load(std::memory_order_acquire);
+                for (uint32 i = 0; i < count; i++)
+                    delete[] chunks[i].load(std::memory_order_relaxed);
+            }
+
+            node& at(uint32 index) const noexcept
+            {
+                uint32 chunk = 0;
+                uint32 chunkSize = first_chunk_size;
+                while (index >= chunkSize)
+                {
+                    index -= chunkSize;
+                    chunkSize <<= 1;
+                    chunk++;
+                }
+                return chunks[chunk].load(std::memory_order_acquire)[index];
+            }
+
+            event_type& value_of(uint32 index) const noexcept
+            {
+                return *std::launder(reinterpret_cast<event_type*>(at(index).value));
+            }
+
+            /**@brief Give a linked list of nodes back to the free list.
+             */
+            void release(uint32 first, uint32 last)
+            {
+                uint64 top = freeList.load(std::memory_order_relaxed);
+                do
+                {
+                    at(last).next.store(static_cast<uint32>(top), std::memory_order_relaxed);
+                } while (!freeList.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | first, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            /**@brief Take a node from the free list, or add a new chunk if there are no free nodes left.
+             */
+            uint32 allocate()
+            {
+                uint64 top = freeList.load(std::memory_order_acquire);
+                while (true)
+                {
+                    while (static_cast<uint32>(top) != null_node)
+                    {
+                        // The node might get taken by another thread in the meantime, the tag makes sure the exchange fails if that happened.
+                        uint32 next = at(static_cast<uint32>(top)).next.load(std::memory_order_relaxed);
+                        if (freeList.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | next, std::memory_order_acquire, std::memory_order_acquire))
+                            return static_cast<uint32>(top);
+                    }
+
+                    // Only one thread grows the queue at a time, otherwise every thread that ran out at the same time would double the size again.
+                    if (!growing.exchange(true, std::memory_order_acquire))
+                        break;
+
+                    std::this_thread::yield();
+                    top = freeList.load(std::memory_order_acquire);
+                }
+
+                uint32 chunk = chunkCount.load(std::memory_order_relaxed);
+                if (chunk >= max_chunks)
+                {
+                    growing.store(false, std::memory_order_release);
+                    throw std::bad_alloc();
+                }
+
+                uint32 chunkSize = first_chunk_size << chunk;
+                uint32 chunkStart = first_chunk_size * ((1u << chunk) - 1);
+                node* nodes = new node[chunkSize];
+                for (uint32 i = 1; i < chunkSize - 1; i++)
+                    nodes[i].next.store(chunkStart + i + 1, std::memory_order_relaxed);
+                chunks[chunk].store(nodes, std::memory_order_release);
+                chunkCount.store(chunk + 1, std::memory_order_release);
+
+                release(chunkStart + 1, chunkStart + chunkSize - 1); // Keep the first node and make the rest available to others.
+                growing.store(false, std::memory_order_release);
+                return chunkStart;
+            }
+
+            virtual void push(event_base& value) override
+            {
+                uint32 index = allocate();
+                node& item = at(index);
+                new (item.value) event_type(static_cast<event_type&>(value));
+
+                uint32 next = head.load(std::memory_order_relaxed);
+                do
+                {
+                    item.next.store(next, std::memory_order_relaxed);
+                } while (!head.compare_exchange_weak(next, index, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            virtual void dispatch(async::rw_spinlock& callbacksLock) override
+            {
+                uint32 list = head.exchange(null_node, std::memory_order_acquire);
+                if (list == null_node)
+                    return;
+
+                // The list is newest first, reverse it so events get delivered in the order they were raised.
+                uint32 last = list;
+                uint32 ordered = null_node;
+                while (list != null_node)
+                {
+                    node& item = at(list);
+                    uint32 next = item.next.load(std::memory_order_relaxed);
+                    item.next.store(ordered, std::memory_order_relaxed);
+                    ordered = list;
+                    list = next;
+                }
+
+                for (uint32 index = ordered; index != null_node; index = at(index).next.load(std::memory_order_relaxed))
+                {
+                    event_type& event = value_of(index);
+                    batch.push_back(std::move(event));
+                    event.~event_type();
+                }
+                release(ordered, last); // Recycle the nodes before the callbacks, so events they raise can reuse them.
+
+                {
+                    async::readonly_guard guard(callbacksLock);
+                    receivers = callbacks;
+                }
+
+                OPTICK_EVENT("Deferred event callbacks");
+                OPTICK_TAG("Event", nameOfType<event_type>());
+                receivers.invoke(batch);
+                batch.clear();
+            }
+        };
+
+        /**@class callback_list
+         * @brief Immediate subscribers of a single event type. A published list never changes anymore,
+         *        (un)binding publishes a changed copy so notify can invoke the list it got without holding the lock.
+         */
+        struct callback_list
+        {
+            multicast_delegate<void(event_base*)> untyped; // Subscribers bound by id without knowing the event type.
+
+            virtual ~callback_list() = default;
+
+            L_NODISCARD virtual std::shared_ptr<callback_list> copy() const
+            {
+                return std::make_shared<callback_list>(*this);
+            }
+
+            L_NODISCARD virtual size_type size() const
+            {
+                return untyped.size();
+            }
+
+            virtual void invoke(event_base* value) const
+            {
+                untyped.invoke(value);
+            }
+        };
+
+        /**@class typed_callback_list
+         * @brief Keeps the subscribers as the delegates they were bound with and only casts the event when it gets delivered.
+         *        Wrapping a delegate into one taking event_base* would need more room than the small buffer of a delegate and allocate.
+         */
+        template<typename event_type>
+        struct typed_callback_list final : public callback_list
+        {
+            multicast_delegate<void(event_type*)> callbacks;
+
+            typed_callback_list() = default;
+            explicit typed_callback_list(const callback_list& other) : callback_list(other) {}
+
+            L_NODISCARD virtual std::shared_ptr<callback_list> copy() const override
+            {
+                return std::make_shared<typed_callback_list>(*this);
+            }
+
+            L_NODISCARD virtual size_type size() const override
+            {
+                return untyped.size() + callbacks.size();
+            }
+
+            virtual void invoke(event_base* value) const override
+            {
+                untyped.invoke(value);
+                callbacks.invoke(static_cast<event_type*>(value));
+            }
+        };
+    }
+
+    /**@brief Id of the dispatch point of a certain process chain and phase.
+     * @param chainId Name hash of the process chain.
+     */
+    L_NODISCARD constexpr id_type dispatch_point(id_type chainId, dispatch_phase phase) noexcept
+    {
+        return detail::combine_ids(chainId, static_cast<id_type>(phase) + 1);
+    }
+
     /**@class EventBus
      * @brief Central communication channel for events and messages.
+     * @note Thread safe. Subscribers bound with bindToEvent get notified immediately on the raising thread,
+     *       subscribers bound with bindToEventBatch get all events of a frame in one call at a dispatch point of a process chain.
      */
     class EventBus
     {
+        mutable async::rw_spinlock m_eventsLock;
         sparse_map<id_type, hashed_sparse_set<std::shared_ptr<event_base>>> m_events;
-        sparse_map<id_type, multicast_delegate<void(event_base*)>> m_eventCallbacks;
+
+        mutable async::rw_spinlock m_callbacksLock;
+        std::unordered_map<id_type, std::shared_ptr<const detail::callback_list>> m_eventCallbacks;
+
+        // Deferred queues per dispatch point, and the same queues per event type to push raised events into.
+        std::unordered_map<id_type, std::vector<std::unique_ptr<detail::deferred_queue_base>>> m_deferredQueues;
+        std::unordered_map<id_type, std::vector<detail::deferred_queue_base*>> m_deferredTypes;
+        std::unordered_map<id_type, detail::deferred_queue_base*> m_deferredLookup; // Keyed by combination of dispatch point and event type.
+        std::atomic<size_type> m_deferredCount = { 0 };
+
+        /**@brief Store the event if it's persistent.
+         * @return event_base* The stored event, or nullptr if the event didn't need to be stored.
+         */
+        event_base* storeEvent(id_type id, std::unique_ptr<event_base>& value)
+        {
+            if (!value->persistent())
+                return nullptr;
+
+            async::readwrite_guard guard(m_eventsLock);
+            auto& events = m_events[id];
+            if (value->unique() && events.size())
+                return nullptr;
+
+            event_base* eventptr = value.release();
+            events.emplace(eventptr); // If it's persistent keep the event stored. (Or at least keep it somewhere fetch able.)
+            return eventptr;
+        }
+
+        /**@brief Notify the immediate subscribers and queue the event for the deferred subscribers.
+         * @note The immediate subscribers are taken under the lock and invoked after releasing it, the same as the deferred dispatch.
+         *       Callbacks can thus (un)bind subscribers without deadlocking on the callbacks lock.
+         */
+        void notify(id_type id, event_base* value)
+        {
+            std::shared_ptr<const detail::callback_list> receivers;
+
+            {
+                async::readonly_guard guard(m_callbacksLock);
+
+                if (m_deferredCount.load(std::memory_order_relaxed))
+                    if (auto itr = m_deferredTypes.find(id); itr != m_deferredTypes.end())
+                        for (auto* queue : itr->second)
+                            queue->push(*value);
+
+                if (auto itr = m_eventCallbacks.find(id); itr != m_eventCallbacks.end())
+                    receivers = itr->second;
+            }
+
+            if (!receivers)
+                return;
+
+            OPTICK_EVENT("Event callbacks");
+            receivers->invoke(value);
+        }
+
+        /**@brief Copy of the immediate subscribers of an event type to change and publish, the callbacks lock needs to be held for writing.
+         */
+        template<typename event_type>
+        std::shared_ptr<detail::typed_callback_list<event_type>> copyCallbacks()
+        {
+            using list_type = detail::typed_callback_list<event_type>;
+
+            auto itr = m_eventCallbacks.find(event_type::id);
+            if (itr == m_eventCallbacks.end())
+                return std::make_shared<list_type>();
+
+            if (auto* typed = dynamic_cast<const list_type*>(itr->second.get()))
+                return std::make_shared<list_type>(*typed);
+
+            return std::make_shared<list_type>(*itr->second); // Only had subscribers bound by id so far.
+        }
 
     public:
 
@@ -32,56 +367,40 @@ namespace legion::core::events
         void raiseEvent(Args&&... arguments)
         {
             OPTICK_EVENT();
-            event_type* eventptr;
+            event_type* eventptr = nullptr;
 
             event_type event(arguments...); // Create new event.
-            if (event.persistent() && !(event.unique() && m_events[event_type::id].size()))
+            if (event.persistent())
             {
-                eventptr = new event_type(std::move(event));
-                m_events[event_type::id].emplace(eventptr); // If it's persistent keep the event stored. (Or at least keep it somewhere fetch able.)
+                async::readwrite_guard guard(m_eventsLock);
+                auto& events = m_events[event_type::id];
+                if (!(event.unique() && events.size()))
+                {
+                    eventptr = new event_type(std::move(event));
+                    events.emplace(eventptr); // If it's persistent keep the event stored. (Or at least keep it somewhere fetch able.)
+                }
             }
-            else
+
+            if (!eventptr)
                 eventptr = &event;
 
-            if (m_eventCallbacks.contains(event_type::id))
-            {
-                OPTICK_EVENT("Event callbacks");
-                OPTICK_TAG("Event", nameOfType<event_type>());
-                force_value_cast<multicast_delegate<void(event_type*)>>(m_eventCallbacks[event_type::id]).invoke(eventptr); // Notify.
-            }
+            OPTICK_TAG("Event", nameOfType<event_type>());
+            notify(event_type::id, eventptr);
         }
 
         void raiseEvent(std::unique_ptr<event_base>&& value)
         {
             OPTICK_EVENT();
-            if (value->persistent() && !(value->unique() && m_events[value->get_id()].size()))
-            {
-                m_events[value->get_id()].emplace(value.release()); // If it's persistent keep the event stored. (Or at least keep it somewhere fetch able.)
-            }
-
-            if (m_eventCallbacks.contains(value->get_id()))
-            {
-                OPTICK_EVENT("Event callbacks");
-                OPTICK_TAG("Event", detail::eventNames[value->get_id()].c_str());
-                m_eventCallbacks[value->get_id()].invoke(value.get());
-            }
+            id_type id = value->get_id();
+            event_base* stored = storeEvent(id, value);
+            notify(id, stored ? stored : value.get());
         }
 
         void raiseEventUnsafe(std::unique_ptr<event_base>&& value, id_type id)
         {
             OPTICK_EVENT();
-
-            if (value->persistent() && !(value->unique() && m_events[id].size()))
-            {
-                m_events[id].emplace(value.release()); // If it's persistent keep the event stored. (Or at least keep it somewhere fetch able.)
-            }
-
-            if (m_eventCallbacks.contains(id))
-            {
-                OPTICK_EVENT("Event callbacks");
-                OPTICK_TAG("Event", detail::eventNames[value->get_id()].c_str());
-                m_eventCallbacks[id].invoke(value.get());
-            }
+            event_base* stored = storeEvent(id, value);
+            notify(id, stored ? stored : value.get());
         }
 
         /**@brief Check if an event is active.
@@ -91,9 +410,23 @@ namespace legion::core::events
         bool checkEvent() const
         {
             OPTICK_EVENT();
+            async::readonly_guard guard(m_eventsLock);
             return m_events.contains(event_type::id) && m_events[event_type::id].size();
         }
 
+        /**@brief Check if any callbacks are bound to an event type, either immediate or deferred.
+         *        Allows expensive events to be skipped entirely when nobody would receive them.
+         * @tparam event_type Event type to check for.
+         */
+        template<typename event_type, typename = inherits_from<event_type, event<event_type>>>
+        bool hasSubscribers() const
+        {
+            async::readonly_guard guard(m_callbacksLock);
+            if (auto itr = m_eventCallbacks.find(event_type::id); itr != m_eventCallbacks.end() && itr->second->size())
+                return true;
+            return m_deferredCount.load(std::memory_order_relaxed) && m_deferredTypes.count(event_type::id);
+        }
+
         /**@brief Get the amount of events/messages that are currently in the bus.
          * @tparam event_type Event type to get the amount of.
          */
@@ -101,6 +434,7 @@ namespace legion::core::events
         size_type getEventCount() const
         {
             OPTICK_EVENT();
+            async::readonly_guard guard(m_eventsLock);
             if (m_events.contains(event_type::id))
                 return m_events[event_type::id].size();
             return 0;
@@ -113,9 +447,8 @@ namespace legion::core::events
         const event_type& getEvent(index_type index = 0) const
         {
             OPTICK_EVENT();
-            if (checkEvent<event_type>())
-                return *static_cast<event_type*>(m_events[event_type::id][index]); // Static cast because we already know that the types are the same.
-            return nullptr;
+            async::readonly_guard guard(m_eventsLock);
+            return *static_cast<event_type*>(m_events[event_type::id][index].get()); // Static cast because we already know that the types are the same.
         }
 
         /**@brief Get a reference to the most recently raised event of this type.
@@ -125,12 +458,9 @@ namespace legion::core::events
         const event_type& getLastEvent() const
         {
             OPTICK_EVENT();
-            if (checkEvent<event_type>())
-            {
-                size_type size = m_events[event_type::id].size();
-                return *static_cast<event_type*>(m_events[event_type::id][size - 1]); // Static cast because we already know that the types are the same.
-            }
-            return nullptr;
+            async::readonly_guard guard(m_eventsLock);
+            size_type size = m_events[event_type::id].size();
+            return *static_cast<event_type*>(m_events[event_type::id][size - 1].get()); // Static cast because we already know that the types are the same.
         }
 
         /**@brief Removes a certain event from the bus.
@@ -140,11 +470,11 @@ namespace legion::core::events
         void clearEvent(index_type index = 0)
         {
             OPTICK_EVENT();
-            if (checkEvent<event_type>())
+            async::readwrite_guard guard(m_eventsLock);
+            if (m_events.contains(event_type::id) && m_events[event_type::id].size() > index)
             {
-                auto* event = m_events[event_type::id][index];
+                auto event = m_events[event_type::id][index];
                 m_events[event_type::id].erase(event);
-                delete event;
             }
         }
 
@@ -155,27 +485,130 @@ namespace legion::core::events
         void clearLastEvent()
         {
             OPTICK_EVENT();
-            if (checkEvent<event_type>())
+            async::readwrite_guard guard(m_eventsLock);
+            if (m_events.contains(event_type::id) && m_events[event_type::id].size())
             {
-                auto* event = m_events[event_type::id][m_events[event_type::id].size() - 1];
+                auto event = m_events[event_type::id][m_events[event_type::id].size() - 1];
                 m_events[event_type::id].erase(event);
-                delete event;
             }
         }
 
         /**@brief Link a callback to an event type in order to get notified whenever one gets raised.
+         * @note The callback gets invoked on the thread that raised the event, which might be a worker in the middle of a job.
          * @tparam event_type Event type to subscribe to.
          */
         template<typename event_type, typename = inherits_from<event_type, event<event_type>>>
         void bindToEvent(delegate<void(event_type*)> callback)
         {
             OPTICK_EVENT();
-            m_eventCallbacks[event_type::id] += force_value_cast<delegate<void(event_base*)>>(callback);
+            async::readwrite_guard guard(m_callbacksLock);
+            auto list = copyCallbacks<event_type>();
+            list->callbacks += std::move(callback);
+            m_eventCallbacks[event_type::id] = std::move(list);
+        }
+
+        /**@brief Remove a callback that was linked with bindToEvent.
+         * @note Callbacks compare the same way delegates do. A delegate to the same (member) function of the same object unbinds it,
+         *       but the bus keeps its own copy of every bound delegate that owns a callable (e.g. a lambda) and those are only equal to themselves.
+         *       Unbinding a lambda, a copy of it or an equivalent lambda therefore does nothing.
+         * @tparam event_type Event type to unsubscribe from.
+         */
+        template<typename event_type, typename = inherits_from<event_type, event<event_type>>>
+        void unbindFromEvent(const delegate<void(event_type*)>& callback)
+        {
+            OPTICK_EVENT();
+            async::readwrite_guard guard(m_callbacksLock);
+            if (!m_eventCallbacks.count(event_type::id))
+                return;
+
+            auto list = copyCallbacks<event_type>();
+            list->callbacks -= callback;
+            m_eventCallbacks[event_type::id] = std::move(list);
         }
 
         void bindToEventUnsafe(id_type id, delegate<void(event_base*)> callback)
         {
-            m_eventCallbacks[id] += callback;
+            async::readwrite_guard guard(m_callbacksLock);
+            auto& current = m_eventCallbacks[id];
+            std::shared_ptr<detail::callback_list> list = current ? current->copy() : std::make_shared<detail::callback_list>();
+            list->untyped += std::move(callback);
+            current = std::move(list);
+        }
+
+        /**@brief Link a callback to an event type that receives all events of that type raised since the last dispatch in one batch.
+         *        Events get copied into a lock free queue when they're raised and get delivered on the thread of the dispatch point.
+         * @note Events that reference data owned by the raiser (e.g. bulk_component_creation) can't be deferred.
+         * @tparam event_type Event type to subscribe to.
+         * @param dispatchPoint Where to deliver the events. ref: events::dispatch_point()
+         */
+        template<typename event_type, typename = inherits_from<event_type, event<event_type>>>
+        void bindToEventBatch(delegate<void(const std::vector<event_type>&)> callback, id_type dispatchPoint)
+        {
+            static_assert(std::is_copy_constructible_v<event_type> && std::is_copy_assignable_v<event_type>,
+                "Deferred events are copied into the queue and need to be copyable by value, events with reference members can't be deferred.");
+
+            OPTICK_EVENT();
+            async::readwrite_guard guard(m_callbacksLock);
+
+            id_type key = detail::combine_ids(dispatchPoint, event_type::id);
+            auto& queue = m_deferredLookup[key];
+            if (!queue)
+            {
+                auto& queues = m_deferredQueues[dispatchPoint];
+                queues.push_back(std::make_unique<detail::deferred_queue<event_type>>());
+                queue = queues.back().get();
+                m_deferredTypes[event_type::id].push_back(queue);
+                m_deferredCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            static_cast<detail::deferred_queue<event_type>*>(queue)->callbacks += callback;
+        }
+
+        /**@brief Link a callback to an event type that receives all events of that type raised since the last time the chain reached a certain phase.
+         * @tparam event_type Event type to subscribe to.
+         * @param chainId Name hash of the process chain to deliver the events on.
+         * @param phase Moment within the frame of the chain to deliver the events at.
+         */
+        template<typename event_type, typename = inherits_from<event_type, event<event_type>>>
+        void bindToEventBatch(delegate<void(const std::vector<event_type>&)> callback, id_type chainId, dispatch_phase phase)
+        {
+            bindToEventBatch<event_type>(callback, dispatch_point(chainId, phase));
+        }
+
+        /**@brief Deliver all deferred events of a dispatch point to their subscribers.
+         * @note Process chains dispatch their own points at the start and end of every frame. ref: events::dispatch_point()
+         */
+        void dispatchEvents(id_type dispatchPoint)
+        {
+            if (!m_deferredCount.load(std::memory_order_relaxed))
+                return;
+
+            OPTICK_EVENT();
+            std::vector<std::unique_ptr<detail::deferred_queue_base>>* queues = nullptr;
+
+            {
+                async::readonly_guard guard(m_callbacksLock);
+                if (auto itr = m_deferredQueues.find(dispatchPoint); itr != m_deferredQueues.end())
+                    queues = &itr->second; // Entries are never erased and unordered_map doesn't move its values, so the pointer stays valid.
+            }
+
+            if (!queues)
+                return;
+
+            // The lock isn't held during the callbacks, callbacks may bind new deferred callbacks which can add queues to this list.
+            for (size_type i = 0;; i++)
+            {
+                detail::deferred_queue_base* queue;
+
+                {
+                    async::readonly_guard guard(m_callbacksLock);
+                    if (i >= queues->size())
+                        break;
+                    queue = (*queues)[i].get();
+                }
+
+                queue->dispatch(m_callbacksLock);
+            }
         }
     };
 }
@@ -5,7 +5,7 @@
 #include <core/filesystem/view.hpp>
 #include <core/logging/logging.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file assetimporter.hpp
@@ -2,7 +2,7 @@
 
 #include <core/common/string_extra.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::filesystem
 {
@@ -0,0 +1,116 @@
+#include <core/filesystem/mapped_file.hpp>
+#include <core/tracing/tracing.hpp>
+
+#if !defined(LEGION_WINDOWS)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+#include <utility>
+
+namespace legion::core::filesystem
+{
+    mapped_file::mapped_file(const std::string& path)
+    {
+        OPTICK_EVENT();
+#if defined(LEGION_WINDOWS)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            close();
+            return;
+        }
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            close();
+            return;
+        }
+
+        m_data = static_cast<const byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            close();
+            return;
+        }
+
+        m_size = static_cast<size_type>(fileSize.QuadPart);
+#else
+        m_file = ::open(path.c_str(), O_RDONLY);
+        if (m_file < 0)
+            return;
+
+        struct stat fileStat;
+        if (fstat(m_file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close();
+            return;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+        if (data == MAP_FAILED)
+        {
+            close();
+            return;
+        }
+
+        m_data = static_cast<const byte*>(data);
+        m_size = static_cast<size_type>(fileStat.st_size);
+#endif
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_file, other.m_file);
+#if defined(LEGION_WINDOWS)
+        std::swap(m_mapping, other.m_mapping);
+#endif
+        return *this;
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    void mapped_file::close() noexcept
+    {
+#if defined(LEGION_WINDOWS)
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data)
+            munmap(const_cast<byte*>(m_data), m_size);
+        if (m_file >= 0)
+            ::close(m_file);
+
+        m_file = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
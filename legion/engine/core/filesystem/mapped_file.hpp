@@ -0,0 +1,50 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <core/types/primitives.hpp>
+
+#include <string>
+
+/**
+ * @file mapped_file.hpp
+ */
+
+namespace legion::core::filesystem
+{
+    /**@class mapped_file
+     * @brief Read-only memory mapping of an entire file. The mapping stays valid for the lifetime of the object.
+     */
+    class mapped_file
+    {
+    private:
+        const byte* m_data = nullptr;
+        size_type m_size = 0;
+
+#if defined(LEGION_WINDOWS)
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+        HANDLE m_mapping = nullptr;
+#else
+        int m_file = -1;
+#endif
+
+        void close() noexcept;
+
+    public:
+        mapped_file() = default;
+
+        /**@brief Maps the file at the given path, check is_open() to see whether it succeeded.
+         */
+        explicit mapped_file(const std::string& path);
+
+        mapped_file(mapped_file&& other) noexcept;
+        mapped_file& operator=(mapped_file&& other) noexcept;
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        ~mapped_file();
+
+        L_NODISCARD bool is_open() const noexcept { return m_data != nullptr; }
+        L_NODISCARD const byte* data() const noexcept { return m_data; }
+        L_NODISCARD size_type size() const noexcept { return m_size; }
+    };
+}
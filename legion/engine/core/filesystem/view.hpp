@@ -5,7 +5,7 @@
 
 #include <core/common/exception.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 #include "mem_filesystem_resolver.hpp"
 #include "navigator.hpp"
@@ -3,7 +3,7 @@
 #include "../gtc/constants.hpp"
 #include "../gtc/epsilon.hpp"
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::core::math{
 namespace detail
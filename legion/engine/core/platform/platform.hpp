@@ -114,6 +114,14 @@
 #define L_PAUSE_INSTRUCTION _mm_pause
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    /**@def LEGION_SSE
+     * @brief Defined when the target supports SSE2, code using intrinsics should provide a scalar path for when it isn't.
+     */
+    #define LEGION_SSE
+    #include <emmintrin.h>
+#endif
+
 #if (defined(LEGION_WINDOWS) && !defined(LEGION_WINDOWS_USE_CDECL)) || defined (DOXY_INCLUDE)
     /**@def LEGION_CCONV
      * @brief the calling convention exported functions will use in the args engine
@@ -205,3 +213,18 @@
 #if !defined(LEGION_MIN_THREADS)
 #define LEGION_MIN_THREADS 5
 #endif
+
+/**@def LEGION_MAX_COMPONENT_TYPES
+ * @brief Max amount of component types that can be reported, determines the size of component signatures.
+ */
+#if !defined(LEGION_MAX_COMPONENT_TYPES)
+#define LEGION_MAX_COMPONENT_TYPES 256
+#endif
+
+/**@def LEGION_TRACING
+ * @brief Routes OPTICK_EVENT and the other Optick instrumentation macros to the built-in tracer instead of Optick.
+ *        Meant for headless builds that can't connect to the Optick GUI, dump the capture with tracing::Tracer instead.
+ */
+#if !defined(LEGION_TRACING)
+#define LEGION_TRACING 0
+#endif
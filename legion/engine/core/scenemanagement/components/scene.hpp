@@ -23,3 +23,18 @@ namespace legion::core::scenemanagement
         SceneManager::sceneNames[id] = name;
     }
 }
+
+namespace legion::core::ecs
+{
+    /**@brief Scenes register their name while deserializing, so they can't be restored from raw bytes
+     *        and can't be decoded on a worker thread.
+     */
+    template<>
+    struct snapshot_encoding_of<scenemanagement::scene>
+    {
+        static constexpr bool has_serialize = true;
+        static constexpr bool has_save_load = false;
+        static constexpr bool concurrent_decode = false;
+        static constexpr snapshot_encoding value = snapshot_encoding::cereal;
+    };
+}
@@ -0,0 +1,390 @@
+#include <core/scenemanagement/scene_snapshot.hpp>
+#include <core/filesystem/mapped_file.hpp>
+#include <core/defaults/defaultcomponents.hpp>
+#include <core/logging/logging.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace legion::core::scenemanagement
+{
+    namespace detail
+    {
+        /**@brief Append bytes to the buffer at an aligned offset, reserves zeroed space if data is null.
+         * @return uint64 Offset the bytes were written at.
+         */
+        static uint64 append(std::vector<byte>& buffer, const void* data, size_type size, size_type alignment = 8)
+        {
+            size_type offset = (buffer.size() + alignment - 1) / alignment * alignment;
+            buffer.resize(offset + size);
+            if (data && size)
+                std::memcpy(buffer.data() + offset, data, size);
+            return offset;
+        }
+
+        static bool in_bounds(uint64 offset, uint64 size, size_type bufferSize)
+        {
+            return offset <= bufferSize && size <= bufferSize - offset;
+        }
+    }
+
+    std::vector<byte> SceneSnapshot::write(ecs::EcsRegistry& registry, ecs::entity_handle root)
+    {
+        OPTICK_EVENT();
+        using namespace detail;
+
+        ecs::entity_container entities;
+        std::vector<snapshot_entity> entityTable;
+        std::string names;
+
+        { // Depth first so that parents always come before their children.
+            OPTICK_EVENT("Collect entities");
+            std::vector<std::pair<ecs::entity_handle, uint32>> stack{ { root, snapshot_no_parent } };
+            while (!stack.empty())
+            {
+                auto [entity, parent] = stack.back();
+                stack.pop_back();
+
+                uint32 index = static_cast<uint32>(entities.size());
+                entities.push_back(entity);
+
+                std::string name;
+                if (entity.has_component<hierarchy>())
+                {
+                    hierarchy hry = entity.read_component<hierarchy>();
+                    name = hry.name;
+                    for (auto& child : hry.children.reverse_range()) // Reversed so the children keep their order.
+                        stack.emplace_back(child, index);
+                }
+
+                entityTable.push_back(snapshot_entity{ parent, static_cast<uint32>(name.size()), names.size() });
+                names += name;
+            }
+        }
+
+        // The hierarchy is stored in the entity list instead.
+        std::map<id_type, std::vector<uint32>> familyIndices;
+        for (uint32 i = 0; i < entities.size(); i++)
+            for (id_type componentTypeId : entities[i].component_composition())
+                if (componentTypeId != typeHash<hierarchy>())
+                    familyIndices[componentTypeId].push_back(i);
+
+        std::vector<snapshot_family> familyTable;
+        std::vector<std::vector<byte>> blobs;
+        familyTable.reserve(familyIndices.size());
+        blobs.reserve(familyIndices.size());
+
+        {
+            OPTICK_EVENT("Encode families");
+            ecs::entity_container familyEntities;
+            for (auto& [componentTypeId, indices] : familyIndices)
+            {
+                familyEntities.clear();
+                for (uint32 index : indices)
+                    familyEntities.push_back(entities[index]);
+
+                std::vector<byte> blob;
+                auto* family = registry.getFamily(componentTypeId);
+                ecs::snapshot_encoding encoding = family->write_snapshot(familyEntities, blob);
+
+                familyTable.push_back(snapshot_family{ componentTypeId, indices.size(), 0, 0, blob.size(), encoding, {}, family->snapshot_layout() });
+                blobs.push_back(std::move(blob));
+            }
+        }
+
+        snapshot_header header{};
+        std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+        header.version = snapshot_version;
+        header.familyCount = static_cast<uint32>(familyTable.size());
+        header.entityCount = entities.size();
+
+        std::vector<byte> buffer(sizeof(snapshot_header));
+        header.entitiesOffset = append(buffer, entityTable.data(), entityTable.size() * sizeof(snapshot_entity));
+        header.familiesOffset = append(buffer, nullptr, familyTable.size() * sizeof(snapshot_family)); // Filled in once the blob offsets are known.
+        header.namesOffset = append(buffer, names.data(), names.size());
+        header.namesSize = names.size();
+
+        for (size_type i = 0; i < familyTable.size(); i++)
+        {
+            auto& indices = familyIndices[familyTable[i].typeId];
+            familyTable[i].indicesOffset = append(buffer, indices.data(), indices.size() * sizeof(uint32));
+            familyTable[i].dataOffset = append(buffer, blobs[i].data(), blobs[i].size(), 16);
+        }
+
+        if (!familyTable.empty())
+            std::memcpy(buffer.data() + header.familiesOffset, familyTable.data(), familyTable.size() * sizeof(snapshot_family));
+        std::memcpy(buffer.data(), &header, sizeof(snapshot_header));
+        return buffer;
+    }
+
+    bool SceneSnapshot::save(ecs::EcsRegistry& registry, const std::string& path, ecs::entity_handle root)
+    {
+        OPTICK_EVENT();
+        std::vector<byte> buffer = write(registry, root);
+
+        std::ofstream outFile(path, std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open())
+        {
+            log::error("Could not open {} to write the scene snapshot to.", path);
+            return false;
+        }
+
+        outFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        return outFile.good();
+    }
+
+    const detail::snapshot_entity* SnapshotLoader::entity_table() const noexcept
+    {
+        return reinterpret_cast<const detail::snapshot_entity*>(m_data + m_header.entitiesOffset);
+    }
+
+    const detail::snapshot_family* SnapshotLoader::family_table() const noexcept
+    {
+        return reinterpret_cast<const detail::snapshot_family*>(m_data + m_header.familiesOffset);
+    }
+
+    const uint32* SnapshotLoader::family_indices(size_type family) const noexcept
+    {
+        return reinterpret_cast<const uint32*>(m_data + family_table()[family].indicesOffset);
+    }
+
+    bool SnapshotLoader::open(const byte* data, size_type size)
+    {
+        OPTICK_EVENT();
+        using namespace detail;
+
+        if (size < sizeof(snapshot_header))
+        {
+            log::error("Scene snapshot is too small to contain a header.");
+            return false;
+        }
+
+        snapshot_header header;
+        std::memcpy(&header, data, sizeof(snapshot_header));
+        if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 || header.version != snapshot_version)
+        {
+            log::error("Data is not a version {} scene snapshot.", snapshot_version);
+            return false;
+        }
+
+        if (!header.entityCount || header.entityCount >= snapshot_no_parent ||
+            !in_bounds(header.entitiesOffset, header.entityCount * sizeof(snapshot_entity), size) ||
+            !in_bounds(header.familiesOffset, header.familyCount * sizeof(snapshot_family), size) ||
+            !in_bounds(header.namesOffset, header.namesSize, size))
+        {
+            log::error("Scene snapshot is corrupt, its tables are out of bounds.");
+            return false;
+        }
+
+        m_data = data;
+        m_size = size;
+        m_header = header;
+
+        m_staging.resize(header.familyCount);
+        m_decoded.assign(header.familyCount, false);
+        m_familyCursors.assign(header.familyCount, 0);
+        m_entities.reserve(header.entityCount);
+        return true;
+    }
+
+    bool SnapshotLoader::validate()
+    {
+        OPTICK_EVENT();
+        using namespace detail;
+
+        // The tables are read in place, they are aligned as long as the data is.
+        const snapshot_entity* entityTable = entity_table();
+        for (size_type i = 0; i < m_header.entityCount; i++)
+        {
+            const snapshot_entity& entry = entityTable[i];
+            bool validParent = i == 0 ? entry.parent == snapshot_no_parent : entry.parent < i;
+            if (!validParent || !in_bounds(entry.nameOffset, entry.nameSize, m_header.namesSize))
+            {
+                log::error("Scene snapshot is corrupt, entity {} is invalid.", i);
+                return false;
+            }
+        }
+
+        const snapshot_family* familyTable = family_table();
+        for (size_type i = 0; i < m_header.familyCount; i++)
+        {
+            const snapshot_family& family = familyTable[i];
+            bool valid = family.count <= m_header.entityCount && in_bounds(family.indicesOffset, family.count * sizeof(uint32), m_size) && in_bounds(family.dataOffset, family.dataSize, m_size);
+
+            // Indices are ascending so that batches can walk every family with a cursor.
+            const uint32* indices = family_indices(i);
+            for (size_type j = 0; valid && j < family.count; j++)
+                valid = indices[j] < m_header.entityCount && (j == 0 || indices[j - 1] < indices[j]);
+
+            if (!valid)
+            {
+                log::error("Scene snapshot is corrupt, component family {} is invalid.", family.typeId);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void SnapshotLoader::decode_family(ecs::EcsRegistry& registry, size_type family)
+    {
+        OPTICK_EVENT();
+        const detail::snapshot_family& entry = family_table()[family];
+
+        if (registry.isComponentTypeReported(entry.typeId))
+            m_staging[family] = registry.getFamily(entry.typeId)->decode_snapshot(entry.count, m_data + entry.dataOffset, entry.dataSize, entry.encoding, entry.layout);
+
+        if (!m_staging[family])
+            log::warn("Skipped component type {} ({}) of the scene snapshot, it is either not reported or its layout changed.", registry.getFamilyName(entry.typeId), entry.typeId);
+
+        m_decoded[family] = true;
+    }
+
+    bool SnapshotLoader::concurrent_decode(ecs::EcsRegistry& registry, size_type family) const
+    {
+        id_type typeId = family_table()[family].typeId;
+        return !registry.isComponentTypeReported(typeId) || registry.getFamily(typeId)->concurrent_snapshot_decode();
+    }
+
+    bool SnapshotLoader::is_decoded(size_type family) const noexcept
+    {
+        return m_decoded[family];
+    }
+
+    size_type SnapshotLoader::integrate(ecs::EcsRegistry& registry, size_type count, ecs::entity_handle parent)
+    {
+        OPTICK_EVENT();
+        using namespace detail;
+
+        size_type begin = m_entities.size();
+        size_type end = std::min<size_type>(begin + count, m_header.entityCount);
+        if (begin >= end)
+            return 0;
+
+        ecs::entity_container batch = registry.createEntities(end - begin, false);
+        m_entities.insert(m_entities.end(), batch.begin(), batch.end());
+
+        {
+            OPTICK_EVENT("Build hierarchy");
+            const snapshot_entity* entityTable = entity_table();
+            const char* names = reinterpret_cast<const char*>(m_data + m_header.namesOffset);
+
+            std::vector<hierarchy> hierarchies(end - begin);
+            std::map<uint32, ecs::entity_container> lateChildren; // Children of parents created by earlier batches.
+            for (size_type i = begin; i < end; i++)
+            {
+                const snapshot_entity& entry = entityTable[i];
+                hierarchy& hry = hierarchies[i - begin];
+                hry.name.assign(names + entry.nameOffset, entry.nameSize);
+
+                if (entry.parent == snapshot_no_parent)
+                {
+                    hry.parent = invalid_id;
+                    continue;
+                }
+
+                hry.parent = m_entities[entry.parent];
+                if (entry.parent >= begin)
+                    hierarchies[entry.parent - begin].children.insert(m_entities[i]);
+                else
+                    lateChildren[entry.parent].push_back(m_entities[i]);
+            }
+
+            registry.insertComponents(batch, std::move(hierarchies));
+
+            for (auto& [parentIndex, children] : lateChildren)
+            {
+                ecs::entity_handle parentEntity = m_entities[parentIndex];
+                hierarchy hry = parentEntity.read_component<hierarchy>();
+                for (auto& child : children)
+                    hry.children.insert(child);
+                parentEntity.write_component(hry);
+            }
+        }
+
+        {
+            OPTICK_EVENT("Insert families");
+            const snapshot_family* familyTable = family_table();
+            ecs::entity_container familyEntities;
+            for (size_type i = 0; i < m_header.familyCount; i++)
+            {
+                if (!m_staging[i])
+                    continue;
+
+                const uint32* indices = family_indices(i);
+                size_type first = m_familyCursors[i];
+                size_type cursor = first;
+
+                familyEntities.clear();
+                while (cursor < familyTable[i].count && indices[cursor] < end)
+                    familyEntities.push_back(m_entities[indices[cursor++]]);
+
+                if (!familyEntities.empty())
+                    registry.insertComponentSnapshot(familyTable[i].typeId, familyEntities, *m_staging[i], first);
+
+                m_familyCursors[i] = cursor;
+                if (cursor == familyTable[i].count)
+                    m_staging[i].reset(); // All components have been moved out.
+            }
+        }
+
+        if (begin == 0)
+            m_entities[0].set_parent(parent);
+
+        return end - begin;
+    }
+
+    size_type SnapshotLoader::entity_count() const noexcept
+    {
+        return m_header.entityCount;
+    }
+
+    size_type SnapshotLoader::family_count() const noexcept
+    {
+        return m_header.familyCount;
+    }
+
+    const ecs::entity_container& SnapshotLoader::entities() const noexcept
+    {
+        return m_entities;
+    }
+
+    bool SnapshotLoader::is_done() const noexcept
+    {
+        return m_data && m_entities.size() == m_header.entityCount;
+    }
+
+    ecs::entity_handle SnapshotLoader::root() const noexcept
+    {
+        return m_entities.empty() ? ecs::entity_handle(invalid_id) : m_entities[0];
+    }
+
+    ecs::entity_handle SceneSnapshot::read(ecs::EcsRegistry& registry, const byte* data, size_type size, ecs::entity_handle parent)
+    {
+        OPTICK_EVENT();
+        SnapshotLoader loader;
+        if (!loader.open(data, size) || !loader.validate())
+            return ecs::entity_handle(invalid_id);
+
+        for (size_type i = 0; i < loader.family_count(); i++)
+            loader.decode_family(registry, i);
+
+        loader.integrate(registry, loader.entity_count(), parent);
+        return loader.root();
+    }
+
+    ecs::entity_handle SceneSnapshot::load(ecs::EcsRegistry& registry, const std::string& path, ecs::entity_handle parent)
+    {
+        OPTICK_EVENT();
+        filesystem::mapped_file file(path);
+        if (!file.is_open())
+        {
+            log::error("Could not map scene snapshot {}.", path);
+            return ecs::entity_handle(invalid_id);
+        }
+
+        return read(registry, file.data(), file.size(), parent);
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <core/types/primitives.hpp>
+#include <core/ecs/ecsregistry.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file scene_snapshot.hpp
+ * @brief Binary scene format laid out per component family so that it can be memory mapped and bulk inserted into the families.
+ *
+ *        Layout, all offsets are from the start of the file:
+ *        - snapshot_header
+ *        - snapshot_entity[entityCount]    Entity list in depth first order, the root is entity 0 and parents come before their children.
+ *        - snapshot_family[familyCount]    Type id table, one entry per component family.
+ *        - Name table                      Names of all entities, referenced by the entity list.
+ *        - Per family: uint32[count] entity indices followed by the component blob.
+ */
+
+namespace legion::core::scenemanagement
+{
+    namespace detail
+    {
+        constexpr char snapshot_magic[8] = { 'L', 'G', 'N', 'S', 'C', 'E', 'N', 'E' };
+        constexpr uint32 snapshot_version = 2;
+        constexpr uint32 snapshot_no_parent = static_cast<uint32>(-1);
+
+        struct snapshot_header
+        {
+            char magic[8];
+            uint32 version;
+            uint32 familyCount;
+            uint64 entityCount;
+            uint64 entitiesOffset;
+            uint64 familiesOffset;
+            uint64 namesOffset;
+            uint64 namesSize;
+        };
+
+        struct snapshot_entity
+        {
+            uint32 parent; // Index of the parent in the entity list, snapshot_no_parent for the root.
+            uint32 nameSize;
+            uint64 nameOffset; // Offset into the name table.
+        };
+
+        struct snapshot_family
+        {
+            id_type typeId;
+            uint64 count;
+            uint64 indicesOffset;
+            uint64 dataOffset;
+            uint64 dataSize;
+            ecs::snapshot_encoding encoding;
+            byte padding[7];
+            uint64 layout; // Layout hash of the component type, see ecs::snapshot_layout_of_v.
+        };
+    }
+
+    /**@class SnapshotLoader
+     * @brief Creates the entities of a binary scene snapshot in steps, so that the work can be spread over threads and frames.
+     *        open -> validate -> decode_family for every family -> integrate until done.
+     * @note Only decode_family may run concurrently, and only for different families of which the component family supports concurrent decoding.
+     *       The snapshot data must outlive the loader.
+     */
+    class SnapshotLoader
+    {
+    private:
+        const byte* m_data = nullptr;
+        size_type m_size = 0;
+        detail::snapshot_header m_header{};
+
+        std::vector<std::unique_ptr<ecs::component_staging_base>> m_staging;
+        std::vector<uint8> m_decoded; // Not a vector<bool> because families get decoded concurrently.
+        std::vector<size_type> m_familyCursors;
+
+        ecs::entity_container m_entities;
+
+        L_NODISCARD const detail::snapshot_entity* entity_table() const noexcept;
+        L_NODISCARD const detail::snapshot_family* family_table() const noexcept;
+        L_NODISCARD const uint32* family_indices(size_type family) const noexcept;
+
+    public:
+        /**@brief Check the header and the table bounds of a snapshot.
+         * @return bool False if the data isn't a valid snapshot.
+         */
+        bool open(const byte* data, size_type size);
+
+        /**@brief Check every entry of the tables, nothing gets created if this fails.
+         * @return bool False if the snapshot is corrupt.
+         */
+        bool validate();
+
+        /**@brief Decode the components of a family, families of unreported component types or with a different layout hash get skipped.
+         */
+        void decode_family(ecs::EcsRegistry& registry, size_type family);
+
+        /**@brief Whether the components of a family may be decoded on another thread than the one calling integrate.
+         */
+        L_NODISCARD bool concurrent_decode(ecs::EcsRegistry& registry, size_type family) const;
+
+        /**@brief Whether decode_family has been called for a family.
+         */
+        L_NODISCARD bool is_decoded(size_type family) const noexcept;
+
+        /**@brief Create the next batch of entities in depth first order, together with their hierarchy and components.
+         * @note Every family needs to be decoded first.
+         * @param count Maximum amount of entities to create.
+         * @param parent Entity to parent the root of the snapshot to, only used by the first batch.
+         * @return size_type Amount of entities created.
+         */
+        size_type integrate(ecs::EcsRegistry& registry, size_type count, ecs::entity_handle parent);
+
+        L_NODISCARD size_type entity_count() const noexcept;
+        L_NODISCARD size_type family_count() const noexcept;
+
+        /**@brief Entities created so far, in the order of the snapshot.
+         */
+        L_NODISCARD const ecs::entity_container& entities() const noexcept;
+
+        /**@brief Whether all entities have been created.
+         */
+        L_NODISCARD bool is_done() const noexcept;
+
+        /**@brief Root entity of the snapshot, invalid until the first batch has been integrated.
+         */
+        L_NODISCARD ecs::entity_handle root() const noexcept;
+    };
+
+    /**@class SceneSnapshot
+     * @brief Reads and writes binary scene snapshots.
+     * @note Components are stored according to ecs::snapshot_encoding_of, trivially copyable families load with a single memcpy.
+     *       Every family stores the layout hash of its component type, families whose layout changed since the snapshot was written get skipped.
+     *       Snapshots are only valid for builds with the same endianness as the build that wrote them.
+     */
+    class SceneSnapshot
+    {
+    public:
+        /**@brief Encode the entity subtree of root into a snapshot.
+         */
+        L_NODISCARD static std::vector<byte> write(ecs::EcsRegistry& registry, ecs::entity_handle root);
+
+        /**@brief Write the entity subtree of root to a snapshot file.
+         * @return bool True if the file was written.
+         */
+        static bool save(ecs::EcsRegistry& registry, const std::string& path, ecs::entity_handle root);
+
+        /**@brief Create the entities of a snapshot.
+         * @param parent Entity to parent the root of the snapshot to.
+         * @return ecs::entity_handle The root entity of the snapshot, invalid if the data isn't a valid snapshot.
+         */
+        static ecs::entity_handle read(ecs::EcsRegistry& registry, const byte* data, size_type size, ecs::entity_handle parent = world_entity_id);
+
+        /**@brief Memory map a snapshot file and create its entities.
+         * @ref legion::core::scenemanagement::SceneSnapshot::read
+         */
+        static ecs::entity_handle load(ecs::EcsRegistry& registry, const std::string& path, ecs::entity_handle parent = world_entity_id);
+    };
+}
@@ -0,0 +1,205 @@
+#include <core/scenemanagement/scene_streamer.hpp>
+#include <core/logging/logging.hpp>
+#include <core/time/clock.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+namespace legion::core::scenemanagement
+{
+    scene_stream_operation detail::stream_repeater::operator()(const std::string& path, ecs::entity_handle parent) const
+    {
+        return streamer->stream(path, parent);
+    }
+
+    scene_stream_operation::scene_stream_operation(const std::shared_ptr<detail::scene_stream>& stream, SceneStreamer* streamer)
+        : async::async_operation<detail::stream_repeater>(stream->progress, detail::stream_repeater{ streamer }), m_stream(stream), m_streamer(streamer) {}
+
+    void scene_stream_operation::wait(async::wait_priority priority) const noexcept
+    {
+        if (!m_stream)
+            return;
+
+        // Nothing else would create the entities while the integrating thread is blocked.
+        if (std::this_thread::get_id() == m_streamer->syncThread())
+        {
+            m_streamer->finish(m_stream);
+            return;
+        }
+
+        async::async_operation<detail::stream_repeater>::wait(priority);
+    }
+
+    ecs::entity_handle scene_stream_operation::root() const noexcept
+    {
+        return m_stream ? ecs::entity_handle(m_stream->root.load(std::memory_order_acquire)) : ecs::entity_handle(invalid_id);
+    }
+
+    bool scene_stream_operation::failed() const noexcept
+    {
+        return m_stream && m_stream->failed.load(std::memory_order_acquire);
+    }
+
+    SceneStreamer::SceneStreamer(ecs::EcsRegistry* registry, scheduling::Scheduler* scheduler)
+        : m_registry(registry), m_scheduler(scheduler), m_syncThread(std::this_thread::get_id()) {}
+
+    scene_stream_operation SceneStreamer::stream(const std::string& path, ecs::entity_handle parent, complete_fn onComplete)
+    {
+        OPTICK_EVENT();
+        auto stream = std::make_shared<detail::scene_stream>();
+        stream->parent = parent;
+        stream->onComplete = onComplete;
+        stream->file = filesystem::mapped_file(path);
+
+        if (!stream->file.is_open() || !stream->loader.open(stream->file.data(), stream->file.size()))
+        {
+            if (!stream->file.is_open())
+                log::error("Could not map scene snapshot {}.", path);
+
+            // Still goes through update so that onComplete gets called on the integrating thread.
+            stream->progress = std::make_shared<async::async_progress>(1);
+            stream->failed.store(true, std::memory_order_release);
+            stream->pendingJobs.store(0, std::memory_order_release);
+        }
+        else
+        {
+            size_type familyCount = stream->loader.family_count();
+            stream->progress = std::make_shared<async::async_progress>(1 + familyCount + stream->loader.entity_count());
+            stream->pendingJobs.store(1 + familyCount, std::memory_order_release);
+
+            m_scheduler->queueJobs(1, [this, stream]()
+                {
+                    if (!stream->loader.validate())
+                    {
+                        stream->failed.store(true, std::memory_order_release);
+                        stream->pendingJobs.store(0, std::memory_order_release);
+                        return;
+                    }
+
+                    m_scheduler->queueJobs(stream->loader.family_count(), [this, stream]()
+                        {
+                            size_type family = async::this_job::get_id();
+                            if (stream->loader.concurrent_decode(*m_registry, family))
+                                stream->loader.decode_family(*m_registry, family);
+
+                            stream->progress->advance_progress();
+                            stream->pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+                        });
+
+                    stream->progress->advance_progress();
+                    stream->pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+                });
+        }
+
+        {
+            std::lock_guard guard(m_streamsLock);
+            m_streams.push_back(stream);
+        }
+
+        return scene_stream_operation(stream, this);
+    }
+
+    bool SceneStreamer::step(detail::scene_stream& stream, size_type count)
+    {
+        OPTICK_EVENT();
+        SnapshotLoader& loader = stream.loader;
+
+        if (!stream.failed.load(std::memory_order_acquire))
+        {
+            if (!stream.syncDecoded)
+            {
+                for (size_type i = 0; i < loader.family_count(); i++)
+                    if (!loader.is_decoded(i))
+                        loader.decode_family(*m_registry, i);
+                stream.syncDecoded = true;
+            }
+
+            size_type created = loader.integrate(*m_registry, count, stream.parent);
+            stream.root.store(loader.root(), std::memory_order_release);
+
+            if (!loader.is_done())
+            {
+                stream.progress->advance_progress(created);
+                return false;
+            }
+        }
+
+        if (!stream.onComplete.isNull())
+            stream.onComplete(ecs::entity_handle(stream.root.load(std::memory_order_relaxed)), loader.entities());
+
+        stream.progress->complete();
+        return true;
+    }
+
+    void SceneStreamer::remove(const std::shared_ptr<detail::scene_stream>& stream)
+    {
+        std::lock_guard guard(m_streamsLock);
+        m_streams.erase(std::remove(m_streams.begin(), m_streams.end(), stream), m_streams.end());
+    }
+
+    void SceneStreamer::setFrameBudget(time::span budget) noexcept
+    {
+        m_frameBudget.store(budget.seconds(), std::memory_order_relaxed);
+    }
+
+    time::span SceneStreamer::getFrameBudget() const noexcept
+    {
+        return time::span(m_frameBudget.load(std::memory_order_relaxed));
+    }
+
+    size_type SceneStreamer::pendingStreams()
+    {
+        std::lock_guard guard(m_streamsLock);
+        return m_streams.size();
+    }
+
+    std::thread::id SceneStreamer::syncThread() const noexcept
+    {
+        return m_syncThread;
+    }
+
+    void SceneStreamer::finish(const std::shared_ptr<detail::scene_stream>& stream)
+    {
+        OPTICK_EVENT();
+        if (stream->progress->is_done())
+            return;
+
+        while (stream->pendingJobs.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        while (!step(*stream, stream->loader.entity_count()));
+        remove(stream);
+    }
+
+    void SceneStreamer::update()
+    {
+        OPTICK_EVENT();
+        std::vector<std::shared_ptr<detail::scene_stream>> streams;
+        {
+            std::lock_guard guard(m_streamsLock);
+            if (m_streams.empty())
+                return;
+            streams = m_streams;
+        }
+
+        time::timer timer;
+        fast_time budget = m_frameBudget.load(std::memory_order_relaxed);
+
+        for (auto& stream : streams)
+        {
+            if (stream->pendingJobs.load(std::memory_order_acquire)) // Still parsing or decoding.
+                continue;
+
+            bool done;
+            do
+                done = step(*stream, batch_size);
+            while (!done && timer.elapsedTime().seconds() < budget);
+
+            if (done)
+                remove(stream);
+
+            if (timer.elapsedTime().seconds() >= budget)
+                break;
+        }
+    }
+}
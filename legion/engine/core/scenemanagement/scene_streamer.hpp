@@ -0,0 +1,156 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <core/types/primitives.hpp>
+#include <core/async/async_operation.hpp>
+#include <core/async/spinlock.hpp>
+#include <core/containers/delegate.hpp>
+#include <core/filesystem/mapped_file.hpp>
+#include <core/scheduling/scheduler.hpp>
+#include <core/scenemanagement/scene_snapshot.hpp>
+#include <core/time/time_span.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file scene_streamer.hpp
+ */
+
+namespace legion::core::scenemanagement
+{
+    class SceneStreamer;
+    struct scene_stream_operation;
+
+    namespace detail
+    {
+        /**@brief State of a single scene that is streaming in, shared between the jobs decoding it, the streamer and the operation handles.
+         */
+        struct scene_stream
+        {
+            using complete_fn = delegate<void(ecs::entity_handle, const ecs::entity_container&)>;
+
+            filesystem::mapped_file file;
+            SnapshotLoader loader;
+            ecs::entity_handle parent;
+            complete_fn onComplete;
+
+            std::shared_ptr<async::async_progress> progress;
+            std::atomic<size_type> pendingJobs;             // Parse and decode jobs that haven't finished yet.
+            std::atomic_bool failed = { false };
+            std::atomic<id_type> root = { invalid_id };     // Set once the first batch has been created.
+            bool syncDecoded = false;                       // Whether the families that can't be decoded on workers are decoded.
+        };
+
+        /**@brief Repeater of scene_stream_operation, streams in another scene.
+         */
+        struct stream_repeater
+        {
+            SceneStreamer* streamer;
+
+            scene_stream_operation operator()(const std::string& path, ecs::entity_handle parent = world_entity_id) const;
+        };
+    }
+
+    /**@class scene_stream_operation
+     * @brief Handle to a scene that is streaming in, progress goes from parsing through decoding to the amount of entities created.
+     */
+    struct scene_stream_operation : public async::async_operation<detail::stream_repeater>
+    {
+    private:
+        std::shared_ptr<detail::scene_stream> m_stream;
+        SceneStreamer* m_streamer = nullptr;
+
+    public:
+        scene_stream_operation(const std::shared_ptr<detail::scene_stream>& stream, SceneStreamer* streamer);
+        scene_stream_operation(const scene_stream_operation&) = default;
+        scene_stream_operation(scene_stream_operation&&) = default;
+
+        /**@brief Wait for the scene to finish streaming in.
+         * @note Waiting on the thread that integrates the streams creates the rest of the scene right away, ignoring the frame budget.
+         */
+        virtual void wait(async::wait_priority priority = async::wait_priority_normal) const noexcept override;
+
+        /**@brief Root entity of the scene, valid as soon as the first batch of entities has been created.
+         */
+        L_NODISCARD ecs::entity_handle root() const noexcept;
+
+        /**@brief Whether the scene couldn't be loaded, only meaningful once the operation is done.
+         */
+        L_NODISCARD bool failed() const noexcept;
+    };
+
+    /**@class SceneStreamer
+     * @brief Loads binary scene snapshots without stalling the frame.
+     *        Parsing and decoding happens in jobs on the worker threads, the entities get created in batches at the end of the
+     *        main thread's frame until the frame budget runs out. The streamed entities show up in queries batch by batch.
+     * @ref legion::core::scenemanagement::SnapshotLoader
+     */
+    class SceneStreamer
+    {
+    public:
+        using complete_fn = detail::scene_stream::complete_fn;
+
+        /**@brief Amount of entities created at once, the frame budget is checked between batches.
+         */
+        static constexpr size_type batch_size = 256;
+
+        /**@brief Time spent creating entities per frame unless changed with setFrameBudget.
+         */
+        static constexpr fast_time default_frame_budget = 0.002f;
+
+    private:
+        ecs::EcsRegistry* m_registry;
+        scheduling::Scheduler* m_scheduler;
+        std::thread::id m_syncThread;
+        std::atomic<fast_time> m_frameBudget = { default_frame_budget };
+
+        async::spinlock m_streamsLock;
+        std::vector<std::shared_ptr<detail::scene_stream>> m_streams;
+
+        /**@brief Create the next batch of entities of a stream.
+         * @return bool True if the stream is done, either because all entities were created or because it failed.
+         */
+        bool step(detail::scene_stream& stream, size_type count);
+
+        void remove(const std::shared_ptr<detail::scene_stream>& stream);
+
+    public:
+        /**@brief Creates a streamer that integrates on the calling thread.
+         */
+        SceneStreamer(ecs::EcsRegistry* registry, scheduling::Scheduler* scheduler);
+
+        /**@brief Start streaming in a scene snapshot file.
+         * @note The file gets mapped and its header read on the calling thread, everything else happens in jobs and during update.
+         * @param path Path of the snapshot file.
+         * @param parent Entity to parent the root of the scene to, the root gets attached as soon as the first batch is created.
+         * @param onComplete Called on the integrating thread once every entity has been created, or with an invalid root if loading failed.
+         */
+        scene_stream_operation stream(const std::string& path, ecs::entity_handle parent = world_entity_id, complete_fn onComplete = {});
+
+        /**@brief Set the time spent creating entities per frame, at least one batch gets created every frame regardless.
+         */
+        void setFrameBudget(time::span budget) noexcept;
+        L_NODISCARD time::span getFrameBudget() const noexcept;
+
+        /**@brief Amount of scenes that are still streaming in.
+         */
+        L_NODISCARD size_type pendingStreams();
+
+        /**@brief Thread that integrates the streams.
+         */
+        L_NODISCARD std::thread::id syncThread() const noexcept;
+
+        /**@brief Create the entities of a stream right away.
+         * @note Must be called on the integrating thread.
+         */
+        void finish(const std::shared_ptr<detail::scene_stream>& stream);
+
+        /**@brief Create batches of the ready streams until the frame budget is used up.
+         * @note Subscribed to the end of the main thread's frame by the engine.
+         */
+        void update();
+    };
+}
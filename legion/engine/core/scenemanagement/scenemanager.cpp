@@ -1,14 +1,19 @@
 #include <core/scenemanagement/components/scene.hpp>
+#include <core/scenemanagement/scene_snapshot.hpp>
+#include <core/filesystem/mapped_file.hpp>
 #include <core/serialization/serializationUtil.hpp>
 #include <core/logging/logging.hpp>
 #include <core/common/string_extra.hpp>
 #include <core/defaults/defaultcomponents.hpp>
+
+#include <filesystem>
 //#include <rendering/components/camera.hpp>
 
 
 namespace legion::core::scenemanagement
 {
     ecs::EcsRegistry* SceneManager::m_ecs;
+    SceneStreamer* SceneManager::m_streamer;
     int SceneManager::sceneCount;
     ecs::component_handle<scene> SceneManager::currentScene;
     std::unordered_map<id_type, std::string> SceneManager::sceneNames;
@@ -92,13 +97,22 @@ namespace legion::core::scenemanagement
         }
     }
 
+    bool SceneManager::has_current_snapshot(const std::string& path)
+    {
+        std::error_code error;
+        auto snapshotTime = std::filesystem::last_write_time(path + snapshot_extension, error);
+        if (error)
+            return false;
+
+        auto jsonTime = std::filesystem::last_write_time(path, error);
+        return error || snapshotTime >= jsonTime; // Snapshots of scenes without a JSON file can't be stale.
+    }
+
     ecs::component_handle<scene> SceneManager::load_scene(const std::string& name)
     {
         std::string filename = name;
         if (!common::ends_with(filename, ".cornflake")) filename += ".cornflake";
 
-        std::ifstream inFile("assets/scenes/" + filename);
-
         auto hry = world.read_component<hierarchy>();
         log::debug("Child Count Before: {}", hry.children.size());
         for (auto child : hry.children)
@@ -110,7 +124,29 @@ namespace legion::core::scenemanagement
         world.write_component(hry);
         log::debug("Child Count After: {}", world.child_count());
 
-        auto sceneEntity = serialization::SerializationUtil::JSONDeserialize<ecs::entity_handle>(inFile);
+        std::string path = "assets/scenes/" + filename;
+        ecs::entity_handle sceneEntity;
+        if (has_current_snapshot(path))
+        {
+            filesystem::mapped_file snapshot(path + snapshot_extension);
+            if (snapshot.is_open())
+                sceneEntity = SceneSnapshot::read(*m_ecs, snapshot.data(), snapshot.size());
+        }
+
+        if (!sceneEntity)
+        {
+            std::ifstream inFile(path);
+            sceneEntity = serialization::SerializationUtil::JSONDeserialize<ecs::entity_handle>(inFile);
+            inFile.close();
+
+            // The snapshot is missing, stale or unreadable, replace it so the next load doesn't have to parse the JSON again.
+            if (sceneEntity && !SceneSnapshot::save(*m_ecs, path + snapshot_extension, sceneEntity))
+            {
+                std::error_code error;
+                std::filesystem::remove(path + snapshot_extension, error);
+            }
+        }
+
         currentScene = sceneEntity.get_component_handle<scene>();
 
         for (auto& [id, fn] : m_additionalLoaders)
@@ -142,12 +178,61 @@ namespace legion::core::scenemanagement
         return sceneEntity.get_component_handle<scene>();
     }
 
+    scene_stream_operation SceneManager::load_scene_async(const std::string& name)
+    {
+        std::string filename = name;
+        if (!common::ends_with(filename, ".cornflake")) filename += ".cornflake";
+
+        std::string path = "assets/scenes/" + filename;
+        if (!has_current_snapshot(path))
+        {
+            std::error_code error;
+            if (std::filesystem::remove(path + snapshot_extension, error))
+                log::warn("Deleted the snapshot of {}, it is older than the JSON file of the scene.", filename);
+        }
+
+        return m_streamer->stream(path + snapshot_extension, world, SceneStreamer::complete_fn::create<&SceneManager::on_scene_streamed>());
+    }
+
+    SceneStreamer& SceneManager::get_streamer()
+    {
+        return *m_streamer;
+    }
+
+    void SceneManager::on_scene_streamed(ecs::entity_handle sceneEntity, const ecs::entity_container& entities)
+    {
+        if (!sceneEntity)
+            return;
+
+        auto sceneHandle = sceneEntity.get_component_handle<scene>();
+        if (sceneHandle)
+        {
+            sceneList[sceneHandle.read().id] = sceneHandle;
+            if (!currentScene)
+                currentScene = sceneHandle;
+        }
+
+        // Only the streamed entities, the rest of the world has been through the loaders already.
+        for (auto& [id, fn] : m_additionalLoaders)
+            for (auto& entity : entities)
+                if (entity.has_component(id))
+                    fn(entity);
+    }
+
     ecs::component_handle<scene> SceneManager::save_scene(const std::string& name, ecs::entity_handle& ent)
     {
         std::ofstream outFile("assets/scenes/" + name + ".cornflake");
         outFile.clear();
         serialization::SerializationUtil::JSONSerialize<ecs::entity_handle>(outFile, ent);
         outFile.close();
+
+        // A snapshot that failed to write would be stale or truncated.
+        std::string snapshotPath = "assets/scenes/" + name + ".cornflake" + snapshot_extension;
+        if (!SceneSnapshot::save(*m_ecs, snapshotPath, ent))
+        {
+            std::error_code error;
+            std::filesystem::remove(snapshotPath, error);
+        }
         return ent.get_component_handle<scene>();
     }
 
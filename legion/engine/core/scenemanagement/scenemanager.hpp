@@ -3,6 +3,7 @@
 #include <core/ecs/component_handle.hpp>
 #include <core/filesystem/filesystem.hpp>
 #include <core/filesystem/view.hpp>
+#include <core/scenemanagement/scene_streamer.hpp>
 #include <tinygltf/json.hpp>
 
 /**
@@ -20,9 +21,24 @@ namespace legion::core::scenemanagement
     private:
         static std::unordered_map<id_type, additional_loader_fn> m_additionalLoaders;
         static ecs::EcsRegistry* m_ecs;
+        static SceneStreamer* m_streamer;
+
+        /**@brief Registers a streamed in scene and runs the additional loaders on its entities.
+         */
+        static void on_scene_streamed(ecs::entity_handle sceneEntity, const ecs::entity_container& entities);
+
+        /**@brief Whether the snapshot of a scene exists and was written after its JSON file, snapshots older than the JSON file are stale.
+         * @param path Path of the .cornflake file.
+         */
+        static bool has_current_snapshot(const std::string& path);
 
     public:
 
+        /**@brief Extension appended to the .cornflake file name for the binary snapshot of a scene.
+         * @ref legion::core::scenemanagement::SceneSnapshot
+         */
+        static constexpr cstring snapshot_extension = ".snapshot";
+
         static int sceneCount;
         static ecs::component_handle<scene> currentScene;
         static std::unordered_map<id_type, std::string> sceneNames;
@@ -74,12 +90,27 @@ namespace legion::core::scenemanagement
         static ecs::component_handle<scene> create_scene(const std::string& name, ecs::entity_handle& ent);
 
         /**@brief Deserializes the scene from the disk.
+         * @note Loads the binary snapshot of the scene if it is newer than the JSON file, otherwise the JSON file after which the snapshot gets rewritten.
          * @param name The name of the file to deserialize.
          * @returns bool Signifying whether it was successful.
          */
         static ecs::component_handle<scene> load_scene(const std::string& name);
 
-        /**@brief Serializes a scene to disk
+        /**@brief Streams the binary snapshot of a scene in over the next frames while the game keeps running.
+         * @note Unlike load_scene the current scene stays loaded, the streamed scene gets added to the world next to it.
+         *       Scenes without a snapshot can't be streamed, save_scene writes one. Snapshots older than the JSON file of the scene get deleted
+         *       instead of streamed, load_scene writes a new one.
+         * @param name The name of the scene to stream in.
+         * @returns scene_stream_operation Handle to track the progress with, the scene is registered and loaded once it's done.
+         * @ref legion::core::scenemanagement::SceneStreamer
+         */
+        static scene_stream_operation load_scene_async(const std::string& name);
+
+        /**@brief Gets the streamer that streams in the scenes for load_scene_async.
+         */
+        static SceneStreamer& get_streamer();
+
+        /**@brief Serializes a scene to disk, both as JSON and as binary snapshot.
           * @param name string of the name of the scene you wish to save.
           * @param ent a specific entity to serialize.
           * @returns bool Signifying whether it was successful.
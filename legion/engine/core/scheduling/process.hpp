@@ -4,7 +4,9 @@
 #include <core/containers/containers.hpp>
 #include <core/time/time.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
+
+#include <atomic>
 
 /**@file process.hpp
  */
@@ -28,6 +30,20 @@ namespace legion::core::scheduling
         time::clock<fast_time> m_clock;
         bool m_fixedTimeStep;
         bool firstStep = true;
+
+        hashed_sparse_set<id_type> m_reads;
+        hashed_sparse_set<id_type> m_writes;
+        bool m_declaredAccess = false;
+
+        // Increased every time any process changes its declared access, process chains use it to detect that their dependency graph is outdated.
+        static std::atomic<size_type> m_accessVersion;
+
+        void markAccessChanged()
+        {
+            m_declaredAccess = true;
+            m_accessVersion.fetch_add(1, std::memory_order_relaxed);
+        }
+
     public:
 
         template<size_type charc>
@@ -46,6 +62,74 @@ namespace legion::core::scheduling
 
         bool inUse() const { return m_hooks.size(); }
 
+        /**@brief Declare that the operation reads certain component types.
+         * @note Processes that declare their access can run concurrently with other non-conflicting processes of the same chain on worker threads.
+         *       Processes that don't declare anything always run alone on the thread of the chain.
+         */
+        template<typename... component_types>
+        Process& reads()
+        {
+            (m_reads.insert(typeHash<component_types>()), ...);
+            markAccessChanged();
+            return *this;
+        }
+
+        /**@brief Declare that the operation reads certain component types, for example all the types of a query.
+         */
+        Process& reads(const hashed_sparse_set<id_type>& componentTypes)
+        {
+            for (id_type componentTypeId : componentTypes)
+                m_reads.insert(componentTypeId);
+            markAccessChanged();
+            return *this;
+        }
+
+        /**@brief Declare that the operation writes certain component types.
+         * @note Writing also counts as reading.
+         */
+        template<typename... component_types>
+        Process& writes()
+        {
+            (m_writes.insert(typeHash<component_types>()), ...);
+            markAccessChanged();
+            return *this;
+        }
+
+        /**@brief Declare that the operation writes certain component types, for example all the types of a query.
+         */
+        Process& writes(const hashed_sparse_set<id_type>& componentTypes)
+        {
+            for (id_type componentTypeId : componentTypes)
+                m_writes.insert(componentTypeId);
+            markAccessChanged();
+            return *this;
+        }
+
+        /**@brief Whether the process declared which components it accesses.
+         */
+        bool declaresAccess() const noexcept { return m_declaredAccess; }
+
+        /**@brief Whether the two processes may not run at the same time.
+         *        True if either of them didn't declare its access or if one writes a component type the other accesses.
+         */
+        bool conflictsWith(const Process& other) const
+        {
+            if (!m_declaredAccess || !other.m_declaredAccess)
+                return true;
+
+            for (id_type componentTypeId : m_writes)
+                if (other.m_writes.contains(componentTypeId) || other.m_reads.contains(componentTypeId))
+                    return true;
+
+            for (id_type componentTypeId : other.m_writes)
+                if (m_reads.contains(componentTypeId))
+                    return true;
+
+            return false;
+        }
+
+        static size_type accessVersion() noexcept { return m_accessVersion.load(std::memory_order_relaxed); }
+
         /**@brief Set the operation for the process to execute at the set interval.
          */
         void setOperation(delegate<void(time::time_span<fast_time>)>&& operation)
@@ -3,6 +3,7 @@
 #include <core/scheduling/scheduler.hpp>
 #include <core/common/exception.hpp>
 #include <thread>
+#include <algorithm>
 
 #include <core/logging/logging.hpp>
 
@@ -11,6 +12,7 @@ namespace legion::core::scheduling
     async::rw_spinlock ProcessChain::m_callbackLock;
     multicast_delegate<void()> ProcessChain::m_onFrameStart;
     multicast_delegate<void()> ProcessChain::m_onFrameEnd;
+    std::atomic<size_type> Process::m_accessVersion = { 0 };
 
     void ProcessChain::threadedRun(ProcessChain* chain)
     {
@@ -47,7 +49,10 @@ namespace legion::core::scheduling
             }
 #endif
 
-            chain->runInCurrentThread(); // Execute all processes.
+            {
+                LEGION_TRACE_SCOPE("Frame"); // Chain threads are named after their chain, so this marks the frames of each chain.
+                chain->runInCurrentThread(); // Execute all processes.
+            }
 
             if (chain->m_scheduler->syncRequested()) // Sync if requested.
                 chain->m_scheduler->waitForProcessSync();
@@ -99,16 +104,46 @@ namespace legion::core::scheduling
             m_onFrameStart();
         }
 
-        hashed_sparse_set<id_type> finishedProcesses;
+        events::EventBus* eventBus = m_scheduler->getEventBus();
+        eventBus->dispatchEvents(events::dispatch_point(m_nameHash, events::dispatch_phase::chain_start));
+
         async::readonly_guard guard(m_processesLock); // Hooking more processes whilst executing isn't allowed.
+
+        if (m_graphDirty || m_graphVersion != Process::accessVersion())
+            buildGraph();
+
+        float timeScale = m_scheduler->getTimeScale();
+        std::vector<byte> finishedProcesses(m_order.size(), false);
+        size_type finishedCount = 0;
+
         do
         {
-            for (auto [id, process] : m_processes)
-                if (!finishedProcesses.contains(id))
-                    if (process->execute(m_scheduler->getTimeScale())) // If the process wasn't finished then execute it and check if it's finished now.
-                        finishedProcesses.insert(id);
+            for (auto& level : m_levels)
+            {
+                if (level.size() == 1) // Processes that run alone run on the thread of the chain.
+                {
+                    size_type index = level[0];
+                    if (!finishedProcesses[index])
+                        finishedProcesses[index] = m_order[index]->execute(timeScale); // If the process wasn't finished then execute it and check if it's finished now.
+                    continue;
+                }
+
+                OPTICK_EVENT("Run concurrent processes");
+                m_scheduler->queueJobs(level.size(), [&]()
+                    {
+                        size_type index = level[async::this_job::get_id()];
+                        if (!finishedProcesses[index])
+                            finishedProcesses[index] = m_order[index]->execute(timeScale);
+                    }).wait();
+            }
+
+            finishedCount = 0;
+            for (byte finished : finishedProcesses)
+                finishedCount += finished ? 1 : 0;
 
-        } while (finishedProcesses.size() != m_processes.size() && !m_exit->load(std::memory_order_acquire));
+        } while (finishedCount != m_order.size() && !m_exit->load(std::memory_order_acquire));
+
+        eventBus->dispatchEvents(events::dispatch_point(m_nameHash, events::dispatch_phase::chain_end));
 
         {
             async::readonly_guard guard(m_callbackLock);
@@ -116,12 +151,43 @@ namespace legion::core::scheduling
         }
     }
 
+    void ProcessChain::buildGraph()
+    {
+        OPTICK_EVENT();
+        m_graphVersion = Process::accessVersion();
+        m_graphDirty = false;
+
+        m_order.clear();
+        for (auto [id, process] : m_processes)
+            m_order.push_back(process);
+
+        // The level of a process is one deeper than the deepest earlier process it conflicts with.
+        std::vector<size_type> depths(m_order.size(), 0);
+        size_type levelCount = 0;
+        for (size_type i = 0; i < m_order.size(); i++)
+        {
+            for (size_type j = 0; j < i; j++)
+                if (depths[j] + 1 > depths[i] && m_order[i]->conflictsWith(*m_order[j]))
+                    depths[i] = depths[j] + 1;
+
+            levelCount = std::max(levelCount, depths[i] + 1);
+        }
+
+        m_levels.clear();
+        m_levels.resize(levelCount);
+        for (size_type i = 0; i < m_order.size(); i++)
+            m_levels[depths[i]].push_back(i);
+    }
+
     void ProcessChain::addProcess(Process* process)
     {
         OPTICK_EVENT();
         async::readwrite_guard guard(m_processesLock);
         if (m_processes.insert(process->id(), process).second)
+        {
             process->m_hooks.insert(m_nameHash);
+            m_graphDirty = true;
+        }
     }
 
     void ProcessChain::removeProcess(Process* process)
@@ -129,6 +195,9 @@ namespace legion::core::scheduling
         OPTICK_EVENT();
         async::readwrite_guard guard(m_processesLock);
         if (m_processes.erase(process->id()))
+        {
             process->m_hooks.erase(m_nameHash);
+            m_graphDirty = true;
+        }
     }
 }
@@ -6,6 +6,7 @@
 #include <core/async/transferable_atomic.hpp>
 
 #include <thread>
+#include <vector>
 
 /**@file processchain.hpp
  */
@@ -29,7 +30,18 @@ namespace legion::core::scheduling
 		async::rw_spinlock m_processesLock;
 		sparse_map<id_type, Process*> m_processes;
 		async::transferable_atomic<bool> m_exit;
-        bool m_low_power;
+        bool m_low_power = false;
+
+        // Dependency graph of the processes flattened into levels. Processes within a level don't conflict and can run at the same time,
+        // every level only starts once the previous one has finished.
+        std::vector<Process*> m_order;
+        std::vector<std::vector<size_type>> m_levels;
+        bool m_graphDirty = true;
+        size_type m_graphVersion = 0;
+
+        /**@brief Rebuild the dependency graph from the declared component access of the processes. Requires read permission on m_processesLock.
+         */
+        void buildGraph();
 
         static async::rw_spinlock m_callbackLock;
         static multicast_delegate<void()> m_onFrameStart;
@@ -105,6 +117,8 @@ namespace legion::core::scheduling
 
 		/**@brief Runs one iteration of the process-chains program loop without creating a new thread.
 		 * @note Loops through all hooked processes and executes them until they are all finished.
+		 * @note Processes that declared their component access run concurrently on the worker threads with all other processes they don't conflict with.
+		 *       Processes that conflict keep the order in which they were hooked. ref: Process::reads(), Process::writes()
 		 */
 		void runInCurrentThread();
 
@@ -13,8 +13,20 @@ namespace legion::core::scheduling
     async::rw_spinlock Scheduler::m_availabilityLock;
     uint Scheduler::m_availableThreads = static_cast<uint>(math::ceil((m_maxThreadCount * 0.5f) - reserved_threads) + math::epsilon<float>()); // subtract OS and this_thread, and then leave some extra for miscellaneous processes.
 
-    async::rw_spinlock Scheduler::m_jobQueueLock;
-    std::queue<std::shared_ptr<async::job_pool_base>> Scheduler::m_jobs;
+    std::vector<std::unique_ptr<Scheduler::job_queue>> Scheduler::m_jobQueues;
+    std::atomic<size_type> Scheduler::m_nextJobQueue = { 0 };
+    std::atomic<size_type> Scheduler::m_nextPushQueue = { 0 };
+    thread_local Scheduler::job_queue* Scheduler::m_localJobQueue = nullptr;
+
+    std::mutex Scheduler::m_idleMutex;
+    std::condition_variable Scheduler::m_idleCondition;
+    std::atomic<uint> Scheduler::m_idleThreads = { 0 };
+
+    namespace
+    {
+        // Amount of idle iterations a worker keeps polling for work before it parks.
+        constexpr uint idle_poll_iterations = 64;
+    }
     std::unordered_map<std::thread::id, async::rw_spinlock> Scheduler::m_commandLocks;
     std::unordered_map<std::thread::id, std::queue<std::unique_ptr<runnable_base>>> Scheduler::m_commands;
 
@@ -30,6 +42,11 @@ namespace legion::core::scheduling
                 std::this_thread::yield();
         }
 
+        size_type queueIndex = m_nextJobQueue.fetch_add(1, std::memory_order_acq_rel); // Synchronizes with the creation of the queues.
+        if (queueIndex < m_jobQueues.size())
+            m_localJobQueue = m_jobQueues[queueIndex].get();
+
+        uint idleIterations = 0;
 
         while (!(*exit))
         {
@@ -54,64 +71,138 @@ namespace legion::core::scheduling
                     async::readwrite_guard guard(m_commandLocks[id], async::wait_priority_normal);
                     m_commands[id].pop();
                 }
-                instruction = nullptr;
+                idleIterations = 0;
             }
 
+            if (executeJobs(true))
+            {
+                idleIterations = 0;
+            }
+            else if (!instruction)
             {
-                OPTICK_EVENT("Fetching job");
-                async::readonly_guard guard(m_jobQueueLock, async::wait_priority_normal);
-                if (!m_jobs.empty())
+                if (idleIterations < idle_poll_iterations)
                 {
-                    instruction = m_jobs.front()->pop_job();
+                    idleIterations++;
+                    if (lowPower)
+                        std::this_thread::sleep_for(std::chrono::microseconds(1));
+                    else
+                        std::this_thread::yield();
+                }
+                else
+                {
+                    // Park until new work gets pushed. The timeout covers work that got pushed right before this thread registered as idle.
+                    OPTICK_CATEGORY("Parked", Optick::Category::Wait);
+                    std::unique_lock<std::mutex> lock(m_idleMutex);
+                    m_idleThreads.fetch_add(1, std::memory_order_relaxed);
+                    m_idleCondition.wait_for(lock, lowPower ? std::chrono::microseconds(1000) : std::chrono::microseconds(100));
+                    m_idleThreads.fetch_sub(1, std::memory_order_relaxed);
                 }
             }
+        }
+    }
 
-            if (instruction)
+    void Scheduler::pushJobPool(std::shared_ptr<async::job_pool_base>&& jobPool)
+    {
+        job_queue* queue = m_localJobQueue;
+        if (!queue)
+        {
+            size_type queueCount = m_jobQueues.size();
+            if (!queueCount) // No scheduler running yet, nobody else would ever pick the jobs up.
             {
-                async::readonly_guard guard(m_jobQueueLock);
-                auto pool = m_jobs.front();
-                while (instruction && !pool->is_done())
-                {
-                    {
-                        OPTICK_EVENT("Executing job");
-                        instruction->execute();
-                    }
-
-                    {
-                        OPTICK_EVENT("Fetching job");
-                        pool->complete_job();
-                        instruction = pool->pop_job();
-                        if (!instruction)
-                        {
-                            tryCompleteJobPool();
-                        }
-                    }
-                }
+                while (jobPool->execute_job())
+                    continue;
+                return;
             }
-            else
+
+            // Threads without a queue of their own spread their pools over the queues of the workers in turn.
+            queue = m_jobQueues[m_nextPushQueue.fetch_add(1, std::memory_order_relaxed) % queueCount].get();
+        }
+
+        {
+            std::lock_guard guard(queue->lock);
+            queue->pools.push_back(std::move(jobPool));
+            queue->poolCount.store(queue->pools.size(), std::memory_order_release);
+        }
+
+        wakeIdleThreads();
+    }
+
+    bool Scheduler::executeJobsFrom(job_queue& queue, bool newest, bool drain)
+    {
+        if (!queue.poolCount.load(std::memory_order_acquire)) // Don't contend on the lock of queues that have nothing to offer.
+            return false;
+
+        std::shared_ptr<async::job_pool_base> pool;
+
+        {
+            std::lock_guard guard(queue.lock);
+            while (!queue.pools.empty())
             {
-                if (lowPower)
+                auto& candidate = newest ? queue.pools.back() : queue.pools.front();
+                if (!candidate->empty())
                 {
-                    std::this_thread::sleep_for(std::chrono::microseconds(1));
+                    pool = candidate;
+                    break;
                 }
+
+                // All jobs of this pool have been handed out, other threads that are still executing jobs of it keep it alive.
+                if (newest)
+                    queue.pools.pop_back();
                 else
-                {
-                    std::this_thread::yield();
-                }
+                    queue.pools.pop_front();
             }
+            queue.poolCount.store(queue.pools.size(), std::memory_order_release);
         }
+
+        if (!pool)
+            return false;
+
+        OPTICK_EVENT("Executing jobs");
+        bool executed = false;
+        while (pool->execute_job())
+        {
+            executed = true;
+            if (!drain)
+                break;
+        }
+
+        return executed;
     }
 
-    void Scheduler::tryCompleteJobPool()
+    bool Scheduler::executeJobs(bool drain)
     {
-        async::readwrite_guard wguard(m_jobQueueLock);
-        if (!m_jobs.empty())
+        if (m_localJobQueue && executeJobsFrom(*m_localJobQueue, true, drain))
+            return true;
+
+        size_type queueCount = m_jobQueues.size();
+        if (!queueCount)
+            return false;
+
+        // Every thread starts stealing from a different queue so thieves spread out over the victims,
+        // after a successful steal the same victim is tried first again since it's likely to have more work.
+        static thread_local size_type victim = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+        for (size_type i = 0; i < queueCount; i++)
         {
-            if (m_jobs.front()->is_done())
+            size_type index = (victim + i) % queueCount;
+            job_queue& queue = *m_jobQueues[index];
+            if (&queue == m_localJobQueue)
+                continue;
+
+            if (executeJobsFrom(queue, false, drain))
             {
-                m_jobs.pop();
+                victim = index;
+                return true;
             }
         }
+
+        return false;
+    }
+
+    void Scheduler::wakeIdleThreads()
+    {
+        if (m_idleThreads.load(std::memory_order_relaxed))
+            m_idleCondition.notify_all();
     }
 
     Scheduler::Scheduler(events::EventBus* eventBus, bool lowPower, uint minThreads) : m_eventBus(eventBus), m_lowPower(lowPower)
@@ -128,13 +219,22 @@ namespace legion::core::scheduling
         async::rw_spinlock::force_release(false);
         async::spinlock::force_release(false);
 
+        size_type threadCount = 0;
         std::thread::id id;
         while ((id = createThread(threadMain, &m_threadsShouldTerminate, &m_threadsShouldStart, m_lowPower)) != invalid_thread_id)
         {
             m_commands[id];
             m_commandLocks[id];
+            threadCount++;
         }
 
+        // One job queue for every thread and one for this thread.
+        m_jobQueues.clear();
+        for (size_type i = 0; i <= threadCount; i++)
+            m_jobQueues.push_back(std::make_unique<job_queue>());
+        m_localJobQueue = m_jobQueues[0].get();
+        m_nextJobQueue.store(1, std::memory_order_release);
+
         m_threadsShouldStart = true;
 
         addProcessChain("Update");
@@ -249,6 +349,12 @@ namespace legion::core::scheduling
             if (m_localChain.id()) // If the local chain is valid run an iteration.
                 m_localChain.runInCurrentThread();
 
+            {
+                OPTICK_EVENT("Frame end callbacks");
+                async::readonly_guard guard(m_frameEndLock);
+                m_onFrameEnd();
+            }
+
             if (syncRequested()) // If a major engine sync was requested halt thread until all threads have reached a sync point and let them all continue.
                 waitForProcessSync();
         }
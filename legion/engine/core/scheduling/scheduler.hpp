@@ -11,7 +11,7 @@
 #include <core/async/async_runnable.hpp>
 #include <core/async/thread_util.hpp>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 #include <memory>
 #include <thread>
@@ -19,6 +19,9 @@
 #include <sstream>
 #include <limits>
 #include <queue>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 /**@file scheduler.hpp
  */
@@ -63,6 +66,9 @@ namespace legion::core::scheduling
 
         std::atomic<float> m_timeScale { 1.f };
 
+        async::rw_spinlock m_frameEndLock;
+        multicast_delegate<void()> m_onFrameEnd;
+
         events::EventBus* m_eventBus;
 
         bool m_threadsShouldTerminate = false;
@@ -76,14 +82,50 @@ namespace legion::core::scheduling
         static async::rw_spinlock m_availabilityLock;
         static uint m_availableThreads;
 
-        static async::rw_spinlock m_jobQueueLock;
-        static std::queue<std::shared_ptr<async::job_pool_base>> m_jobs;
+        /**@brief Job pools queued by a single thread. The owner works on its newest pools first, other threads steal the oldest pools.
+         * @note Pools stay in the queue until all their jobs are handed out, so multiple threads can work on the same pool at once.
+         */
+        struct job_queue
+        {
+            async::spinlock lock;
+            std::deque<std::shared_ptr<async::job_pool_base>> pools;
+            std::atomic<size_type> poolCount = { 0 }; // Size of pools, readable without taking the lock.
+        };
+
+        static std::vector<std::unique_ptr<job_queue>> m_jobQueues;
+        static std::atomic<size_type> m_nextJobQueue;
+        static std::atomic<size_type> m_nextPushQueue; // Round robin counter for pools pushed by threads without a queue.
+        static thread_local job_queue* m_localJobQueue;
+
+        static std::mutex m_idleMutex;
+        static std::condition_variable m_idleCondition;
+        static std::atomic<uint> m_idleThreads;
+
         static std::unordered_map<std::thread::id, async::rw_spinlock> m_commandLocks;
         static std::unordered_map<std::thread::id, std::queue<std::unique_ptr<runnable_base>>> m_commands;
 
         static void threadMain(bool* exit, bool* start, bool lowPower);
 
-        static void tryCompleteJobPool();
+        /**@brief Push a job pool onto the queue of the current thread, or onto the queues of the workers in turn if this thread has none.
+         * @note Without any queues (no scheduler constructed yet) the jobs get executed right away on the current thread.
+         */
+        static void pushJobPool(std::shared_ptr<async::job_pool_base>&& jobPool);
+
+        /**@brief Execute jobs of a pool from a certain queue.
+         * @param newest Whether to take the newest or the oldest pool of the queue.
+         * @param drain Whether to keep executing jobs of the found pool until it has none left, or to only execute a single job.
+         * @return bool True if any job was executed.
+         */
+        static bool executeJobsFrom(job_queue& queue, bool newest, bool drain);
+
+        /**@brief Execute jobs from the queue of this thread, or steal them from the other queues if this thread has nothing to do.
+         * @return bool True if any job was executed.
+         */
+        static bool executeJobs(bool drain);
+
+        /**@brief Wake up workers that are parked because there was no work.
+         */
+        static void wakeIdleThreads();
 
     public:
 
@@ -105,6 +147,13 @@ namespace legion::core::scheduling
             return m_timeScale.load(std::memory_order_relaxed);
         }
 
+        /**@brief Get the event bus the scheduler reports to.
+         */
+        events::EventBus* getEventBus() noexcept
+        {
+            return m_eventBus;
+        }
+
         /**@brief Run main program loop, also starts all process-chains in their own threads.
          */
         void run();
@@ -149,25 +198,33 @@ namespace legion::core::scheduling
         {
             OPTICK_EVENT("legion::core::scheduling::Scheduler::sendCommand<T>");
             async::async_runnable<Func>* command = new async::async_runnable<Func>(func);
-            async::readwrite_guard guard(m_commandLocks[id]);
-            m_commands[id].push(std::unique_ptr<runnable_base>(command));
+            {
+                async::readwrite_guard guard(m_commandLocks[id]);
+                m_commands[id].push(std::unique_ptr<runnable_base>(command));
+            }
+            wakeIdleThreads();
             return command->getOperation([&](std::thread::id id, auto func) { return sendCommand(id, func); });
         }
 
+        /**@brief Queue a pool of jobs that will be executed by the worker threads.
+         * @note Jobs can queue child jobs themselves, waiting on the returned operation executes other pending jobs in the meantime.
+         * @param count Amount of jobs to execute, use async::this_job::get_id() inside func to get the index of the current job.
+         * @param func Function to execute for every job.
+         */
         template<typename Func>
         auto queueJobs(size_type count, const Func& func)
         {
             auto repeater = [&](size_type count, auto func) { return queueJobs(count, func); };
-            auto onComplete = [&]() {tryCompleteJobPool(); };
+            auto helpExecute = []() { return executeJobs(false); };
 
             if (!count)
-                return async::job_operation<decltype(repeater), decltype(onComplete)>(std::shared_ptr<async::async_progress>(nullptr), std::shared_ptr<async::job_pool_base>(nullptr), repeater, onComplete);
+                return async::job_operation<decltype(repeater), decltype(helpExecute)>(std::shared_ptr<async::async_progress>(nullptr), std::shared_ptr<async::job_pool_base>(nullptr), repeater, helpExecute);
 
             OPTICK_EVENT("legion::core::scheduling::Scheduler::queueJobs<T>");
             std::shared_ptr<async::job_pool_base> jobPool = std::shared_ptr<async::job_pool_base>(new async::job_pool<Func>(count, func));
-            async::readwrite_guard guard(m_jobQueueLock);
-            m_jobs.push(jobPool);
-            return async::job_operation<decltype(repeater), decltype(onComplete)>(jobPool->get_progress(), jobPool, repeater, onComplete);
+            auto operation = async::job_operation<decltype(repeater), decltype(helpExecute)>(jobPool->get_progress(), jobPool, repeater, helpExecute);
+            pushJobPool(std::move(jobPool));
+            return operation;
         }
 
         /**@brief Destroy a thread.
@@ -195,6 +252,15 @@ namespace legion::core::scheduling
          */
         void reportExitWithError(const std::thread::id& id, const std::exception& exc);
 
+        /**@brief Subscribe a member function to be called on the main thread at the end of every main thread frame.
+         */
+        template<typename owner_type, void(owner_type::* func)()>
+        void subscribeToFrameEnd(owner_type* instance)
+        {
+            async::readwrite_guard guard(m_frameEndLock);
+            m_onFrameEnd += delegate<void()>::template create<owner_type, func>(instance);
+        }
+
         void subscribeToSync()
         {
             m_syncLock.subscribe();
@@ -0,0 +1,25 @@
+#pragma once
+#include <core/types/primitives.hpp>
+
+#include <streambuf>
+
+/**
+ * @file memory_streambuf.hpp
+ */
+
+namespace legion::core::serialization
+{
+    /**@class memory_streambuf
+     * @brief Read-only stream buffer over memory owned by someone else, lets std::istream based readers like cereal archives decode
+     *        straight from a memory mapped file without copying it first.
+     */
+    class memory_streambuf : public std::streambuf
+    {
+    public:
+        memory_streambuf(const byte* data, size_type size)
+        {
+            char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+            setg(begin, begin, begin + size);
+        }
+    };
+}
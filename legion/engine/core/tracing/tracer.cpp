@@ -0,0 +1,209 @@
+#include <core/tracing/tracer.hpp>
+#include <core/logging/logging.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+namespace legion::core::tracing
+{
+    std::atomic_bool Tracer::m_enabled = { true };
+    time::clock<time64> Tracer::m_clock;
+
+    std::mutex Tracer::m_buffersLock;
+    std::vector<std::unique_ptr<detail::thread_buffer>> Tracer::m_buffers;
+    thread_local detail::thread_buffer* Tracer::m_localBuffer = nullptr;
+
+    namespace
+    {
+        std::string thread_name(const thread_capture& thread)
+        {
+            if (auto it = log::impl::thread_names.find(thread.threadId); it != log::impl::thread_names.end())
+                return it->second;
+            return "thread " + std::to_string(thread.index);
+        }
+
+        void write_json_string(std::ostream& stream, std::string_view str)
+        {
+            stream << '"';
+            for (char c : str)
+            {
+                switch (c)
+                {
+                case '"': stream << "\\\""; break;
+                case '\\': stream << "\\\\"; break;
+                case '\n': stream << "\\n"; break;
+                case '\t': stream << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                        stream << c;
+                }
+            }
+            stream << '"';
+        }
+
+        template<typename T>
+        void write_binary(std::ostream& stream, T value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void write_binary_string(std::ostream& stream, std::string_view str)
+        {
+            write_binary(stream, static_cast<uint32>(str.size()));
+            stream.write(str.data(), str.size());
+        }
+
+        void write_chrome_json(std::ostream& stream, const std::vector<thread_capture>& threads)
+        {
+            stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+            bool first = true;
+
+            for (auto& thread : threads)
+            {
+                stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.index << ",\"args\":{\"name\":";
+                write_json_string(stream, thread_name(thread));
+                stream << "}}";
+                first = false;
+
+                for (auto& event : thread.events)
+                {
+                    // Chrome trace timestamps are in microseconds, the fraction keeps the nanosecond precision.
+                    stream << ",\n{\"ph\":\"" << (event.begin ? 'B' : 'E') << "\",\"pid\":0,\"tid\":" << thread.index
+                        << ",\"ts\":" << event.timestamp / 1000 << '.' << std::to_string(1000 + event.timestamp % 1000).substr(1);
+                    if (event.begin)
+                    {
+                        stream << ",\"name\":";
+                        write_json_string(stream, event.description->name);
+                        stream << ",\"args\":{\"file\":";
+                        write_json_string(stream, event.description->file);
+                        stream << ",\"line\":" << event.description->line << '}';
+                    }
+                    stream << '}';
+                }
+            }
+
+            stream << "\n]}\n";
+        }
+
+        void write_binary_capture(std::ostream& stream, const std::vector<thread_capture>& threads)
+        {
+            std::unordered_map<const event_description*, uint32> descriptionIndices;
+            std::vector<const event_description*> descriptions;
+            for (auto& thread : threads)
+                for (auto& event : thread.events)
+                    if (descriptionIndices.emplace(event.description, static_cast<uint32>(descriptions.size())).second)
+                        descriptions.push_back(event.description);
+
+            stream.write("LGNTRACE", 8);
+            write_binary<uint32>(stream, 1);
+
+            write_binary(stream, static_cast<uint32>(descriptions.size()));
+            for (auto* description : descriptions)
+            {
+                write_binary_string(stream, description->name);
+                write_binary_string(stream, description->file);
+                write_binary(stream, description->line);
+            }
+
+            write_binary(stream, static_cast<uint32>(threads.size()));
+            for (auto& thread : threads)
+            {
+                write_binary(stream, thread.index);
+                write_binary_string(stream, thread_name(thread));
+                write_binary(stream, static_cast<uint32>(thread.events.size()));
+                for (auto& event : thread.events)
+                {
+                    write_binary(stream, descriptionIndices[event.description] | (event.begin ? 0u : 0x80000000u));
+                    write_binary(stream, event.timestamp);
+                }
+            }
+        }
+    }
+
+    void detail::thread_buffer::snapshot(std::vector<trace_event>& events) const
+    {
+        uint64 end = head.load(std::memory_order_acquire);
+        uint64 start = std::max(tail.load(std::memory_order_relaxed), end > trace_buffer_capacity ? end - trace_buffer_capacity : 0);
+
+        std::vector<std::pair<uintptr_t, int64>> copies;
+        copies.reserve(end - start);
+        for (uint64 i = start; i < end; i++)
+        {
+            const record& source = records[i & (trace_buffer_capacity - 1)];
+            copies.emplace_back(source.descriptionAndType.load(std::memory_order_relaxed), source.timestamp.load(std::memory_order_relaxed));
+        }
+
+        // The writer may have lapped the copy, every record it could have been writing to in the meantime is unreliable.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64 newEnd = head.load(std::memory_order_relaxed);
+        uint64 firstValid = newEnd >= trace_buffer_capacity ? newEnd - trace_buffer_capacity + 1 : 0;
+
+        size_type depth = 0;
+        for (uint64 i = std::max(start, firstValid); i < end; i++)
+        {
+            auto [descriptionAndType, timestamp] = copies[i - start];
+            bool begin = (descriptionAndType & 1u) == 0;
+
+            if (begin)
+                depth++;
+            else if (depth)
+                depth--;
+            else
+                continue; // The begin record of this scope was already overwritten.
+
+            events.push_back(trace_event{ reinterpret_cast<const event_description*>(descriptionAndType & ~uintptr_t(1)), timestamp, begin });
+        }
+    }
+
+    detail::thread_buffer& Tracer::createLocalBuffer()
+    {
+        std::lock_guard guard(m_buffersLock);
+        m_buffers.push_back(std::make_unique<detail::thread_buffer>(static_cast<uint32>(m_buffers.size())));
+        m_localBuffer = m_buffers.back().get();
+        return *m_localBuffer;
+    }
+
+    std::vector<thread_capture> Tracer::capture()
+    {
+        std::lock_guard guard(m_buffersLock);
+
+        std::vector<thread_capture> threads;
+        threads.reserve(m_buffers.size());
+        for (auto& buffer : m_buffers)
+        {
+            auto& thread = threads.emplace_back();
+            thread.threadId = buffer->threadId;
+            thread.index = buffer->index;
+            buffer->snapshot(thread.events);
+        }
+        return threads;
+    }
+
+    void Tracer::clear()
+    {
+        std::lock_guard guard(m_buffersLock);
+        for (auto& buffer : m_buffers)
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+
+    void Tracer::write(std::ostream& stream, trace_format format)
+    {
+        auto threads = capture();
+        if (format == trace_format::chrome_json)
+            write_chrome_json(stream, threads);
+        else
+            write_binary_capture(stream, threads);
+    }
+
+    bool Tracer::dump(std::string_view path, trace_format format)
+    {
+        std::ofstream file(std::string(path), format == trace_format::binary ? std::ios::out | std::ios::binary : std::ios::out);
+        if (!file.is_open())
+            return false;
+
+        write(file, format);
+        return true;
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <core/types/primitives.hpp>
+#include <core/time/clock.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @file tracer.hpp
+ * @brief Built-in low overhead tracer that records begin and end events into per thread ring buffers.
+ */
+
+namespace legion::core::tracing
+{
+    /**@brief Amount of records every thread keeps before the oldest ones get overwritten. Needs to be a power of 2.
+     */
+    constexpr size_type trace_buffer_capacity = 1 << 15;
+
+    /**@class event_description
+     * @brief Static description of an instrumented scope, every macro site has exactly one.
+     */
+    struct alignas(8) event_description
+    {
+        cstring name;
+        cstring file;
+        uint32 line;
+    };
+
+    /**@brief Describe an instrumented scope, uses the function name when the name is empty.
+     */
+    L_NODISCARD constexpr event_description describe(cstring function, cstring file, uint32 line, cstring name) noexcept
+    {
+        return event_description{ name[0] ? name : function, file, line };
+    }
+
+    enum struct trace_format { chrome_json, binary };
+
+    /**@class trace_event
+     * @brief Single begin or end record in a capture.
+     */
+    struct trace_event
+    {
+        const event_description* description;
+        int64 timestamp; // Nanoseconds since the tracer started.
+        bool begin;
+    };
+
+    /**@class thread_capture
+     * @brief All the records a single thread had in its buffer at the time of the capture.
+     */
+    struct thread_capture
+    {
+        std::thread::id threadId;
+        uint32 index;
+        std::vector<trace_event> events;
+    };
+
+    namespace detail
+    {
+        /**@class thread_buffer
+         * @brief Ring buffer with a single writer, the owning thread, and any amount of readers taking snapshots.
+         *        Readers discard the records that may have been overwritten while they were copying them.
+         */
+        struct thread_buffer
+        {
+            struct record
+            {
+                std::atomic<uintptr_t> descriptionAndType; // Descriptions are aligned, so the lowest bit marks end records.
+                std::atomic<int64> timestamp;
+            };
+
+            std::unique_ptr<record[]> records = std::make_unique<record[]>(trace_buffer_capacity);
+            std::atomic<uint64> head = { 0 };
+            std::atomic<uint64> tail = { 0 };
+            std::thread::id threadId = std::this_thread::get_id();
+            uint32 index;
+
+            explicit thread_buffer(uint32 threadIndex) : index(threadIndex) {}
+
+            void write(const event_description* description, bool begin, int64 timestamp) noexcept
+            {
+                uint64 position = head.load(std::memory_order_relaxed);
+                record& target = records[position & (trace_buffer_capacity - 1)];
+
+                // Readers that see any part of the new record also need to see that the head moved past the old one.
+                std::atomic_thread_fence(std::memory_order_release);
+                target.descriptionAndType.store(reinterpret_cast<uintptr_t>(description) | (begin ? 0u : 1u), std::memory_order_relaxed);
+                target.timestamp.store(timestamp, std::memory_order_relaxed);
+                head.store(position + 1, std::memory_order_release);
+            }
+
+            void snapshot(std::vector<trace_event>& events) const;
+        };
+    }
+
+    /**@class Tracer
+     * @brief Engine native tracing backend behind the Optick macros when LEGION_TRACING is enabled.
+     *        Every thread records into its own lock free ring buffer, captures can be dumped at any moment as
+     *        Chrome trace_event JSON (chrome://tracing, Perfetto) or as a compact binary format.
+     */
+    class Tracer
+    {
+    private:
+        static std::atomic_bool m_enabled;
+        static time::clock<time64> m_clock;
+
+        static std::mutex m_buffersLock; // Not a spinlock, those are instrumented themselves.
+        static std::vector<std::unique_ptr<detail::thread_buffer>> m_buffers;
+        static thread_local detail::thread_buffer* m_localBuffer;
+
+        static detail::thread_buffer& createLocalBuffer();
+
+    public:
+        /**@brief Start or stop recording, already recorded events stay available.
+         */
+        static void setEnabled(bool enabled) noexcept { m_enabled.store(enabled, std::memory_order_relaxed); }
+        L_NODISCARD static bool isEnabled() noexcept { return m_enabled.load(std::memory_order_relaxed); }
+
+        /**@brief Nanoseconds since the tracer started.
+         */
+        L_NODISCARD static int64 timestamp() noexcept
+        {
+            return m_clock.elapsedTime().nanoseconds<int64>();
+        }
+
+        static void beginEvent(const event_description& description) noexcept
+        {
+            detail::thread_buffer* buffer = m_localBuffer;
+            if (!buffer)
+                buffer = &createLocalBuffer();
+            buffer->write(&description, true, timestamp());
+        }
+
+        static void endEvent(const event_description& description) noexcept
+        {
+            int64 time = timestamp();
+            detail::thread_buffer* buffer = m_localBuffer;
+            if (!buffer)
+                buffer = &createLocalBuffer();
+            buffer->write(&description, false, time);
+        }
+
+        /**@brief Copy the current contents of all thread buffers. Threads can keep recording in the meantime.
+         * @note End records whose begin record was already overwritten are left out.
+         */
+        L_NODISCARD static std::vector<thread_capture> capture();
+
+        /**@brief Forget everything that was recorded up until now.
+         */
+        static void clear();
+
+        /**@brief Write a capture of all threads to a stream.
+         * @note The binary format is little endian and starts with the magic "LGNTRACE" followed by a uint32 version,
+         *       a table of descriptions (uint32 count, then per description the name and file as uint32 size + chars, and a uint32 line),
+         *       and a list of threads (uint32 count, then per thread a uint32 index, the name as uint32 size + chars, a uint32 record count
+         *       and per record a uint32 description index with the highest bit set for end records and an int64 timestamp in nanoseconds).
+         */
+        static void write(std::ostream& stream, trace_format format);
+
+        /**@brief Write a capture of all threads to a file.
+         * @return bool False if the file couldn't be opened.
+         */
+        static bool dump(std::string_view path, trace_format format = trace_format::chrome_json);
+    };
+
+    /**@class scoped_event
+     * @brief Records a begin event on construction and the matching end event on destruction.
+     */
+    class scoped_event
+    {
+    private:
+        const event_description* m_description;
+
+    public:
+        explicit scoped_event(const event_description& description) noexcept
+            : m_description(Tracer::isEnabled() ? &description : nullptr)
+        {
+            if (m_description)
+                Tracer::beginEvent(*m_description);
+        }
+
+        ~scoped_event()
+        {
+            if (m_description)
+                Tracer::endEvent(*m_description);
+        }
+
+        scoped_event(const scoped_event&) = delete;
+        scoped_event& operator=(const scoped_event&) = delete;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <core/platform/platform.hpp>
+#include <Optick/optick.h>
+#include <core/tracing/tracer.hpp>
+
+/**
+ * @file tracing.hpp
+ * @brief Include this instead of Optick directly. With LEGION_TRACING enabled the Optick instrumentation macros record into
+ *        the built-in tracer instead, without LEGION_TRACING and with USE_OPTICK disabled the macros compile to nothing.
+ */
+
+#if LEGION_TRACING
+
+#define LEGION_TRACE_CONCAT_IMPL(x, y) x##y
+#define LEGION_TRACE_CONCAT(x, y) LEGION_TRACE_CONCAT_IMPL(x, y)
+
+/**@def LEGION_TRACE_SCOPE
+ * @brief Record the enclosing scope in the built-in tracer, takes an optional name and otherwise uses the function name.
+ * @note The name has to be a string literal, it gets concatenated with "" so that leaving it out doesn't rely on comma elision.
+ */
+#define LEGION_TRACE_SCOPE(...)                                                                                                                         \
+    static const ::legion::core::tracing::event_description LEGION_TRACE_CONCAT(legion_trace_description_, __LINE__) =                                \
+        ::legion::core::tracing::describe(__FULL_FUNC__, __FILE__, __LINE__, "" __VA_ARGS__);                                                          \
+    ::legion::core::tracing::scoped_event LEGION_TRACE_CONCAT(legion_trace_event_, __LINE__)(LEGION_TRACE_CONCAT(legion_trace_description_, __LINE__))
+
+#undef OPTICK_EVENT
+#undef OPTICK_CATEGORY
+#undef OPTICK_FRAME
+#undef OPTICK_THREAD
+#undef OPTICK_TAG
+#undef OPTICK_EVENT_DYNAMIC
+#undef OPTICK_PUSH_DYNAMIC
+#undef OPTICK_PUSH
+#undef OPTICK_POP
+
+#define OPTICK_EVENT(...) LEGION_TRACE_SCOPE(__VA_ARGS__)
+#define OPTICK_CATEGORY(NAME, CATEGORY) LEGION_TRACE_SCOPE(NAME)
+#define OPTICK_FRAME(NAME, ...) LEGION_TRACE_SCOPE(NAME)
+#define OPTICK_THREAD(THREAD_NAME)
+#define OPTICK_TAG(NAME, ...)
+#define OPTICK_EVENT_DYNAMIC(NAME)
+#define OPTICK_PUSH_DYNAMIC(NAME)
+#define OPTICK_PUSH(NAME)
+#define OPTICK_POP()
+
+#else
+
+#define LEGION_TRACE_SCOPE(...)
+
+#endif
@@ -8,7 +8,7 @@
 #include <string_view>
 #include <cstring>
 
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 /**
  * @file type_util.hpp
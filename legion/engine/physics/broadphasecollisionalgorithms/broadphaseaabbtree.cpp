@@ -0,0 +1,138 @@
+#include <physics/broadphasecollisionalgorithms/broadphaseaabbtree.hpp>
+#include <rendering/debugrendering.hpp>
+
+namespace legion::physics
+{
+    const std::vector<std::vector<physics_manifold_precursor>>& BroadphaseAABBTree::collectPairs(
+        std::vector<physics_manifold_precursor>&& manifoldPrecursors)
+    {
+        OPTICK_EVENT();
+        m_groupings.clear();
+        m_activeProxies.clear();
+        m_frame++;
+
+        {
+            OPTICK_EVENT("Updating tree");
+            for (size_type i = 0; i < manifoldPrecursors.size(); i++)
+            {
+                auto& precursor = manifoldPrecursors[i];
+
+                // If the entity has no colliders, we can skip it
+                std::vector<PhysicsColliderPtr>& colliders = precursor.physicsComp->colliders;
+                if (colliders.size() == 0) continue;
+
+                // Combine the bounds of all the colliders of this physics component
+                std::pair<math::vec3, math::vec3> aabb = colliders.at(0)->GetMinMaxWorldAABB();
+                for (int j = 1; j < colliders.size(); ++j)
+                {
+                    aabb = PhysicsStatics::CombineAABB(colliders.at(j)->GetMinMaxWorldAABB(), aabb);
+                }
+
+                math::vec3 pos = precursor.worldTransform[3];
+                id_type id = precursor.entity;
+
+                int32 proxy;
+                auto itr = m_trackedEntities.find(id);
+                if (itr == m_trackedEntities.end())
+                {
+                    // A new entity has entered the broadphase
+                    proxy = m_tree.createProxy(aabb, id);
+                    m_trackedEntities.emplace(id, tracked_entity{ proxy, pos, m_frame });
+                }
+                else
+                {
+                    // Only gets reinserted if it moved out of its fat bounds
+                    tracked_entity& tracked = itr->second;
+                    proxy = tracked.proxy;
+                    m_tree.moveProxy(proxy, aabb, pos - tracked.position);
+                    tracked.position = pos;
+                    tracked.lastFrame = m_frame;
+                }
+
+                if (proxy >= m_proxyPrecursors.size())
+                    m_proxyPrecursors.resize(proxy + 1);
+
+                m_proxyPrecursors[proxy] = i;
+                m_activeProxies.push_back(proxy);
+            }
+
+            // Entities that weren't passed this frame have been destroyed or lost their physics component
+            for (auto itr = m_trackedEntities.begin(); itr != m_trackedEntities.end();)
+            {
+                if (itr->second.lastFrame != m_frame)
+                {
+                    m_tree.destroyProxy(itr->second.proxy);
+                    itr = m_trackedEntities.erase(itr);
+                }
+                else
+                    ++itr;
+            }
+        }
+
+        {
+            OPTICK_EVENT("Collecting overlapping pairs");
+            for (int32 proxy : m_activeProxies)
+            {
+                auto [low, high] = m_tree.getFatAABB(proxy);
+                m_tree.query(low, high, [&](int32 other)
+                    {
+                        // Every pair is found from both sides, only keep it once
+                        if (other > proxy)
+                        {
+                            m_groupings.emplace_back();
+                            auto& pair = m_groupings.back();
+                            pair.reserve(2);
+                            pair.push_back(manifoldPrecursors[m_proxyPrecursors[proxy]]);
+                            pair.push_back(manifoldPrecursors[m_proxyPrecursors[other]]);
+                        }
+                        return true;
+                    });
+            }
+        }
+
+        return m_groupings;
+    }
+
+    std::vector<ecs::entity_handle> BroadphaseAABBTree::queryAABB(const math::vec3& low, const math::vec3& high) const
+    {
+        OPTICK_EVENT();
+        std::vector<ecs::entity_handle> entities;
+        m_tree.query(low, high, [&](int32 proxy)
+            {
+                entities.emplace_back(m_tree.getUserData(proxy));
+                return true;
+            });
+        return entities;
+    }
+
+    std::vector<std::pair<ecs::entity_handle, float>> BroadphaseAABBTree::raycast(const math::vec3& origin, const math::vec3& direction, float maxDistance) const
+    {
+        OPTICK_EVENT();
+        std::vector<std::pair<ecs::entity_handle, float>> hits;
+        m_tree.raycast(origin, direction, maxDistance, [&](int32 proxy, float distance)
+            {
+                hits.emplace_back(ecs::entity_handle(m_tree.getUserData(proxy)), distance);
+                return maxDistance;
+            });
+
+        std::sort(hits.begin(), hits.end(), [](auto& lhs, auto& rhs) { return lhs.second < rhs.second; });
+        return hits;
+    }
+
+    void BroadphaseAABBTree::clear()
+    {
+        m_tree.clear();
+        m_trackedEntities.clear();
+        m_proxyPrecursors.clear();
+        m_activeProxies.clear();
+        m_groupings.clear();
+    }
+
+    void BroadphaseAABBTree::debugDraw()
+    {
+        m_tree.forEachNode([](const math::vec3& low, const math::vec3& high, int32 height)
+            {
+                debug::drawCube(low, high, height == 0 ? math::colors::blue : math::colors::red, 5.0f);
+            });
+    }
+}
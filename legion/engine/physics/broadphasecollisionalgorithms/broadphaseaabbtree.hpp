@@ -0,0 +1,71 @@
+#pragma once
+#include <physics/broadphasecollisionalgorithms/broadphasecollisionalgorithm.hpp>
+#include <physics/data/dynamicaabbtree.hpp>
+#include <physics/physics_statics.hpp>
+
+namespace legion::physics
+{
+    /**@class BroadphaseAABBTree
+     * @brief Implementation of broad-phase collision detection
+     * Keeps the bounds of every physics component in a DynamicAABBTree that persists between frames.
+     * Unlike the uniform grid it has no cell size to tune, so scenes that mix small and very large colliders stay cheap.
+     * Every pair of colliders whose fat bounds overlap is returned as its own grouping.
+     */
+    class BroadphaseAABBTree : public BroadPhaseCollisionAlgorithm
+    {
+    public:
+        /**@brief Constructor of BroadphaseAABBTree
+         * @param margin The distance the bounds of each collider get fattened by, larger margins mean fewer tree updates but more pairs.
+         */
+        BroadphaseAABBTree(float margin = constants::aabbTreeFatMargin) : m_tree(margin)
+        {
+        }
+
+        /**@brief Collects collider pairs that have a chance of colliding and should be checked in narrow-phase collision detection
+         * @param manifoldPrecursors all the physics components
+         * @return a list-list of colliders that have a chance of colliding and should be checked, each list is one pair
+         */
+        const std::vector<std::vector<physics_manifold_precursor>>& collectPairs(
+            std::vector<physics_manifold_precursor>&& manifoldPrecursors) override;
+
+        /**@brief Gets all the entities whose bounds overlap the given bounds, using the state of the last collectPairs call.
+         * @note The bounds of the entities are fattened by the margin of the tree.
+         */
+        std::vector<ecs::entity_handle> queryAABB(const math::vec3& low, const math::vec3& high) const;
+
+        /**@brief Gets all the entities whose bounds the given ray hits, sorted from closest to furthest.
+         * @param direction the normalized direction of the ray
+         * @return pairs of the entities and the distance along the ray at which their bounds are hit
+         */
+        std::vector<std::pair<ecs::entity_handle, float>> raycast(const math::vec3& origin, const math::vec3& direction, float maxDistance) const;
+
+        /**@brief Removes all the cached data, the tree gets rebuilt on the next collectPairs call.
+         */
+        void clear();
+
+        const DynamicAABBTree& getTree() const { return m_tree; }
+
+        void debugDraw() override;
+
+    private:
+        struct tracked_entity
+        {
+            int32 proxy;
+            math::vec3 position;
+            size_type lastFrame;
+        };
+
+        DynamicAABBTree m_tree;
+
+        // Stores the proxy, last position and the frame it was last seen of every entity in the tree.
+        std::unordered_map<id_type, tracked_entity> m_trackedEntities;
+
+        // Index of each proxy's precursor in the current frame's precursor list.
+        std::vector<size_type> m_proxyPrecursors;
+
+        // Proxies that are in the tree this frame.
+        std::vector<int32> m_activeProxies;
+
+        size_type m_frame = 0;
+    };
+}
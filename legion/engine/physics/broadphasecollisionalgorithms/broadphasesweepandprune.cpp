@@ -0,0 +1,301 @@
+#include <physics/broadphasecollisionalgorithms/broadphasesweepandprune.hpp>
+#include <rendering/debugrendering.hpp>
+#include <limits>
+#include <numeric>
+
+namespace legion::physics
+{
+    const std::vector<std::vector<physics_manifold_precursor>>& BroadphaseSweepAndPrune::collectPairs(
+        std::vector<physics_manifold_precursor>&& manifoldPrecursors)
+    {
+        OPTICK_EVENT();
+        m_groupings.clear();
+        m_frame++;
+
+        std::vector<std::pair<math::vec3, math::vec3>> precursorBounds(manifoldPrecursors.size());
+        size_type newEntities = 0;
+
+        {
+            OPTICK_EVENT("Updating bounds");
+            for (size_type i = 0; i < manifoldPrecursors.size(); i++)
+            {
+                auto& precursor = manifoldPrecursors[i];
+
+                // If the entity has no colliders, we can skip it
+                std::vector<PhysicsColliderPtr>& colliders = precursor.physicsComp->colliders;
+                if (colliders.size() == 0) continue;
+
+                // Combine the bounds of all the colliders of this physics component
+                std::pair<math::vec3, math::vec3> aabb = colliders.at(0)->GetMinMaxWorldAABB();
+                for (int j = 1; j < colliders.size(); ++j)
+                {
+                    aabb = PhysicsStatics::CombineAABB(colliders.at(j)->GetMinMaxWorldAABB(), aabb);
+                }
+                precursorBounds[i] = aabb;
+
+                id_type id = precursor.entity;
+                auto itr = m_trackedEntities.find(id);
+                if (itr == m_trackedEntities.end())
+                {
+                    // A new entity gets added to the end, the sort moves it into place
+                    m_trackedEntities.emplace(id, tracked_entity{ i, m_frame });
+                    m_order.push_back(id);
+                    newEntities++;
+                }
+                else
+                {
+                    itr->second.precursorIndex = i;
+                    itr->second.lastFrame = m_frame;
+                }
+            }
+
+            // Entities that weren't passed this frame have been destroyed or lost their physics component.
+            // Removing them keeps the order of the remaining entities intact.
+            m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [&](id_type id)
+                {
+                    auto itr = m_trackedEntities.find(id);
+                    if (itr->second.lastFrame == m_frame)
+                        return false;
+
+                    m_trackedEntities.erase(itr);
+                    return true;
+                }), m_order.end());
+
+            // Gather the bounds in the order of the previous frame.
+            size_type count = m_order.size();
+            m_precursorIndices.resize(count);
+            for (size_type axis = 0; axis < 3; axis++)
+            {
+                m_min[axis].resize(count + simdWidth);
+                m_max[axis].resize(count + simdWidth);
+            }
+
+            for (size_type i = 0; i < count; i++)
+            {
+                size_type precursorIndex = m_trackedEntities.at(m_order[i]).precursorIndex;
+                m_precursorIndices[i] = precursorIndex;
+
+                auto& [low, high] = precursorBounds[precursorIndex];
+                for (size_type axis = 0; axis < 3; axis++)
+                {
+                    m_min[axis][i] = low[axis];
+                    m_max[axis][i] = high[axis];
+                }
+            }
+
+            // Padding never overlaps anything, so vector loads may read past the last entry.
+            for (size_type axis = 0; axis < 3; axis++)
+            {
+                std::fill(m_min[axis].begin() + count, m_min[axis].end(), std::numeric_limits<float>::infinity());
+                std::fill(m_max[axis].begin() + count, m_max[axis].end(), -std::numeric_limits<float>::infinity());
+            }
+        }
+
+        {
+            OPTICK_EVENT("Sorting bounds");
+            size_type sweepAxis = selectSweepAxis();
+            bool coherent = sweepAxis == m_sweepAxis && newEntities <= m_order.size() / 8;
+            m_sweepAxis = sweepAxis;
+            sortBounds(coherent);
+        }
+
+        {
+            OPTICK_EVENT("Sweeping");
+            sweep(manifoldPrecursors);
+        }
+
+        return m_groupings;
+    }
+
+    void BroadphaseSweepAndPrune::clear()
+    {
+        m_trackedEntities.clear();
+        m_order.clear();
+        m_precursorIndices.clear();
+        for (size_type axis = 0; axis < 3; axis++)
+        {
+            m_min[axis].clear();
+            m_max[axis].clear();
+        }
+        m_groupings.clear();
+    }
+
+    void BroadphaseSweepAndPrune::debugDraw()
+    {
+        for (size_type i = 0; i < m_order.size(); i++)
+        {
+            math::vec3 low(m_min[0][i], m_min[1][i], m_min[2][i]);
+            math::vec3 high(m_max[0][i], m_max[1][i], m_max[2][i]);
+            debug::drawCube(low, high, math::colors::blue, 5.0f);
+        }
+    }
+
+    size_type BroadphaseSweepAndPrune::selectSweepAxis() const
+    {
+        size_type count = m_order.size();
+        if (count < 2)
+            return m_sweepAxis;
+
+        float variance[3];
+        for (size_type axis = 0; axis < 3; axis++)
+        {
+            float sum = 0.f;
+            float sumSquared = 0.f;
+            for (size_type i = 0; i < count; i++)
+            {
+                float centre = (m_min[axis][i] + m_max[axis][i]) * 0.5f;
+                sum += centre;
+                sumSquared += centre * centre;
+            }
+
+            float mean = sum / count;
+            variance[axis] = sumSquared / count - mean * mean;
+        }
+
+        size_type bestAxis = variance[0] > variance[1] ? 0 : 1;
+        bestAxis = variance[bestAxis] > variance[2] ? bestAxis : 2;
+
+        // Switching axis costs a full sort, only do it when the other axis is clearly better.
+        if (variance[bestAxis] > variance[m_sweepAxis] * 1.5f)
+            return bestAxis;
+        return m_sweepAxis;
+    }
+
+    void BroadphaseSweepAndPrune::sortBounds(bool coherent)
+    {
+        size_type count = m_order.size();
+        std::vector<float>& key = m_min[m_sweepAxis];
+
+        if (coherent)
+        {
+            // Insertion sort, entries only move as far as they moved past their neighbours since the last frame.
+            for (size_type i = 1; i < count; i++)
+            {
+                if (key[i - 1] <= key[i])
+                    continue;
+
+                float min[3] = { m_min[0][i], m_min[1][i], m_min[2][i] };
+                float max[3] = { m_max[0][i], m_max[1][i], m_max[2][i] };
+                id_type id = m_order[i];
+                size_type precursorIndex = m_precursorIndices[i];
+
+                size_type j = i;
+                for (; j > 0 && key[j - 1] > min[m_sweepAxis]; j--)
+                {
+                    for (size_type axis = 0; axis < 3; axis++)
+                    {
+                        m_min[axis][j] = m_min[axis][j - 1];
+                        m_max[axis][j] = m_max[axis][j - 1];
+                    }
+                    m_order[j] = m_order[j - 1];
+                    m_precursorIndices[j] = m_precursorIndices[j - 1];
+                }
+
+                for (size_type axis = 0; axis < 3; axis++)
+                {
+                    m_min[axis][j] = min[axis];
+                    m_max[axis][j] = max[axis];
+                }
+                m_order[j] = id;
+                m_precursorIndices[j] = precursorIndex;
+            }
+            return;
+        }
+
+        // Too much has changed for an insertion sort, sort a permutation and apply it to every array.
+        std::vector<size_type> permutation(count);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::sort(permutation.begin(), permutation.end(), [&](size_type lhs, size_type rhs) { return key[lhs] < key[rhs]; });
+
+        auto applyPermutation = [&](auto& values)
+        {
+            std::remove_reference_t<decltype(values)> sorted(values.size());
+            for (size_type i = 0; i < count; i++)
+                sorted[i] = values[permutation[i]];
+
+            // Keep the padding after the sorted entries.
+            std::copy(values.begin() + count, values.end(), sorted.begin() + count);
+            values = std::move(sorted);
+        };
+
+        for (size_type axis = 0; axis < 3; axis++)
+        {
+            applyPermutation(m_min[axis]);
+            applyPermutation(m_max[axis]);
+        }
+        applyPermutation(m_order);
+        applyPermutation(m_precursorIndices);
+    }
+
+    void BroadphaseSweepAndPrune::sweep(const std::vector<physics_manifold_precursor>& manifoldPrecursors)
+    {
+        size_type count = m_order.size();
+
+        size_type axisB = (m_sweepAxis + 1) % 3;
+        size_type axisC = (m_sweepAxis + 2) % 3;
+
+        const float* minA = m_min[m_sweepAxis].data();
+        const float* maxA = m_max[m_sweepAxis].data();
+        const float* minB = m_min[axisB].data();
+        const float* maxB = m_max[axisB].data();
+        const float* minC = m_min[axisC].data();
+        const float* maxC = m_max[axisC].data();
+
+        for (size_type i = 0; i < count; i++)
+        {
+            // Entries are sorted by their lower bound on the sweep axis, so every entry after i that starts before i ends overlaps it on that axis.
+#if defined(LEGION_SSE)
+            __m128 maxAi = _mm_set1_ps(maxA[i]);
+            __m128 minBi = _mm_set1_ps(minB[i]);
+            __m128 maxBi = _mm_set1_ps(maxB[i]);
+            __m128 minCi = _mm_set1_ps(minC[i]);
+            __m128 maxCi = _mm_set1_ps(maxC[i]);
+
+            for (size_type j = i + 1; j < count; j += simdWidth)
+            {
+                __m128 overlapA = _mm_cmple_ps(_mm_loadu_ps(minA + j), maxAi);
+                int sweepMask = _mm_movemask_ps(overlapA);
+                if (!sweepMask)
+                    break;
+
+                __m128 overlapB = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minB + j), maxBi), _mm_cmpge_ps(_mm_loadu_ps(maxB + j), minBi));
+                __m128 overlapC = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minC + j), maxCi), _mm_cmpge_ps(_mm_loadu_ps(maxC + j), minCi));
+                int overlapMask = _mm_movemask_ps(_mm_and_ps(overlapA, _mm_and_ps(overlapB, overlapC)));
+
+                for (size_type k = 0; k < simdWidth; k++)
+                {
+                    if (overlapMask & (1 << k))
+                        addPair(manifoldPrecursors, i, j + k);
+                }
+
+                // Once one of the lanes starts after i ends, so do all the entries after it.
+                if (sweepMask != 0xF)
+                    break;
+            }
+#else
+            for (size_type j = i + 1; j < count && minA[j] <= maxA[i]; j++)
+            {
+                if (minB[j] <= maxB[i] && maxB[j] >= minB[i] &&
+                    minC[j] <= maxC[i] && maxC[j] >= minC[i])
+                    addPair(manifoldPrecursors, i, j);
+            }
+#endif
+        }
+    }
+
+    void BroadphaseSweepAndPrune::addPair(const std::vector<physics_manifold_precursor>& manifoldPrecursors, size_type first, size_type second)
+    {
+        size_type precursorA = m_precursorIndices[first];
+        size_type precursorB = m_precursorIndices[second];
+
+        // Keep the pairs in the same order regardless of the sort order.
+        if (precursorB < precursorA)
+            std::swap(precursorA, precursorB);
+
+        m_groupings.emplace_back();
+        auto& pair = m_groupings.back();
+        pair.reserve(2);
+        pair.push_back(manifoldPrecursors[precursorA]);
+        pair.push_back(manifoldPrecursors[precursorB]);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <physics/broadphasecollisionalgorithms/broadphasecollisionalgorithm.hpp>
+#include <physics/physics_statics.hpp>
+
+namespace legion::physics
+{
+    /**@class BroadphaseSweepAndPrune
+     * @brief Implementation of broad-phase collision detection
+     * Sorts the bounds of all physics components along one axis and sweeps over them, only bounds that overlap on the sweep axis get tested on the other two.
+     * The sorted order is kept between frames and restored with an insertion sort, which is close to linear when objects move little per frame.
+     * The bounds are stored as separate min and max arrays per axis so that four candidates can be tested at once with SIMD.
+     * Every pair of colliders whose bounds overlap is returned as its own grouping.
+     */
+    class BroadphaseSweepAndPrune : public BroadPhaseCollisionAlgorithm
+    {
+    public:
+        /**@brief Collects collider pairs that have a chance of colliding and should be checked in narrow-phase collision detection
+         * @param manifoldPrecursors all the physics components
+         * @return a list-list of colliders that have a chance of colliding and should be checked, each list is one pair
+         */
+        const std::vector<std::vector<physics_manifold_precursor>>& collectPairs(
+            std::vector<physics_manifold_precursor>&& manifoldPrecursors) override;
+
+        /**@brief Removes all the cached data, the sorted order gets rebuilt on the next collectPairs call.
+         */
+        void clear();
+
+        /**@brief Gets the axis the bounds are currently sorted and swept along, 0 for x, 1 for y and 2 for z.
+         */
+        L_NODISCARD size_type getSweepAxis() const { return m_sweepAxis; }
+
+        void debugDraw() override;
+
+    private:
+        // Amount of candidates tested at once, the bound arrays are padded by this so loads past the end stay valid.
+        static constexpr size_type simdWidth = 4;
+
+        struct tracked_entity
+        {
+            size_type precursorIndex;
+            size_type lastFrame;
+        };
+
+        // Stores the index in the current frame's precursor list and the frame it was last seen of every entity.
+        std::unordered_map<id_type, tracked_entity> m_trackedEntities;
+
+        // Entities in the order of the previous sort, the bound arrays below follow the same order.
+        std::vector<id_type> m_order;
+
+        // Lower and higher bounds per axis.
+        std::vector<float> m_min[3];
+        std::vector<float> m_max[3];
+
+        // Index of each sorted entry in the current frame's precursor list.
+        std::vector<size_type> m_precursorIndices;
+
+        size_type m_sweepAxis = 0;
+        size_type m_frame = 0;
+
+        /**@brief Picks the axis along which the centres of the bounds are spread out the most, which leaves the fewest overlaps on the sweep axis.
+         */
+        size_type selectSweepAxis() const;
+
+        /**@brief Sorts all the arrays by the lower bound on the sweep axis.
+         * @param coherent Whether the arrays are still mostly sorted from the previous frame, if so an insertion sort is used.
+         */
+        void sortBounds(bool coherent);
+
+        void sweep(const std::vector<physics_manifold_precursor>& manifoldPrecursors);
+
+        void addPair(const std::vector<physics_manifold_precursor>& manifoldPrecursors, size_type first, size_type second);
+    };
+}
@@ -32,27 +32,88 @@ namespace legion::physics
         //'this' is colliderB and 'convexCollider' is colliderA
         
 
+        // The world data is built with the transform of the current step, the manifold should have the same transforms.
+        // If it doesn't the hulls get transformed for every test instead.
+        const convex_world_data& worldA = convexCollider->GetWorldData();
+        const convex_world_data& worldB = GetWorldData();
+        bool useWorldData = worldA.matches(manifold.transformA, convexCollider->GetVertices().size(), convexCollider->GetHalfEdgeFaces().size())
+            && worldB.matches(manifold.transformB, vertices.size(), halfEdgeFaces.size());
+
+        math::vec3 centroidDirB = manifold.transformB * math::vec4(GetLocalCentroid(), 0);
+        math::vec3 positionB = math::vec3(manifold.transformB[3]) + centroidDirB;
+
+        //--------------------- Check the feature that seperated the colliders in the last step first --------------//
+        seperating_axis_hint& hint = manifold.seperatingAxisHint;
+        if (useWorldData)
+        {
+            bool hintSeperates = false;
+            switch (hint.type)
+            {
+            case seperating_axis_type::faceA:
+                hintSeperates = hint.featureA < convexCollider->GetHalfEdgeFaces().size()
+                    && PhysicsStatics::GetFaceSeperation(worldB, worldA, hint.featureA) > 0.0f;
+                break;
+            case seperating_axis_type::faceB:
+                hintSeperates = hint.featureB < halfEdgeFaces.size()
+                    && PhysicsStatics::GetFaceSeperation(worldA, worldB, hint.featureB) > 0.0f;
+                break;
+            case seperating_axis_type::edges:
+            {
+                math::vec3 seperatingAxis;
+                float seperation;
+                if (hint.featureA < worldA.edges.size() && hint.featureB < worldB.edges.size()
+                    && PhysicsStatics::GetEdgeSeperation(worldB, worldA, positionB, hint.featureB, hint.featureA, seperatingAxis, seperation)
+                    && seperation > 0.0f)
+                {
+                    // Edges whose arcs only touch pass the minkowski face test without their axis seperating anything,
+                    // the full check takes the closest edge pair so it doesn't care, but a single hinted pair has to be confirmed.
+                    math::vec3 supportPoint;
+                    hintSeperates = -worldA.getSupportPoint(-seperatingAxis, supportPoint) - worldB.getSupportPoint(seperatingAxis, supportPoint) > 0.0f;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            if (hintSeperates)
+            {
+                manifold.isColliding = false;
+                return;
+            }
+        }
+
         ////log::debug("-------------------- SAT CHECK -----------------");
         PointerEncapsulator < HalfEdgeFace> ARefFace;
 
         ////log::debug("Face Check A");
         float ARefSeperation;
-        if (PhysicsStatics::FindSeperatingAxisByExtremePointProjection(
-            this, convexCollider, manifold.transformB,manifold.transformA,  ARefFace, ARefSeperation) || !ARefFace.ptr)
+        size_type ARefFaceIndex = 0;
+        bool seperatedOnA = useWorldData ?
+            PhysicsStatics::FindSeperatingAxisByExtremePointProjection(worldB, worldA, convexCollider->GetHalfEdgeFaces(), ARefFace, ARefSeperation, ARefFaceIndex) :
+            PhysicsStatics::FindSeperatingAxisByExtremePointProjection(this, convexCollider, manifold.transformB, manifold.transformA, ARefFace, ARefSeperation);
+
+        if (seperatedOnA || !ARefFace.ptr)
         {
             //log::debug("Not Found on A ");
             manifold.isColliding = false;
+            hint = { seperatedOnA && useWorldData ? seperating_axis_type::faceA : seperating_axis_type::none, ARefFaceIndex, 0 };
             return;
         }
 
         PointerEncapsulator < HalfEdgeFace> BRefFace;
         //log::debug("Face Check B");
         float BRefSeperation;
-        if (PhysicsStatics::FindSeperatingAxisByExtremePointProjection(convexCollider,
-            this, manifold.transformA, manifold.transformB, BRefFace, BRefSeperation, shouldDebug) || !BRefFace.ptr)
+        size_type BRefFaceIndex = 0;
+        bool seperatedOnB = useWorldData ?
+            PhysicsStatics::FindSeperatingAxisByExtremePointProjection(worldA, worldB, halfEdgeFaces, BRefFace, BRefSeperation, BRefFaceIndex) :
+            PhysicsStatics::FindSeperatingAxisByExtremePointProjection(convexCollider, this, manifold.transformA, manifold.transformB, BRefFace, BRefSeperation, shouldDebug);
+
+        if (seperatedOnB || !BRefFace.ptr)
         {
             //log::debug("Not Found on B ");
             manifold.isColliding = false;
+            hint = { seperatedOnB && useWorldData ? seperating_axis_type::faceB : seperating_axis_type::none, 0, BRefFaceIndex };
             return;
         }
 
@@ -61,14 +122,22 @@ namespace legion::physics
 
         math::vec3 edgeNormal;
         float aToBEdgeSeperation;
+        size_type edgeRefIndex = 0;
+        size_type edgeIncIndex = 0;
         //log::debug("Edge Check");
-        if (PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(this, convexCollider, manifold.transformB, manifold.transformA,
-            edgeRef, edgeInc, edgeNormal, aToBEdgeSeperation, shouldDebug) || !edgeRef.ptr)
+        bool seperatedOnEdges = useWorldData ?
+            PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(worldB, worldA, positionB,
+                edgeRef, edgeInc, edgeNormal, aToBEdgeSeperation, edgeRefIndex, edgeIncIndex) :
+            PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(this, convexCollider, manifold.transformB, manifold.transformA,
+                edgeRef, edgeInc, edgeNormal, aToBEdgeSeperation, shouldDebug);
+
+        if (seperatedOnEdges || !edgeRef.ptr)
         {
             //
             manifold.isColliding = false;
+            hint = { seperatedOnEdges && useWorldData ? seperating_axis_type::edges : seperating_axis_type::none, edgeIncIndex, edgeRefIndex };
 
-            if (shouldDebug)
+            if (shouldDebug && edgeRef.ptr)
             {
                 edgeRef.ptr->DEBUG_drawEdge(manifold.transformB, math::colors::blue, 10.0f);
                 edgeInc.ptr->DEBUG_drawEdge(manifold.transformA, math::colors::red, 10.0f);
@@ -76,6 +145,9 @@ namespace legion::physics
             return;
         }
 
+        // The colliders are touching, there's no seperating axis to remember.
+        hint = {};
+
         if (shouldDebug)
         {
             log::debug("-> collision detected for debug ");
@@ -223,6 +295,25 @@ namespace legion::physics
     {
         minMaxWorldAABB = PhysicsStatics::ConstructAABBFromTransformedVertices
         (vertices, transform);
+
+        // Static, sleeping and far away colliders never need the world space hull, so it's only built once a collision check asks for it.
+        worldDataTransform = transform;
+        worldDataCurrent.store(false, std::memory_order_relaxed);
+    }
+
+    const convex_world_data& ConvexCollider::GetWorldData()
+    {
+        if (worldDataCurrent.load(std::memory_order_acquire))
+            return worldData;
+
+        std::lock_guard guard(worldDataLock); // Other jobs can check pairs with this collider at the same time.
+        if (!worldDataCurrent.load(std::memory_order_relaxed))
+        {
+            if (!worldData.matches(worldDataTransform, vertices.size(), halfEdgeFaces.size()))
+                worldData.build(vertices, halfEdgeFaces, worldDataTransform);
+            worldDataCurrent.store(true, std::memory_order_release);
+        }
+        return worldData;
     }
 
     void ConvexCollider::UpdateLocalAABB()
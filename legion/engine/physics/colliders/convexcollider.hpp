@@ -7,6 +7,7 @@
 #include <physics/halfedgeedge.hpp>
 #include <physics/halfedgeface.hpp>
 #include <physics/data/convex_convergance_identifier.hpp>
+#include <physics/data/convex_world_data.hpp>
 #include <physics/data/physics_manifold.hpp>
 #include <rendering/debugrendering.hpp>
 
@@ -58,7 +59,8 @@ namespace legion::physics
             UpdateTightAABB(transform);
         }
 
-        /**@brief Given the current transform of the entity, creates a tight AABB of the collider;
+        /**@brief Given the current transform of the entity, creates a tight AABB of the collider
+        * and remembers the transform for the world space hull of this step.
         */
         void UpdateTightAABB(const math::mat4& transform);
        
@@ -346,6 +348,12 @@ namespace legion::physics
             return vertices;
         }
 
+        /**@brief Gets the hull in world space with the transform of the last call to UpdateTightAABB.
+        * The hull is only transformed by the first collision check that needs it, and not at all if the transform didn't change.
+        * @note Safe to call from multiple narrowphase jobs at once.
+        */
+        const convex_world_data& GetWorldData();
+
         void AssertEdgeValidity()
         {
             auto assertFunc = [](HalfEdgeEdge* edge)
@@ -369,6 +377,12 @@ namespace legion::physics
 
         std::vector<math::vec3> vertices;
 
+        convex_world_data worldData;
+        math::mat4 worldDataTransform = math::mat4(1.0f);
+        // Whether worldData was checked against worldDataTransform since the last call to UpdateTightAABB.
+        std::atomic_bool worldDataCurrent = { false };
+        async::spinlock worldDataLock;
+
         HalfEdgeFace* instantiateMeshFace(const std::vector<math::vec3*>& vertices, const math::vec3& faceNormal)
         {
             if (vertices.size() == 0) { return nullptr; }
@@ -109,8 +109,9 @@ namespace legion::physics
         int colliderIter = 0;
         for (auto ent : entitiesGenerated)
         {
-            auto [posH, rotH, scaleH] = ent.get_component_handles<transform>();
-            math::mat4 trans = math::compose(scaleH.read(), rotH.read(), posH.read());
+            // The fragments might be children, the explosion happens in world space.
+            math::mat4 trans = HierarchySystem::worldMatrix(ent);
+            math::vec3 fragmentPosition = trans[3];
             //generate hull
             auto physicsCompHandle = ent.add_component<physicsComponent>();
             auto physicsComp = physicsCompHandle.read();
@@ -119,13 +120,12 @@ namespace legion::physics
             physicsCompHandle.write(physicsComp);
 
             //add rigidbody 
-            auto posHandle = ent.get_component_handle<position>();
             auto rbH = ent.add_component<rigidbody>();
             auto fragmentRB = rbH.read();
-            fragmentRB.globalCentreOfMass = posH.read();
+            fragmentRB.globalCentreOfMass = fragmentPosition;
 
             //add force based on distance from explosion point
-            math::vec3 distanceFromCentroid = posH.read() - fractureParams.explosionCentroid ;
+            math::vec3 distanceFromCentroid = fragmentPosition - fractureParams.explosionCentroid ;
             math::vec3 forceDir = math::normalize(distanceFromCentroid);
             float forceAmount = (1.0f / (math::length(distanceFromCentroid))) * fractureParams.strength;
 
@@ -246,9 +246,7 @@ namespace legion::physics
 
                 auto ownerEntity = meshToColliderPairing.meshSplitterPairing.
                     entity;
-                auto [posH, rotH, scaleH] = ownerEntity.get_component_handles<transform>();
-
-                auto transformB = math::compose(scaleH.read(), rotH.read(), posH.read());
+                auto transformB = HierarchySystem::worldMatrix(ownerEntity);
 
                 time::timer convexConvexCollision;
  /*               PhysicsStatics::DetectConvexConvexCollision(instantiatedVoronoiCollider.get()
@@ -31,7 +31,11 @@ namespace legion::physics
         float restitution = 0.3f;
         float friction = 0.3f;
 
-        bool isAsleep;
+        //sleeping component
+        bool isAsleep = false;
+        float sleepTimer = 0.0f;
+        // Rigidbodies that fell asleep in the same island share this id, so waking one of them can wake the rest. 0 if it never slept.
+        size_type sleepingIsland = 0;
 
         template<typename Archive>
         void serialize(Archive& archive)
@@ -62,6 +66,7 @@ namespace legion::physics
         void addForce(math::vec3 force)
         {
             forceAccumulator += force;
+            wakeUp();
         }
 
         /** @brief Adds a force in the direction of 'force' and
@@ -71,6 +76,25 @@ namespace legion::physics
             forceAccumulator += force;
             math::vec3 axis = worldForcePosition - globalCentreOfMass;
             torqueAccumulator += math::cross(axis, force);
+            wakeUp();
+        }
+
+        /** @brief Makes the rigidbody get simulated again if it was asleep.
+        * @note Rigidbodies wake up by themselves when a force is added or when an awake rigidbody collides with them.
+        */
+        void wakeUp()
+        {
+            isAsleep = false;
+            sleepTimer = 0.0f;
+        }
+
+        /** @brief Stops simulating the rigidbody until it gets woken up.
+        */
+        void sleep()
+        {
+            isAsleep = true;
+            velocity = math::vec3(0.0f);
+            angularVelocity = math::vec3(0.0f);
         }
 
         void setMass(float mass)
@@ -0,0 +1,116 @@
+#include <physics/data/convex_world_data.hpp>
+
+namespace legion::physics
+{
+    void convex_world_data::build(const std::vector<math::vec3>& vertices, const std::vector<HalfEdgeFace*>& faces, const math::mat4& worldTransform)
+    {
+        OPTICK_EVENT();
+        transform = worldTransform;
+        isValid = !vertices.empty();
+        vertexCount = vertices.size();
+
+        // Padding repeats the first vertex, on a tie the lowest index wins so the padding is never returned.
+        size_type paddedCount = (vertexCount + simdWidth - 1) / simdWidth * simdWidth;
+        vertexX.resize(paddedCount);
+        vertexY.resize(paddedCount);
+        vertexZ.resize(paddedCount);
+
+        for (size_type i = 0; i < paddedCount; i++)
+        {
+            math::vec3 worldVertex = worldTransform * math::vec4(vertices[i < vertexCount ? i : 0], 1);
+            vertexX[i] = worldVertex.x;
+            vertexY[i] = worldVertex.y;
+            vertexZ[i] = worldVertex.z;
+        }
+
+        faceNormals.resize(faces.size());
+        faceCentroids.resize(faces.size());
+        faceEdgeOffsets.resize(faces.size() + 1);
+        edges.clear();
+
+        for (size_type i = 0; i < faces.size(); i++)
+        {
+            faceNormals[i] = math::normalize(worldTransform * math::vec4(faces[i]->normal, 0));
+            faceCentroids[i] = worldTransform * math::vec4(faces[i]->centroid, 1);
+
+            faceEdgeOffsets[i] = edges.size();
+            faces[i]->forEachEdge([this](HalfEdgeEdge* edge) { edges.push_back(edge); });
+        }
+        faceEdgeOffsets[faces.size()] = edges.size();
+
+        edgePositions.resize(edges.size());
+        edgeDirections.resize(edges.size());
+        edgeFaceNormals.resize(edges.size());
+        edgePairingFaceNormals.resize(edges.size());
+
+        for (size_type i = 0; i < edges.size(); i++)
+        {
+            HalfEdgeEdge* edge = edges[i];
+            edgePositions[i] = worldTransform * math::vec4(edge->edgePosition, 1);
+            edgeDirections[i] = math::normalize(worldTransform * math::vec4(edge->getLocalEdgeDirection(), 0));
+            edgeFaceNormals[i] = worldTransform * math::vec4(edge->getLocalNormal(), 0);
+            edgePairingFaceNormals[i] = worldTransform * math::vec4(edge->pairingEdge->getLocalNormal(), 0);
+        }
+    }
+
+    float convex_world_data::getSupportPoint(const math::vec3& direction, math::vec3& worldSupportPoint) const
+    {
+        size_type bestIndex = 0;
+        float bestDistance = std::numeric_limits<float>::lowest();
+
+#if defined(LEGION_SSE)
+        __m128 dirX = _mm_set1_ps(direction.x);
+        __m128 dirY = _mm_set1_ps(direction.y);
+        __m128 dirZ = _mm_set1_ps(direction.z);
+
+        __m128 bestDistances = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        __m128i bestIndices = _mm_setzero_si128();
+        __m128i indices = _mm_set_epi32(3, 2, 1, 0);
+        const __m128i step = _mm_set1_epi32(simdWidth);
+
+        for (size_type i = 0; i < vertexX.size(); i += simdWidth)
+        {
+            __m128 distances = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(&vertexX[i]), dirX),
+                _mm_mul_ps(_mm_loadu_ps(&vertexY[i]), dirY)),
+                _mm_mul_ps(_mm_loadu_ps(&vertexZ[i]), dirZ));
+
+            // Only strictly further vertices replace the best of their lane, so every lane keeps its lowest index on a tie.
+            __m128 further = _mm_cmpgt_ps(distances, bestDistances);
+            __m128i furtherMask = _mm_castps_si128(further);
+
+            bestDistances = _mm_or_ps(_mm_and_ps(further, distances), _mm_andnot_ps(further, bestDistances));
+            bestIndices = _mm_or_si128(_mm_and_si128(furtherMask, indices), _mm_andnot_si128(furtherMask, bestIndices));
+            indices = _mm_add_epi32(indices, step);
+        }
+
+        alignas(16) float laneDistances[simdWidth];
+        alignas(16) int32 laneIndices[simdWidth];
+        _mm_store_ps(laneDistances, bestDistances);
+        _mm_store_si128(reinterpret_cast<__m128i*>(laneIndices), bestIndices);
+
+        for (size_type lane = 0; lane < simdWidth; lane++)
+        {
+            size_type index = static_cast<size_type>(laneIndices[lane]);
+            if (laneDistances[lane] > bestDistance || (laneDistances[lane] == bestDistance && index < bestIndex))
+            {
+                bestDistance = laneDistances[lane];
+                bestIndex = index;
+            }
+        }
+#else
+        for (size_type i = 0; i < vertexCount; i++)
+        {
+            float distance = vertexX[i] * direction.x + vertexY[i] * direction.y + vertexZ[i] * direction.z;
+            if (distance > bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = i;
+            }
+        }
+#endif
+
+        worldSupportPoint = math::vec3(vertexX[bestIndex], vertexY[bestIndex], vertexZ[bestIndex]);
+        return bestDistance;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <core/core.hpp>
+#include <physics/halfedgeedge.hpp>
+#include <physics/halfedgeface.hpp>
+
+namespace legion::physics
+{
+    /**@struct convex_world_data
+     * @brief World space copy of the vertices, face planes and edges of a convex hull for one transform.
+     * The vertex coordinates are stored in separate arrays so support points can be found for four vertices at once with SIMD.
+     * Every ConvexCollider rebuilds it once per physics step, so the separating axis tests don't have to transform anything per test.
+     */
+    struct convex_world_data
+    {
+        // Amount of vertices tested at once, the vertex arrays are padded to a multiple of this.
+        static constexpr size_type simdWidth = 4;
+
+        math::mat4 transform;
+        bool isValid = false;
+
+        size_type vertexCount = 0;
+        std::vector<float> vertexX;
+        std::vector<float> vertexY;
+        std::vector<float> vertexZ;
+
+        std::vector<math::vec3> faceNormals;
+        std::vector<math::vec3> faceCentroids;
+
+        // Edges of all faces in face order, the edges of face i start at faceEdgeOffsets[i] and end at faceEdgeOffsets[i + 1].
+        std::vector<size_type> faceEdgeOffsets;
+        std::vector<HalfEdgeEdge*> edges;
+        std::vector<math::vec3> edgePositions;
+        std::vector<math::vec3> edgeDirections;
+        // Normals of the two faces that share the edge, the arc between them is the edge on the gauss map.
+        std::vector<math::vec3> edgeFaceNormals;
+        std::vector<math::vec3> edgePairingFaceNormals;
+
+        /**@brief Transforms the given hull into world space.
+         */
+        void build(const std::vector<math::vec3>& vertices, const std::vector<HalfEdgeFace*>& faces, const math::mat4& worldTransform);
+
+        /**@brief Whether the data was built with the given transform for a hull with the given amount of vertices and faces.
+         */
+        L_NODISCARD bool matches(const math::mat4& worldTransform, size_type hullVertexCount, size_type hullFaceCount) const noexcept
+        {
+            return isValid && vertexCount == hullVertexCount && faceNormals.size() == hullFaceCount && transform == worldTransform;
+        }
+
+        /**@brief Gets the vertex furthest in the given direction.
+         * @param direction The direction in world space.
+         * @param worldSupportPoint [out] The vertex in world space.
+         * @return The dot product of the vertex and the direction.
+         */
+        float getSupportPoint(const math::vec3& direction, math::vec3& worldSupportPoint) const;
+    };
+}
@@ -0,0 +1,281 @@
+#include <physics/data/dynamicaabbtree.hpp>
+
+namespace legion::physics
+{
+    DynamicAABBTree::DynamicAABBTree(float margin, float displacementMultiplier) : m_margin(margin), m_displacementMultiplier(displacementMultiplier)
+    {
+    }
+
+    int32 DynamicAABBTree::createProxy(const std::pair<math::vec3, math::vec3>& aabb, id_type userData)
+    {
+        int32 proxy = allocateNode();
+
+        aabb_tree_node& node = m_nodes[proxy];
+        node.low = aabb.first - math::vec3(m_margin);
+        node.high = aabb.second + math::vec3(m_margin);
+        node.userData = userData;
+        node.height = 0;
+
+        insertLeaf(proxy);
+        m_proxyCount++;
+        return proxy;
+    }
+
+    void DynamicAABBTree::destroyProxy(int32 proxy)
+    {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        m_proxyCount--;
+    }
+
+    bool DynamicAABBTree::moveProxy(int32 proxy, const std::pair<math::vec3, math::vec3>& aabb, const math::vec3& displacement)
+    {
+        aabb_tree_node& node = m_nodes[proxy];
+
+        // Still inside the fat bounds, the tree doesn't need to change.
+        if (contains(node.low, node.high, aabb.first, aabb.second))
+            return false;
+
+        removeLeaf(proxy);
+
+        math::vec3 low = aabb.first - math::vec3(m_margin);
+        math::vec3 high = aabb.second + math::vec3(m_margin);
+
+        // Extend the bounds in the direction the proxy is moving so it stays inside them for longer.
+        math::vec3 prediction = displacement * m_displacementMultiplier;
+        node.low = low + math::min(prediction, math::vec3(0.f));
+        node.high = high + math::max(prediction, math::vec3(0.f));
+
+        insertLeaf(proxy);
+        return true;
+    }
+
+    void DynamicAABBTree::clear()
+    {
+        m_freeList = null_node;
+        for (int32 i = static_cast<int32>(m_nodes.size()) - 1; i >= 0; i--)
+        {
+            m_nodes[i] = aabb_tree_node();
+            m_nodes[i].parent = m_freeList;
+            m_freeList = i;
+        }
+
+        m_root = null_node;
+        m_proxyCount = 0;
+    }
+
+    int32 DynamicAABBTree::allocateNode()
+    {
+        if (m_freeList == null_node)
+        {
+            // Grow the pool and put all the new nodes in the free list.
+            int32 oldCapacity = static_cast<int32>(m_nodes.size());
+            int32 newCapacity = oldCapacity ? oldCapacity * 2 : 16;
+            m_nodes.resize(newCapacity);
+
+            for (int32 i = newCapacity - 1; i >= oldCapacity; i--)
+            {
+                m_nodes[i].parent = m_freeList;
+                m_freeList = i;
+            }
+        }
+
+        int32 index = m_freeList;
+        m_freeList = m_nodes[index].parent;
+
+        aabb_tree_node& node = m_nodes[index];
+        node.parent = null_node;
+        node.children[0] = null_node;
+        node.children[1] = null_node;
+        node.height = 0;
+        node.userData = invalid_id;
+        return index;
+    }
+
+    void DynamicAABBTree::freeNode(int32 index)
+    {
+        aabb_tree_node& node = m_nodes[index];
+        node.parent = m_freeList;
+        node.height = -1;
+        m_freeList = index;
+    }
+
+    void DynamicAABBTree::insertLeaf(int32 leaf)
+    {
+        if (m_root == null_node)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = null_node;
+            return;
+        }
+
+        // Allocate first, growing the pool invalidates references to nodes.
+        int32 newParent = allocateNode();
+
+        math::vec3 leafLow = m_nodes[leaf].low;
+        math::vec3 leafHigh = m_nodes[leaf].high;
+
+        // Walk down to the sibling that increases the total surface area of the tree the least.
+        int32 index = m_root;
+        while (!m_nodes[index].isLeaf())
+        {
+            const aabb_tree_node& node = m_nodes[index];
+
+            float area = surfaceArea(node.low, node.high);
+            float combinedArea = surfaceArea(math::min(node.low, leafLow), math::max(node.high, leafHigh));
+
+            // Cost of making the leaf a sibling of this node.
+            float cost = 2.f * combinedArea;
+
+            // Every ancestor grows when the leaf is pushed further down.
+            float inheritanceCost = 2.f * (combinedArea - area);
+
+            float childCosts[2];
+            for (int i = 0; i < 2; i++)
+            {
+                const aabb_tree_node& child = m_nodes[node.children[i]];
+                float childCombinedArea = surfaceArea(math::min(child.low, leafLow), math::max(child.high, leafHigh));
+                childCosts[i] = inheritanceCost + (child.isLeaf() ? childCombinedArea : childCombinedArea - surfaceArea(child.low, child.high));
+            }
+
+            if (cost < childCosts[0] && cost < childCosts[1])
+                break;
+
+            index = childCosts[0] < childCosts[1] ? node.children[0] : node.children[1];
+        }
+
+        int32 sibling = index;
+        int32 oldParent = m_nodes[sibling].parent;
+
+        aabb_tree_node& parentNode = m_nodes[newParent];
+        parentNode.parent = oldParent;
+        parentNode.low = math::min(m_nodes[sibling].low, leafLow);
+        parentNode.high = math::max(m_nodes[sibling].high, leafHigh);
+        parentNode.height = m_nodes[sibling].height + 1;
+        parentNode.children[0] = sibling;
+        parentNode.children[1] = leaf;
+
+        if (oldParent != null_node)
+        {
+            aabb_tree_node& grandParent = m_nodes[oldParent];
+            grandParent.children[grandParent.children[0] == sibling ? 0 : 1] = newParent;
+        }
+        else
+        {
+            m_root = newParent;
+        }
+
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        refitAncestors(oldParent);
+    }
+
+    void DynamicAABBTree::removeLeaf(int32 leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null_node;
+            return;
+        }
+
+        int32 parent = m_nodes[leaf].parent;
+        int32 grandParent = m_nodes[parent].parent;
+        int32 sibling = m_nodes[parent].children[0] == leaf ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+
+        // The sibling takes the place of the parent.
+        if (grandParent != null_node)
+        {
+            aabb_tree_node& grandParentNode = m_nodes[grandParent];
+            grandParentNode.children[grandParentNode.children[0] == parent ? 0 : 1] = sibling;
+            m_nodes[sibling].parent = grandParent;
+            freeNode(parent);
+
+            refitAncestors(grandParent);
+        }
+        else
+        {
+            m_root = sibling;
+            m_nodes[sibling].parent = null_node;
+            freeNode(parent);
+        }
+    }
+
+    void DynamicAABBTree::refitAncestors(int32 index)
+    {
+        while (index != null_node)
+        {
+            index = balance(index);
+
+            aabb_tree_node& node = m_nodes[index];
+            const aabb_tree_node& child0 = m_nodes[node.children[0]];
+            const aabb_tree_node& child1 = m_nodes[node.children[1]];
+
+            node.height = 1 + math::max(child0.height, child1.height);
+            node.low = math::min(child0.low, child1.low);
+            node.high = math::max(child0.high, child1.high);
+
+            index = node.parent;
+        }
+    }
+
+    int32 DynamicAABBTree::balance(int32 indexA)
+    {
+        aabb_tree_node& a = m_nodes[indexA];
+        if (a.isLeaf() || a.height < 2)
+            return indexA;
+
+        // The higher child gets rotated up into the place of A, A takes the place of that child's higher child.
+        int32 side = m_nodes[a.children[1]].height - m_nodes[a.children[0]].height > 1 ? 1
+            : m_nodes[a.children[0]].height - m_nodes[a.children[1]].height > 1 ? 0 : -1;
+
+        if (side == -1)
+            return indexA;
+
+        int32 indexB = a.children[1 - side]; // Lower child, stays below A.
+        int32 indexC = a.children[side];     // Higher child, moves up.
+        aabb_tree_node& b = m_nodes[indexB];
+        aabb_tree_node& c = m_nodes[indexC];
+
+        int32 indexF = c.children[0];
+        int32 indexG = c.children[1];
+        aabb_tree_node& f = m_nodes[indexF];
+        aabb_tree_node& g = m_nodes[indexG];
+
+        // C replaces A under A's parent.
+        c.children[0] = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+
+        if (c.parent != null_node)
+        {
+            aabb_tree_node& parent = m_nodes[c.parent];
+            parent.children[parent.children[0] == indexA ? 0 : 1] = indexC;
+        }
+        else
+        {
+            m_root = indexC;
+        }
+
+        // The higher grandchild stays with C, the lower one moves to A.
+        bool keepF = f.height > g.height;
+        int32 indexKept = keepF ? indexF : indexG;
+        int32 indexMoved = keepF ? indexG : indexF;
+        aabb_tree_node& kept = m_nodes[indexKept];
+        aabb_tree_node& moved = m_nodes[indexMoved];
+
+        c.children[1] = indexKept;
+        a.children[side] = indexMoved;
+        moved.parent = indexA;
+
+        a.low = math::min(b.low, moved.low);
+        a.high = math::max(b.high, moved.high);
+        a.height = 1 + math::max(b.height, moved.height);
+
+        c.low = math::min(a.low, kept.low);
+        c.high = math::max(a.high, kept.high);
+        c.height = 1 + math::max(a.height, kept.height);
+
+        return indexC;
+    }
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <core/core.hpp>
+#include <physics/physicsconstants.hpp>
+
+namespace legion::physics
+{
+    /**@class DynamicAABBTree
+     * @brief Bounding volume hierarchy of axis aligned boxes that gets updated incrementally instead of being rebuilt.
+     * Every leaf (proxy) stores a fattened box so that small movements don't require the tree to change,
+     * only proxies that leave their fat box get reinserted. Internal nodes are kept balanced with tree rotations.
+     * All nodes live in one pooled array and are referred to by index, freed nodes get reused.
+     */
+    class DynamicAABBTree
+    {
+    public:
+        static constexpr int32 null_node = -1;
+
+        /**@brief Constructor of DynamicAABBTree
+         * @param margin The distance each proxy's box gets fattened by in every direction.
+         * @param displacementMultiplier How far ahead along the displacement of a moving proxy its box gets extended.
+         */
+        DynamicAABBTree(float margin = constants::aabbTreeFatMargin, float displacementMultiplier = constants::aabbTreeDisplacementMultiplier);
+
+        /**@brief Inserts a new proxy into the tree.
+         * @param aabb The tight lower and higher bounds of the proxy.
+         * @param userData Data to identify the proxy with, returned in query results through getUserData.
+         * @return The index of the proxy, stays the same until the proxy is destroyed.
+         */
+        int32 createProxy(const std::pair<math::vec3, math::vec3>& aabb, id_type userData);
+
+        /**@brief Removes a proxy from the tree, its index may be handed out again afterwards.
+         */
+        void destroyProxy(int32 proxy);
+
+        /**@brief Updates the bounds of a proxy. The tree only changes if the new bounds leave the proxy's fat bounds.
+         * @param aabb The new tight lower and higher bounds of the proxy.
+         * @param displacement The movement of the proxy since the last update, used to predict where it will go next.
+         * @return Whether the proxy had to be reinserted.
+         */
+        bool moveProxy(int32 proxy, const std::pair<math::vec3, math::vec3>& aabb, const math::vec3& displacement);
+
+        L_NODISCARD id_type getUserData(int32 proxy) const { return m_nodes[proxy].userData; }
+        void setUserData(int32 proxy, id_type userData) { m_nodes[proxy].userData = userData; }
+
+        /**@brief Gets the fattened bounds the tree stores for a proxy.
+         */
+        L_NODISCARD std::pair<math::vec3, math::vec3> getFatAABB(int32 proxy) const
+        {
+            return std::make_pair(m_nodes[proxy].low, m_nodes[proxy].high);
+        }
+
+        /**@brief Height of the tree, 0 when there is only one proxy.
+         */
+        L_NODISCARD int32 getHeight() const { return m_root == null_node ? 0 : m_nodes[m_root].height; }
+
+        L_NODISCARD size_type getProxyCount() const { return m_proxyCount; }
+
+        /**@brief Removes all proxies, the node storage is kept.
+         */
+        void clear();
+
+        /**@brief Calls the callback for every proxy whose fat bounds overlap the given bounds.
+         * @param callback Callable that takes the index of the proxy and returns whether the query should continue.
+         */
+        template<typename Callback>
+        void query(const math::vec3& low, const math::vec3& high, Callback&& callback) const
+        {
+            if (m_root == null_node)
+                return;
+
+            std::vector<int32> stack;
+            stack.reserve(64);
+            stack.push_back(m_root);
+
+            while (!stack.empty())
+            {
+                int32 index = stack.back();
+                stack.pop_back();
+
+                const aabb_tree_node& node = m_nodes[index];
+                if (!overlaps(node.low, node.high, low, high))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    if (!callback(index))
+                        return;
+                }
+                else
+                {
+                    stack.push_back(node.children[0]);
+                    stack.push_back(node.children[1]);
+                }
+            }
+        }
+
+        /**@brief Casts a ray through the tree and calls the callback for every proxy whose fat bounds it hits.
+         * @param origin The start of the ray.
+         * @param direction The normalized direction of the ray.
+         * @param maxDistance The length of the ray.
+         * @param callback Callable that takes the index of the proxy and the distance at which the ray enters its bounds.
+         * It returns the new length of the ray, returning 0 stops the cast and returning the current length keeps it going unchanged.
+         */
+        template<typename Callback>
+        void raycast(const math::vec3& origin, const math::vec3& direction, float maxDistance, Callback&& callback) const
+        {
+            if (m_root == null_node)
+                return;
+
+            // Division by zero gives infinity, which the slab test handles correctly.
+            math::vec3 inverseDirection = math::vec3(1.f) / direction;
+
+            std::vector<int32> stack;
+            stack.reserve(64);
+            stack.push_back(m_root);
+
+            while (!stack.empty())
+            {
+                int32 index = stack.back();
+                stack.pop_back();
+
+                const aabb_tree_node& node = m_nodes[index];
+                float entry;
+                if (!intersectsRay(node.low, node.high, origin, inverseDirection, maxDistance, entry))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    maxDistance = callback(index, entry);
+                    if (maxDistance <= 0.f)
+                        return;
+                }
+                else
+                {
+                    stack.push_back(node.children[0]);
+                    stack.push_back(node.children[1]);
+                }
+            }
+        }
+
+        /**@brief Calls the callback with the bounds and height of every node, leaves have height 0.
+         */
+        template<typename Callback>
+        void forEachNode(Callback&& callback) const
+        {
+            if (m_root == null_node)
+                return;
+
+            std::vector<int32> stack{ m_root };
+            while (!stack.empty())
+            {
+                const aabb_tree_node& node = m_nodes[stack.back()];
+                stack.pop_back();
+
+                callback(node.low, node.high, node.height);
+
+                if (!node.isLeaf())
+                {
+                    stack.push_back(node.children[0]);
+                    stack.push_back(node.children[1]);
+                }
+            }
+        }
+
+    private:
+        struct aabb_tree_node
+        {
+            math::vec3 low;
+            math::vec3 high;
+            id_type userData = invalid_id;
+            int32 parent = null_node; // Next node in the free list while the node is unused.
+            int32 children[2] = { null_node, null_node };
+            int32 height = -1; // -1 while the node is unused.
+
+            bool isLeaf() const { return children[0] == null_node; }
+        };
+
+        std::vector<aabb_tree_node> m_nodes;
+        int32 m_root = null_node;
+        int32 m_freeList = null_node;
+        size_type m_proxyCount = 0;
+
+        float m_margin;
+        float m_displacementMultiplier;
+
+        int32 allocateNode();
+        void freeNode(int32 index);
+
+        void insertLeaf(int32 leaf);
+        void removeLeaf(int32 leaf);
+
+        /**@brief Recalculates the bounds and heights of the nodes from the given node up to the root, rotating unbalanced nodes on the way.
+         */
+        void refitAncestors(int32 index);
+
+        /**@brief Rotates the given node if one child is more than one level higher than the other.
+         * @return The index of the node that took the place of the given node.
+         */
+        int32 balance(int32 index);
+
+        static float surfaceArea(const math::vec3& low, const math::vec3& high)
+        {
+            math::vec3 extents = high - low;
+            return 2.f * (extents.x * extents.y + extents.y * extents.z + extents.z * extents.x);
+        }
+
+        static bool overlaps(const math::vec3& low0, const math::vec3& high0, const math::vec3& low1, const math::vec3& high1)
+        {
+            return low0.x <= high1.x && high0.x >= low1.x &&
+                low0.y <= high1.y && high0.y >= low1.y &&
+                low0.z <= high1.z && high0.z >= low1.z;
+        }
+
+        static bool contains(const math::vec3& outerLow, const math::vec3& outerHigh, const math::vec3& innerLow, const math::vec3& innerHigh)
+        {
+            return outerLow.x <= innerLow.x && outerLow.y <= innerLow.y && outerLow.z <= innerLow.z &&
+                innerHigh.x <= outerHigh.x && innerHigh.y <= outerHigh.y && innerHigh.z <= outerHigh.z;
+        }
+
+        static bool intersectsRay(const math::vec3& low, const math::vec3& high, const math::vec3& origin, const math::vec3& inverseDirection, float maxDistance, float& entry)
+        {
+            math::vec3 t0 = (low - origin) * inverseDirection;
+            math::vec3 t1 = (high - origin) * inverseDirection;
+            math::vec3 tMin = math::min(t0, t1);
+            math::vec3 tMax = math::max(t0, t1);
+
+            float enter = math::max(math::max(tMin.x, tMin.y), math::max(tMin.z, 0.f));
+            float exit = math::min(math::min(tMax.x, tMax.y), math::min(tMax.z, maxDistance));
+
+            entry = enter;
+            return enter <= exit;
+        }
+    };
+}
@@ -6,6 +6,7 @@
 #include <core/core.hpp>
 #include <physics/components/physics_component.hpp>
 #include <physics/data/penetrationquery.hpp>
+#include <physics/data/seperating_axis_hint.hpp>
 
 namespace legion::physics
 {
@@ -37,6 +38,9 @@ namespace legion::physics
 
         bool isColliding;
 
+        // Separating feature found in the previous step, updated by the collision check for the next one.
+        seperating_axis_hint seperatingAxisHint;
+
         /*void DEBUG_checkIDAndBreak(std::string firstID,std::string secondID) const
         {
             auto idHA = entityA.get_component_handle<identifier>();
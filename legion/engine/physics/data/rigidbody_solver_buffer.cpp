@@ -0,0 +1,135 @@
+#include <physics/data/rigidbody_solver_buffer.hpp>
+
+namespace legion::physics
+{
+    void rigidbody_solver_buffer::resize(size_type count)
+    {
+        // Round up to a whole group so the last group can be loaded and stored as a whole.
+        size_type paddedCount = (count + simd_width - 1) / simd_width * simd_width;
+
+        active.resize(count);
+        inverseMass.resize(paddedCount);
+        for (size_type axis = 0; axis < 3; axis++)
+        {
+            velocity[axis].resize(paddedCount);
+            angularVelocity[axis].resize(paddedCount);
+            forceAccumulator[axis].resize(paddedCount);
+            torqueAccumulator[axis].resize(paddedCount);
+        }
+
+        for (auto& element : inverseInertiaTensor)
+            element.resize(paddedCount);
+    }
+
+    void rigidbody_solver_buffer::gather(const ecs::component_container<rigidbody>& rigidbodies, const std::vector<byte>& hasRigidBodies, size_type begin, size_type end)
+    {
+        OPTICK_EVENT();
+        for (size_type i = begin; i < end; i++)
+        {
+            active[i] = hasRigidBodies[i] && !rigidbodies[i].isAsleep;
+            if (!active[i])
+            {
+                // Integrated along with the rest of its group but never written back.
+                inverseMass[i] = 0.f;
+                for (size_type axis = 0; axis < 3; axis++)
+                {
+                    velocity[axis][i] = 0.f;
+                    angularVelocity[axis][i] = 0.f;
+                    forceAccumulator[axis][i] = 0.f;
+                    torqueAccumulator[axis][i] = 0.f;
+                }
+
+                for (auto& element : inverseInertiaTensor)
+                    element[i] = 0.f;
+                continue;
+            }
+
+            const rigidbody& rb = rigidbodies[i];
+            inverseMass[i] = rb.inverseMass;
+
+            for (size_type axis = 0; axis < 3; axis++)
+            {
+                velocity[axis][i] = rb.velocity[axis];
+                angularVelocity[axis][i] = rb.angularVelocity[axis];
+                forceAccumulator[axis][i] = rb.forceAccumulator[axis];
+                torqueAccumulator[axis][i] = rb.torqueAccumulator[axis];
+            }
+
+            for (size_type column = 0; column < 3; column++)
+                for (size_type row = 0; row < 3; row++)
+                    inverseInertiaTensor[column * 3 + row][i] = rb.globalInverseInertiaTensor[column][row];
+        }
+    }
+
+    void rigidbody_solver_buffer::integrate(float deltaTime, size_type begin, size_type end)
+    {
+        OPTICK_EVENT();
+#if defined(LEGION_SSE)
+        // Same as integrate_scalar, the last group reads and writes the padding.
+        __m128 dt = _mm_set1_ps(deltaTime);
+        __m128 gravity[3] = { _mm_set1_ps(constants::gravity.x), _mm_set1_ps(constants::gravity.y), _mm_set1_ps(constants::gravity.z) };
+
+        for (size_type i = begin; i < end; i += simd_width)
+        {
+            __m128 invMass = _mm_loadu_ps(&inverseMass[i]);
+
+            __m128 torque[3];
+            for (size_type axis = 0; axis < 3; axis++)
+            {
+                __m128 acc = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&forceAccumulator[axis][i]), invMass), gravity[axis]);
+                _mm_storeu_ps(&velocity[axis][i], _mm_add_ps(_mm_loadu_ps(&velocity[axis][i]), _mm_mul_ps(acc, dt)));
+
+                torque[axis] = _mm_loadu_ps(&torqueAccumulator[axis][i]);
+            }
+
+            // Row vector times matrix, every component of the result is the dot product of the torque and one column.
+            for (size_type column = 0; column < 3; column++)
+            {
+                __m128 angularAcc = _mm_mul_ps(torque[0], _mm_loadu_ps(&inverseInertiaTensor[column * 3][i]));
+                angularAcc = _mm_add_ps(angularAcc, _mm_mul_ps(torque[1], _mm_loadu_ps(&inverseInertiaTensor[column * 3 + 1][i])));
+                angularAcc = _mm_add_ps(angularAcc, _mm_mul_ps(torque[2], _mm_loadu_ps(&inverseInertiaTensor[column * 3 + 2][i])));
+
+                _mm_storeu_ps(&angularVelocity[column][i], _mm_add_ps(_mm_loadu_ps(&angularVelocity[column][i]), _mm_mul_ps(angularAcc, dt)));
+            }
+        }
+#else
+        integrate_scalar(deltaTime, begin, end);
+#endif
+    }
+
+    void rigidbody_solver_buffer::integrate_scalar(float deltaTime, size_type begin, size_type end)
+    {
+        // Same as rigidbody integration on a single body:
+        // velocity += (force * inverseMass + gravity) * dt
+        // angularVelocity += (torque * inverseInertiaTensor) * dt
+        for (size_type i = begin; i < end; i++)
+        {
+            for (size_type axis = 0; axis < 3; axis++)
+                velocity[axis][i] += (forceAccumulator[axis][i] * inverseMass[i] + constants::gravity[axis]) * deltaTime;
+
+            for (size_type column = 0; column < 3; column++)
+            {
+                float angularAcc = torqueAccumulator[0][i] * inverseInertiaTensor[column * 3][i] +
+                    torqueAccumulator[1][i] * inverseInertiaTensor[column * 3 + 1][i] +
+                    torqueAccumulator[2][i] * inverseInertiaTensor[column * 3 + 2][i];
+
+                angularVelocity[column][i] += angularAcc * deltaTime;
+            }
+        }
+    }
+
+    void rigidbody_solver_buffer::scatter(ecs::component_container<rigidbody>& rigidbodies, size_type begin, size_type end) const
+    {
+        OPTICK_EVENT();
+        for (size_type i = begin; i < end; i++)
+        {
+            if (!active[i])
+                continue;
+
+            rigidbody& rb = rigidbodies[i];
+            rb.velocity = math::vec3(velocity[0][i], velocity[1][i], velocity[2][i]);
+            rb.angularVelocity = math::vec3(angularVelocity[0][i], angularVelocity[1][i], angularVelocity[2][i]);
+            rb.resetAccumulators();
+        }
+    }
+}
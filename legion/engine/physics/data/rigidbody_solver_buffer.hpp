@@ -0,0 +1,54 @@
+#pragma once
+#include <core/core.hpp>
+#include <physics/components/rigidbody.hpp>
+
+namespace legion::physics
+{
+    /**@class rigidbody_solver_buffer
+     * @brief Packed copy of the state of the rigidbodies that the integrator needs, every member is stored in its own array.
+     * Body i of the rigidbody container is stored at index i, so separate ranges can be gathered, integrated and scattered by separate jobs.
+     * Bodies are integrated four at a time with SIMD, the arrays are padded so the last group can be loaded as a whole.
+     * The buffer is kept by the physics system between steps so its storage gets reused.
+     */
+    struct rigidbody_solver_buffer
+    {
+        // Amount of bodies integrated at once, ranges passed to integrate need to start at a multiple of this.
+        static constexpr size_type simd_width = 4;
+
+        // Whether the body at the same index gets written back, entities without a rigidbody and sleeping rigidbodies don't.
+        std::vector<byte> active;
+
+        std::vector<float> inverseMass;
+        std::vector<float> velocity[3];
+        std::vector<float> angularVelocity[3];
+        std::vector<float> forceAccumulator[3];
+        std::vector<float> torqueAccumulator[3];
+
+        // Global inverse inertia tensor, element column * 3 + row.
+        std::vector<float> inverseInertiaTensor[9];
+
+        /**@brief Makes room for count bodies, storage from previous steps gets reused.
+         */
+        void resize(size_type count);
+
+        /**@brief Packs the bodies in [begin, end). Entities without a rigidbody and sleeping rigidbodies are packed as zeros.
+         * @param hasRigidBodies Whether the entity at the same index in rigidbodies has a rigidbody.
+         */
+        void gather(const ecs::component_container<rigidbody>& rigidbodies, const std::vector<byte>& hasRigidBodies, size_type begin, size_type end);
+
+        /**@brief Applies the accumulated forces, torques and gravity to the velocities of the bodies in [begin, end).
+         * @param begin First body, a multiple of simd_width.
+         */
+        void integrate(float deltaTime, size_type begin, size_type end);
+
+        /**@brief Same as integrate but one body at a time, the only path used when LEGION_SSE isn't defined.
+         */
+        void integrate_scalar(float deltaTime, size_type begin, size_type end);
+
+        /**@brief Writes the velocities of the active bodies in [begin, end) back to the rigidbodies they were gathered from and clears their accumulators.
+         */
+        void scatter(ecs::component_container<rigidbody>& rigidbodies, size_type begin, size_type end) const;
+
+        L_NODISCARD size_type size() const noexcept { return active.size(); }
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <core/core.hpp>
+
+namespace legion::physics
+{
+    /**@brief The kind of feature that separated two convex colliders.
+     */
+    enum struct seperating_axis_type : uint8
+    {
+        none,
+        // A face of colliderA, featureA is the index of the face.
+        faceA,
+        // A face of colliderB, featureB is the index of the face.
+        faceB,
+        // An edge of each collider, featureA and featureB are indices into the edges of their convex_world_data.
+        edges
+    };
+
+    /**@struct seperating_axis_hint
+     * @brief The feature that separated a pair of colliders in the last step.
+     * Colliders that were apart usually still are, so the hinted axis is tested before any of the others.
+     */
+    struct seperating_axis_hint
+    {
+        seperating_axis_type type = seperating_axis_type::none;
+        size_type featureA = 0;
+        size_type featureB = 0;
+    };
+}
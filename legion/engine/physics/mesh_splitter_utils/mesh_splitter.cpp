@@ -91,10 +91,12 @@ namespace legion::physics
 
         //-------------------------------- use each polygon list to create a new object -----------------------------------------//
 
-        for (auto& polygonIsland : outputPolygonIslandsGenerated)
+        ecs::entity_container fragments = PrimitiveMesh::CreateGameObjects(outputPolygonIslandsGenerated.size());
+
+        for (size_type i = 0; i < outputPolygonIslandsGenerated.size(); i++)
         {
-            PrimitiveMesh newMesh(owner, polygonIsland, ownerMaterialH);
-            auto newEnt = newMesh.InstantiateNewGameObject();
+            PrimitiveMesh newMesh(owner, outputPolygonIslandsGenerated[i], ownerMaterialH);
+            auto newEnt = newMesh.InstantiateNewGameObject(fragments[i]);
 
             entitiesGenerated.push_back(newEnt);
         }
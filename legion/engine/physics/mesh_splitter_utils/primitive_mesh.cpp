@@ -14,11 +14,20 @@ namespace legion::physics
     }
 
     ecs::entity_handle PrimitiveMesh::InstantiateNewGameObject()
+    {
+        return InstantiateNewGameObject(m_ecs->createEntity());
+    }
+
+    ecs::entity_container PrimitiveMesh::CreateGameObjects(size_type count)
+    {
+        return m_ecs->createEntities(count);
+    }
+
+    ecs::entity_handle PrimitiveMesh::InstantiateNewGameObject(ecs::entity_handle ent)
     {
         auto [originalPosH, originalRotH, originalScaleH] = originalEntity.get_component_handles<transform>();
         math::mat4 trans = math::compose(originalScaleH.read(), originalRotH.read(), originalPosH.read());
       
-        auto ent = m_ecs->createEntity();
         math::vec3 offset;
 
         mesh newMesh;
@@ -18,6 +18,14 @@ namespace legion::physics
 
 		ecs::entity_handle InstantiateNewGameObject();
 
+		/**@brief Turns an already created entity into the game object of this mesh.
+		 */
+		ecs::entity_handle InstantiateNewGameObject(ecs::entity_handle ent);
+
+		/**@brief Creates the entities for a batch of meshes at once.
+		 */
+		static ecs::entity_container CreateGameObjects(size_type count);
+
 		static void SetECSRegistry(ecs::EcsRegistry* ecs);
 
 	private:
@@ -69,13 +69,20 @@ namespace legion::physics
         math::vec3 centroidDir = transformA * math::vec4(convexA->GetLocalCentroid(), 0);
         math::vec3 positionA = math::vec3(transformA[3]) + centroidDir;
 
-        int facei = 0;
-        int facej = 0;
+        //----------------- Get all edges of every face of convexB once instead of once for every face of convexA ------------//
+        std::vector<std::vector<HalfEdgeEdge*>> convexBFaceEdges(convexB->GetHalfEdgeFaces().size());
+        for (size_type i = 0; i < convexBFaceEdges.size(); i++)
+        {
+            auto& faceEdges = convexBFaceEdges[i];
+            convexB->GetHalfEdgeFaces()[i]->forEachEdge([&faceEdges](HalfEdgeEdge* edge) { faceEdges.push_back(edge); });
+        }
+
+        std::vector<HalfEdgeEdge*> convexAHalfEdges;
 
         for (const auto faceA : convexA->GetHalfEdgeFaces())
         {
             //----------------- Get all edges of faceA ------------//
-            std::vector<HalfEdgeEdge*> convexAHalfEdges;
+            convexAHalfEdges.clear();
 
             auto lambda = [&convexAHalfEdges](HalfEdgeEdge* edge)
             {
@@ -83,20 +90,9 @@ namespace legion::physics
             };
 
             faceA->forEachEdge(lambda);
-            facej = 0;
 
-            for (const auto faceB : convexB->GetHalfEdgeFaces())
+            for (const auto& convexBHalfEdges : convexBFaceEdges)
             {
-                //----------------- Get all edges of faceB ------------//
-                std::vector<HalfEdgeEdge*> convexBHalfEdges;
-
-                auto lambda = [&convexBHalfEdges](HalfEdgeEdge* edge)
-                {
-                    convexBHalfEdges.push_back(edge);
-                };
-
-                faceB->forEachEdge(lambda);
-
                 for (HalfEdgeEdge* edgeA : convexAHalfEdges)
                 {
                     for (HalfEdgeEdge* edgeB : convexBHalfEdges)
@@ -146,15 +142,131 @@ namespace legion::physics
                         }
                     }
                 }
-                facej++;
             }
-            facei++;
         }
 
         maximumSeperation = currentMinimumSeperation;
         return currentMinimumSeperation > 0.0f;
     }
 
+    bool PhysicsStatics::FindSeperatingAxisByExtremePointProjection(const convex_world_data& worldA, const convex_world_data& worldB,
+        const std::vector<HalfEdgeFace*>& facesB, PointerEncapsulator<HalfEdgeFace>& refFace, float& maximumSeperation, size_type& refFaceIndex)
+    {
+        float currentMaximumSeperation = std::numeric_limits<float>::lowest();
+
+        for (size_type i = 0; i < facesB.size(); i++)
+        {
+            float seperation = GetFaceSeperation(worldA, worldB, i);
+
+            if (seperation > currentMaximumSeperation)
+            {
+                currentMaximumSeperation = seperation;
+                refFace.ptr = facesB[i];
+                refFaceIndex = i;
+            }
+
+            if (seperation > 0)
+            {
+                //we have found a seperating axis, we can exit early
+                maximumSeperation = currentMaximumSeperation;
+                return true;
+            }
+        }
+
+        //no seperating axis was found
+        maximumSeperation = currentMaximumSeperation;
+        return false;
+    }
+
+    bool PhysicsStatics::FindSeperatingAxisByGaussMapEdgeCheck(const convex_world_data& worldA, const convex_world_data& worldB, const math::vec3& positionA,
+        PointerEncapsulator<HalfEdgeEdge>& refEdge, PointerEncapsulator<HalfEdgeEdge>& incEdge, math::vec3& seperatingAxisFound, float& maximumSeperation,
+        size_type& refEdgeIndex, size_type& incEdgeIndex)
+    {
+        float currentMinimumSeperation = std::numeric_limits<float>::max();
+
+        // Goes through the edge pairs in the same order as the version that works on the colliders, so both find the same edges.
+        for (size_type faceA = 0; faceA + 1 < worldA.faceEdgeOffsets.size(); faceA++)
+        {
+            for (size_type faceB = 0; faceB + 1 < worldB.faceEdgeOffsets.size(); faceB++)
+            {
+                for (size_type edgeA = worldA.faceEdgeOffsets[faceA]; edgeA < worldA.faceEdgeOffsets[faceA + 1]; edgeA++)
+                {
+                    for (size_type edgeB = worldB.faceEdgeOffsets[faceB]; edgeB < worldB.faceEdgeOffsets[faceB + 1]; edgeB++)
+                    {
+                        math::vec3 seperatingAxis;
+                        float distance;
+                        if (!GetEdgeSeperation(worldA, worldB, positionA, edgeA, edgeB, seperatingAxis, distance))
+                        {
+                            continue;
+                        }
+
+                        if (distance < currentMinimumSeperation)
+                        {
+                            refEdge.ptr = worldA.edges[edgeA];
+                            incEdge.ptr = worldB.edges[edgeB];
+                            refEdgeIndex = edgeA;
+                            incEdgeIndex = edgeB;
+
+                            seperatingAxisFound = seperatingAxis;
+                            currentMinimumSeperation = distance;
+                        }
+                    }
+                }
+            }
+        }
+
+        maximumSeperation = currentMinimumSeperation;
+        return currentMinimumSeperation > 0.0f;
+    }
+
+    float PhysicsStatics::GetFaceSeperation(const convex_world_data& worldA, const convex_world_data& worldB, size_type faceIndexB)
+    {
+        const math::vec3& seperatingAxis = worldB.faceNormals[faceIndexB];
+        const math::vec3& facePositionB = worldB.faceCentroids[faceIndexB];
+
+        //get extreme point of other face in normal direction
+        math::vec3 worldSupportPoint;
+        worldA.getSupportPoint(-seperatingAxis, worldSupportPoint);
+
+        return math::dot(worldSupportPoint - facePositionB, seperatingAxis);
+    }
+
+    bool PhysicsStatics::GetEdgeSeperation(const convex_world_data& worldA, const convex_world_data& worldB, const math::vec3& positionA,
+        size_type edgeIndexA, size_type edgeIndexB, math::vec3& seperatingAxis, float& seperation)
+    {
+        const math::vec3& a1 = worldA.edgeFaceNormals[edgeIndexA];
+        const math::vec3& a2 = worldA.edgePairingFaceNormals[edgeIndexA];
+        const math::vec3 b1 = -worldB.edgeFaceNormals[edgeIndexB];
+        const math::vec3 b2 = -worldB.edgePairingFaceNormals[edgeIndexB];
+
+        //if the given edges don't create a minkowski face
+        if (!isMinkowskiFace(a1, a2, b1, b2, math::cross(a1, a2), math::cross(b1, b2)))
+        {
+            return false;
+        }
+
+        //get the seperating axis
+        seperatingAxis = math::cross(worldA.edgeDirections[edgeIndexA], worldB.edgeDirections[edgeIndexB]);
+
+        if (math::epsilonEqual(math::length(seperatingAxis), 0.0f, math::epsilon<float>()))
+        {
+            return false;
+        }
+
+        seperatingAxis = math::normalize(seperatingAxis);
+
+        const math::vec3& edgePositionA = worldA.edgePositions[edgeIndexA];
+
+        //check if its pointing in the right direction
+        if (math::dot(seperatingAxis, edgePositionA - positionA) < 0)
+        {
+            seperatingAxis = -seperatingAxis;
+        }
+
+        seperation = math::dot(seperatingAxis, worldB.edgePositions[edgeIndexB] - edgePositionA);
+        return true;
+    }
+
     bool PhysicsStatics::DetectConvexSphereCollision(ConvexCollider* convexA, const math::mat4& transformA, math::vec3 sphereWorldPosition, float sphereRadius,
         float& maximumSeperation)
     {
@@ -158,6 +158,42 @@ namespace legion::physics
         static bool FindSeperatingAxisByGaussMapEdgeCheck(ConvexCollider* convexA, ConvexCollider* convexB,
             const math::mat4& transformA, const math::mat4& transformB, PointerEncapsulator<HalfEdgeEdge>& refEdge, PointerEncapsulator<HalfEdgeEdge>& incEdge,
             math::vec3& seperatingAxisFound, float& maximumSeperation, bool shouldDebug = false);
+
+        /** @brief Same as FindSeperatingAxisByExtremePointProjection but uses the world space data of both colliders,
+         * so neither the vertices nor the faces have to be transformed.
+         * @param worldA the world data of the reference collider
+         * @param worldB the world data of the collider that will create the seperating axes
+         * @param facesB the faces of the collider that worldB was built from
+         * @param refFace [out] a HalfEdgeFace* that has a normal parallel to the seperating axis
+         * @param maximumSeperation [out] the seperation on the given seperating axis
+         * @param refFaceIndex [out] the index of refFace in facesB
+         * @return returns true if a seperating axis was found
+         */
+        static bool FindSeperatingAxisByExtremePointProjection(const convex_world_data& worldA, const convex_world_data& worldB,
+            const std::vector<HalfEdgeFace*>& facesB, PointerEncapsulator<HalfEdgeFace>& refFace, float& maximumSeperation, size_type& refFaceIndex);
+
+        /** @brief Same as FindSeperatingAxisByGaussMapEdgeCheck but uses the world space data of both colliders.
+         * @param positionA the world position of the centroid of the collider worldA was built from
+         * @param refEdgeIndex [out] the index of refEdge in the edges of worldA
+         * @param incEdgeIndex [out] the index of incEdge in the edges of worldB
+         * @return returns true if a seperating axis was found
+         */
+        static bool FindSeperatingAxisByGaussMapEdgeCheck(const convex_world_data& worldA, const convex_world_data& worldB, const math::vec3& positionA,
+            PointerEncapsulator<HalfEdgeEdge>& refEdge, PointerEncapsulator<HalfEdgeEdge>& incEdge, math::vec3& seperatingAxisFound, float& maximumSeperation,
+            size_type& refEdgeIndex, size_type& incEdgeIndex);
+
+        /** @brief Gets the seperation between the support point of worldA and a face of worldB along the normal of that face.
+         */
+        static float GetFaceSeperation(const convex_world_data& worldA, const convex_world_data& worldB, size_type faceIndexB);
+
+        /** @brief Checks if an edge of worldA and an edge of worldB create a minkowski face, and if they do gets the seperating axis they create.
+         * @param positionA the world position of the centroid of the collider worldA was built from
+         * @param seperatingAxis [out] the seperating axis, pointing away from positionA
+         * @param seperation [out] the seperation along seperatingAxis
+         * @return returns false if the edges don't create a minkowski face or are parallel
+         */
+        static bool GetEdgeSeperation(const convex_world_data& worldA, const convex_world_data& worldB, const math::vec3& positionA,
+            size_type edgeIndexA, size_type edgeIndexB, math::vec3& seperatingAxis, float& seperation);
       
         /** @brief Given a ConvexCollider and sphere with a position and a readius, checks if these 2 shapes are colliding
         */
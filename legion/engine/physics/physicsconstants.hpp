@@ -29,4 +29,14 @@ namespace legion::physics::constants
     static constexpr float polygonItersectionEpsilon = 0.01f;
 
     static constexpr float polygonSplitterEpsilon = 0.01f;
+
+    static constexpr float aabbTreeFatMargin = 0.1f;
+
+    static constexpr float aabbTreeDisplacementMultiplier = 2.0f;
+
+    static constexpr float sleepLinearVelocityThreshold = 0.05f;
+
+    static constexpr float sleepAngularVelocityThreshold = 0.05f;
+
+    static constexpr float timeToSleep = 0.5f;
 }
@@ -1,5 +1,6 @@
 #include <physics/systems/physicssystem.hpp>
 #include <physics/broadphasecollisionalgorithms/broadphaseuniformgridnocaching.hpp>
+#include <numeric>
 
 namespace legion::physics
 {
@@ -11,7 +12,10 @@ namespace legion::physics
 
     void PhysicsSystem::setup()
     {
-        createProcess<&PhysicsSystem::fixedUpdate>("Physics", m_timeStep);
+        // Fracturing splits meshes and creates new entities from them, so the mesh components are written as well.
+        createProcess<&PhysicsSystem::fixedUpdate>("Physics", m_timeStep)
+            .reads<scale, hierarchy, world_transform>()
+            .writes<position, rotation, rigidbody, physicsComponent, FractureCountdown, Fracturer, MeshSplitter, mesh_filter, rendering::mesh_renderer>();
 
         manifoldPrecursorQuery = createQuery<position, rotation, scale, physicsComponent>();
 
@@ -50,69 +54,75 @@ namespace legion::physics
         {
             OPTICK_EVENT("Narrowphase");
 
-            std::set<std::pair<id_type, id_type>> idPairings;
+            std::vector<narrowphase_pair> candidatePairs;
+            collectCandidatePairs(manifoldPrecursorGrouping, hasRigidBodies, rigidbodies, candidatePairs);
+
+            // Every job writes into its own buffer, merging them in job order keeps the results independent of which thread ran what.
+            std::vector<narrowphase_buffer> buffers((candidatePairs.size() + narrowphaseChunkSize - 1) / narrowphaseChunkSize);
 
-            size_type totalChecks = 0;
-            for (auto& manifoldPrecursor : manifoldPrecursorGrouping)
             {
-                if (manifoldPrecursor.size() == 0) continue;
-                for (int i = 0; i < manifoldPrecursor.size() - 1; i++)
-                {
-                    for (int j = i + 1; j < manifoldPrecursor.size(); j++)
+                OPTICK_EVENT("Constructing manifolds");
+                m_scheduler->queueJobs(buffers.size(), [&]() {
+                    id_type chunk = async::this_job::get_id();
+                    auto& buffer = buffers[chunk];
+
+                    size_type start = chunk * narrowphaseChunkSize;
+                    size_type end = math::min(start + narrowphaseChunkSize, candidatePairs.size());
+
+                    for (size_type i = start; i < end; i++)
                     {
-                        totalChecks++;
-                        assert(j != manifoldPrecursor.size());
-
-                        physics_manifold_precursor& precursorA = manifoldPrecursor.at(i);
-                        physics_manifold_precursor& precursorB = manifoldPrecursor.at(j);
-
-                        //check if we have found this pairing before
-                        std::pair<id_type, id_type> precursorPairing = std::make_pair(precursorA.id, precursorB.id);
-                        auto foundPairingIter = idPairings.find(precursorPairing);
-
-                        if (foundPairingIter != idPairings.end())
-                        {
-                            //early out so we dont solve the collision twice
-                            continue;
-                        }
-                        else
-                        {
-                            idPairings.insert(precursorPairing);
-                        }
-                       
-
-                        auto& precursorPhyCompA = *precursorA.physicsComp;
-                        auto& precursorPhyCompB = *precursorB.physicsComp;
-
-                        auto& precursorRigidbodyA = rigidbodies[precursorA.id];
-                        auto& precursorRigidbodyB = rigidbodies[precursorB.id];
-
-                        //only construct a manifold if at least one of these requirement are fulfilled
-                        //1. One of the physicsComponents is a trigger and the other one is not
-                        //2. One of the physicsComponent's entity has a rigidbody and the other one is not a trigger
-                        //3. Both have a rigidbody
-
-                        bool isBetweenTriggerAndNonTrigger =
-                            (precursorPhyCompA.isTrigger && !precursorPhyCompB.isTrigger) || (!precursorPhyCompA.isTrigger && precursorPhyCompB.isTrigger);
-
-                        bool isBetweenRigidbodyAndNonTrigger =
-                            (hasRigidBodies[precursorA.id] && !precursorPhyCompB.isTrigger) || (hasRigidBodies[precursorB.id] && !precursorPhyCompA.isTrigger);
-
-                        bool isBetween2Rigidbodies = (hasRigidBodies[precursorA.id] && hasRigidBodies[precursorB.id]);
-
-
-                        if (isBetweenTriggerAndNonTrigger || isBetweenRigidbodyAndNonTrigger || isBetween2Rigidbodies)
-                        {
-                            constructManifoldsWithPrecursors(rigidbodies, hasRigidBodies, precursorA, precursorB,
-                                manifoldsToSolve,
-                                hasRigidBodies[precursorA.id] || hasRigidBodies[precursorB.id]
-                                , precursorPhyCompA.isTrigger || precursorPhyCompB.isTrigger);
-                        }
+                        auto& [precursorA, precursorB] = candidatePairs[i];
+                        constructManifoldsWithPrecursors(rigidbodies, hasRigidBodies, *precursorA, *precursorB,
+                            precursorA->physicsComp->isTrigger || precursorB->physicsComp->isTrigger ? buffer.triggerManifolds : buffer.manifolds,
+                            buffer.seperatingAxisHints,
+                            hasRigidBodies[precursorA->id] || hasRigidBodies[precursorB->id]
+                            , precursorA->physicsComp->isTrigger || precursorB->physicsComp->isTrigger);
                     }
+                    }).wait();
+            }
+
+            {
+                OPTICK_EVENT("Merging manifolds");
+
+                size_type manifoldCount = 0;
+                for (auto& buffer : buffers)
+                    manifoldCount += buffer.manifolds.size();
+                manifoldsToSolve.reserve(manifoldCount);
+
+                // Events are raised from this thread so that listeners don't have to be thread safe.
+                for (auto& buffer : buffers)
+                {
+                    for (auto& manifold : buffer.triggerManifolds)
+                        raiseEvent<trigger_event>(&manifold, m_timeStep);
+
+                    for (auto& manifold : buffer.manifolds)
+                        manifoldsToSolve.emplace_back(std::move(manifold));
+                }
+
+                for (auto& manifold : manifoldsToSolve)
+                    raiseEvent<collision_event>(&manifold, m_timeStep);
+            }
+
+            {
+                OPTICK_EVENT("Updating seperating axis cache");
+                m_physicsStep++;
+
+                for (auto& buffer : buffers)
+                {
+                    for (auto& [key, hint] : buffer.seperatingAxisHints)
+                        m_seperatingAxisCache[key] = { hint, m_physicsStep };
+                }
+
+                // Pairs that weren't checked this step have moved apart or gone to sleep, they start without a hint when they come back.
+                for (auto itr = m_seperatingAxisCache.begin(); itr != m_seperatingAxisCache.end();)
+                {
+                    if (itr->second.lastStep != m_physicsStep)
+                        itr = m_seperatingAxisCache.erase(itr);
+                    else
+                        ++itr;
                 }
             }
-            //log::debug("groupings {}", manifoldPrecursorGrouping.size());
-            //log::debug("total checks {}", totalChecks);
+            //log::debug("candidate pairs {}", candidatePairs.size());
         }
 
         //------------------------------------------------ Pre Collision Solve Events --------------------------------------------//
@@ -201,37 +211,49 @@ namespace legion::physics
         //the effective mass remains the same for every iteration of the solver. This means that we can precalculate it before
         //we start the solver
 
-        //log::debug("--------------Logging contacts for manifold -------------------");
-        {
-            OPTICK_EVENT("Resolve collisions");
-
-            initializeManifolds(manifoldsToSolve, manifoldValidity);
+        //manifolds that share no rigidbodies can't affect each other, so islands can be solved by different jobs.
+        //the order of the manifolds within an island stays the same, so the result is the same as solving them all on one thread.
+        std::vector<std::vector<size_type>> islands;
+        std::vector<size_type> bodyIslands;
+        buildIslands(manifoldsToSolve, manifoldValidity, rigidbodies, islands, bodyIslands);
 
+        //most islands are a single resting body, so consecutive islands are batched until every job has islandChunkSize manifolds to solve
+        std::vector<size_type> islandBatchStarts;
+        size_type batchManifolds = islandChunkSize;
+        for (size_type i = 0; i < islands.size(); i++)
+        {
+            if (batchManifolds >= islandChunkSize)
             {
-                OPTICK_EVENT("Resolve contact constraints");
-
-                //resolve contact constraint
-                for (size_t contactIter = 0;
-                    contactIter < constants::contactSolverIterationCount; contactIter++)
-                {
-                    resolveContactConstraint(manifoldsToSolve, manifoldValidity, deltaTime, contactIter);
-                }
+                islandBatchStarts.push_back(i);
+                batchManifolds = 0;
             }
+            batchManifolds += islands[i].size();
+        }
+        islandBatchStarts.push_back(islands.size());
 
-            {
-                OPTICK_EVENT("Resolve friction constraints");
+        //log::debug("--------------Logging contacts for manifold -------------------");
+        {
+            OPTICK_EVENT("Resolve collisions");
 
-                //resolve friction constraint
-                for (size_t frictionIter = 0;
-                    frictionIter < constants::frictionSolverIterationCount; frictionIter++)
-                {
-                    resolveFrictionConstraint(manifoldsToSolve, manifoldValidity);
-                }
-            }
+            auto solveBatch = [&](size_type batch)
+            {
+                for (size_type i = islandBatchStarts[batch]; i < islandBatchStarts[batch + 1]; i++)
+                    solveIsland(manifoldsToSolve, islands[i], deltaTime);
+            };
+
+            size_type batchCount = islandBatchStarts.size() - 1;
+            if (batchCount == 1) // Not worth the overhead of queueing a job.
+                solveBatch(0);
+            else if (batchCount > 1)
+                m_scheduler->queueJobs(batchCount, [&]() {
+                    solveBatch(async::this_job::get_id());
+                    }).wait();
 
             {
                 OPTICK_EVENT("Converge manifolds");
 
+                //colliders without a rigidbody can be part of multiple islands, so this can't be done per island
+
                 //reset convergance identifiers for all colliders
                 for (auto& manifold : manifoldsToSolve)
                 {
@@ -250,10 +272,235 @@ namespace legion::physics
             }
         }
 
+        updateSleepStates(hasRigidBodies, rigidbodies, bodyIslands, deltaTime);
+    }
+
+    void PhysicsSystem::buildIslands(std::vector<physics_manifold>& manifoldsToSolve, std::vector<byte>& manifoldValidity, ecs::component_container<rigidbody>& rigidbodies,
+        std::vector<std::vector<size_type>>& islands, std::vector<size_type>& bodyIslands)
+    {
+        OPTICK_EVENT();
+
+        //union-find over the rigidbodies, every set is one island
+        bodyIslands.resize(rigidbodies.size());
+        std::iota(bodyIslands.begin(), bodyIslands.end(), 0);
+
+        auto findIsland = [&](size_type body)
+        {
+            while (bodyIslands[body] != body)
+            {
+                bodyIslands[body] = bodyIslands[bodyIslands[body]];
+                body = bodyIslands[body];
+            }
+            return body;
+        };
+
+        auto bodyIndex = [&](rigidbody* rb) { return static_cast<size_type>(rb - rigidbodies.data()); };
+
+        std::vector<size_type> wokenIslands;
+
+        for (size_type i = 0; i < manifoldsToSolve.size(); i++)
+        {
+            auto& manifold = manifoldsToSolve[i];
+            if (!manifoldValidity[i])
+                continue;
+
+            //only an awake rigidbody wakes up a sleeping one, waking an awake one would reset its sleep timer and keep resting bodies awake forever
+            bool isAwakeA = manifold.rigidbodyA && !manifold.rigidbodyA->isAsleep;
+            bool isAwakeB = manifold.rigidbodyB && !manifold.rigidbodyB->isAsleep;
+
+            if (manifold.rigidbodyA && manifold.rigidbodyA->isAsleep && isAwakeB)
+            {
+                manifold.rigidbodyA->wakeUp();
+                wokenIslands.push_back(manifold.rigidbodyA->sleepingIsland);
+            }
+            if (manifold.rigidbodyB && manifold.rigidbodyB->isAsleep && isAwakeA)
+            {
+                manifold.rigidbodyB->wakeUp();
+                wokenIslands.push_back(manifold.rigidbodyB->sleepingIsland);
+            }
+
+            if (manifold.rigidbodyA && manifold.rigidbodyB)
+            {
+                size_type islandA = findIsland(bodyIndex(manifold.rigidbodyA));
+                size_type islandB = findIsland(bodyIndex(manifold.rigidbodyB));
+                if (islandA != islandB)
+                    bodyIslands[math::max(islandA, islandB)] = math::min(islandA, islandB);
+            }
+        }
+
+        //pairs of sleeping rigidbodies aren't checked, so waking only the touched rigidbodies would wake a stack one layer per step.
+        //everything that fell asleep together with a woken rigidbody gets woken up instead and is checked from the next step on.
+        if (!wokenIslands.empty())
+        {
+            std::sort(wokenIslands.begin(), wokenIslands.end());
+            for (auto& rb : rigidbodies)
+            {
+                if (rb.isAsleep && std::binary_search(wokenIslands.begin(), wokenIslands.end(), rb.sleepingIsland))
+                    rb.wakeUp();
+            }
+        }
+
+        for (size_type body = 0; body < bodyIslands.size(); body++)
+            bodyIslands[body] = findIsland(body);
+
+        //islands are numbered in the order of their first manifold, which keeps them in the same order every step
+        constexpr size_type noIsland = std::numeric_limits<size_type>::max();
+        std::vector<size_type> islandIndices(rigidbodies.size(), noIsland);
+        for (size_type i = 0; i < manifoldsToSolve.size(); i++)
+        {
+            auto& manifold = manifoldsToSolve[i];
+            if (!manifoldValidity[i])
+                continue;
+
+            size_type island = bodyIslands[bodyIndex(manifold.rigidbodyA ? manifold.rigidbodyA : manifold.rigidbodyB)];
+            if (islandIndices[island] == noIsland)
+            {
+                islandIndices[island] = islands.size();
+                islands.emplace_back();
+            }
+
+            islands[islandIndices[island]].push_back(i);
+        }
+    }
+
+    void PhysicsSystem::solveIsland(std::vector<physics_manifold>& manifoldsToSolve, const std::vector<size_type>& island, float deltaTime)
+    {
+        OPTICK_EVENT();
+
+        initializeManifolds(manifoldsToSolve, island);
+
+        {
+            OPTICK_EVENT("Resolve contact constraints");
+
+            //resolve contact constraint
+            for (size_t contactIter = 0;
+                contactIter < constants::contactSolverIterationCount; contactIter++)
+            {
+                resolveContactConstraint(manifoldsToSolve, island, deltaTime, contactIter);
+            }
+        }
+
+        {
+            OPTICK_EVENT("Resolve friction constraints");
+
+            //resolve friction constraint
+            for (size_t frictionIter = 0;
+                frictionIter < constants::frictionSolverIterationCount; frictionIter++)
+            {
+                resolveFrictionConstraint(manifoldsToSolve, island);
+            }
+        }
+    }
+
+    void PhysicsSystem::updateSleepStates(std::vector<byte>& hasRigidBodies, ecs::component_container<rigidbody>& rigidbodies, const std::vector<size_type>& bodyIslands, float deltaTime)
+    {
+        OPTICK_EVENT();
+
+        //an island can only sleep as soon as its most recently moving rigidbody can
+        std::vector<float> islandSleepTimers(rigidbodies.size(), std::numeric_limits<float>::max());
+
+        for (size_type body = 0; body < rigidbodies.size(); body++)
+        {
+            auto& rb = rigidbodies[body];
+            if (!hasRigidBodies[body] || rb.isAsleep)
+                continue;
+
+            bool isResting =
+                math::length2(rb.velocity) < constants::sleepLinearVelocityThreshold * constants::sleepLinearVelocityThreshold &&
+                math::length2(rb.angularVelocity) < constants::sleepAngularVelocityThreshold * constants::sleepAngularVelocityThreshold;
+
+            rb.sleepTimer = isResting ? rb.sleepTimer + deltaTime : 0.0f;
+
+            float& islandSleepTimer = islandSleepTimers[bodyIslands[body]];
+            islandSleepTimer = math::min(islandSleepTimer, rb.sleepTimer);
+        }
+
+        //every island that falls asleep gets a new id, so it can be woken up as a whole
+        std::vector<size_type> sleepingIslands(rigidbodies.size(), 0);
+
+        for (size_type body = 0; body < rigidbodies.size(); body++)
+        {
+            auto& rb = rigidbodies[body];
+            if (!hasRigidBodies[body] || rb.isAsleep)
+                continue;
+
+            size_type island = bodyIslands[body];
+            if (islandSleepTimers[island] < constants::timeToSleep)
+                continue;
+
+            if (!sleepingIslands[island])
+                sleepingIslands[island] = ++m_sleepingIslandCount;
+
+            rb.sleep();
+            rb.sleepingIsland = sleepingIslands[island];
+        }
+    }
+
+    void PhysicsSystem::collectCandidatePairs(std::vector<std::vector<physics_manifold_precursor>>& manifoldPrecursorGrouping, std::vector<byte>& hasRigidBodies,
+        ecs::component_container<rigidbody>& rigidbodies, std::vector<narrowphase_pair>& candidatePairs)
+    {
+        OPTICK_EVENT();
+        for (auto& manifoldPrecursor : manifoldPrecursorGrouping)
+        {
+            for (size_type i = 0; i + 1 < manifoldPrecursor.size(); i++)
+            {
+                for (size_type j = i + 1; j < manifoldPrecursor.size(); j++)
+                {
+                    physics_manifold_precursor* precursorA = &manifoldPrecursor[i];
+                    physics_manifold_precursor* precursorB = &manifoldPrecursor[j];
+
+                    if (!precursorA->physicsComp || !precursorB->physicsComp)
+                        continue;
+
+                    // A pair can show up in multiple groupings in either order, always put the lowest id first so duplicates can be found.
+                    if (precursorB->id < precursorA->id)
+                        std::swap(precursorA, precursorB);
+
+                    auto& precursorPhyCompA = *precursorA->physicsComp;
+                    auto& precursorPhyCompB = *precursorB->physicsComp;
+
+                    //only construct a manifold if at least one of these requirement are fulfilled
+                    //1. One of the physicsComponents is a trigger and the other one is not
+                    //2. One of the physicsComponent's entity has a rigidbody and the other one is not a trigger
+                    //3. Both have a rigidbody
+
+                    bool isBetweenTriggerAndNonTrigger =
+                        (precursorPhyCompA.isTrigger && !precursorPhyCompB.isTrigger) || (!precursorPhyCompA.isTrigger && precursorPhyCompB.isTrigger);
+
+                    bool isBetweenRigidbodyAndNonTrigger =
+                        (hasRigidBodies[precursorA->id] && !precursorPhyCompB.isTrigger) || (hasRigidBodies[precursorB->id] && !precursorPhyCompA.isTrigger);
+
+                    bool isBetween2Rigidbodies = (hasRigidBodies[precursorA->id] && hasRigidBodies[precursorB->id]);
+
+                    //resting rigidbodies only need to be checked once something awake comes close to them
+                    bool isAwakeRigidbodyInvolved =
+                        (hasRigidBodies[precursorA->id] && !rigidbodies[precursorA->id].isAsleep) || (hasRigidBodies[precursorB->id] && !rigidbodies[precursorB->id].isAsleep);
+
+                    if (!isAwakeRigidbodyInvolved && !isBetweenTriggerAndNonTrigger)
+                        continue;
+
+                    if (isBetweenTriggerAndNonTrigger || isBetweenRigidbodyAndNonTrigger || isBetween2Rigidbodies)
+                        candidatePairs.push_back({ precursorA, precursorB });
+                }
+            }
+        }
+
+        //check if we have found this pairing before so we dont solve the collision twice
+        auto pairIds = [](const narrowphase_pair& pair) { return std::make_pair(pair.first->id, pair.second->id); };
+
+        std::sort(candidatePairs.begin(), candidatePairs.end(), [&](const narrowphase_pair& lhs, const narrowphase_pair& rhs)
+            {
+                return pairIds(lhs) < pairIds(rhs);
+            });
+
+        candidatePairs.erase(std::unique(candidatePairs.begin(), candidatePairs.end(), [&](const narrowphase_pair& lhs, const narrowphase_pair& rhs)
+            {
+                return pairIds(lhs) == pairIds(rhs);
+            }), candidatePairs.end());
     }
 
     void PhysicsSystem::constructManifoldsWithPrecursors(ecs::component_container<rigidbody>& rigidbodies, std::vector<byte>& hasRigidBodies, physics_manifold_precursor& precursorA, physics_manifold_precursor& precursorB,
-        std::vector<physics_manifold>& manifoldsToSolve, bool isRigidbodyInvolved, bool isTriggerInvolved)
+        std::vector<physics_manifold>& manifolds, std::vector<std::pair<uint64, seperating_axis_hint>>& seperatingAxisHints, bool isRigidbodyInvolved, bool isTriggerInvolved)
     {
         OPTICK_EVENT();
         if (!precursorA.physicsComp || !precursorB.physicsComp) return;
@@ -262,12 +509,20 @@ namespace legion::physics
 
         //if (physicsComponentA.colliders.empty() || physicsComponentB.colliders.empty()) return;
 
-        for (auto colliderA : physicsComponentA.colliders)
+        for (auto& colliderA : physicsComponentA.colliders)
         {
-            for (auto colliderB : physicsComponentB.colliders)
+            for (auto& colliderB : physicsComponentB.colliders)
             {
                 physics::physics_manifold m;
+
+                // The cache isn't written to until all the jobs are done, so it can be read without locking.
+                uint64 pairKey = seperatingAxisCacheKey(colliderA.get(), colliderB.get());
+                auto cached = m_seperatingAxisCache.find(pairKey);
+                if (cached != m_seperatingAxisCache.end())
+                    m.seperatingAxisHint = cached->second.hint;
+
                 constructManifoldWithCollider(rigidbodies, hasRigidBodies, colliderA.get(), colliderB.get(), precursorA, precursorB, m);
+                seperatingAxisHints.emplace_back(pairKey, m.seperatingAxisHint);
 
                 if (!m.isColliding)
                 {
@@ -276,20 +531,13 @@ namespace legion::physics
 
                 colliderA->PopulateContactPoints(colliderB.get(), m);
 
-                if (isTriggerInvolved)
-                {
-                    //notify the event-bus
-                    raiseEvent<trigger_event>(&m, m_timeStep);
-                    //notify both the trigger and triggerer
-                    //TODO:(Developer-The-Great): the triggerer and trigger should probably received this event
-                    //TODO:(cont.) through the event bus, we should probably create a filterable system here to
-                    //TODO:(cont.) uniquely identify involved objects and then redirect only required messages
-                }
-
-                if (isRigidbodyInvolved && !isTriggerInvolved)
+                //triggers are reported through the event-bus once all the jobs are done
+                //TODO:(Developer-The-Great): the triggerer and trigger should probably received this event
+                //TODO:(cont.) through the event bus, we should probably create a filterable system here to
+                //TODO:(cont.) uniquely identify involved objects and then redirect only required messages
+                if (isTriggerInvolved || isRigidbodyInvolved)
                 {
-                    raiseEvent<collision_event>(&m, m_timeStep);
-                    manifoldsToSolve.emplace_back(std::move(m));
+                    manifolds.emplace_back(std::move(m));
                 }
             }
         }
@@ -3,14 +3,18 @@
 #include <physics/broadphasecollisionalgorithms/broadphasecollisionalgorithm.hpp>
 #include <physics/broadphasecollisionalgorithms/broadphaseuniformgrid.hpp>
 #include <physics/broadphasecollisionalgorithms/broadphasebruteforce.hpp>
+#include <physics/broadphasecollisionalgorithms/broadphaseaabbtree.hpp>
+#include <physics/broadphasecollisionalgorithms/broadphasesweepandprune.hpp>
 #include <physics/components/rigidbody.hpp>
 #include <physics/data/physics_manifold_precursor.hpp>
 #include <physics/data/physics_manifold.hpp>
+#include <physics/data/rigidbody_solver_buffer.hpp>
 #include <physics/physics_contact.hpp>
 #include <physics/components/physics_component.hpp>
 #include <physics/data/identifier.hpp>
 #include <physics/events/events.hpp>
 #include <memory>
+#include <unordered_map>
 #include <rendering/debugrendering.hpp>
 #include <physics/components/fracturer.hpp>
 #include <physics/components/fracturecountdown.hpp>
@@ -30,6 +34,15 @@ namespace legion::physics
         static bool IsPaused;
         static bool oneTimeRunActive;
 
+        // Amount of entities each job of a parallel_for over the physics query handles.
+        static constexpr size_type jobChunkSize = 128;
+
+        // Amount of candidate pairs each narrowphase job checks, pairs are far more expensive than entities so the chunks are smaller.
+        static constexpr size_type narrowphaseChunkSize = 16;
+
+        // Amount of manifolds each solver job resolves at least, consecutive islands get solved by the same job until they add up to this.
+        static constexpr size_type islandChunkSize = 16;
+
         ecs::EntityQuery manifoldPrecursorQuery;
 
         //TODO move implementation to a seperate cpp file
@@ -48,6 +61,7 @@ namespace legion::physics
 
             ecs::component_container<rigidbody> rigidbodies;
             std::vector<byte> hasRigidBodies;
+            std::vector<byte> wasAsleep;
 
             {
                 OPTICK_EVENT("Fetching data");
@@ -55,18 +69,26 @@ namespace legion::physics
 
                 rigidbodies.resize(manifoldPrecursorQuery.size());
                 hasRigidBodies.resize(manifoldPrecursorQuery.size());
-
-                m_scheduler->queueJobs(manifoldPrecursorQuery.size(), [&]() {
-                    id_type index = async::this_job::get_id();
-                    auto entity = manifoldPrecursorQuery[index];
-                    if (entity.has_component<rigidbody>())
+                wasAsleep.resize(manifoldPrecursorQuery.size());
+                m_parentMatrices.resize(manifoldPrecursorQuery.size());
+                m_hasParent.resize(manifoldPrecursorQuery.size());
+
+                auto rigidbodyView = manifoldPrecursorQuery.view<rigidbody>();
+                manifoldPrecursorQuery.parallel_for(jobChunkSize, [&](size_type index, ecs::entity_handle entity) {
+                    // Positions and rotations are local to the parent, the simulation runs in world space.
+                    ecs::entity_handle parent = entity.has_component<hierarchy>() ? entity.get_parent() : ecs::entity_handle(invalid_id);
+                    m_hasParent[index] = parent && parent.get_id() != world_entity_id;
+                    m_parentMatrices[index] = m_hasParent[index] ? HierarchySystem::parentWorldMatrix(entity) : math::mat4(1.f);
+
+                    if (rigidbodyView.contains(index))
                     {
                         hasRigidBodies[index] = true;
-                        rigidbodies[index] = entity.read_component<rigidbody>();
+                        rigidbodies[index] = rigidbodyView[index];
+                        wasAsleep[index] = rigidbodies[index].isAsleep;
                     }
                     else
                         hasRigidBodies[index] = false;
-                    }).wait();
+                    });
             }
 
             auto& physComps = manifoldPrecursorQuery.get<physicsComponent>();
@@ -92,14 +114,14 @@ namespace legion::physics
 
             {
                 OPTICK_EVENT("Writing data");
-                m_scheduler->queueJobs(manifoldPrecursorQuery.size(), [&]() {
-                    id_type index = async::this_job::get_id();
-                    if (hasRigidBodies[index])
-                    {
-                        auto entity = manifoldPrecursorQuery[index];
-                        entity.write_component(rigidbodies[index]);
-                    }
-                    }).wait();
+                {
+                    // Written in place without modification events, rigidbodies that slept through the entire step haven't changed and are skipped.
+                    auto rigidbodyView = manifoldPrecursorQuery.view<rigidbody, ecs::access_mode::read_write>();
+                    manifoldPrecursorQuery.parallel_for(jobChunkSize, [&](size_type index, ecs::entity_handle entity) {
+                        if (hasRigidBodies[index] && !(wasAsleep[index] && rigidbodies[index].isAsleep) && rigidbodyView.contains(index))
+                            rigidbodyView[index] = rigidbodies[index];
+                        });
+                }
 
                     manifoldPrecursorQuery.submit<physicsComponent>();
                     manifoldPrecursorQuery.submit<position>();
@@ -139,20 +161,23 @@ namespace legion::physics
             OPTICK_EVENT();
             manifoldPrecursors.resize(physComps.size());
 
-            m_scheduler->queueJobs(physComps.size(), [&]() {
-                id_type index = async::this_job::get_id();
+            forEachChunk(physComps.size(), [&](size_type index) {
                 math::mat4 transf;
                 math::compose(transf, scales[index], rotations[index], positions[index]);
+                if (m_hasParent[index])
+                    transf = m_parentMatrices[index] * transf;
 
                 for (auto& collider : physComps[index].colliders)
                     collider->UpdateTransformedTightBoundingVolume(transf);
 
                 manifoldPrecursors[index] = { transf, &physComps[index], index, manifoldPrecursorQuery[index] };
-                }).wait();
+                });
         }
 
         /**@brief Sets the broad phase collision detection method
          * Use BroadPhaseBruteForce to not use any broad phase collision detection
+         * Use BroadphaseAABBTree for scenes that mix small and large colliders
+         * Use BroadphaseSweepAndPrune for scenes where most objects move little per frame
          */
         template <typename BroadPhaseType, typename ...Args>
         static void setBroadPhaseCollisionDetection(Args&& ...args)
@@ -174,6 +199,84 @@ namespace legion::physics
 
         math::ivec3 uniformGridCellSize = math::ivec3(1, 1, 1);
 
+        rigidbody_solver_buffer m_solverBuffer;
+
+        // World matrix of the parent of every entity in manifoldPrecursorQuery, only valid for the entities that have a parent other than the world.
+        std::vector<math::mat4> m_parentMatrices;
+        std::vector<byte> m_hasParent;
+
+        /**@brief The seperating axis hint of a collider pair and the step it was last checked in.
+         */
+        struct cached_seperating_axis
+        {
+            seperating_axis_hint hint;
+            size_type lastStep;
+        };
+
+        // Hints of the collider pairs checked in the last step, only read while the narrowphase jobs are running.
+        std::unordered_map<uint64, cached_seperating_axis> m_seperatingAxisCache;
+        size_type m_physicsStep = 0;
+        // Amount of islands that fell asleep so far, used to give every sleeping island its own id.
+        size_type m_sleepingIslandCount = 0;
+
+        /**@brief Gets the key of a collider pair in m_seperatingAxisCache.
+         */
+        static uint64 seperatingAxisCacheKey(const PhysicsCollider* colliderA, const PhysicsCollider* colliderB)
+        {
+            return (static_cast<uint64>(static_cast<uint32>(colliderA->GetColliderID())) << 32) | static_cast<uint32>(colliderB->GetColliderID());
+        }
+
+        /**@brief Calls func with the first and one past the last index of every chunk of jobChunkSize indices below count, one job per chunk.
+         * Blocks until all the jobs are done.
+         */
+        template<typename Func>
+        void forEachChunkRange(size_type count, Func&& func)
+        {
+            size_type jobCount = (count + jobChunkSize - 1) / jobChunkSize;
+
+            auto runJob = [&](size_type jobIndex)
+            {
+                func(jobIndex * jobChunkSize, math::min((jobIndex + 1) * jobChunkSize, count));
+            };
+
+            if (jobCount <= 1) // Not worth the overhead of queueing a job.
+            {
+                if (jobCount)
+                    runJob(0);
+                return;
+            }
+
+            m_scheduler->queueJobs(jobCount, [&]()
+                {
+                    runJob(async::this_job::get_id());
+                }).wait();
+        }
+
+        /**@brief Calls func for every index below count, split into jobs of jobChunkSize indices.
+         * Blocks until all the jobs are done.
+         */
+        template<typename Func>
+        void forEachChunk(size_type count, Func&& func)
+        {
+            forEachChunkRange(count, [&](size_type begin, size_type end)
+                {
+                    for (size_type i = begin; i < end; i++)
+                        func(i);
+                });
+        }
+
+        using narrowphase_pair = std::pair<physics_manifold_precursor*, physics_manifold_precursor*>;
+
+        /**@brief Output of one narrowphase job, the buffers of all jobs get merged in order once they are done.
+         */
+        struct narrowphase_buffer
+        {
+            std::vector<physics_manifold> manifolds;
+            std::vector<physics_manifold> triggerManifolds;
+            // New seperating axis hint of every collider pair that was checked.
+            std::vector<std::pair<uint64, seperating_axis_hint>> seperatingAxisHints;
+        };
+
         /** @brief Performs the entire physics pipeline (
          * Broadphase Collision Detection, Narrowphase Collision Detection, and the Collision Resolution)
         */
@@ -186,16 +289,42 @@ namespace legion::physics
             ecs::component_container<scale>& scales,
             float deltaTime);
        
+        /**@brief Flattens the broadphase groupings into a list of unique pairs that need to be checked in narrowphase,
+        * pairs that can't produce a manifold or trigger are left out, as are pairs without any awake rigidbody.
+        * @param candidatePairs [out] the pairs sorted by the ids of their precursors, with the lowest id first in every pair
+        */
+        void collectCandidatePairs(std::vector<std::vector<physics_manifold_precursor>>& manifoldPrecursorGrouping, std::vector<byte>& hasRigidBodies,
+            ecs::component_container<rigidbody>& rigidbodies, std::vector<narrowphase_pair>& candidatePairs);
+
         /**@brief given 2 physics_manifold_precursors precursorA and precursorB, create a manifold for each collider in precursorA
-        * with every other collider in precursorB. The manifolds that involve rigidbodies are then pushed into the given manifold list
-        * @param manifoldsToSolve [out] a std::vector of physics_manifold that will store the manifolds created
+        * with every other collider in precursorB. The colliding manifolds that involve rigidbodies or triggers are then pushed into the given manifold list
+        * @note Doesn't raise any events, so it is safe to call from multiple jobs at once.
+        * @param manifolds [out] a std::vector of physics_manifold that will store the manifolds created
+        * @param seperatingAxisHints [out] the key and new seperating axis hint of every collider pair that was checked
         * @param isRigidbodyInvolved A bool that indicates whether a rigidbody is involved in this manifold
         * @param isTriggerInvolved A bool that indicates whether a physicsComponent with a physicsComponent::isTrigger set to true is involved in this manifold
         */
         void constructManifoldsWithPrecursors(ecs::component_container<rigidbody>& rigidbodies, std::vector<byte>& hasRigidBodies, physics_manifold_precursor& precursorA, physics_manifold_precursor& precursorB,
-            std::vector<physics_manifold>& manifoldsToSolve, bool isRigidbodyInvolved, bool isTriggerInvolved);
+            std::vector<physics_manifold>& manifolds, std::vector<std::pair<uint64, seperating_axis_hint>>& seperatingAxisHints, bool isRigidbodyInvolved, bool isTriggerInvolved);
        
 
+        /**@brief Groups the valid manifolds into islands, sets of manifolds that share no rigidbodies with the manifolds of any other island.
+        * Rigidbodies are connected through the manifolds between them, colliders without a rigidbody don't connect anything since the solver never changes them.
+        * Sleeping rigidbodies that are part of a manifold with an awake rigidbody get woken up together with everything they fell asleep with, colliders without a rigidbody never wake anything.
+        * @param islands [out] the indices of the manifolds in each island, in the same order as in manifoldsToSolve
+        * @param bodyIslands [out] for every rigidbody the index of the rigidbody that represents its island, rigidbodies without contacts represent themselves
+        */
+        void buildIslands(std::vector<physics_manifold>& manifoldsToSolve, std::vector<byte>& manifoldValidity, ecs::component_container<rigidbody>& rigidbodies,
+            std::vector<std::vector<size_type>>& islands, std::vector<size_type>& bodyIslands);
+
+        /**@brief Runs the contact and friction solver over the manifolds of one island.
+        */
+        void solveIsland(std::vector<physics_manifold>& manifoldsToSolve, const std::vector<size_type>& island, float deltaTime);
+
+        /**@brief Puts the rigidbodies of an island to sleep once all of them have moved slower than the sleep thresholds for long enough.
+        */
+        void updateSleepStates(std::vector<byte>& hasRigidBodies, ecs::component_container<rigidbody>& rigidbodies, const std::vector<size_type>& bodyIslands, float deltaTime);
+
         void constructManifoldWithCollider(
             ecs::component_container<rigidbody>& rigidbodies, std::vector<byte>& hasRigidBodies,
             PhysicsCollider* colliderA, PhysicsCollider* colliderB
@@ -230,27 +359,20 @@ namespace legion::physics
             colliderA->CheckCollision(colliderB, manifold);
         }
 
-        /** @brief gets all the entities with a rigidbody component and calls the integrate function on them
+        /** @brief Applies forces and gravity to the velocities of all the awake rigidbodies.
+        * Every job packs its chunk of rigidbodies into m_solverBuffer, integrates it with SIMD and writes it back while it's still in cache.
         */
         void integrateRigidbodies(std::vector<byte>& hasRigidBodies, ecs::component_container<rigidbody>& rigidbodies, float deltaTime)
         {
             OPTICK_EVENT();
-            m_scheduler->queueJobs(manifoldPrecursorQuery.size(), [&]() {
-                if (!hasRigidBodies[async::this_job::get_id()])
-                    return;
-
-                auto& rb = rigidbodies[async::this_job::get_id()];
-
-                ////-------------------- update velocity ------------------//
-                math::vec3 acc = rb.forceAccumulator * rb.inverseMass;
-                rb.velocity += (acc + constants::gravity) * deltaTime;
-
-                ////-------------------- update angular velocity ------------------//
-                math::vec3 angularAcc = rb.torqueAccumulator * rb.globalInverseInertiaTensor;
-                rb.angularVelocity += (angularAcc)*deltaTime;
-
-                rb.resetAccumulators();
-                }).wait();
+            static_assert(jobChunkSize % rigidbody_solver_buffer::simd_width == 0, "Every chunk needs to start at a whole SIMD group.");
+
+            m_solverBuffer.resize(rigidbodies.size());
+            forEachChunkRange(rigidbodies.size(), [&](size_type begin, size_type end) {
+                m_solverBuffer.gather(rigidbodies, hasRigidBodies, begin, end);
+                m_solverBuffer.integrate(deltaTime, begin, end);
+                m_solverBuffer.scatter(rigidbodies, begin, end);
+                });
         }
 
         void integrateRigidbodyQueryPositionAndRotation(
@@ -261,17 +383,27 @@ namespace legion::physics
             float deltaTime)
         {
             OPTICK_EVENT();
-            m_scheduler->queueJobs(manifoldPrecursorQuery.size(), [&]() {
-                id_type index = async::this_job::get_id();
+            forEachChunk(manifoldPrecursorQuery.size(), [&](size_type index) {
                 if (!hasRigidBodies[index])
                     return;
 
                 auto& rb = rigidbodies[index];
+                if (rb.isAsleep)
+                    return;
+
                 auto& pos = positions[index];
                 auto& rot = rotations[index];
 
+                // The velocities are in world space, children move through the space of their parent.
+                const bool hasParent = m_hasParent[index];
+                const math::mat4& parentMatrix = m_parentMatrices[index];
+                math::quat parentRotation = hasParent ? world_transform{ parentMatrix }.get_rotation() : math::quat(1, 0, 0, 0);
+
                 ////-------------------- update position ------------------//
-                pos += rb.velocity * deltaTime;
+                math::vec3 displacement = rb.velocity * deltaTime;
+                if (hasParent)
+                    displacement = math::vec3(math::inverse(parentMatrix) * math::vec4(displacement, 0.f));
+                pos += displacement;
 
                 ////-------------------- update rotation ------------------//
                 float angle = math::clamp(math::length(rb.angularVelocity), 0.0f, 32.0f);
@@ -280,6 +412,8 @@ namespace legion::physics
                 if (!math::epsilonEqual(dtAngle, 0.0f, math::epsilon<float>()))
                 {
                     math::vec3 axis = math::normalize(rb.angularVelocity);
+                    if (hasParent)
+                        axis = math::inverse(parentRotation) * axis;
 
                     math::quat glmQuat = math::angleAxis(dtAngle, axis);
                     rot = glmQuat * rot;
@@ -287,65 +421,53 @@ namespace legion::physics
                 }
 
                 //for now assume that there is no offset from bodyP
-                rb.globalCentreOfMass = pos;
+                rb.globalCentreOfMass = hasParent ? math::vec3(parentMatrix * math::vec4(pos, 1.f)) : math::vec3(pos);
 
-                rb.UpdateInertiaTensor(rot);
-                }).wait();
+                rb.UpdateInertiaTensor(hasParent ? math::normalize(parentRotation * rot) : math::quat(rot));
+                });
         }
 
-        void initializeManifolds(std::vector<physics_manifold>& manifoldsToSolve, std::vector<byte>& manifoldValidity)
+        void initializeManifolds(std::vector<physics_manifold>& manifoldsToSolve, const std::vector<size_type>& island)
         {
             OPTICK_EVENT();
-            for (int i = 0; i < manifoldsToSolve.size(); i++)
+            for (size_type manifoldIndex : island)
             {
-                if (manifoldValidity.at(i))
-                {
-                    auto& manifold = manifoldsToSolve.at(i);
+                auto& manifold = manifoldsToSolve.at(manifoldIndex);
 
-                    for (auto& contact : manifold.contacts)
-                    {
-                        contact.preCalculateEffectiveMass();
-                        contact.ApplyWarmStarting();
-                    }
+                for (auto& contact : manifold.contacts)
+                {
+                    contact.preCalculateEffectiveMass();
+                    contact.ApplyWarmStarting();
                 }
-
             }
         }
 
-        void resolveContactConstraint(std::vector<physics_manifold>& manifoldsToSolve, std::vector<byte>& manifoldValidity, float dt, int contactIter)
+        void resolveContactConstraint(std::vector<physics_manifold>& manifoldsToSolve, const std::vector<size_type>& island, float dt, int contactIter)
         {
             OPTICK_EVENT();
 
-            for (int manifoldIter = 0;
-                manifoldIter < manifoldsToSolve.size(); manifoldIter++)
+            for (size_type manifoldIndex : island)
             {
-                if (manifoldValidity.at(manifoldIter))
-                {
-                    auto& manifold = manifoldsToSolve.at(manifoldIter);
+                auto& manifold = manifoldsToSolve.at(manifoldIndex);
 
-                    for (auto& contact : manifold.contacts)
-                    {
-                        contact.resolveContactConstraint(dt, contactIter);
-                    }
+                for (auto& contact : manifold.contacts)
+                {
+                    contact.resolveContactConstraint(dt, contactIter);
                 }
             }
         }
 
-        void resolveFrictionConstraint(std::vector<physics_manifold>& manifoldsToSolve, std::vector<byte>& manifoldValidity)
+        void resolveFrictionConstraint(std::vector<physics_manifold>& manifoldsToSolve, const std::vector<size_type>& island)
         {
             OPTICK_EVENT();
 
-            for (int manifoldIter = 0;
-                manifoldIter < manifoldsToSolve.size(); manifoldIter++)
+            for (size_type manifoldIndex : island)
             {
-                if (manifoldValidity.at(manifoldIter))
-                {
-                    auto& manifold = manifoldsToSolve.at(manifoldIter);
+                auto& manifold = manifoldsToSolve.at(manifoldIndex);
 
-                    for (auto& contact : manifold.contacts)
-                    {
-                        contact.resolveFrictionConstraint();
-                    }
+                for (auto& contact : manifold.contacts)
+                {
+                    contact.resolveFrictionConstraint();
                 }
             }
         }
@@ -6,15 +6,15 @@ namespace legion::rendering
 
     light::light() : m_type(light_type::POINT), m_attenuation(10), m_intensity(1), m_index(m_lastidx++), m_direction(0, 0, 1), m_falloff(math::pi<float>()), m_position(0,0,0), m_angle(math::radians(45.f)), m_color(1, 1, 1) { }
 
-    const detail::light_data& light::get_light_data(const ecs::component_handle<position>& pos, const ecs::component_handle<rotation>& rot)
+    const detail::light_data& light::get_light_data(const world_transform& transf)
     {
         if (m_type != light_type::DIRECTIONAL)
-            m_position = pos.read();
+            m_position = transf.get_position();
         else
             m_attenuation = FLT_MAX;
 
         if (m_type != light_type::POINT)
-            m_direction = -rot.read().forward();
+            m_direction = -transf.forward();
 
         return m_lightData;
     }
@@ -33,7 +33,7 @@ namespace legion::rendering
     public:
         light();
 
-        const detail::light_data& get_light_data(const ecs::component_handle<position>& pos, const ecs::component_handle<rotation>& rot);
+        const detail::light_data& get_light_data(const world_transform& transf);
 
         void set_type(light_type type);
         void set_attenuation(float attenuation);
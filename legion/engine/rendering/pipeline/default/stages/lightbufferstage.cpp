@@ -66,7 +66,7 @@ namespace legion::rendering
             for (auto ent : m_lightEntities)
             {
                 light lght = ent.read_component<light>();
-                m_lights[i] = lght.get_light_data(ent.get_component_handle<position>(), ent.get_component_handle<rotation>());
+                m_lights[i] = lght.get_light_data(HierarchySystem::worldTransform(ent));
                 i++;
             }
         }
@@ -19,14 +19,11 @@ namespace  legion::rendering
         static id_type batchesId = nameHash("mesh batches");
         auto* batches = get_meta<sparse_map<material_handle, sparse_map<model_handle, std::vector<math::mat4>>>>(batchesId);
 
-        static auto renderablesQuery = createQuery<position, rotation, scale, mesh_filter, mesh_renderer>();
+        // world_transform gets added by the HierarchySystem, entities created since its last update calculate their matrix from their local transform.
+        static auto renderablesQuery = createQuery<world_transform, mesh_filter, mesh_renderer>();
+        static auto transformedQuery = createQuery<position, rotation, scale, mesh_filter, mesh_renderer>();
         renderablesQuery.queryEntities();
-
-        auto& positions = renderablesQuery.get<position>();
-        auto& rotations = renderablesQuery.get<rotation>();
-        auto& scales = renderablesQuery.get<scale>();
-        auto& filters = renderablesQuery.get<mesh_filter>();
-        auto& renderers = renderablesQuery.get<mesh_renderer>();
+        transformedQuery.queryEntities();
 
         {
             OPTICK_EVENT("Clear instances");
@@ -37,10 +34,27 @@ namespace  legion::rendering
 
         {
             OPTICK_EVENT("Calculate instances");
+            auto worldTransforms = renderablesQuery.view<world_transform>();
+            auto filters = renderablesQuery.view<mesh_filter>();
+            auto renderers = renderablesQuery.view<mesh_renderer>();
+
             for (int i = 0; i < renderablesQuery.size(); i++)
             {
                 OPTICK_EVENT("instance");
-                (*batches)[renderers[i].material][model_handle{ filters[i].id }].push_back(math::compose(scales[i], rotations[i], positions[i]));
+                (*batches)[renderers[i].material][model_handle{ filters[i].id }].push_back(worldTransforms[i].matrix);
+            }
+        }
+
+        {
+            // The views are gone, so checking the families per entity doesn't lock them recursively.
+            OPTICK_EVENT("Uncached instances");
+            for (auto& entity : transformedQuery)
+            {
+                if (entity.has_component<world_transform>())
+                    continue;
+
+                transform transf = entity.get_component_handles<transform>();
+                (*batches)[entity.read_component<mesh_renderer>().material][model_handle{ entity.read_component<mesh_filter>().id }].push_back(transf.get_local_to_world_matrix());
             }
         }
     }
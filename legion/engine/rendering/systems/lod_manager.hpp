@@ -12,7 +12,7 @@ namespace legion::rendering
     {
         void setup()
         {
-            createProcess<&LODManager::update>("Update");
+            createProcess<&LODManager::update>("Update").reads<position, rotation, scale, world_transform, camera>().writes<lod>();
         }
         /** @brief Update queries all entities with LOD components, caclulates their distance and updates the LOD
           */
@@ -26,7 +26,7 @@ namespace legion::rendering
             for (ecs::entity_handle entity : m_query)
             {
                 //get distance for current entity
-                float distance = CalculateDistance(entity.get_component_handle<position>());
+                float distance = CalculateDistance(HierarchySystem::worldTransform(entity).get_position());
                 //read the LOD
                 auto currentLOD = entity.get_component_handle<lod>().read();
                 //make sure it is initialized
@@ -75,14 +75,14 @@ namespace legion::rendering
             {
                 if (entity.has_component<position>())
                 {
-                    m_camPosition = entity.get_component_handle<position>().read();
+                    m_camPosition = HierarchySystem::worldTransform(entity).get_position();
                 }
             }
         }
-        //calculates distince between cam and input positon
-        float CalculateDistance(ecs::component_handle<position> pos)
+        //calculates distince between cam and input world positon
+        float CalculateDistance(const math::vec3& pos)
         {
-            return math::distance(pos.read(), m_camPosition);
+            return math::distance(pos, m_camPosition);
         }
         math::vec3 m_camPosition;
         //query for the lod components
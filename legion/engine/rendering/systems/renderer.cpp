@@ -1,6 +1,6 @@
 #include <rendering/systems/renderer.hpp>
 #include <rendering/debugrendering.hpp>
-#include <Optick/optick.h>
+#include <core/tracing/tracing.hpp>
 
 namespace legion::rendering
 {
@@ -315,6 +315,7 @@ namespace legion::rendering
 
         bindToEvent<events::exit, &Renderer::onExit>();
 
+        // No component access is declared on purpose, the render stages need the context of the rendering thread so rendering has to run on the chain thread.
         createProcess<&Renderer::render>("Rendering");
 
         m_scheduler->sendCommand(m_scheduler->getChainThreadId("Rendering"), [&]()
@@ -386,17 +387,12 @@ namespace legion::rendering
             if (viewportSize.x == 0 || viewportSize.y == 0)
                 continue;
 
-            position camPos = ent.get_component_handle<position>().read();
-            rotation camRot = ent.get_component_handle<rotation>().read();
-            scale camScale = ent.get_component_handle<scale>().read();
-
-            math::mat4 view(1.f);
-            math::compose(view, camScale, camRot, camPos);
-            view = math::inverse(view);
+            world_transform camTransform = HierarchySystem::worldTransform(ent);
+            math::mat4 view = math::inverse(camTransform.matrix);
 
             math::mat4 projection = cam.get_projection(((float)viewportSize.x) / viewportSize.y);
 
-            camera::camera_input cam_input_data(view, projection, camPos, camRot.forward(), cam.nearz, cam.farz, viewportSize);
+            camera::camera_input cam_input_data(view, projection, camTransform.get_position(), camTransform.forward(), cam.nearz, cam.farz, viewportSize);
 
             if (!m_exiting.load(std::memory_order_relaxed))
             {